@@ -9,12 +9,14 @@
 // Arguments:
 // - cchRowWidth - the length of the default text attribute
 // - attr - the default text attribute
+// - table - the table that the attributes of the row are interned in
 // Return Value:
 // - constructed object
 // Note: will throw exception if unable to allocate memory for text attribute storage
-ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr)
+ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr, TextAttributeTable& table) :
+    _table{ &table }
 {
-    _list.push_back(TextAttributeRun(cchRowWidth, attr));
+    _list.push_back(TextAttributeIdRun{ _table->Intern(attr), gsl::narrow<uint16_t>(cchRowWidth) });
     _cchRowWidth = cchRowWidth;
 }
 
@@ -24,8 +26,9 @@ ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr)
 // - attr - The default text attributes to use on text in this row.
 void ATTR_ROW::Reset(const TextAttribute attr)
 {
+    const auto id = _table->Intern(attr);
     _list.clear();
-    _list.push_back(TextAttributeRun(_cchRowWidth, attr));
+    _list.push_back(TextAttributeIdRun{ id, gsl::narrow<uint16_t>(_cchRowWidth) });
 }
 
 // Routine Description:
@@ -49,7 +52,7 @@ void ATTR_ROW::Resize(const size_t newWidth)
         auto& run = _list.at(runPos);
 
         // Extend its length by the additional columns we're adding.
-        run.SetLength(run.GetLength() + newWidth - _cchRowWidth);
+        run.length = gsl::narrow<uint16_t>(run.length + newWidth - _cchRowWidth);
 
         // Store that the new total width we represent is the new width.
         _cchRowWidth = newWidth;
@@ -67,7 +70,7 @@ void ATTR_ROW::Resize(const size_t newWidth)
         // then when we called FindAttrIndex, it returned the B5 as the pIndexedRun and a 2 for how many more segments it covers
         // after and including the 3rd column.
         // B5-2 = B3, which is what we desire to cover the new 3 size buffer.
-        run.SetLength(run.GetLength() - CountOfAttr + 1);
+        run.length = gsl::narrow<uint16_t>(run.length - CountOfAttr + 1);
 
         // Store that the new total width we represent is the new width.
         _cchRowWidth = newWidth;
@@ -108,7 +111,22 @@ TextAttribute ATTR_ROW::GetAttrByColumn(const size_t column,
 {
     THROW_HR_IF(E_INVALIDARG, column >= _cchRowWidth);
     const auto runPos = FindAttrIndex(column, pApplies);
-    return _list.at(runPos).GetAttributes();
+    return _table->Get(_list.at(runPos).id);
+}
+
+// Routine Description:
+// - returns the ID of the TextAttribute at the specified column. Columns
+//   with the same ID have the same attributes.
+// Arguments:
+// - column - the column to get the attribute ID for
+// Return Value:
+// - the ID of the text attribute at column, in the table of the text buffer
+// Note:
+// - will throw on error
+TextAttributeTable::Id ATTR_ROW::GetAttrIdByColumn(const size_t column) const
+{
+    THROW_HR_IF(E_INVALIDARG, column >= _cchRowWidth);
+    return _list.at(FindAttrIndex(column, nullptr)).id;
 }
 
 // Routine Description:
@@ -141,7 +159,7 @@ size_t ATTR_ROW::FindAttrIndex(const size_t index, size_t* const pApplies) const
     auto runPos = _list.cbegin();
     do
     {
-        cTotalLength += runPos->GetLength();
+        cTotalLength += runPos->length;
 
         if (cTotalLength > index)
         {
@@ -186,8 +204,8 @@ bool ATTR_ROW::SetAttrToEnd(const UINT iStart, const TextAttribute attr)
 {
     size_t const length = _cchRowWidth - iStart;
 
-    const TextAttributeRun run(length, attr);
-    return SUCCEEDED(InsertAttrRuns({ &run, 1 }, iStart, _cchRowWidth - 1, _cchRowWidth));
+    const TextAttributeIdRun run{ _table->Intern(attr), gsl::narrow<uint16_t>(length) };
+    return SUCCEEDED(InsertAttrIdRuns({ &run, 1 }, iStart, _cchRowWidth - 1, _cchRowWidth));
 }
 
 // Routine Description:
@@ -220,26 +238,36 @@ void ATTR_ROW::ReplaceLegacyAttrs(_In_ WORD wToBeReplacedAttr, _In_ WORD wReplac
 // - <none>
 void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept
 {
-    for (auto& run : _list)
+    try
     {
-        if (run.GetAttributes() == toBeReplacedAttr)
+        // If the attributes were never interned, no run can have them.
+        const auto toBeReplaced = _table->Find(toBeReplacedAttr);
+        if (!toBeReplaced.has_value())
         {
-            run.SetAttributes(replaceWith);
+            return;
+        }
+
+        const auto replacement = _table->Intern(replaceWith);
+        for (auto& run : _list)
+        {
+            if (run.id == toBeReplaced.value())
+            {
+                run.id = replacement;
+            }
         }
     }
+    CATCH_LOG();
 }
 
 // Routine Description:
 // - Takes a array of attribute runs, and inserts them into this row from startIndex to endIndex.
-// - For example, if the current row was was [{4, BLUE}], the merge string
-//   was [{ 2, RED }], with (StartIndex, EndIndex) = (1, 2),
-//   then the row would modified to be = [{ 1, BLUE}, {2, RED}, {1, BLUE}].
+// - The attributes are interned into the table of the text buffer first.
+//   See InsertAttrIdRuns for the details.
 // Arguments:
-// - rgInsertAttrs - The array of attrRuns to merge into this row.
-// - cInsertAttrs - The number of elements in rgInsertAttrs
+// - newAttrs - The array of attrRuns to merge into this row.
 // - iStart - The index in the row to place the array of runs.
 // - iEnd - the final index of the merge runs
-// - BufferWidth - the width of the row.
+// - cBufferWidth - the width of the row.
 // Return Value:
 // - STATUS_NO_MEMORY if there wasn't enough memory to insert the runs
 //   otherwise STATUS_SUCCESS if we were successful.
@@ -248,320 +276,332 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                                                const size_t iEnd,
                                                const size_t cBufferWidth)
 {
-    // Definitions:
-    // Existing Run = The run length encoded color array we're already storing in memory before this was called.
-    // Insert Run = The run length encoded color array that someone is asking us to inject into our stored memory run.
-    // New Run = The run length encoded color array that we have to allocate and rebuild to store internally
-    //           which will replace Existing Run at the end of this function.
-    // Example:
-    // cBufferWidth = 10.
-    // Existing Run: R3 -> G5 -> B2
-    // Insert Run: Y1 -> N1 at iStart = 5 and iEnd = 6
-    //            (rgInsertAttrs is a 2 length array with Y1->N1 in it and cInsertAttrs = 2)
-    // Final Run: R3 -> G2 -> Y1 -> N1 -> G1 -> B2
-
-    // We'll need to know what the last valid column is for some calculations versus iEnd
-    // because iEnd is specified to us as an inclusive index value.
-    // Do the -1 math here now so we don't have to have -1s scattered all over this function.
-    const size_t iLastBufferCol = cBufferWidth - 1;
-
-    // If the insertion size is 1, do some pre-processing to
-    // see if we can get this done quickly.
-    if (newAttrs.size() == 1)
+    try
     {
-        // Get the new color attribute we're trying to apply
-        const TextAttribute NewAttr = newAttrs.at(0).GetAttributes();
+        // Most callers insert a single run, one cell at a time. Don't allocate for those.
+        if (newAttrs.size() == 1)
+        {
+            const TextAttributeIdRun run{ _table->Intern(newAttrs.at(0).GetAttributes()),
+                                          gsl::narrow<uint16_t>(newAttrs.at(0).GetLength()) };
+            return InsertAttrIdRuns({ &run, 1 }, iStart, iEnd, cBufferWidth);
+        }
 
-        // If the existing run was only 1 element...
-        // ...and the new color is the same as the old, we don't have to do anything and can exit quick.
-        if (_list.size() == 1 && _list.at(0).GetAttributes() == NewAttr)
+        std::vector<TextAttributeIdRun> runs;
+        runs.reserve(newAttrs.size());
+        for (const auto& run : newAttrs)
         {
+            runs.push_back(TextAttributeIdRun{ _table->Intern(run.GetAttributes()),
+                                               gsl::narrow<uint16_t>(run.GetLength()) });
+        }
+        return InsertAttrIdRuns(runs, iStart, iEnd, cBufferWidth);
+    }
+    CATCH_RETURN();
+}
+
+// Routine Description:
+// - Takes a array of attribute runs, and inserts them into this row from startIndex to endIndex.
+// - For example, if the current row was was [{4, BLUE}], the merge string
+//   was [{ 2, RED }], with (StartIndex, EndIndex) = (1, 2),
+//   then the row would modified to be = [{ 1, BLUE}, {2, RED}, {1, BLUE}].
+// - Runs are compared by their attribute IDs, which are only equal if the
+//   attributes are.
+// - The runs are spliced into the row in place. Most rows hold only a few
+//   runs, which are stored inline, so most writes don't allocate at all.
+// Arguments:
+// - newAttrs - The array of attrRuns to merge into this row.
+// - iStart - The index in the row to place the array of runs.
+// - iEnd - the final index of the merge runs
+// - BufferWidth - the width of the row.
+// Return Value:
+// - STATUS_NO_MEMORY if there wasn't enough memory to insert the runs
+//   otherwise STATUS_SUCCESS if we were successful.
+[[nodiscard]] HRESULT ATTR_ROW::InsertAttrIdRuns(const gsl::span<const TextAttributeIdRun> newAttrs,
+                                                 const size_t iStart,
+                                                 const size_t iEnd,
+                                                 const size_t cBufferWidth)
+{
+    try
+    {
+        // Example:
+        // cBufferWidth = 10.
+        // Existing Run: R3 -> G5 -> B2
+        // Insert Run: Y1 -> N1 at iStart = 5 and iEnd = 6
+        // Final Run: R3 -> G2 -> Y1 -> N1 -> G1 -> B2
+
+        // We'll need to know what the last valid column is for some calculations versus iEnd
+        // because iEnd is specified to us as an inclusive index value.
+        // Do the -1 math here now so we don't have to have -1s scattered all over this function.
+        const size_t iLastBufferCol = cBufferWidth - 1;
+
+        RETURN_HR_IF(E_INVALIDARG, newAttrs.empty() || iStart > iEnd || iEnd > iLastBufferCol);
+
+        // If we're about to cover the entire existing run with a new one, we can also make an optimization.
+        if (iStart == 0 && iEnd == iLastBufferCol)
+        {
+            // Just dump what we're given over what we have and call it a day.
+            _list.assign(newAttrs.begin(), newAttrs.end());
             return S_OK;
         }
-        // .. otherwise if we internally have a list of 2 or more and we're about to insert a single color
-        // it's possible that we just walk left-to-right through the row and find a quick exit.
-        else if (iStart > 0 && iStart == iEnd)
+
+        // Find the existing run that the insertion starts in, and the column that run starts at.
+        size_t first = 0;
+        size_t firstStart = 0;
+        while (firstStart + _list.at(first).length <= iStart)
         {
-            // First we try to find the run where the insertion happens, using lowerBound and upperBound to track
-            // where we are currently at.
-            size_t lowerBound = 0;
-            size_t upperBound = 0;
-            for (size_t i = 0; i < _list.size(); i++)
+            firstStart += _list.at(first).length;
+            ++first;
+        }
+
+        // Colorized output mostly writes one cell after the other in the same color.
+        // If the run we start in already has the color and covers the whole insertion, we're done.
+        // e.g.
+        // AAAAABBBBBBBCCC
+        //       ^^
+        // 'B' is the new color and '^' represents where it's inserted.
+        if (newAttrs.size() == 1 &&
+            newAttrs[0].id == _list.at(first).id &&
+            iEnd < firstStart + _list.at(first).length)
+        {
+            return S_OK;
+        }
+
+        // If the insertion runs all the way to the end of the row (like every character
+        // that gets written at the cursor), the existing runs from iStart on are simply
+        // cut off and the new ones appended.
+        if (iEnd == iLastBufferCol)
+        {
+            const size_t head = iStart - firstStart;
+            const size_t kept = head > 0 ? first + 1 : first;
+
+            // Make room first, so that we can't fail halfway through.
+            _list.reserve(kept + newAttrs.size());
+            _list.erase(_list.cbegin() + kept, _list.cend());
+            if (head > 0)
             {
-                upperBound += _list.at(i).GetLength();
-                if (iStart >= lowerBound && iStart < upperBound)
+                _list.back().length = gsl::narrow_cast<uint16_t>(head);
+            }
+
+            for (const auto& run : newAttrs)
+            {
+                if (!_list.empty() && _list.back().id == run.id)
                 {
-                    const auto curr = std::next(_list.begin(), i);
-
-                    // The run that we try to insert into has the same color as the new one.
-                    // e.g.
-                    // AAAAABBBBBBBCCC
-                    //       ^
-                    // AAAAABBBBBBBCCC
-                    //
-                    // 'B' is the new color and '^' represents where iStart is. We don't have to
-                    // do anything.
-                    if (curr->GetAttributes() == NewAttr)
-                    {
-                        return S_OK;
-                    }
-
-                    // If the insertion happens at current run's lower boundary...
-                    if (iStart == lowerBound)
-                    {
-                        const auto prev = std::prev(curr, 1);
-                        // ... and the previous run has the same color as the new one, we can
-                        // just adjust the counts in the existing two elements in our internal list.
-                        // e.g.
-                        // AAAAABBBBBBBCCC
-                        //      ^
-                        // AAAAAABBBBBBCCC
-                        //
-                        // Here 'A' is the new color.
-                        if (NewAttr == prev->GetAttributes())
-                        {
-                            prev->IncrementLength();
-                            curr->DecrementLength();
-
-                            // If we just reduced the right half to zero, just erase it out of the list.
-                            if (curr->GetLength() == 0)
-                            {
-                                _list.erase(curr);
-                            }
-
-                            return S_OK;
-                        }
-                    }
+                    _list.back().length = gsl::narrow_cast<uint16_t>(_list.back().length + run.length);
                 }
-
-                // Advance one run in the _list.
-                lowerBound = upperBound;
-
-                // The lowerBound is larger than iStart, which means we fail to find an early exit at the run
-                // where the insertion happens. We can just break out.
-                if (lowerBound > iStart)
+                else
                 {
-                    break;
+                    _list.push_back(run);
                 }
             }
+            return S_OK;
         }
-    }
 
-    // If we're about to cover the entire existing run with a new one, we can also make an optimization.
-    if (iStart == 0 && iEnd == iLastBufferCol)
-    {
-        // Just dump what we're given over what we have and call it a day.
-        _list.assign(newAttrs.cbegin(), newAttrs.cend());
-
-        return S_OK;
-    }
-
-    // In the worst case scenario, we will need a new run that is the length of
-    // The existing run in memory + The new run in memory + 1.
-    // This worst case occurs when we inject a new item in the middle of an existing run like so
-    // Existing R3->B5->G2, Insertion Y2 starting at 5 (in the middle of the B5)
-    // becomes R3->B2->Y2->B1->G2.
-    // The original run was 3 long. The insertion run was 1 long. We need 1 more for the
-    // fact that an existing piece of the run was split in half (to hold the latter half).
-    const size_t cNewRun = _list.size() + newAttrs.size() + 1;
-    std::vector<TextAttributeRun> newRun;
-    newRun.resize(cNewRun);
-
-    // We will start analyzing from the beginning of our existing run.
-    // Use some pointers to keep track of where we are in walking through our runs.
-
-    // Get the existing run that we'll be updating/manipulating.
-    const auto existingRun = _list.begin();
-    auto pExistingRunPos = existingRun;
-    const auto pExistingRunEnd = existingRun + _list.size();
-    auto pInsertRunPos = newAttrs.begin();
-    size_t cInsertRunRemaining = newAttrs.size();
-    auto pNewRunPos = newRun.begin();
-    size_t iExistingRunCoverage = 0;
-
-    // Copy the existing run into the new buffer up to the "start index" where the new run will be injected.
-    // If the new run starts at 0, we have nothing to copy from the beginning.
-    if (iStart != 0)
-    {
-        // While we're less than the desired insertion position...
-        while (iExistingRunCoverage < iStart)
+        // Find the existing run that the insertion ends in, and the column just past that run.
+        size_t last = first;
+        size_t lastEnd = firstStart + _list.at(first).length;
+        while (lastEnd <= iEnd)
         {
-            // Add up how much length we can cover by copying an item from the existing run.
-            iExistingRunCoverage += pExistingRunPos->GetLength();
-
-            // Copy it to the new run buffer and advance both pointers.
-            *pNewRunPos++ = *pExistingRunPos++;
+            ++last;
+            lastEnd += _list.at(last).length;
         }
 
-        // When we get to this point, we've copied full segments from the original existing run
-        // into our new run buffer. We will have 1 or more full segments of color attributes and
-        // we MIGHT have to cut the last copied segment's length back depending on where the inserted
-        // attributes will fall in the final/new run.
-        // Some examples:
-        // - Starting with the original string R3 -> G5 -> B2
-        // - 1. If the insertion is Y5 at start index 3
-        //      We are trying to get a result/final/new run of R3 -> Y5 -> B2.
-        //      We just copied R3 to the new destination buffer and we cang skip down and start inserting the new attrs.
-        // - 2. If the insertion is Y3 at start index 5
-        //      We are trying to get a result/final/new run of R3 -> G2 -> Y3 -> B2.
-        //      We just copied R3 -> G5 to the new destination buffer with the code above.
-        //      But the insertion is going to cut out some of the length of the G5.
-        //      We need to fix this up below so it says G2 instead to leave room for the Y3 to fit in
-        //      the new/final run.
-
-        // Copying above advanced the pointer to an empty cell beyond what we copied.
-        // Back up one cell so we can manipulate the final item we copied from the existing run to the new run.
-        pNewRunPos--;
-
-        // Fetch out the length so we can fix it up based on the below conditions.
-        size_t length = pNewRunPos->GetLength();
-
-        // If we've covered more cells already than the start of the attributes to be inserted...
-        if (iExistingRunCoverage > iStart)
+        // The existing runs from first to last are replaced by what's left of the first one
+        // before the insertion, the inserted runs, and what's left of the last one after it.
+        // If the insertion starts or ends right at the edge of an existing run, its neighbor
+        // is replaced as well, so that it can merge with the inserted runs.
+        // e.g. R3 -> G5 -> B2 with B5 inserted at iStart = 3 replaces all three runs with R3 -> B7.
+        size_t replaceBegin = first;
+        size_t replaceEnd = last + 1;
+        if (iStart == firstStart && first > 0)
         {
-            // ..then subtract some of the length of the final cell we copied.
-            // We want to take remove the difference in distance between the cells we've covered in the new
-            // run and the insertion point.
-            // (This turns G5 into G2 from Example 2 just above)
-            length -= (iExistingRunCoverage - iStart);
+            --replaceBegin;
         }
-
-        // Now we're still on that "last cell copied" into the new run.
-        // If the color of that existing copied cell matches the color of the first segment
-        // of the run we're about to insert, we can just increment the length to extend the coverage.
-        if (pNewRunPos->GetAttributes() == pInsertRunPos->GetAttributes())
+        if (iEnd + 1 == lastEnd && replaceEnd < _list.size())
         {
-            length += pInsertRunPos->GetLength();
+            ++replaceEnd;
+        }
 
-            // Since the color matched, we have already "used up" part of the insert run
-            // and can skip it in our big "memcopy" step below that will copy the bulk of the insert run.
-            cInsertRunRemaining--;
-            pInsertRunPos++;
+        til::small_vector<TextAttributeIdRun, 8> replacement;
+        const auto append = [&](const TextAttributeIdRun run) {
+            if (run.length == 0)
+            {
+                return;
+            }
+            if (!replacement.empty() && replacement.back().id == run.id)
+            {
+                replacement.back().length = gsl::narrow_cast<uint16_t>(replacement.back().length + run.length);
+            }
+            else
+            {
+                replacement.push_back(run);
+            }
+        };
+
+        if (replaceBegin < first)
+        {
+            append(_list.at(replaceBegin));
+        }
+        append({ _list.at(first).id, gsl::narrow_cast<uint16_t>(iStart - firstStart) });
+        for (const auto& run : newAttrs)
+        {
+            append(run);
+        }
+        append({ _list.at(last).id, gsl::narrow_cast<uint16_t>(lastEnd - (iEnd + 1)) });
+        if (replaceEnd > last + 1)
+        {
+            append(_list.at(last + 1));
         }
 
-        // We're done manipulating the length. Store it back.
-        pNewRunPos->SetLength(length);
+        // Make room first, so that we can't fail halfway through. Then overwrite the
+        // replaced runs and shift the rest of the row over by however many runs we gained or lost.
+        const size_t replaced = replaceEnd - replaceBegin;
+        const size_t overwritten = std::min(replaced, replacement.size());
+        _list.reserve(_list.size() - replaced + replacement.size());
 
-        // Now that we're done adjusting the last copied item, advance the pointer into a fresh/blank
-        // part of the new run array.
-        pNewRunPos++;
-    }
+        std::copy_n(replacement.cbegin(), overwritten, _list.begin() + replaceBegin);
+        if (replacement.size() > replaced)
+        {
+            _list.insert(_list.cbegin() + replaceBegin + overwritten, replacement.cbegin() + overwritten, replacement.cend());
+        }
+        else
+        {
+            _list.erase(_list.cbegin() + replaceBegin + overwritten, _list.cbegin() + replaceEnd);
+        }
 
-    // Bulk copy the majority (or all, depending on circumstance) of the insert run into the final run buffer.
-    std::copy_n(pInsertRunPos, cInsertRunRemaining, pNewRunPos);
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
 
-    // Advance the new run pointer into the position just after everything we copied.
-    pNewRunPos += cInsertRunRemaining;
+// Routine Description:
+// - Gets the table that the attributes of this row are interned in, to
+//   get IDs for InsertAttrIdRuns.
+TextAttributeTable& ATTR_ROW::GetAttributeTable() const noexcept
+{
+    return *_table;
+}
 
-    // We're technically done with the insert run now and have 0 remaining, but won't bother updating its pointers
-    // and counts any further because we won't use them.
+// Routine Description:
+// - Appends the runs that cover columns [iStart, iStart + cch) of this row
+//   to the end of the given run list. If the first appended run has the same
+//   attributes as the final run already in the list, the two are merged so
+//   the list stays packed.
+// Arguments:
+// - iStart - The first column to copy attributes from
+// - cch - The number of columns to copy
+// - runs - The list to append the runs to
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ATTR_ROW::AppendRuns(const size_t iStart,
+                          const size_t cch,
+                          std::vector<TextAttributeRun>& runs) const
+{
+    THROW_HR_IF(E_INVALIDARG, iStart + cch > _cchRowWidth);
 
-    // Now we need to move our pointer for the original existing run forward and update our counts
-    // on how many cells we could have copied from the source before finishing off the new run.
-    while (iExistingRunCoverage <= iEnd)
+    if (cch == 0)
     {
-        FAIL_FAST_IF(!(pExistingRunPos != pExistingRunEnd));
-        iExistingRunCoverage += pExistingRunPos->GetLength();
-        pExistingRunPos++;
+        return;
     }
 
-    // If we still have original existing run cells remaining, copy them into the final new run.
-    if (pExistingRunPos != pExistingRunEnd || iExistingRunCoverage != (iEnd + 1))
+    size_t applies = 0;
+    auto runPos = _list.cbegin() + FindAttrIndex(iStart, &applies);
+    size_t remaining = cch;
+
+    while (remaining > 0)
     {
-        // Back up one cell so we can inspect the most recent item copied into the new run for optimizations.
-        pNewRunPos--;
-
-        // We advanced the existing run pointer and its count to on or past the end of what the insertion run filled in.
-        // If this ended up being past the end of what the insertion run covers, we have to account for the cells after
-        // the insertion run but before the next piece of the original existing run.
-        // The example in this case is if we had...
-        // Existing Run = R3 -> G5 -> B2 -> X5
-        // Insert Run = Y2 @ iStart = 7 and iEnd = 8
-        // ... then at this point in time, our states would look like...
-        // New Run so far = R3 -> G4 -> Y2
-        // Existing Run Pointer is at X5
-        // Existing run coverage count at 3 + 5 + 2 = 10.
-        // However, in order to get the final desired New Run
-        //   (which is R3 -> G4 -> Y2 -> B1 -> X5)
-        //   we would need to grab a piece of that B2 we already skipped past.
-        // iExistingRunCoverage = 10. iEnd = 8. iEnd+1 = 9. 10 > 9. So we skipped something.
-        if (iExistingRunCoverage > (iEnd + 1))
+        const auto length = std::min(applies, remaining);
+        const auto& attr = _table->Get(runPos->id);
+
+        if (!runs.empty() && runs.back().GetAttributes() == attr)
         {
-            // Back up the existing run pointer so we can grab the piece we skipped.
-            pExistingRunPos--;
-
-            // If the color matches what's already in our run, just increment the count value.
-            // This case is slightly off from the example above. This case is for if the B2 above was actually Y2.
-            // That Y2 from the existing run is the same color as the Y2 we just filled a few columns left in the final run
-            // so we can just adjust the final run's column count instead of adding another segment here.
-            if (pNewRunPos->GetAttributes() == pExistingRunPos->GetAttributes())
-            {
-                size_t length = pNewRunPos->GetLength();
-                length += (iExistingRunCoverage - (iEnd + 1));
-                pNewRunPos->SetLength(length);
-            }
-            else
-            {
-                // If the color didn't match, then we just need to copy the piece we skipped and adjust
-                // its length for the discrepancy in columns not yet covered by the final/new run.
+            runs.back().SetLength(runs.back().GetLength() + length);
+        }
+        else
+        {
+            runs.emplace_back(length, attr);
+        }
+
+        remaining -= length;
+        if (remaining > 0)
+        {
+            ++runPos;
+            applies = runPos->length;
+        }
+    }
+}
 
-                // Move forward to a blank spot in the new run
-                pNewRunPos++;
+// Routine Description:
+// - Same as AppendRuns, but appends the IDs of the attributes instead. The
+//   runs can only be inserted into rows that share this row's table.
+// Arguments:
+// - iStart - The first column to copy attributes from
+// - cch - The number of columns to copy
+// - runs - The list to append the runs to
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ATTR_ROW::AppendIdRuns(const size_t iStart,
+                            const size_t cch,
+                            std::vector<TextAttributeIdRun>& runs) const
+{
+    THROW_HR_IF(E_INVALIDARG, iStart + cch > _cchRowWidth);
 
-                // Copy the existing run's color information to the new run
-                pNewRunPos->SetAttributes(pExistingRunPos->GetAttributes());
+    if (cch == 0)
+    {
+        return;
+    }
 
-                // Adjust the length of that copied color to cover only the reduced number of columns needed
-                // now that some have been replaced by the insert run.
-                pNewRunPos->SetLength(iExistingRunCoverage - (iEnd + 1));
-            }
+    size_t applies = 0;
+    auto runPos = _list.cbegin() + FindAttrIndex(iStart, &applies);
+    size_t remaining = cch;
 
-            // Now that we're done recovering a piece of the existing run we skipped, move the pointer forward again.
-            pExistingRunPos++;
-        }
+    while (remaining > 0)
+    {
+        const auto length = std::min(applies, remaining);
 
-        // OK. In this case, we didn't skip anything. The end of the insert run fell right at a boundary
-        // in columns that was in the original existing run.
-        // However, the next piece of the original existing run might happen to have the same color attribute
-        // as the final piece of what we just copied.
-        // As an example...
-        // Existing Run = R3 -> G5 -> B2.
-        // Insert Run = B5 @ iStart = 3 and iEnd = 7
-        // New Run so far = R3 -> B5
-        // New Run desired when done = R3 -> B7
-        // Existing run pointer is on B2.
-        // We want to merge the 2 from the B2 into the B5 so we get B7.
-        else if (pNewRunPos->GetAttributes() == pExistingRunPos->GetAttributes())
+        if (!runs.empty() && runs.back().id == runPos->id)
         {
-            // Add the value from the existing run into the current new run position.
-            size_t length = pNewRunPos->GetLength();
-            length += pExistingRunPos->GetLength();
-            pNewRunPos->SetLength(length);
-
-            // Advance the existing run position since we consumed its value and merged it in.
-            pExistingRunPos++;
+            runs.back().length = gsl::narrow<uint16_t>(runs.back().length + length);
         }
-
-        // OK. We're done inspecting the most recently copied cell for optimizations.
-        pNewRunPos++;
-
-        // Now bulk copy any segments left in the original existing run
-        if (pExistingRunPos < pExistingRunEnd)
+        else
         {
-            std::copy_n(pExistingRunPos, (pExistingRunEnd - pExistingRunPos), pNewRunPos);
+            runs.push_back({ runPos->id, gsl::narrow<uint16_t>(length) });
+        }
 
-            // Fix up the end pointer so we know where we are for counting how much of the new run's memory space we used.
-            pNewRunPos += (pExistingRunEnd - pExistingRunPos);
+        remaining -= length;
+        if (remaining > 0)
+        {
+            ++runPos;
+            applies = runPos->length;
         }
     }
+}
 
-    // OK, phew. We're done. Now we just need to free the existing run, store the new run in its place,
-    // and update the count for the correct length of the new run now that we've filled it up.
-
-    newRun.erase(pNewRunPos, newRun.end());
-    _list.swap(newRun);
+// Routine Description:
+// - Marks the IDs of all attributes used in this row.
+// Arguments:
+// - used - for every ID in the table of the text buffer, whether it's used
+// Return Value:
+// - <none>
+void ATTR_ROW::MarkUsedIds(std::vector<bool>& used) const
+{
+    for (const auto& run : _list)
+    {
+        used.at(run.id) = true;
+    }
+}
 
-    return S_OK;
+// Routine Description:
+// - Updates the IDs of all attributes in this row after the table of the
+//   text buffer was compacted.
+// Arguments:
+// - remap - the new ID of every old ID, as returned by TextAttributeTable::Compact
+// Return Value:
+// - <none>
+void ATTR_ROW::RemapIds(const std::vector<TextAttributeTable::Id>& remap) noexcept
+{
+    for (auto& run : _list)
+    {
+        run.id = run.id < remap.size() ? remap[run.id] : TextAttributeTable::DefaultId;
+    }
 }
 
 // Routine Description:
@@ -612,9 +652,16 @@ ATTR_ROW::const_iterator ATTR_ROW::cend() const noexcept
     return AttrRowIterator::CreateEndIterator(this);
 }
 
+// Routine Description:
+// - Compares the runs of two rows. IDs from the same table are compared
+//   directly, and looked up otherwise.
 bool operator==(const ATTR_ROW& a, const ATTR_ROW& b) noexcept
 {
-    return (a._list.size() == b._list.size() &&
-            a._list.data() == b._list.data() &&
-            a._cchRowWidth == b._cchRowWidth);
+    const auto sameRun = [&](const TextAttributeIdRun& runA, const TextAttributeIdRun& runB) noexcept {
+        return runA.length == runB.length &&
+               (a._table == b._table ? runA.id == runB.id : a._table->Get(runA.id) == b._table->Get(runB.id));
+    };
+
+    return (a._cchRowWidth == b._cchRowWidth &&
+            std::equal(a._list.cbegin(), a._list.cend(), b._list.cbegin(), b._list.cend(), sameRun));
 }
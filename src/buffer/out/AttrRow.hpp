@@ -21,6 +21,7 @@ Revision History:
 #pragma once
 
 #include "TextAttributeRun.hpp"
+#include "TextAttributeTable.hpp"
 #include "AttrRowIterator.hpp"
 
 class ATTR_ROW final
@@ -28,13 +29,14 @@ class ATTR_ROW final
 public:
     using const_iterator = typename AttrRowIterator;
 
-    ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr);
+    ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr, TextAttributeTable& table);
 
     void Reset(const TextAttribute attr);
 
     TextAttribute GetAttrByColumn(const size_t column) const;
     TextAttribute GetAttrByColumn(const size_t column,
                                   size_t* const pApplies) const;
+    TextAttributeTable::Id GetAttrIdByColumn(const size_t column) const;
 
     size_t GetNumberOfRuns() const noexcept;
 
@@ -52,6 +54,23 @@ public:
                                          const size_t iEnd,
                                          const size_t cBufferWidth);
 
+    [[nodiscard]] HRESULT InsertAttrIdRuns(const gsl::span<const TextAttributeIdRun> newAttrs,
+                                           const size_t iStart,
+                                           const size_t iEnd,
+                                           const size_t cBufferWidth);
+
+    TextAttributeTable& GetAttributeTable() const noexcept;
+
+    void AppendRuns(const size_t iStart,
+                    const size_t cch,
+                    std::vector<TextAttributeRun>& runs) const;
+    void AppendIdRuns(const size_t iStart,
+                      const size_t cch,
+                      std::vector<TextAttributeIdRun>& runs) const;
+
+    void MarkUsedIds(std::vector<bool>& used) const;
+    void RemapIds(const std::vector<TextAttributeTable::Id>& remap) noexcept;
+
     static std::vector<TextAttributeRun> PackAttrs(const std::vector<TextAttribute>& attrs);
 
     const_iterator begin() const noexcept;
@@ -64,8 +83,10 @@ public:
     friend class AttrRowIterator;
 
 private:
-    std::vector<TextAttributeRun> _list;
+    // Most rows only have a few runs, so those are kept inline.
+    til::small_vector<TextAttributeIdRun, 4> _list;
     size_t _cchRowWidth;
+    TextAttributeTable* _table; // non ownership pointer, to the table of the text buffer
 
 #ifdef UNIT_TESTING
     friend class AttrRowTests;
@@ -90,13 +90,24 @@ AttrRowIterator AttrRowIterator::operator--(int)
 const TextAttribute* AttrRowIterator::operator->() const
 {
     THROW_HR_IF(E_BOUNDS, _exceeded);
-    return &_run->GetAttributes();
+    return &_pAttrRow->_table->Get(_run->id);
 }
 
 const TextAttribute& AttrRowIterator::operator*() const
 {
     THROW_HR_IF(E_BOUNDS, _exceeded);
-    return _run->GetAttributes();
+    return _pAttrRow->_table->Get(_run->id);
+}
+
+// Routine Description:
+// - Gets the ID of the attributes the iterator points to. Two positions in
+//   the same text buffer have the same attributes if their IDs are equal.
+// Return Value:
+// - the ID of the attributes in the table of the text buffer
+TextAttributeTable::Id AttrRowIterator::GetAttributeId() const
+{
+    THROW_HR_IF(E_BOUNDS, _exceeded);
+    return _run->id;
 }
 
 // Routine Description:
@@ -107,7 +118,7 @@ void AttrRowIterator::_increment(size_t count)
 {
     while (count > 0)
     {
-        const size_t runLength = _run->GetLength();
+        const size_t runLength = _run->length;
         if (count + _currentAttributeIndex < runLength)
         {
             _currentAttributeIndex += count;
@@ -148,7 +159,7 @@ void AttrRowIterator::_decrement(size_t count)
             }
             count -= _currentAttributeIndex + 1;
             --_run;
-            _currentAttributeIndex = _run->GetLength() - 1;
+            _currentAttributeIndex = _run->length - 1;
         }
     }
 }
@@ -7,6 +7,10 @@
 #include "unicode.hpp"
 #include "Row.hpp"
 
+// Four blank cells, as they appear in the char plane. Compared against
+// whole words to scan past the blank ends of a row four cells at a time.
+static constexpr uint64_t FourSpaces = 0x0020002000200020;
+
 // Routine Description:
 // - constructor
 // Arguments:
@@ -18,7 +22,8 @@
 CharRow::CharRow(size_t rowWidth, ROW* const pParent) :
     _wrapForced{ false },
     _doubleBytePadded{ false },
-    _data(rowWidth, value_type()),
+    _chars(rowWidth, UNICODE_SPACE),
+    _attrs(rowWidth, DbcsAttribute{}),
     _pParent{ FAIL_FAST_IF_NULL(pParent) }
 {
 }
@@ -75,7 +80,7 @@ bool CharRow::WasDoubleBytePadded() const noexcept
 // - the size of the row
 size_t CharRow::size() const noexcept
 {
-    return _data.size();
+    return _chars.size();
 }
 
 // Routine Description:
@@ -86,10 +91,8 @@ size_t CharRow::size() const noexcept
 // - <none>
 void CharRow::Reset() noexcept
 {
-    for (auto& cell : _data)
-    {
-        cell.Reset();
-    }
+    std::fill(_chars.begin(), _chars.end(), UNICODE_SPACE);
+    std::fill(_attrs.begin(), _attrs.end(), DbcsAttribute{});
 
     _wrapForced = false;
     _doubleBytePadded = false;
@@ -105,32 +108,111 @@ void CharRow::Reset() noexcept
 {
     try
     {
-        const value_type insertVals;
-        _data.resize(newSize, insertVals);
+        // Reserve both planes first, so that they're never left with
+        // different sizes if we run out of memory.
+        _chars.reserve(newSize);
+        _attrs.reserve(newSize);
+        _chars.resize(newSize, UNICODE_SPACE);
+        _attrs.resize(newSize, DbcsAttribute{});
     }
     CATCH_RETURN();
 
     return S_OK;
 }
 
-typename CharRow::iterator CharRow::begin() noexcept
+// Routine Description:
+// - gets the char of every cell of the row. Cells that hold a glyph from the
+//   UnicodeStorage have StoredGlyphPlaceholder instead, and the trailing
+//   cell of a double width glyph repeats its char.
+// Arguments:
+// - <none>
+// Return Value:
+// - the char plane of the row
+gsl::span<const CharRow::glyph_type> CharRow::Chars() const noexcept
 {
-    return _data.begin();
+    return { _chars.data(), gsl::narrow_cast<std::ptrdiff_t>(_chars.size()) };
 }
 
-typename CharRow::const_iterator CharRow::cbegin() const noexcept
+// Routine Description:
+// - gets the DBCS attribute of every cell of the row
+// Arguments:
+// - <none>
+// Return Value:
+// - the attribute plane of the row
+gsl::span<const DbcsAttribute> CharRow::DbcsAttrs() const noexcept
 {
-    return _data.cbegin();
+    return { _attrs.data(), gsl::narrow_cast<std::ptrdiff_t>(_attrs.size()) };
 }
 
-typename CharRow::iterator CharRow::end() noexcept
+// Routine Description:
+// - copies the chars and attributes of a span of cells from another row.
+//   Glyphs kept in the UnicodeStorage are not copied, only the cells that
+//   refer to them. The caller has to store them for the new cells itself.
+// - The source may be this row, in which case the spans may overlap.
+// Arguments:
+// - source - the row to copy the cells from
+// - srcColumn - the first column to copy from the source row
+// - dstColumn - the first column to copy to in this row
+// - count - the number of cells to copy
+// Return Value:
+// - <none>
+// Note: will throw exception if either span is out of bounds
+void CharRow::CopyCells(const CharRow& source, const size_t srcColumn, const size_t dstColumn, const size_t count)
 {
-    return _data.end();
+    THROW_HR_IF(E_INVALIDARG, srcColumn > source.size() || count > source.size() - srcColumn);
+    THROW_HR_IF(E_INVALIDARG, dstColumn > size() || count > size() - dstColumn);
+
+    if (&source == this && dstColumn > srcColumn)
+    {
+        // Copy from the back, so that the cells we still have to read
+        // aren't overwritten before we get to them.
+        const auto srcChars = _chars.begin() + srcColumn;
+        const auto srcAttrs = _attrs.begin() + srcColumn;
+        std::copy_backward(srcChars, srcChars + count, _chars.begin() + dstColumn + count);
+        std::copy_backward(srcAttrs, srcAttrs + count, _attrs.begin() + dstColumn + count);
+        return;
+    }
+
+    std::copy_n(source._chars.cbegin() + srcColumn, count, _chars.begin() + dstColumn);
+    std::copy_n(source._attrs.cbegin() + srcColumn, count, _attrs.begin() + dstColumn);
 }
 
-typename CharRow::const_iterator CharRow::cend() const noexcept
+// Routine Description:
+// - overwrites a span of cells with copies of a single width char.
+// Arguments:
+// - wch - the char to fill the cells with
+// - column - the first column to fill
+// - count - the number of cells to fill
+// Return Value:
+// - <none>
+// Note: will throw exception if the span is out of bounds
+void CharRow::FillCells(const glyph_type wch, const size_t column, const size_t count)
 {
-    return _data.cend();
+    THROW_HR_IF(E_INVALIDARG, column > size() || count > size() - column);
+
+    std::fill_n(_chars.begin() + column, count, wch);
+    std::fill_n(_attrs.begin() + column, count, DbcsAttribute{});
+}
+
+// Routine Description:
+// - overwrites a span of cells with the chars of legacy CHAR_INFOs. All of
+//   them become single width cells, so none of the CHAR_INFOs may be marked
+//   as the leading or trailing half of a double byte character.
+// Arguments:
+// - charInfos - the cells to write
+// - column - the first column to write to
+// Return Value:
+// - <none>
+// Note: will throw exception if the span is out of bounds
+void CharRow::WriteCharInfos(const gsl::span<const CHAR_INFO> charInfos, const size_t column)
+{
+    const auto count = gsl::narrow<size_t>(charInfos.size());
+    THROW_HR_IF(E_INVALIDARG, column > size() || count > size() - column);
+
+    std::transform(charInfos.cbegin(), charInfos.cend(), _chars.begin() + column, [](const CHAR_INFO& charInfo) noexcept {
+        return charInfo.Char.UnicodeChar;
+    });
+    std::fill_n(_attrs.begin() + column, count, DbcsAttribute{});
 }
 
 // Routine Description:
@@ -141,12 +223,25 @@ typename CharRow::const_iterator CharRow::cend() const noexcept
 // - The calculated left boundary of the internal string.
 size_t CharRow::MeasureLeft() const
 {
-    std::vector<value_type>::const_iterator it = _data.cbegin();
-    while (it != _data.cend() && it->IsSpace())
+    // Stored glyphs have a placeholder in the char plane, so only the
+    // char plane has to be looked at to find blank cells.
+    const auto size = _chars.size();
+    size_t left = 0;
+    while (size - left >= 4)
+    {
+        uint64_t cells;
+        memcpy(&cells, &_chars[left], sizeof(cells));
+        if (cells != FourSpaces)
+        {
+            break;
+        }
+        left += 4;
+    }
+    while (left < size && _chars[left] == UNICODE_SPACE)
     {
-        ++it;
+        ++left;
     }
-    return it - _data.cbegin();
+    return left;
 }
 
 // Routine Description:
@@ -157,17 +252,35 @@ size_t CharRow::MeasureLeft() const
 // - The calculated right boundary of the internal string.
 size_t CharRow::MeasureRight() const noexcept
 {
-    std::vector<value_type>::const_reverse_iterator it = _data.crbegin();
-    while (it != _data.crend() && it->IsSpace())
+    size_t right = _chars.size();
+    while (right >= 4)
     {
-        ++it;
+        uint64_t cells;
+        memcpy(&cells, &_chars[right - 4], sizeof(cells));
+        if (cells != FourSpaces)
+        {
+            break;
+        }
+        right -= 4;
     }
-    return _data.crend() - it;
+    while (right > 0 && _chars[right - 1] == UNICODE_SPACE)
+    {
+        --right;
+    }
+    return right;
 }
 
+// Routine Description:
+// - resets the char and the attribute of the cell at column
+// Arguments:
+// - column - column index to clear
+// Return Value:
+// - <none>
+// Note: will throw exception if column is out of bounds
 void CharRow::ClearCell(const size_t column)
 {
-    _data.at(column).Reset();
+    _chars.at(column) = UNICODE_SPACE;
+    _attrs.at(column).Reset();
 }
 
 // Routine Description:
@@ -178,14 +291,7 @@ void CharRow::ClearCell(const size_t column)
 // - True if there is valid text in this row. False otherwise.
 bool CharRow::ContainsText() const noexcept
 {
-    for (const value_type& cell : _data)
-    {
-        if (!cell.IsSpace())
-        {
-            return true;
-        }
-    }
-    return false;
+    return MeasureRight() != 0;
 }
 
 // Routine Description:
@@ -197,7 +303,7 @@ bool CharRow::ContainsText() const noexcept
 // Note: will throw exception if column is out of bounds
 const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 {
-    return _data.at(column).DbcsAttr();
+    return _attrs.at(column);
 }
 
 // Routine Description:
@@ -209,7 +315,7 @@ const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 // Note: will throw exception if column is out of bounds
 DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 {
-    return _data.at(column).DbcsAttr();
+    return _attrs.at(column);
 }
 
 // Routine Description:
@@ -221,7 +327,8 @@ DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 // Note: will throw exception if column is out of bounds
 void CharRow::ClearGlyph(const size_t column)
 {
-    _data.at(column).EraseChars();
+    _chars.at(column) = UNICODE_SPACE;
+    _attrs.at(column).SetGlyphStored(false);
 }
 
 // Routine Description:
@@ -233,7 +340,7 @@ void CharRow::ClearGlyph(const size_t column)
 // - Note: will throw exception if column is out of bounds
 const CharRow::reference CharRow::GlyphAt(const size_t column) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _chars.size());
     return { const_cast<CharRow&>(*this), column };
 }
 
@@ -246,26 +353,42 @@ const CharRow::reference CharRow::GlyphAt(const size_t column) const
 // - Note: will throw exception if column is out of bounds
 CharRow::reference CharRow::GlyphAt(const size_t column)
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _chars.size());
     return { *this, column };
 }
 
+// Routine Description:
+// - gets the text of the row. The trailing cells of double width glyphs are
+//   left out.
+// Arguments:
+// - <none>
+// Return Value:
+// - the text of the row
 std::wstring CharRow::GetText() const
 {
     std::wstring wstr;
-    wstr.reserve(_data.size());
+    wstr.reserve(_chars.size());
 
-    for (size_t i = 0; i < _data.size(); ++i)
+    // Every other cell holds its whole glyph in the char plane, so runs of
+    // them are copied straight from it.
+    size_t runStart = 0;
+    for (size_t i = 0; i < _attrs.size(); ++i)
     {
-        const auto glyph = GlyphAt(i);
-        if (!DbcsAttrAt(i).IsTrailing())
+        const auto attr = _attrs[i];
+        if (attr.IsTrailing() || attr.IsGlyphStored())
         {
-            for (const auto wch : glyph)
+            wstr.append(_chars.cbegin() + runStart, _chars.cbegin() + i);
+            runStart = i + 1;
+
+            if (!attr.IsTrailing())
             {
-                wstr.push_back(wch);
+                const auto& glyph = GetUnicodeStorage().GetText(GetStorageKey(i));
+                wstr.append(glyph.cbegin(), glyph.cend());
             }
         }
     }
+    wstr.append(_chars.cbegin() + runStart, _chars.cend());
+
     return wstr;
 }
 
@@ -279,7 +402,7 @@ std::wstring CharRow::GetText() const
 // - the delimiter class for the given char
 const DelimiterClass CharRow::DelimiterClassAt(const size_t column, const std::wstring_view wordDelimiters) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _chars.size());
 
     const auto glyph = *GlyphAt(column).begin();
     if (glyph <= UNICODE_SPACE)
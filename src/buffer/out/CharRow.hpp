@@ -7,6 +7,9 @@ Module Name:
 
 Abstract:
 - contains data structure for UCS2 encoded character data of a row
+- the chars and the DBCS attributes of the row are kept in two separate
+  planes, so that scanning or copying one of them doesn't have to step
+  over the other
 
 Author(s):
 - Michael Niksa (miniksa) 10-Apr-2014
@@ -22,8 +25,8 @@ Revision History:
 
 #include "DbcsAttribute.hpp"
 #include "CharRowCellReference.hpp"
-#include "CharRowCell.hpp"
 #include "UnicodeStorage.hpp"
+#include "../../inc/unicode.hpp"
 
 class ROW;
 
@@ -48,11 +51,12 @@ class CharRow final
 {
 public:
     using glyph_type = typename wchar_t;
-    using value_type = typename CharRowCell;
-    using iterator = typename std::vector<value_type>::iterator;
-    using const_iterator = typename std::vector<value_type>::const_iterator;
     using reference = typename CharRowCellReference;
 
+    // Cells whose glyph is kept in the UnicodeStorage hold this char, so
+    // that a cell is blank exactly when it holds a space.
+    static constexpr glyph_type StoredGlyphPlaceholder = UNICODE_REPLACEMENT;
+
     CharRow(size_t rowWidth, ROW* const pParent);
 
     void SetWrapForced(const bool wrap) noexcept;
@@ -77,12 +81,12 @@ public:
     const reference GlyphAt(const size_t column) const;
     reference GlyphAt(const size_t column);
 
-    // iterators
-    iterator begin() noexcept;
-    const_iterator cbegin() const noexcept;
-
-    iterator end() noexcept;
-    const_iterator cend() const noexcept;
+    // working with whole planes
+    gsl::span<const glyph_type> Chars() const noexcept;
+    gsl::span<const DbcsAttribute> DbcsAttrs() const noexcept;
+    void CopyCells(const CharRow& source, const size_t srcColumn, const size_t dstColumn, const size_t count);
+    void FillCells(const glyph_type wch, const size_t column, const size_t count);
+    void WriteCharInfos(const gsl::span<const CHAR_INFO> charInfos, const size_t column);
 
     UnicodeStorage& GetUnicodeStorage() noexcept;
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
@@ -93,6 +97,9 @@ public:
     friend CharRowCellReference;
     friend constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept;
 
+    template<typename InputIt1, typename InputIt2>
+    friend void OverwriteColumns(InputIt1 startChars, InputIt1 endChars, InputIt2 startAttrs, CharRow& charRow, const size_t column);
+
 protected:
     // Occurs when the user runs out of text in a given row and we're forced to wrap the cursor to the next line
     bool _wrapForced;
@@ -100,8 +107,9 @@ protected:
     // Occurs when the user runs out of text to support a double byte character and we're forced to the next line
     bool _doubleBytePadded;
 
-    // storage for glyph data and dbcs attributes
-    std::vector<value_type> _data;
+    // storage for glyph data and dbcs attributes, one entry per cell in each
+    std::vector<glyph_type> _chars;
+    std::vector<DbcsAttribute> _attrs;
 
     // ROW that this CharRow belongs to
     ROW* _pParent;
@@ -111,17 +119,16 @@ constexpr bool operator==(const CharRow& a, const CharRow& b) noexcept
 {
     return (a._wrapForced == b._wrapForced &&
             a._doubleBytePadded == b._doubleBytePadded &&
-            a._data == b._data);
+            a._chars == b._chars &&
+            a._attrs == b._attrs);
 }
 
 template<typename InputIt1, typename InputIt2>
-void OverwriteColumns(InputIt1 startChars, InputIt1 endChars, InputIt2 startAttrs, CharRow::iterator outIt)
+void OverwriteColumns(InputIt1 startChars, InputIt1 endChars, InputIt2 startAttrs, CharRow& charRow, const size_t column)
 {
-    std::transform(startChars,
-                   endChars,
-                   startAttrs,
-                   outIt,
-                   [](const wchar_t wch, const DbcsAttribute attr) {
-                       return CharRow::value_type{ wch, attr };
-                   });
+    const auto count = gsl::narrow<size_t>(std::distance(startChars, endChars));
+    THROW_HR_IF(E_INVALIDARG, column > charRow._chars.size() || count > charRow._chars.size() - column);
+
+    std::copy(startChars, endChars, charRow._chars.begin() + column);
+    std::copy_n(startAttrs, count, charRow._attrs.begin() + column);
 }
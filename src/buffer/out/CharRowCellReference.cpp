@@ -14,15 +14,16 @@ void CharRowCellReference::operator=(const std::wstring_view chars)
     THROW_HR_IF(E_INVALIDARG, chars.empty());
     if (chars.size() == 1)
     {
-        _cellData().Char() = chars.front();
-        _cellData().DbcsAttr().SetGlyphStored(false);
+        _char() = chars.front();
+        _dbcsAttr().SetGlyphStored(false);
     }
     else
     {
         auto& storage = _parent.GetUnicodeStorage();
         const auto key = _parent.GetStorageKey(_index);
         storage.StoreGlyph(key, { chars.cbegin(), chars.cend() });
-        _cellData().DbcsAttr().SetGlyphStored(true);
+        _char() = CharRow::StoredGlyphPlaceholder;
+        _dbcsAttr().SetGlyphStored(true);
     }
 }
 
@@ -36,21 +37,39 @@ CharRowCellReference::operator std::wstring_view() const
 }
 
 // Routine Description:
-// - The CharRowCell this object "references"
+// - The char of the cell this object "references"
 // Return Value:
-// - ref to the CharRowCell
-CharRowCell& CharRowCellReference::_cellData()
+// - ref to the char in the parent's char plane
+wchar_t& CharRowCellReference::_char()
 {
-    return _parent._data.at(_index);
+    return _parent._chars.at(_index);
 }
 
 // Routine Description:
-// - The CharRowCell this object "references"
+// - The char of the cell this object "references"
 // Return Value:
-// - ref to the CharRowCell
-const CharRowCell& CharRowCellReference::_cellData() const
+// - ref to the char in the parent's char plane
+const wchar_t& CharRowCellReference::_char() const
 {
-    return _parent._data.at(_index);
+    return _parent._chars.at(_index);
+}
+
+// Routine Description:
+// - The DBCS attribute of the cell this object "references"
+// Return Value:
+// - ref to the attribute in the parent's attribute plane
+DbcsAttribute& CharRowCellReference::_dbcsAttr()
+{
+    return _parent._attrs.at(_index);
+}
+
+// Routine Description:
+// - The DBCS attribute of the cell this object "references"
+// Return Value:
+// - ref to the attribute in the parent's attribute plane
+const DbcsAttribute& CharRowCellReference::_dbcsAttr() const
+{
+    return _parent._attrs.at(_index);
 }
 
 // Routine Description:
@@ -59,7 +78,7 @@ const CharRowCell& CharRowCellReference::_cellData() const
 // - the glyph data
 std::wstring_view CharRowCellReference::_glyphData() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
+    if (_dbcsAttr().IsGlyphStored())
     {
         const auto& text = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
 
@@ -67,7 +86,7 @@ std::wstring_view CharRowCellReference::_glyphData() const
     }
     else
     {
-        return { &_cellData().Char(), 1 };
+        return { &_char(), 1 };
     }
 }
 
@@ -77,13 +96,13 @@ std::wstring_view CharRowCellReference::_glyphData() const
 // - iterator of the glyph data
 CharRowCellReference::const_iterator CharRowCellReference::begin() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
+    if (_dbcsAttr().IsGlyphStored())
     {
         return _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index)).data();
     }
     else
     {
-        return &_cellData().Char();
+        return &_char();
     }
 }
 
@@ -96,21 +115,21 @@ CharRowCellReference::const_iterator CharRowCellReference::begin() const
 // TODO GH 2672: eliminate using pointers raw as begin/end markers in this class
 CharRowCellReference::const_iterator CharRowCellReference::end() const
 {
-    if (_cellData().DbcsAttr().IsGlyphStored())
+    if (_dbcsAttr().IsGlyphStored())
     {
         const auto& chars = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
         return chars.data() + chars.size();
     }
     else
     {
-        return &_cellData().Char() + 1;
+        return &_char() + 1;
     }
 }
 #pragma warning(pop)
 
 bool operator==(const CharRowCellReference& ref, const std::vector<wchar_t>& glyph)
 {
-    const DbcsAttribute& dbcsAttr = ref._cellData().DbcsAttr();
+    const DbcsAttribute& dbcsAttr = ref._dbcsAttr();
     if (glyph.size() == 1 && dbcsAttr.IsGlyphStored())
     {
         return false;
@@ -121,7 +140,7 @@ bool operator==(const CharRowCellReference& ref, const std::vector<wchar_t>& gly
     }
     else if (glyph.size() == 1 && !dbcsAttr.IsGlyphStored())
     {
-        return ref._cellData().Char() == glyph.front();
+        return ref._char() == glyph.front();
     }
     else
     {
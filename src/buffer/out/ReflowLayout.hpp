@@ -0,0 +1,298 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ReflowLayout.hpp
+
+Abstract:
+- Works out where the cells of a text buffer land when its contents are
+  reflowed into a buffer of a different size, without copying any of them.
+- Used by TextBuffer::Reflow. Every row of the new buffer is described by the
+  spans of old cells it receives, so that rows can be copied in any order,
+  in parallel, or only when they're first needed.
+
+--*/
+
+#pragma once
+
+#include "DbcsAttribute.hpp"
+
+class TextBuffer;
+
+// A span of cells that a reflow copies verbatim from one row of a source
+// buffer into one row of the new buffer.
+struct ReflowSegment
+{
+    const TextBuffer* source;
+    size_t srcRow;
+    size_t srcCol;
+    size_t dstCol;
+    size_t length;
+};
+
+// Everything a reflow does to one row of the new buffer. The row receives
+// the segments from firstSegment up to the next row's firstSegment.
+struct ReflowRow
+{
+    size_t firstSegment;
+    bool wrapForced;
+    bool doubleBytePadded;
+};
+
+// ReflowLayout replays the cursor movement of inserting the old buffer's
+// characters one at a time into the new buffer (InsertCharacter,
+// IncrementCursor, NewlineCursor) without touching the new buffer itself.
+// Rows are addressed by their absolute index: the row the cursor would
+// be on if the new buffer never circled. Every absolute row past the
+// bottom of the new buffer costs one circling of the new buffer.
+class ReflowLayout final
+{
+public:
+    using Erasure = std::pair<size_t, short>;
+
+    ReflowLayout(const TextBuffer& source, const COORD newSize, const COORD start) :
+        _source{ &source },
+        _width{ newSize.X },
+        _height{ newSize.Y },
+        _x{ start.X },
+        _row{ gsl::narrow_cast<size_t>(start.Y) },
+        _rows(_row + 1, ReflowRow{ 0, false, false }),
+        _segments{},
+        _erasures{},
+        _lastWritten{},
+        _lastWrittenAttr{}
+    {
+    }
+
+    // Routine Description:
+    // - The position the new buffer's cursor would have right now.
+    COORD CursorPosition() const noexcept
+    {
+        return { _x, _LogicalRow(_row) };
+    }
+
+    size_t CursorRow() const noexcept
+    {
+        return _row;
+    }
+
+    // Routine Description:
+    // - The number of times the new buffer circles while the cursor moves
+    //   down to its current row.
+    size_t CircleCount() const noexcept
+    {
+        const size_t finalRow = gsl::narrow_cast<size_t>(_height) - 1;
+        return _row > finalRow ? _row - finalRow : 0;
+    }
+
+    short Width() const noexcept
+    {
+        return _width;
+    }
+
+    short Height() const noexcept
+    {
+        return _height;
+    }
+
+    const std::vector<ReflowRow>& Rows() const noexcept
+    {
+        return _rows;
+    }
+
+    // Routine Description:
+    // - The segments copied into the given absolute row.
+    gsl::span<const ReflowSegment> RowSegments(const size_t row) const
+    {
+        const auto first = _rows.at(row).firstSegment;
+        const auto end = row + 1 < _rows.size() ? _rows.at(row + 1).firstSegment : _segments.size();
+        return { _segments.data() + first, gsl::narrow_cast<std::ptrdiff_t>(end - first) };
+    }
+
+    // Routine Description:
+    // - The cells of the given absolute row that have to be cleared once
+    //   its segments are copied, because they held a leading byte that
+    //   lost its trailing byte.
+    gsl::span<const Erasure> RowErasures(const size_t row) const
+    {
+        const auto [first, last] = std::equal_range(_erasures.cbegin(),
+                                                    _erasures.cend(),
+                                                    Erasure{ row, 0 },
+                                                    [](const Erasure& a, const Erasure& b) noexcept { return a.first < b.first; });
+        return { _erasures.data() + (first - _erasures.cbegin()), last - first };
+    }
+
+    bool WasWrapForced(const size_t row) const
+    {
+        return _rows.at(row).wrapForced;
+    }
+
+    // Routine Description:
+    // - Places one cell of the old buffer at the cursor, exactly like
+    //   TextBuffer::InsertCharacter would.
+    void PlaceCell(const size_t srcRow, const size_t srcCol, const DbcsAttribute dbcsAttr)
+    {
+        _AssertValidDoubleByteSequence(dbcsAttr);
+
+        // Mirror _PrepareForDoubleByteSequence: a leading byte never lands
+        // on the last column. The row is padded instead.
+        if (dbcsAttr.IsLeading() && _x == _width - 1)
+        {
+            _rows.back().doubleBytePadded = true;
+            _IncrementCursor();
+        }
+
+        _Append(srcRow, srcCol, 1);
+        _lastWritten = std::make_pair(_row, _x);
+        _lastWrittenAttr = dbcsAttr;
+        _IncrementCursor();
+    }
+
+    // Routine Description:
+    // - Places a run of single-width cells of the old buffer at the
+    //   cursor. This is equivalent to calling PlaceCell for each of them,
+    //   but only splits the run where the new buffer's rows end.
+    void PlaceSingleCells(const size_t srcRow, size_t srcCol, size_t count)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        // Only the first cell of the run can follow a double byte character.
+        _AssertValidDoubleByteSequence(DbcsAttribute{});
+        _lastWrittenAttr = DbcsAttribute{};
+
+        while (count > 0)
+        {
+            const auto length = std::min(count, gsl::narrow_cast<size_t>(_width - _x));
+            _Append(srcRow, srcCol, length);
+
+            _x += gsl::narrow_cast<short>(length);
+            _lastWritten = std::make_pair(_row, gsl::narrow_cast<short>(_x - 1));
+            srcCol += length;
+            count -= length;
+
+            if (_x == _width)
+            {
+                _rows.back().wrapForced = true;
+                NewlineCursor();
+            }
+        }
+    }
+
+    void NewlineCursor()
+    {
+        _x = 0;
+        ++_row;
+        _rows.push_back(ReflowRow{ _segments.size(), false, false });
+    }
+
+    // Routine Description:
+    // - Replaces every segment with the segments that the given function
+    //   expands it into. The function is called as
+    //   expand(row, segment, segments, erasures) and appends to segments
+    //   (and to erasures, for cells of the row that have to be cleared).
+    // - Used to copy cells from wherever the source buffer would copy them
+    //   from, when the source buffer hasn't copied them in yet itself.
+    template<typename T>
+    void ExpandSegments(T expand)
+    {
+        std::vector<ReflowSegment> expanded;
+        expanded.reserve(_segments.size());
+
+        for (size_t row = 0; row < _rows.size(); ++row)
+        {
+            const auto first = _rows.at(row).firstSegment;
+            const auto end = row + 1 < _rows.size() ? _rows.at(row + 1).firstSegment : _segments.size();
+            _rows.at(row).firstSegment = expanded.size();
+
+            for (auto segment = first; segment < end; ++segment)
+            {
+                expand(row, _segments.at(segment), expanded, _erasures);
+            }
+        }
+
+        _segments = std::move(expanded);
+        std::sort(_erasures.begin(), _erasures.end());
+    }
+
+private:
+    short _LogicalRow(const size_t row) const noexcept
+    {
+        return gsl::narrow_cast<short>(std::min(row, gsl::narrow_cast<size_t>(_height) - 1));
+    }
+
+    void _IncrementCursor()
+    {
+        ++_x;
+        if (_x == _width)
+        {
+            _rows.back().wrapForced = true;
+            NewlineCursor();
+        }
+    }
+
+    // Routine Description:
+    // - Appends cells to the segment list, extending the final segment
+    //   when the cells continue it in both buffers.
+    void _Append(const size_t srcRow, const size_t srcCol, const size_t length)
+    {
+        if (_rows.back().firstSegment < _segments.size())
+        {
+            auto& last = _segments.back();
+            if (last.srcRow == srcRow &&
+                last.srcCol + last.length == srcCol &&
+                last.dstCol + last.length == gsl::narrow_cast<size_t>(_x))
+            {
+                last.length += length;
+                return;
+            }
+        }
+
+        _segments.push_back(ReflowSegment{ _source, srcRow, srcCol, gsl::narrow_cast<size_t>(_x), length });
+    }
+
+    // Routine Description:
+    // - Mirrors TextBuffer::_AssertValidDoubleByteSequence. The cell before
+    //   the cursor is either the last one we placed or a blank one, since
+    //   the new buffer starts out empty and is only ever written forwards.
+    void _AssertValidDoubleByteSequence(const DbcsAttribute dbcsAttr)
+    {
+        auto prevPosition = std::make_pair(_row, _x);
+        if (_x > 0)
+        {
+            prevPosition.second--;
+        }
+        else if (_LogicalRow(_row) > 0)
+        {
+            prevPosition = std::make_pair(_row - 1, gsl::narrow_cast<short>(_width - 1));
+        }
+
+        const auto prevAttr = _lastWritten == prevPosition ? _lastWrittenAttr : DbcsAttribute{};
+
+        FAIL_FAST_IF(!prevAttr.IsLeading() && dbcsAttr.IsTrailing());
+
+        if (prevAttr.IsLeading() && !dbcsAttr.IsTrailing())
+        {
+            _erasures.push_back(prevPosition);
+            _lastWrittenAttr = DbcsAttribute{};
+        }
+    }
+
+    const TextBuffer* _source;
+
+    const short _width;
+    const short _height;
+
+    short _x;
+    size_t _row;
+
+    std::vector<ReflowRow> _rows;
+    std::vector<ReflowSegment> _segments;
+    std::vector<Erasure> _erasures;
+
+    std::optional<std::pair<size_t, short>> _lastWritten;
+    DbcsAttribute _lastWrittenAttr;
+};
@@ -20,7 +20,7 @@ ROW::ROW(const SHORT rowId, const short rowWidth, const TextAttribute fillAttrib
     _id{ rowId },
     _rowWidth{ gsl::narrow<size_t>(rowWidth) },
     _charRow{ gsl::narrow<size_t>(rowWidth), this },
-    _attrRow{ gsl::narrow<UINT>(rowWidth), fillAttribute },
+    _attrRow{ gsl::narrow<UINT>(rowWidth), fillAttribute, FAIL_FAST_IF_NULL(pParent)->GetAttributeTable() },
     _pParent{ pParent }
 {
 }
@@ -160,16 +160,25 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
     // If we're given a right-side column limit, use it. Otherwise, the write limit is the final column index available in the char row.
     const auto finalColumnInRow = limitRight.value_or(_charRow.size() - 1);
 
+    // Consecutive cells almost always share their attributes. Only look
+    // them up in the attribute table when they change.
+    std::optional<TextAttribute> lastAttr;
+    TextAttributeIdRun attrRun{ TextAttributeTable::DefaultId, 1 };
+
     while (it && currentIndex <= finalColumnInRow)
     {
         // Fill the color if the behavior isn't set to keeping the current color.
         if (it->TextAttrBehavior() != TextAttributeBehavior::Current)
         {
-            const TextAttributeRun attrRun{ 1, it->TextAttr() };
-            LOG_IF_FAILED(_attrRow.InsertAttrRuns({ &attrRun, 1 },
-                                                  currentIndex,
-                                                  currentIndex,
-                                                  _charRow.size()));
+            if (lastAttr != it->TextAttr())
+            {
+                lastAttr = it->TextAttr();
+                attrRun.id = _attrRow.GetAttributeTable().Intern(it->TextAttr());
+            }
+            LOG_IF_FAILED(_attrRow.InsertAttrIdRuns({ &attrRun, 1 },
+                                                    currentIndex,
+                                                    currentIndex,
+                                                    _charRow.size()));
         }
 
         // Fill the text if the behavior isn't set to saying there's only a color stored in this iterator.
@@ -224,3 +233,192 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
 
     return it;
 }
+
+// Routine Description:
+// - writes a span of legacy CHAR_INFOs to the row in one go
+// - Unlike WriteCells, this doesn't line up double byte characters, so none
+//   of the CHAR_INFOs may be marked as the leading or trailing half of one.
+// Arguments:
+// - charInfos - the cells to write. They have to fit into the row.
+// - index - column in row to start writing at
+// - wrap - change the wrap flag if the write fills the last column of the row.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ROW::WriteCharInfos(const gsl::span<const CHAR_INFO> charInfos, const size_t index, const std::optional<bool> wrap)
+{
+    const auto count = gsl::narrow<size_t>(charInfos.size());
+    THROW_HR_IF(E_INVALIDARG, index >= _charRow.size() || count > _charRow.size() - index);
+    if (count == 0)
+    {
+        return;
+    }
+
+    _charRow.WriteCharInfos(charInfos, index);
+
+    // Pack the attributes into runs while walking the cells. Each legacy
+    // attribute only has to be looked up in the attribute table when it
+    // differs from the one of the cell before.
+    auto& table = _attrRow.GetAttributeTable();
+    til::small_vector<TextAttributeIdRun, 16> runs;
+    WORD lastLegacyAttr = 0;
+    for (const auto& charInfo : charInfos)
+    {
+        if (!runs.empty() && charInfo.Attributes == lastLegacyAttr)
+        {
+            ++runs.back().length;
+            continue;
+        }
+
+        lastLegacyAttr = charInfo.Attributes;
+        TextAttribute attr;
+        attr.SetFromLegacy(charInfo.Attributes);
+        const auto id = table.Intern(attr);
+
+        if (!runs.empty() && runs.back().id == id)
+        {
+            ++runs.back().length;
+        }
+        else
+        {
+            runs.push_back({ id, 1 });
+        }
+    }
+
+    THROW_IF_FAILED(_attrRow.InsertAttrIdRuns({ runs.data(), gsl::narrow<ptrdiff_t>(runs.size()) },
+                                              index,
+                                              index + count - 1,
+                                              _charRow.size()));
+
+    if (wrap.has_value() && index + count == _charRow.size())
+    {
+        _charRow.SetWrapForced(wrap.value());
+    }
+}
+
+// Routine Description:
+// - copies a span of cells with their attributes from another row of the same
+//   text buffer. The source may be this row, in which case the spans may overlap.
+// - Double byte characters that end up cut in half at either edge of the
+//   span are replaced with spaces.
+// Arguments:
+// - source - the row to copy the cells from
+// - srcIndex - column in the source row to start copying from
+// - dstIndex - column in this row to start copying to
+// - count - the number of cells to copy
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ROW::CopyCells(const ROW& source, const size_t srcIndex, const size_t dstIndex, const size_t count)
+{
+    THROW_HR_IF(E_INVALIDARG, &source._attrRow.GetAttributeTable() != &_attrRow.GetAttributeTable());
+    THROW_HR_IF(E_INVALIDARG, srcIndex > source.size() || count > source.size() - srcIndex);
+    THROW_HR_IF(E_INVALIDARG, dstIndex > size() || count > size() - dstIndex);
+    if (count == 0)
+    {
+        return;
+    }
+
+    const auto split = _FindSplitGlyphs(dstIndex, dstIndex + count - 1);
+
+    // Glyphs kept in the UnicodeStorage are stored by position, so look up
+    // the ones we're copying before any of them can be overwritten.
+    const auto& srcCharRow = source.GetCharRow();
+    const auto srcDbcsAttrs = srcCharRow.DbcsAttrs();
+    std::vector<std::pair<size_t, UnicodeStorage::mapped_type>> glyphs;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (srcDbcsAttrs[srcIndex + i].IsGlyphStored())
+        {
+            glyphs.emplace_back(dstIndex + i, srcCharRow.GetUnicodeStorage().GetText(srcCharRow.GetStorageKey(srcIndex + i)));
+        }
+    }
+
+    // Both rows share the attribute table, so the runs are copied by ID.
+    std::vector<TextAttributeIdRun> runs;
+    source._attrRow.AppendIdRuns(srcIndex, count, runs);
+
+    _charRow.CopyCells(srcCharRow, srcIndex, dstIndex, count);
+    THROW_IF_FAILED(_attrRow.InsertAttrIdRuns({ runs.data(), gsl::narrow<ptrdiff_t>(runs.size()) },
+                                              dstIndex,
+                                              dstIndex + count - 1,
+                                              _charRow.size()));
+
+    for (const auto& [column, glyph] : glyphs)
+    {
+        GetUnicodeStorage().StoreGlyph(_charRow.GetStorageKey(column), glyph);
+    }
+
+    _ClearSplitGlyphs(dstIndex, dstIndex + count - 1, split);
+}
+
+// Routine Description:
+// - overwrites a span of cells with copies of a single width char.
+// - Double byte characters that end up cut in half at either edge of the
+//   span are replaced with spaces.
+// Arguments:
+// - wch - the char to fill the cells with
+// - index - column in row to start filling at
+// - count - the number of cells to fill
+// - attr - the attributes to give the cells. If empty, the cells keep theirs.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void ROW::FillCells(const wchar_t wch, const size_t index, const size_t count, const std::optional<TextAttribute> attr)
+{
+    THROW_HR_IF(E_INVALIDARG, index > size() || count > size() - index);
+    if (count == 0)
+    {
+        return;
+    }
+
+    const auto split = _FindSplitGlyphs(index, index + count - 1);
+
+    _charRow.FillCells(wch, index, count);
+    if (attr.has_value())
+    {
+        const TextAttributeIdRun run{ _attrRow.GetAttributeTable().Intern(attr.value()), gsl::narrow<uint16_t>(count) };
+        THROW_IF_FAILED(_attrRow.InsertAttrIdRuns({ &run, 1 },
+                                                  index,
+                                                  index + count - 1,
+                                                  _charRow.size()));
+    }
+
+    _ClearSplitGlyphs(index, index + count - 1, split);
+}
+
+// Routine Description:
+// - Checks whether overwriting the cells [left, right] would separate a
+//   double byte character outside of them from its other half.
+// Return Value:
+// - whether the cell before left and the cell after right would be left behind.
+std::pair<bool, bool> ROW::_FindSplitGlyphs(const size_t left, const size_t right) const
+{
+    const auto dbcsAttrs = _charRow.DbcsAttrs();
+    const auto splitLeft = left > 0 && dbcsAttrs[left].IsTrailing();
+    const auto splitRight = right + 1 < size() && dbcsAttrs[right + 1].IsTrailing();
+    return { splitLeft, splitRight };
+}
+
+// Routine Description:
+// - Replaces the halves of double byte characters that overwriting the cells
+//   [left, right] left behind with spaces. That's the ones outside of the
+//   cells that _FindSplitGlyphs found beforehand, and halves that were
+//   written to the edges of the span. The cells keep their attributes.
+void ROW::_ClearSplitGlyphs(const size_t left, const size_t right, const std::pair<bool, bool> split)
+{
+    const auto dbcsAttrs = _charRow.DbcsAttrs();
+    if (split.first)
+    {
+        _charRow.ClearCell(left - 1);
+    }
+    if (dbcsAttrs[left].IsTrailing())
+    {
+        _charRow.ClearCell(left);
+    }
+    if (dbcsAttrs[right].IsLeading())
+    {
+        _charRow.ClearCell(right);
+    }
+    if (split.second)
+    {
+        _charRow.ClearCell(right + 1);
+    }
+}
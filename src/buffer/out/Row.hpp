@@ -58,6 +58,9 @@ public:
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
 
     OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const std::optional<bool> wrap = std::nullopt, std::optional<size_t> limitRight = std::nullopt);
+    void WriteCharInfos(const gsl::span<const CHAR_INFO> charInfos, const size_t index, const std::optional<bool> wrap = std::nullopt);
+    void CopyCells(const ROW& source, const size_t srcIndex, const size_t dstIndex, const size_t count);
+    void FillCells(const wchar_t wch, const size_t index, const size_t count, const std::optional<TextAttribute> attr);
 
     friend bool operator==(const ROW& a, const ROW& b) noexcept;
 
@@ -71,6 +74,9 @@ private:
     SHORT _id;
     size_t _rowWidth;
     TextBuffer* _pParent; // non ownership pointer
+
+    std::pair<bool, bool> _FindSplitGlyphs(const size_t left, const size_t right) const;
+    void _ClearSplitGlyphs(const size_t left, const size_t right, const std::pair<bool, bool> split);
 };
 
 inline bool operator==(const ROW& a, const ROW& b) noexcept
@@ -217,6 +217,17 @@ void TextAttribute::Invert() noexcept
     WI_ToggleFlag(_wAttrLegacy, COMMON_LVB_REVERSE_VIDEO);
 }
 
+// Routine Description:
+// - reduces the precision of the RGB colors, so that similar colors end up
+//   equal. See TextColor::ReducePrecision.
+// Arguments:
+// - bits - the number of bits to keep per color channel
+void TextAttribute::ReduceColorPrecision(const unsigned int bits) noexcept
+{
+    _foreground.ReducePrecision(bits);
+    _background.ReducePrecision(bits);
+}
+
 void TextAttribute::_SetBoldness(const bool isBold) noexcept
 {
     WI_UpdateFlag(_extendedAttrs, ExtendedAttributes::Bold, isBold);
@@ -125,6 +125,8 @@ public:
 
     void Invert() noexcept;
 
+    void ReduceColorPrecision(const unsigned int bits) noexcept;
+
     friend constexpr bool operator==(const TextAttribute& a, const TextAttribute& b) noexcept;
     friend constexpr bool operator!=(const TextAttribute& a, const TextAttribute& b) noexcept;
     friend constexpr bool operator==(const TextAttribute& attr, const WORD& legacyAttr) noexcept;
@@ -205,6 +207,8 @@ private:
     TextColor _background;
     ExtendedAttributes _extendedAttrs;
 
+    friend struct std::hash<TextAttribute>;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class TextAttributeTests;
@@ -260,6 +264,31 @@ constexpr bool operator!=(const WORD& legacyAttr, const TextAttribute& attr) noe
     return !(attr == legacyAttr);
 }
 
+namespace std
+{
+    template<>
+    struct hash<TextAttribute>
+    {
+        // Routine Description:
+        // - hashes a TextAttribute. The colors take up 26 bits each, so they
+        //   overlap the other fields a little, and the result is folded into
+        //   a size_t.
+        // Arguments:
+        // - attr - the TextAttribute to hash
+        // Return Value:
+        // - the hashed attribute
+        constexpr size_t operator()(const TextAttribute& attr) const noexcept
+        {
+            const std::hash<TextColor> hashColor{};
+            const uint64_t value = static_cast<uint64_t>(hashColor(attr._foreground)) ^
+                                   static_cast<uint64_t>(hashColor(attr._background)) << 26 ^
+                                   static_cast<uint64_t>(attr._wAttrLegacy) << 44 ^
+                                   static_cast<uint64_t>(attr._extendedAttrs) << 56;
+            return static_cast<size_t>(value ^ (value >> 32));
+        }
+    };
+}
+
 #ifdef UNIT_TESTING
 
 #define LOG_ATTR(attr) (Log::Comment(NoThrowString().Format( \
@@ -0,0 +1,243 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "TextAttributeTable.hpp"
+
+// Routine Description:
+// - constructor
+// Return Value:
+// - constructed object, with only the default attributes interned.
+// Note: will throw exception if unable to allocate memory for the table
+TextAttributeTable::TextAttributeTable() :
+    _chunks{},
+    _ids{},
+    _size{ 0 },
+    _free{},
+    _pinned(Capacity, false),
+    _reclaimed{ false },
+    _usage{}
+{
+    Intern(TextAttribute{});
+}
+
+// Routine Description:
+// - Gets the ID of the given attributes, adding them to the table if needed.
+// - Once the table is full, it first frees the IDs that its owner doesn't
+//   use anymore, see _Reclaim. If that doesn't make room, the attributes are
+//   approximated with coarser colors instead, see _InternApproximation.
+// - The returned ID is pinned until the owner calls ReleasePins.
+// Arguments:
+// - attr - the attributes to intern
+// Return Value:
+// - the ID of the attributes, or of the closest ones that fit
+// Note: will throw exception if unable to allocate memory for the table
+TextAttributeTable::Id TextAttributeTable::Intern(const TextAttribute& attr)
+{
+    const auto found = _ids.find(attr);
+    if (found != _ids.end())
+    {
+        _pinned.at(found->second) = true;
+        return found->second;
+    }
+
+    if (_free.empty() && _size >= Capacity - OverflowCapacity && !_Reclaim())
+    {
+        return _InternApproximation(attr);
+    }
+
+    if (_free.empty())
+    {
+        return _Add(gsl::narrow_cast<Id>(_size), attr);
+    }
+
+    const auto id = _Add(_free.back(), attr);
+    _free.pop_back();
+    return id;
+}
+
+// Routine Description:
+// - Gets the ID of the given attributes, without adding them to the table.
+// - Unlike Intern, this never changes the table, so it can be called on
+//   several threads at once.
+// Arguments:
+// - attr - the attributes to look for
+// Return Value:
+// - the ID of the attributes, if they're in the table
+std::optional<TextAttributeTable::Id> TextAttributeTable::Find(const TextAttribute& attr) const
+{
+    const auto found = _ids.find(attr);
+    if (found == _ids.end())
+    {
+        return std::nullopt;
+    }
+    return found->second;
+}
+
+// Routine Description:
+// - Gets the number of IDs in the table, including the ones that were freed
+//   to be handed out again. Every ID in use is less than this.
+size_t TextAttributeTable::Size() const noexcept
+{
+    return _size;
+}
+
+// Routine Description:
+// - Sets the callback that the table asks which IDs are still in use once
+//   it's full. Without one, the table never frees IDs on its own.
+// Arguments:
+// - callback - marks the IDs that the owner of the table still uses
+void TextAttributeTable::SetUsageCallback(UsageCallback callback)
+{
+    _usage = std::move(callback);
+}
+
+// Routine Description:
+// - Lets the table reclaim the IDs it handed out so far, once nothing holds
+//   onto them but the rows that the usage callback reports.
+// - The owner calls this whenever it's done interning for now, before
+//   anything else gets interned.
+void TextAttributeTable::ReleasePins() noexcept
+{
+    std::fill(_pinned.begin(), _pinned.end(), false);
+    _reclaimed = false;
+}
+
+// Routine Description:
+// - Drops the attributes that aren't used anymore and packs the rest. The
+//   default attributes are always kept.
+// - This moves attributes, so the owner calls it only when it can remap
+//   every ID it holds. That releases all pins, too.
+// Arguments:
+// - used - for every ID in the table, whether it's still in use
+// Return Value:
+// - the new ID of every old ID. The IDs of dropped attributes map to DefaultId.
+// Note: will throw exception if unable to allocate memory for the table
+std::vector<TextAttributeTable::Id> TextAttributeTable::Compact(const std::vector<bool>& used)
+{
+    std::vector<Id> remap(_size, DefaultId);
+    std::unordered_map<TextAttribute, Id> ids;
+    ids.reserve(_ids.size());
+
+    size_t size = 0;
+    for (size_t id = 0; id < _size; ++id)
+    {
+        if (id == DefaultId || (id < used.size() && used.at(id)))
+        {
+            const auto newId = gsl::narrow_cast<Id>(size++);
+            const auto attr = Get(gsl::narrow_cast<Id>(id));
+            _chunks[newId / ChunkSize][newId % ChunkSize] = attr;
+            ids.emplace(attr, newId);
+            remap.at(id) = newId;
+        }
+    }
+
+    // Chunks past the end are only held onto to be reused.
+    _ids.swap(ids);
+    _size = size;
+    _free.clear();
+    ReleasePins();
+
+    return remap;
+}
+
+// Routine Description:
+// - Stores the given attributes under the given ID, which has to be free.
+// Arguments:
+// - id - either a freed ID, or the next one past the end
+// - attr - the attributes to store
+// Return Value:
+// - the ID, now pinned
+// Note: will throw exception if unable to allocate memory for the table
+TextAttributeTable::Id TextAttributeTable::_Add(const Id id, const TextAttribute& attr)
+{
+    auto& chunk = _chunks[id / ChunkSize];
+    if (!chunk)
+    {
+        chunk = std::make_unique<TextAttribute[]>(ChunkSize);
+    }
+
+    _ids.emplace(attr, id);
+    chunk[id % ChunkSize] = attr;
+    _pinned.at(id) = true;
+    _size = std::max<size_t>(_size, size_t{ id } + 1);
+
+    return id;
+}
+
+// Routine Description:
+// - Frees every ID that's neither pinned nor reported as used by the usage
+//   callback. Unlike Compact, this leaves the other IDs where they are, so
+//   it can run in the middle of a write without the owner remapping anything.
+// Return Value:
+// - true if there are free IDs to hand out now.
+// Note: will throw exception if unable to allocate memory
+bool TextAttributeTable::_Reclaim()
+{
+    if (!_usage || _reclaimed)
+    {
+        return false;
+    }
+    _reclaimed = true;
+
+    auto used = _pinned;
+    used.at(DefaultId) = true;
+    _usage(used);
+
+    // Walk backwards, so that the lowest IDs are handed out first.
+    for (auto id = _size; id-- > 0;)
+    {
+        if (used.at(id))
+        {
+            continue;
+        }
+
+        // IDs that were freed before hold the default attributes, which
+        // belong to DefaultId, so they aren't freed twice.
+        const auto found = _ids.find(Get(gsl::narrow_cast<Id>(id)));
+        if (found != _ids.end() && found->second == id)
+        {
+            _ids.erase(found);
+            _chunks[id / ChunkSize][id % ChunkSize] = TextAttribute{};
+            _free.push_back(gsl::narrow_cast<Id>(id));
+        }
+    }
+
+    return !_free.empty();
+}
+
+// Routine Description:
+// - Interns attributes that didn't fit into the full table anymore, by
+//   reducing the precision of their RGB colors until they match attributes
+//   already in the table. Failing that, the coarsest approximation gets an
+//   ID from the overflow chunk, which only approximations can use.
+// - Only once that is full too, the attributes are replaced by the default
+//   ones. By then, well over 65000 distinct attributes are in use at once.
+// Arguments:
+// - attr - the attributes to approximate
+// Return Value:
+// - the ID of the approximation
+// Note: will throw exception if unable to allocate memory for the table
+TextAttributeTable::Id TextAttributeTable::_InternApproximation(const TextAttribute& attr)
+{
+    auto approximation = attr;
+    for (const auto bits : { 4u, 2u, 1u })
+    {
+        approximation = attr;
+        approximation.ReduceColorPrecision(bits);
+
+        const auto found = _ids.find(approximation);
+        if (found != _ids.end())
+        {
+            _pinned.at(found->second) = true;
+            return found->second;
+        }
+    }
+
+    if (_size < Capacity)
+    {
+        return _Add(gsl::narrow_cast<Id>(_size), approximation);
+    }
+
+    return DefaultId;
+}
@@ -0,0 +1,103 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TextAttributeTable.hpp
+
+Abstract:
+- Interns the text attributes used by a text buffer, so that its rows can
+  store a 16-bit ID per run instead of a whole TextAttribute. Comparing two
+  IDs from the same table is the same as comparing the attributes.
+- IDs stay valid until the table is compacted. Only the text buffer that
+  owns the table compacts it, and it remaps all of its rows when it does.
+- When the table fills up in between, it frees the IDs that its owner
+  doesn't use anymore in place, without moving the ones still in use.
+--*/
+
+#pragma once
+
+#include "TextAttribute.hpp"
+
+class TextAttributeTable final
+{
+public:
+    using Id = uint16_t;
+
+    static constexpr size_t Capacity = static_cast<size_t>(std::numeric_limits<Id>::max()) + 1;
+
+    // The default attributes are always interned, and always have this ID.
+    static constexpr Id DefaultId = 0;
+
+    // Marks every ID that the owner of the table still uses. The vector
+    // holds an entry for every ID up to the capacity of the table.
+    using UsageCallback = std::function<void(std::vector<bool>& used)>;
+
+    TextAttributeTable();
+    TextAttributeTable(const TextAttributeTable&) = delete;
+    TextAttributeTable& operator=(const TextAttributeTable&) = delete;
+
+    Id Intern(const TextAttribute& attr);
+    std::optional<Id> Find(const TextAttribute& attr) const;
+
+    // Routine Description:
+    // - Looks up the attributes with the given ID.
+    // Return Value:
+    // - A reference that stays valid until the table is compacted.
+    const TextAttribute& Get(const Id id) const noexcept
+    {
+        return _chunks[id / ChunkSize][id % ChunkSize];
+    }
+
+    size_t Size() const noexcept;
+
+    void SetUsageCallback(UsageCallback callback);
+    void ReleasePins() noexcept;
+
+    std::vector<Id> Compact(const std::vector<bool>& used);
+
+private:
+    // Attributes are stored in fixed chunks that are never moved, so that
+    // looking one up stays valid while others are interned. That way rows
+    // that are read on one thread can be interned into on another one, as
+    // long as the attributes they need were interned beforehand.
+    static constexpr size_t ChunkSize = 256;
+
+    // The last chunk is kept for approximations of attributes that didn't
+    // fit anymore, so that those don't all end up with the default ones.
+    static constexpr size_t OverflowCapacity = ChunkSize;
+
+    std::array<std::unique_ptr<TextAttribute[]>, Capacity / ChunkSize> _chunks;
+    std::unordered_map<TextAttribute, Id> _ids;
+    size_t _size;
+
+    // IDs freed by _Reclaim, to be handed out again.
+    std::vector<Id> _free;
+
+    // IDs handed out since the owner last released them. The owner may
+    // still hold onto those without them being in any row yet, so they're
+    // never reclaimed.
+    std::vector<bool> _pinned;
+
+    // Reclaiming walks everything the owner uses, so it's only tried once
+    // until the pins are released, even if it didn't free anything.
+    bool _reclaimed;
+
+    UsageCallback _usage;
+
+    Id _Add(const Id id, const TextAttribute& attr);
+    bool _Reclaim();
+    Id _InternApproximation(const TextAttribute& attr);
+
+#ifdef UNIT_TESTING
+    friend class TextAttributeTableTests;
+#endif
+};
+
+// A run of cells that share the attributes with the given ID, in the table
+// of the text buffer that the cells belong to.
+struct TextAttributeIdRun
+{
+    TextAttributeTable::Id id;
+    uint16_t length;
+};
@@ -43,6 +43,36 @@ void TextColor::SetDefault() noexcept
     _meta = ColorType::IsDefault;
 }
 
+// Method Description:
+// - Keeps only the given number of high bits of every channel of an RGB
+//      color, repeating them into the low bits, so that full intensity stays
+//      full intensity. Indexed and default colors are left alone.
+// Arguments:
+// - bits: the number of bits to keep per channel, from 1 to 8.
+// Return Value:
+// - <none>
+void TextColor::ReducePrecision(const unsigned int bits) noexcept
+{
+    if (!IsRgb() || bits == 0 || bits >= 8)
+    {
+        return;
+    }
+
+    const auto reduce = [bits](const BYTE value) noexcept {
+        const auto kept = gsl::narrow_cast<BYTE>(value & (0xff << (8 - bits)));
+        auto result = kept;
+        for (auto shift = bits; shift < 8; shift += bits)
+        {
+            result |= gsl::narrow_cast<BYTE>(kept >> shift);
+        }
+        return result;
+    };
+
+    _red = reduce(_red);
+    _green = reduce(_green);
+    _blue = reduce(_blue);
+}
+
 // Method Description:
 // - Retrieve the real color value for this TextColor.
 //   * If we're an RGB color, we'll use that value.
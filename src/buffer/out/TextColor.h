@@ -94,6 +94,7 @@ public:
     void SetColor(const COLORREF rgbColor) noexcept;
     void SetIndex(const BYTE index) noexcept;
     void SetDefault() noexcept;
+    void ReducePrecision(const unsigned int bits) noexcept;
 
     COLORREF GetColor(std::basic_string_view<COLORREF> colorTable,
                       const COLORREF defaultColor,
@@ -115,6 +116,8 @@ private:
 
     COLORREF _GetRGB() const noexcept;
 
+    friend struct std::hash<TextColor>;
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     template<typename TextColor>
@@ -137,6 +140,27 @@ bool constexpr operator!=(const TextColor& a, const TextColor& b) noexcept
     return !(a == b);
 }
 
+namespace std
+{
+    template<>
+    struct hash<TextColor>
+    {
+        // Routine Description:
+        // - hashes a TextColor by packing all of its fields into the lower bits of a size_t.
+        // Arguments:
+        // - color - the TextColor to hash
+        // Return Value:
+        // - the hashed color
+        constexpr size_t operator()(const TextColor& color) const noexcept
+        {
+            return static_cast<size_t>(color._meta) << 24 |
+                   static_cast<size_t>(color._red) << 16 |
+                   static_cast<size_t>(color._green) << 8 |
+                   static_cast<size_t>(color._blue);
+        }
+    };
+}
+
 #ifdef UNIT_TESTING
 
 namespace WEX
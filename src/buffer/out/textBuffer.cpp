@@ -5,15 +5,63 @@
 
 #include "textBuffer.hpp"
 #include "CharRow.hpp"
+#include "ReflowLayout.hpp"
 
 #include "../types/inc/utils.hpp"
 #include "../types/inc/convert.hpp"
 
+#include <execution>
+
 #pragma hdrstop
 
 using namespace Microsoft::Console;
 using namespace Microsoft::Console::Types;
 
+// Every lazy reflow that leaves rows to copy gets a new generation, so that
+// background work for a buffer that was reflowed again can tell it's stale.
+static std::atomic<uint64_t> s_lastReflowGeneration{ 0 };
+
+// The rows of a lazy reflow that were laid out, but not copied into the
+// new buffer yet. See TextBuffer::ReflowLazily.
+struct TextBuffer::PendingReflow
+{
+    PendingReflow(ReflowLayout&& layout,
+                  std::vector<bool>&& pending,
+                  const size_t count,
+                  const size_t firstRow,
+                  const TextAttribute fillAttributes,
+                  std::shared_ptr<const TextBuffer> source) :
+        layout{ std::move(layout) },
+        pending{ std::move(pending) },
+        count{ count },
+        firstRow{ firstRow },
+        backgroundRow{ this->layout.CursorRow() + 1 },
+        fillAttributes{ fillAttributes },
+        generation{ ++s_lastReflowGeneration },
+        source{ std::move(source) }
+    {
+    }
+
+    ReflowLayout layout;
+
+    // Which rows of the layout are still pending, and how many.
+    std::vector<bool> pending;
+    size_t count;
+
+    // The row of the layout at offset 0 of the buffer. It moves down as
+    // the buffer circles.
+    size_t firstRow;
+
+    // The row of the layout that ReflowPendingRows continues upwards from.
+    size_t backgroundRow;
+
+    TextAttribute fillAttributes;
+    uint64_t generation;
+
+    // Keeps the buffer that the pending rows copy from alive.
+    std::shared_ptr<const TextBuffer> source;
+};
+
 // Routine Description:
 // - Creates a new instance of TextBuffer
 // Arguments:
@@ -31,17 +79,24 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     _firstRow{ 0 },
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
+    _attributes{},
+    _attributeCompactionLimit{ TextAttributeTable::Capacity / 2 },
     _storage{},
     _unicodeStorage{},
-    _renderTarget{ renderTarget }
+    _renderTarget{ renderTarget },
+    _pendingReflow{}
 {
     // initialize ROWs
     for (size_t i = 0; i < static_cast<size_t>(screenBufferSize.Y); ++i)
     {
         _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this);
     }
+
+    _attributes.SetUsageCallback([this](std::vector<bool>& used) { _MarkUsedAttributes(used); });
 }
 
+TextBuffer::~TextBuffer() = default;
+
 // Routine Description:
 // - Copies properties from another text buffer into this one.
 // - This is primarily to copy properties that would otherwise not be specified during CreateInstance
@@ -74,6 +129,10 @@ UINT TextBuffer::TotalRowCount() const noexcept
 // - const reference to the requested row. Asserts if out of bounds.
 const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 {
+    // Rows that a lazy reflow left pending aren't copied in here, since readers
+    // may share the buffer with each other. Whoever has it to themselves has
+    // to copy in the rows that readers are going to look at first, see
+    // ReflowPendingRowsAt and ReflowAllPendingRows.
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
@@ -90,6 +149,12 @@ const ROW& TextBuffer::GetRowByOffset(const size_t index) const
 // - reference to the requested row. Asserts if out of bounds.
 ROW& TextBuffer::GetRowByOffset(const size_t index)
 {
+    if (_pendingReflow)
+    {
+        _ReflowPendingRow(index);
+        _ReleaseFinishedReflow();
+    }
+
     const size_t totalRows = TotalRowCount();
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
@@ -369,6 +434,8 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
         return givenIt;
     }
 
+    _CompactAttributesIfNeeded();
+
     //  Get the row and write the cells
     ROW& row = GetRowByOffset(target.Y);
     const auto newIt = row.WriteCells(givenIt, target.X, wrap, limitRight);
@@ -381,6 +448,107 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     return newIt;
 }
 
+// Routine Description:
+// - Writes legacy CHAR_INFOs to the output buffer, a whole row at a time.
+// - If any of them is half of a double byte character, they're written cell
+//   by cell through an OutputCellIterator instead, which lines those up.
+// Arguments:
+// - charInfos - The cells to write
+// - target - the row/column to start writing the cells to
+// - wrap - change the wrap flag if we hit the end of the row while writing and there's still more data
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::WriteCharInfos(const gsl::span<const CHAR_INFO> charInfos,
+                                const COORD target,
+                                const std::optional<bool> wrap)
+{
+    const auto isDbcs = std::any_of(charInfos.cbegin(), charInfos.cend(), [](const CHAR_INFO& charInfo) noexcept {
+        return WI_IsAnyFlagSet(charInfo.Attributes, COMMON_LVB_SBCSDBCS);
+    });
+    if (isDbcs)
+    {
+        Write(OutputCellIterator({ charInfos.data(), gsl::narrow<size_t>(charInfos.size()) }), target, wrap);
+        return;
+    }
+
+    const auto size = GetSize();
+    auto remaining = charInfos;
+    auto lineTarget = target;
+    while (!remaining.empty() && size.IsInBounds(lineTarget))
+    {
+        _CompactAttributesIfNeeded();
+
+        // Write as much as fits onto this line, then move to the next line down.
+        const auto count = std::min<ptrdiff_t>(remaining.size(), size.Width() - lineTarget.X);
+        GetRowByOffset(lineTarget.Y).WriteCharInfos(remaining.first(count), lineTarget.X, wrap);
+        _NotifyPaint(Viewport::FromDimensions(lineTarget, { gsl::narrow<SHORT>(count), 1 }));
+
+        remaining = remaining.subspan(count);
+        lineTarget.X = 0;
+        ++lineTarget.Y;
+    }
+}
+
+// Routine Description:
+// - Copies a rectangle of cells to another position in the buffer, one row
+//   span at a time. The source and the target may overlap.
+// - Double byte characters that are cut in half by the edges of the target
+//   are replaced with spaces.
+// Arguments:
+// - source - The cells to copy. Has to be within the buffer.
+// - target - the top left corner to copy the cells to. The whole target has
+//            to be within the buffer as well.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::CopyRectangle(const Viewport& source, const COORD target)
+{
+    const auto size = GetSize();
+    const auto targetRect = Viewport::FromDimensions(target, source.Dimensions());
+    THROW_HR_IF(E_INVALIDARG, !size.IsInBounds(source) || !size.IsInBounds(targetRect));
+
+    // Like a memmove, rows are copied from the bottom up when moving down,
+    // so that no source row is overwritten before it's been copied.
+    const auto height = source.Height();
+    const auto width = gsl::narrow_cast<size_t>(source.Width());
+    const auto movingDown = target.Y > source.Top();
+    for (SHORT i = 0; i < height; ++i)
+    {
+        const auto offset = gsl::narrow_cast<SHORT>(movingDown ? height - 1 - i : i);
+        const ROW& srcRow = GetRowByOffset(source.Top() + offset);
+        ROW& dstRow = GetRowByOffset(target.Y + offset);
+        dstRow.CopyCells(srcRow, source.Left(), target.X, width);
+    }
+
+    _NotifyPaint(_WidenForSplitGlyphs(targetRect));
+}
+
+// Routine Description:
+// - Fills a rectangle of cells with a single width char, one row span at a time.
+// - Double byte characters that are cut in half by the edges of the rectangle
+//   are replaced with spaces.
+// Arguments:
+// - rect - The cells to fill. Has to be within the buffer.
+// - fillChar - The char to fill the cells with.
+// - fillAttributes - The attributes to give the cells. If empty, they keep theirs.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::FillRectangle(const Viewport& rect,
+                               const wchar_t fillChar,
+                               const std::optional<TextAttribute> fillAttributes)
+{
+    THROW_HR_IF(E_INVALIDARG, !GetSize().IsInBounds(rect));
+
+    _CompactAttributesIfNeeded();
+
+    const auto width = gsl::narrow_cast<size_t>(rect.Width());
+    for (auto y = rect.Top(); y < rect.BottomExclusive(); ++y)
+    {
+        GetRowByOffset(y).FillCells(fillChar, rect.Left(), width, fillAttributes);
+    }
+
+    _NotifyPaint(_WidenForSplitGlyphs(rect));
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -412,8 +580,10 @@ bool TextBuffer::InsertCharacter(const std::wstring_view chars,
 
         try
         {
-            charRow.GlyphAt(iCol) = chars;
+            // The attribute goes first, so that it doesn't undo the
+            // glyph being marked as stored.
             charRow.DbcsAttrAt(iCol) = dbcsAttribute;
+            charRow.GlyphAt(iCol) = chars;
         }
         catch (...)
         {
@@ -422,6 +592,7 @@ bool TextBuffer::InsertCharacter(const std::wstring_view chars,
         }
 
         // Store color data
+        _CompactAttributesIfNeeded();
         fSuccess = Row.GetAttrRow().SetAttrToEnd(iCol, attr);
         if (fSuccess)
         {
@@ -559,6 +730,12 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
     const bool fSuccess = _storage.at(_firstRow).Reset(fillAttributes);
     if (fSuccess)
     {
+        // If the old "first row" was still waiting on a lazy reflow, it doesn't need to anymore.
+        if (_pendingReflow)
+        {
+            _CirclePendingReflow();
+        }
+
         // Now proceed to increment.
         // Incrementing it will cause the next line down to become the new "top" of the window (the new "0" in logical coordinates)
         _firstRow++;
@@ -567,7 +744,13 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         if (_firstRow >= GetSize().Height())
         {
             _firstRow = 0;
+
+            // Every row was replaced since, so a full attribute table
+            // that couldn't be compacted before might be now.
+            _attributeCompactionLimit = std::min(_attributeCompactionLimit, TextAttributeTable::Capacity);
         }
+
+        _CompactAttributesIfNeeded();
     }
     return fSuccess;
 }
@@ -670,6 +853,18 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
         return;
     }
 
+    // Rows that a lazy reflow left pending have to be copied in before they move.
+    if (_pendingReflow)
+    {
+        const SHORT first = std::min(firstRow, gsl::narrow_cast<SHORT>(firstRow + delta));
+        const SHORT end = std::max(gsl::narrow_cast<SHORT>(firstRow + size), gsl::narrow_cast<SHORT>(firstRow + size + delta));
+        for (SHORT i = first; i < end; ++i)
+        {
+            _ReflowPendingRow(i);
+        }
+        _ReleaseFinishedReflow();
+    }
+
     // OK. We're about to play games by moving rows around within the deque to
     // scroll a massive region in a faster way than copying things.
     // To make this easier, first correct the circular buffer to have the first row be 0 again.
@@ -790,6 +985,9 @@ void TextBuffer::Reset()
 {
     const auto attr = GetCurrentAttributes();
 
+    // Rows that a lazy reflow left pending are cleared along with the rest.
+    _pendingReflow.reset();
+
     for (auto& row : _storage)
     {
         row.GetCharRow().Reset();
@@ -809,6 +1007,10 @@ void TextBuffer::Reset()
 
     try
     {
+        // The rows are about to be rearranged and resized, so any that a lazy
+        // reflow left pending have to be copied in first.
+        ReflowAllPendingRows();
+
         const auto currentSize = GetSize().Dimensions();
         const auto attributes = GetCurrentAttributes();
 
@@ -861,6 +1063,16 @@ UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
     return _unicodeStorage;
 }
 
+const TextAttributeTable& TextBuffer::GetAttributeTable() const noexcept
+{
+    return _attributes;
+}
+
+TextAttributeTable& TextBuffer::GetAttributeTable() noexcept
+{
+    return _attributes;
+}
+
 // Routine Description:
 // - Method to help refresh all the Row IDs after manipulating the row
 //   by shuffling pointers around.
@@ -902,6 +1114,165 @@ void TextBuffer::_NotifyPaint(const Viewport& viewport) const
     _renderTarget.TriggerRedraw(viewport);
 }
 
+// Routine Description:
+// - Widens a rectangle that was written to by a column on either side, to
+//   include the halves of double byte characters it may have blanked.
+Viewport TextBuffer::_WidenForSplitGlyphs(const Viewport& rect) const
+{
+    auto widened = rect.ToInclusive();
+    if (widened.Left > 0)
+    {
+        --widened.Left;
+    }
+    if (widened.Right < GetSize().RightInclusive())
+    {
+        ++widened.Right;
+    }
+    return Viewport::FromInclusive(widened);
+}
+
+// Routine Description:
+// - Compacts the attribute table once it has grown past its limit, so that
+//   attributes that scrolled out of the buffer don't fill it up.
+// - The limit is set halfway between the size of the table after compacting
+//   and its capacity, so that buffers with many distinct attributes don't
+//   compact over and over again.
+// - Nothing holds onto attribute IDs outside of the rows in between writes,
+//   so this is also where the table may reclaim the IDs it handed out.
+void TextBuffer::_CompactAttributesIfNeeded() noexcept
+{
+    _attributes.ReleasePins();
+
+    if (_attributes.Size() < _attributeCompactionLimit)
+    {
+        return;
+    }
+
+    try
+    {
+        _CompactAttributes();
+    }
+    CATCH_LOG();
+
+    const auto size = _attributes.Size();
+    _attributeCompactionLimit = size + std::max<size_t>((TextAttributeTable::Capacity - size) / 2, 1);
+}
+
+// Routine Description:
+// - Drops the attributes that no row uses anymore from the attribute table,
+//   and updates the IDs of all rows to match.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::_CompactAttributes()
+{
+    std::vector<bool> used(_attributes.Size(), false);
+    for (const auto& row : _storage)
+    {
+        row.GetAttrRow().MarkUsedIds(used);
+    }
+
+    const auto remap = _attributes.Compact(used);
+    for (auto& row : _storage)
+    {
+        row.GetAttrRow().RemapIds(remap);
+    }
+
+    // Rows that a lazy reflow hasn't copied in yet still need everything
+    // they copy to be interned, see _InternReflowAttributes.
+    _ReleaseFinishedReflow();
+    if (_pendingReflow)
+    {
+        _InternReflowAttributes(_pendingReflow->layout, _pendingReflow->fillAttributes);
+    }
+}
+
+// Routine Description:
+// - Marks the IDs of all attributes that this buffer still uses, for the
+//   attribute table to reclaim the others once it's full. Besides the rows,
+//   those are the attributes that rows left pending by a lazy reflow copy in.
+// Arguments:
+// - used - for every ID in the table, whether it's still in use
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::_MarkUsedAttributes(std::vector<bool>& used) const
+{
+    for (const auto& row : _storage)
+    {
+        row.GetAttrRow().MarkUsedIds(used);
+    }
+
+    if (_pendingReflow && _pendingReflow->count != 0)
+    {
+        const auto markFound = [&](const TextAttribute& attr) {
+            const auto id = _attributes.Find(attr);
+            if (id.has_value())
+            {
+                used.at(id.value()) = true;
+            }
+        };
+
+        for (const auto source : _GetReflowSources(_pendingReflow->layout))
+        {
+            const auto& table = source->GetAttributeTable();
+            for (size_t id = 0; id < table.Size(); ++id)
+            {
+                markFound(table.Get(gsl::narrow_cast<TextAttributeTable::Id>(id)));
+            }
+        }
+        markFound(_pendingReflow->fillAttributes);
+    }
+}
+
+// Routine Description:
+// - Gets every buffer that the rows of a reflow layout copy from.
+// Arguments:
+// - layout - the layout of a reflow
+// Return Value:
+// - the source buffers, each once
+std::vector<const TextBuffer*> TextBuffer::_GetReflowSources(const ReflowLayout& layout)
+{
+    std::vector<const TextBuffer*> sources;
+    for (size_t row = 0; row < layout.Rows().size(); ++row)
+    {
+        for (const auto& copy : layout.RowSegments(row))
+        {
+            if (std::find(sources.cbegin(), sources.cend(), copy.source) == sources.cend())
+            {
+                sources.push_back(copy.source);
+            }
+        }
+    }
+    return sources;
+}
+
+// Routine Description:
+// - Interns all attributes that copying the rows of a reflow layout into
+//   this buffer can need: the tables of all buffers it copies from, and the
+//   attributes that rows are filled with.
+// - Rows of a reflow are copied in parallel, or by readers of the buffer,
+//   neither of which may add to the table. Once everything is interned,
+//   copying a row only looks attributes up.
+// Arguments:
+// - layout - the layout of the reflow into this buffer
+// - fillAttributes - the attributes that rows are reset to
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::_InternReflowAttributes(const ReflowLayout& layout, const TextAttribute fillAttributes)
+{
+    for (const auto source : _GetReflowSources(layout))
+    {
+        const auto& table = source->GetAttributeTable();
+        for (size_t id = 0; id < table.Size(); ++id)
+        {
+            _attributes.Intern(table.Get(gsl::narrow_cast<TextAttributeTable::Id>(id)));
+        }
+    }
+
+    _attributes.Intern(fillAttributes);
+}
+
 // Routine Description:
 // - Retrieves the first row from the underlying buffer.
 // Arguments:
@@ -931,7 +1302,9 @@ ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
     }
 
     THROW_HR_IF(E_FAIL, Row.GetId() == _firstRow);
-    return _storage.at(prevRowIndex);
+
+    // Go through GetRowByOffset so that a row left pending by a lazy reflow gets copied in.
+    return GetRowByOffset((prevRowIndex + TotalRowCount() - _firstRow) % TotalRowCount());
 }
 
 // Method Description:
@@ -1946,11 +2319,534 @@ std::string TextBuffer::GenRTF(const TextAndColor& rows, const int fontHeightPoi
     }
 }
 
+// Reflowed rows are copied in chunks of at least this many rows, so that
+// small buffers don't pay for handing work off to other threads.
+static constexpr size_t ReflowMinRowsPerChunk = 256;
+
+// Extended glyphs that a reflow still has to put into the new buffer's UnicodeStorage.
+using ReflowGlyphs = std::vector<std::pair<UnicodeStorage::key_type, UnicodeStorage::mapped_type>>;
+
+// Routine Description:
+// - Copies the cells that the layout placed on the given absolute row into
+//   a row of the new buffer that's still blank. Safe to call concurrently
+//   for different rows.
+// Arguments:
+// - layout - where every copied cell goes
+// - absoluteRow - the row of the layout to copy
+// - fillAttributes - the attributes of rows that the new buffer recycled by circling
+// - row - the row of the new buffer to copy the contents TO
+// - runs - scratch space for building the row's attributes
+// - glyphs - receives the extended glyphs that still need to be stored
+// Return Value:
+// - <none>, throws exceptions on failures.
+static void _CopyReflowedRow(const ReflowLayout& layout,
+                             const size_t absoluteRow,
+                             const TextAttribute fillAttributes,
+                             ROW& row,
+                             std::vector<TextAttributeRun>& runs,
+                             ReflowGlyphs& glyphs)
+{
+    const auto& plan = layout.Rows().at(absoluteRow);
+    const auto segments = layout.RowSegments(absoluteRow);
+
+    // Rows past the bottom of the new buffer were reached by circling,
+    // which recycled the oldest row.
+    if (absoluteRow >= gsl::narrow_cast<size_t>(layout.Height()))
+    {
+        THROW_HR_IF(E_OUTOFMEMORY, !row.Reset(fillAttributes));
+    }
+
+    CharRow& charRow = row.GetCharRow();
+    if (plan.wrapForced)
+    {
+        charRow.SetWrapForced(true);
+    }
+    if (plan.doubleBytePadded)
+    {
+        charRow.SetDoubleBytePadded(true);
+    }
+
+    if (segments.empty())
+    {
+        return;
+    }
+
+    runs.clear();
+    for (const auto& copy : segments)
+    {
+        const ROW& srcRow = copy.source->GetRowByOffset(copy.srcRow);
+        const CharRow& srcCharRow = srcRow.GetCharRow();
+
+        charRow.CopyCells(srcCharRow, copy.srcCol, copy.dstCol, copy.length);
+
+        const auto srcAttrs = srcCharRow.DbcsAttrs().subspan(gsl::narrow_cast<std::ptrdiff_t>(copy.srcCol),
+                                                                  gsl::narrow_cast<std::ptrdiff_t>(copy.length));
+        for (size_t i = 0; i < copy.length; ++i)
+        {
+            if (srcAttrs[i].IsGlyphStored())
+            {
+                // The UnicodeStorage is shared by all rows and can't be
+                // written to concurrently. Stash the glyph for later.
+                glyphs.emplace_back(charRow.GetStorageKey(copy.dstCol + i),
+                                    srcCharRow.GetUnicodeStorage().GetText(srcCharRow.GetStorageKey(copy.srcCol + i)));
+            }
+        }
+
+        srcRow.GetAttrRow().AppendRuns(copy.srcCol, copy.length, runs);
+    }
+
+    // Inserting a character sets its attribute all the way to the end of
+    // the row, so the final attribute also covers the rest of the row.
+    const auto width = gsl::narrow_cast<size_t>(layout.Width());
+    const auto& lastCopy = segments[segments.size() - 1];
+    auto& lastRun = runs.back();
+    lastRun.SetLength(lastRun.GetLength() + width - (lastCopy.dstCol + lastCopy.length));
+
+    THROW_IF_FAILED(row.GetAttrRow().InsertAttrRuns({ runs.data(), runs.size() },
+                                                    segments[0].dstCol,
+                                                    width - 1,
+                                                    width));
+}
+
+// Routine Description:
+// - Copies every row of the layout that survives circling into the new
+//   buffer, except the ones that are left pending. Rows are independent of
+//   each other, so they're copied in chunks in parallel. Writes to shared
+//   state (the UnicodeStorage and the cells cleared by double byte
+//   corrections) are done afterwards.
+// - The new buffer's first row must already account for all circling, so
+//   that absolute row CircleCount() is at offset 0.
+// Arguments:
+// - newBuffer - the text buffer to copy the contents TO
+// - layout - where every copied cell goes
+// - pending - the absolute rows to skip. Empty to copy all of them.
+// Return Value:
+// - S_OK if we successfully copied the rows, otherwise an appropriate HRESULT.
+[[nodiscard]] static HRESULT _CopyReflowedRows(TextBuffer& newBuffer,
+                                               const ReflowLayout& layout,
+                                               const std::vector<bool>& pending) noexcept
+{
+    struct Chunk
+    {
+        size_t begin;
+        size_t end;
+        HRESULT hr;
+        ReflowGlyphs glyphs;
+    };
+
+    try
+    {
+        const auto firstRow = layout.CircleCount();
+        const auto endRow = layout.CursorRow() + 1;
+        const auto fillAttributes = newBuffer.GetCurrentAttributes();
+        const auto isPending = [&](const size_t row) {
+            return !pending.empty() && pending.at(row);
+        };
+
+        const size_t chunksPerThread = 4;
+        const size_t chunkCount = std::max<size_t>(std::thread::hardware_concurrency(), 1) * chunksPerThread;
+        const auto chunkSize = std::max((endRow - firstRow + chunkCount - 1) / chunkCount, ReflowMinRowsPerChunk);
+
+        std::vector<Chunk> chunks;
+        for (auto begin = firstRow; begin < endRow; begin += chunkSize)
+        {
+            chunks.push_back(Chunk{ begin, std::min(begin + chunkSize, endRow), S_OK, {} });
+        }
+
+        // Parallel algorithms terminate if an exception escapes, so each chunk
+        // keeps its own result.
+        const auto copyChunk = [&](Chunk& chunk) noexcept {
+            try
+            {
+                std::vector<TextAttributeRun> runs;
+                for (auto row = chunk.begin; row < chunk.end; ++row)
+                {
+                    if (!isPending(row))
+                    {
+                        _CopyReflowedRow(layout, row, fillAttributes, newBuffer.GetRowByOffset(row - firstRow), runs, chunk.glyphs);
+                    }
+                }
+            }
+            catch (...)
+            {
+                chunk.hr = wil::ResultFromCaughtException();
+            }
+        };
+
+        if (chunks.size() > 1)
+        {
+            std::for_each(std::execution::par, chunks.begin(), chunks.end(), copyChunk);
+        }
+        else
+        {
+            std::for_each(chunks.begin(), chunks.end(), copyChunk);
+        }
+
+        auto& storage = newBuffer.GetUnicodeStorage();
+        for (const auto& chunk : chunks)
+        {
+            RETURN_IF_FAILED(chunk.hr);
+            for (const auto& [key, glyph] : chunk.glyphs)
+            {
+                storage.StoreGlyph(key, glyph);
+            }
+        }
+
+        for (auto row = firstRow; row < endRow; ++row)
+        {
+            if (!isPending(row))
+            {
+                for (const auto& [erasedRow, column] : layout.RowErasures(row))
+                {
+                    newBuffer.GetRowByOffset(row - firstRow).GetCharRow().ClearCell(column);
+                }
+            }
+        }
+    }
+    CATCH_RETURN();
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Copies in a row that a lazy reflow left pending, if it still is.
+// - Once the last row is copied in, it lets go of the buffer the rows were
+//   copied from, and the reflow counts as done. The callers then drop what's
+//   left of it with _ReleaseFinishedReflow.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::_ReflowPendingRow(const size_t index)
+{
+    auto& pending = *_pendingReflow;
+    if (pending.count == 0)
+    {
+        return;
+    }
+
+    const auto offset = index % TotalRowCount();
+    const auto absoluteRow = pending.firstRow + offset;
+    if (absoluteRow >= pending.pending.size() || !pending.pending.at(absoluteRow))
+    {
+        return;
+    }
+
+    ROW& row = _storage.at((_firstRow + offset) % TotalRowCount());
+
+    std::vector<TextAttributeRun> runs;
+    ReflowGlyphs glyphs;
+    _CopyReflowedRow(pending.layout, absoluteRow, pending.fillAttributes, row, runs, glyphs);
+
+    for (const auto& [key, glyph] : glyphs)
+    {
+        _unicodeStorage.StoreGlyph(key, glyph);
+    }
+    for (const auto& [erasedRow, column] : pending.layout.RowErasures(absoluteRow))
+    {
+        row.GetCharRow().ClearCell(column);
+    }
+
+    pending.pending.at(absoluteRow) = false;
+    if (--pending.count == 0)
+    {
+        pending.source.reset();
+    }
+}
+
+// Routine Description:
+// - Lets go of the pending reflow once all of its rows are copied in, and
+//   with it, of the buffer we reflowed from.
+void TextBuffer::_ReleaseFinishedReflow() noexcept
+{
+    if (_pendingReflow && _pendingReflow->count == 0)
+    {
+        _pendingReflow.reset();
+    }
+}
+
+// Routine Description:
+// - Copies in every row that a lazy reflow left pending. The caller must
+//   have the buffer to itself, for example by holding the write lock of the
+//   Terminal, since the rows change under any reader.
+void TextBuffer::ReflowAllPendingRows()
+{
+    for (size_t index = 0; _pendingReflow && index < TotalRowCount(); ++index)
+    {
+        _ReflowPendingRow(index);
+    }
+    _ReleaseFinishedReflow();
+}
+
+// Routine Description:
+// - Copies in the rows in the given range that a lazy reflow left pending,
+//   for example the ones that are about to be scrolled into view. The caller
+//   must have the buffer to itself, like for ReflowAllPendingRows.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer to start at.
+// - count - the number of rows to copy in.
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::ReflowPendingRowsAt(const size_t index, const size_t count)
+{
+    const auto end = std::min(index + count, gsl::narrow_cast<size_t>(TotalRowCount()));
+    for (auto row = index; _pendingReflow && row < end; ++row)
+    {
+        _ReflowPendingRow(row);
+    }
+    _ReleaseFinishedReflow();
+}
+
+// Routine Description:
+// - Tells whether a row still has to be copied in from the buffer that
+//   this one was lazily reflowed from.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+bool TextBuffer::_IsRowPendingReflow(const size_t index) const
+{
+    if (!_pendingReflow)
+    {
+        return false;
+    }
+
+    const auto absoluteRow = _pendingReflow->firstRow + index % TotalRowCount();
+    return absoluteRow < _pendingReflow->pending.size() && _pendingReflow->pending.at(absoluteRow);
+}
+
+// Routine Description:
+// - Gets the characters of a row so that a reflow out of this buffer can
+//   lay them out. Rows that are still pending aren't copied into the
+//   buffer for this; their characters are assembled in a scratch row.
+// Arguments:
+// - index - Number of rows down from the first row of the buffer.
+// - scratch - a row as wide as this buffer, to assemble pending rows in
+// Return Value:
+// - the characters of the row.
+const CharRow& TextBuffer::_PeekCharRow(const size_t index, ROW& scratch) const
+{
+    if (!_IsRowPendingReflow(index))
+    {
+        return GetRowByOffset(index).GetCharRow();
+    }
+
+    const auto& layout = _pendingReflow->layout;
+    const auto absoluteRow = _pendingReflow->firstRow + index % TotalRowCount();
+    const auto& plan = layout.Rows().at(absoluteRow);
+
+    CharRow& charRow = scratch.GetCharRow();
+    charRow.Reset();
+    charRow.SetWrapForced(plan.wrapForced);
+    charRow.SetDoubleBytePadded(plan.doubleBytePadded);
+
+    for (const auto& copy : layout.RowSegments(absoluteRow))
+    {
+        const CharRow& srcCharRow = copy.source->GetRowByOffset(copy.srcRow).GetCharRow();
+        charRow.CopyCells(srcCharRow, copy.srcCol, copy.dstCol, copy.length);
+    }
+    for (const auto& [erasedRow, column] : layout.RowErasures(absoluteRow))
+    {
+        charRow.ClearCell(column);
+    }
+
+    return charRow;
+}
+
+// Routine Description:
+// - Accounts for the buffer circling while a lazy reflow still has rows
+//   pending. The first row was recycled, so it doesn't need copying anymore.
+void TextBuffer::_CirclePendingReflow() noexcept
+{
+    auto& pending = *_pendingReflow;
+    if (pending.firstRow < pending.pending.size() && pending.pending[pending.firstRow])
+    {
+        pending.pending[pending.firstRow] = false;
+        --pending.count;
+    }
+    ++pending.firstRow;
+
+    _ReleaseFinishedReflow();
+}
+
+// Routine Description:
+// - Makes a layout of this buffer's contents copy the rows that this buffer
+//   still has pending from wherever this buffer would copy them from,
+//   instead of from this buffer. That way reflowing a buffer that was just
+//   lazily reflowed doesn't have to copy its pending rows twice.
+// - Only cells that this buffer's own layout places can be forwarded. Rows
+//   that the layout needs other cells of are copied into this buffer first.
+// Arguments:
+// - layout - a layout out of this buffer
+// Return Value:
+// - The buffer that the forwarded cells are copied from, or nullptr if this
+//   buffer has no rows pending (anymore) and nothing was forwarded.
+std::shared_ptr<const TextBuffer> TextBuffer::_ForwardPendingReflow(ReflowLayout& layout)
+{
+    _ReleaseFinishedReflow();
+    if (!_pendingReflow)
+    {
+        return nullptr;
+    }
+
+    const auto pendingRow = [this](const ReflowSegment& segment) {
+        return _pendingReflow->firstRow + segment.srcRow % TotalRowCount();
+    };
+
+    std::vector<size_t> uncovered;
+    for (size_t row = 0; row < layout.Rows().size(); ++row)
+    {
+        for (const auto& segment : layout.RowSegments(row))
+        {
+            if (_IsRowPendingReflow(segment.srcRow))
+            {
+                // The segments of a row are ordered by column, so they cover
+                // the cells we need if they continue each other up to the end.
+                auto column = segment.srcCol;
+                for (const auto& copy : _pendingReflow->layout.RowSegments(pendingRow(segment)))
+                {
+                    if (copy.dstCol <= column && column < copy.dstCol + copy.length)
+                    {
+                        column = copy.dstCol + copy.length;
+                    }
+                }
+
+                if (column < segment.srcCol + segment.length)
+                {
+                    uncovered.push_back(segment.srcRow);
+                }
+            }
+        }
+    }
+
+    for (const auto index : uncovered)
+    {
+        _ReflowPendingRow(index);
+    }
+    _ReleaseFinishedReflow();
+
+    if (!_pendingReflow)
+    {
+        return nullptr;
+    }
+
+    const auto& pending = *_pendingReflow;
+    layout.ExpandSegments([&](const size_t row, const ReflowSegment& segment, std::vector<ReflowSegment>& segments, std::vector<ReflowLayout::Erasure>& erasures) {
+        if (!_IsRowPendingReflow(segment.srcRow))
+        {
+            segments.push_back(segment);
+            return;
+        }
+
+        const auto begin = segment.srcCol;
+        const auto end = segment.srcCol + segment.length;
+        for (const auto& copy : pending.layout.RowSegments(pendingRow(segment)))
+        {
+            const auto first = std::max(begin, copy.dstCol);
+            const auto last = std::min(end, copy.dstCol + copy.length);
+            if (first < last)
+            {
+                segments.push_back(ReflowSegment{ copy.source, copy.srcRow, copy.srcCol + first - copy.dstCol, segment.dstCol + first - begin, last - first });
+            }
+        }
+
+        for (const auto& [erasedRow, column] : pending.layout.RowErasures(pendingRow(segment)))
+        {
+            const auto erasedColumn = gsl::narrow_cast<size_t>(column);
+            if (begin <= erasedColumn && erasedColumn < end)
+            {
+                erasures.emplace_back(row, gsl::narrow_cast<short>(segment.dstCol + erasedColumn - begin));
+            }
+        }
+    });
+
+    return pending.source;
+}
+
+// Routine Description:
+// - Hands this buffer the buffer it was lazily reflowed from. Rows that
+//   haven't been copied in yet still read from it, so callers of
+//   ReflowLazily must pass the old buffer here instead of destroying it,
+//   once they're done with it.
+// Arguments:
+// - oldBuffer - the text buffer this one was reflowed from
+// Return Value:
+// - <none>, throws exceptions on failures.
+void TextBuffer::KeepReflowSource(std::unique_ptr<TextBuffer> oldBuffer)
+{
+    _ReleaseFinishedReflow();
+    if (_pendingReflow && !_pendingReflow->source)
+    {
+        try
+        {
+            _pendingReflow->source = std::move(oldBuffer);
+        }
+        catch (...)
+        {
+            // We can't hold onto the old buffer, so copy out of it while we still have it.
+            LOG_CAUGHT_EXCEPTION();
+            ReflowAllPendingRows();
+        }
+    }
+}
+
+// Routine Description:
+// - Identifies the rows that the last lazy reflow of this buffer left to copy.
+// Return Value:
+// - The generation of the pending rows, or 0 if none are pending.
+uint64_t TextBuffer::GetPendingReflowGeneration() const noexcept
+{
+    return _pendingReflow && _pendingReflow->count != 0 ? _pendingReflow->generation : 0;
+}
+
+// Routine Description:
+// - Copies in some of the rows that a lazy reflow left pending. Meant to be
+//   called repeatedly while the host is idle, until it returns false.
+// - Starts with the rows right above the ones that were reflowed eagerly,
+//   since that's where the user is most likely to scroll to.
+// Arguments:
+// - generation - the generation the caller got from GetPendingReflowGeneration.
+//   If the buffer was reflowed again since, there's nothing to do.
+// - maxRows - the most rows to copy in this call
+// Return Value:
+// - true if rows of the given generation are still pending.
+bool TextBuffer::ReflowPendingRows(const uint64_t generation, const size_t maxRows)
+{
+    _ReleaseFinishedReflow();
+
+    for (size_t copied = 0; copied < maxRows && _pendingReflow && _pendingReflow->generation == generation; ++copied)
+    {
+        auto& pending = *_pendingReflow;
+        while (pending.backgroundRow > pending.firstRow && !pending.pending.at(pending.backgroundRow - 1))
+        {
+            --pending.backgroundRow;
+        }
+
+        // Rows above the first row were recycled by circling, so the
+        // remaining rows are always between the two. If there are none,
+        // ReflowPendingRowsAt copied in the rest already.
+        if (pending.backgroundRow == pending.firstRow)
+        {
+            _pendingReflow.reset();
+            return false;
+        }
+
+        _ReflowPendingRow(pending.backgroundRow - 1 - pending.firstRow);
+        _ReleaseFinishedReflow();
+    }
+
+    return _pendingReflow && _pendingReflow->generation == generation;
+}
+
 // Function Description:
 // - Reflow the contents from the old buffer into the new buffer. The new buffer
 //   can have different dimensions than the old buffer. If it does, then this
 //   function will attempt to maintain the logical contents of the old buffer,
 //   by continuing wrapped lines onto the next line in the new buffer.
+// - The result is the same as inserting every character of the old buffer
+//   into the new one with InsertCharacter. To make this fast for large
+//   buffers, we first lay out where every span of cells lands in the new
+//   buffer (a cheap pass that only looks at the double byte attributes), then
+//   copy the rows that survive circling in parallel, and finally place the
+//   cursor. The new buffer is expected to be freshly created.
 // Arguments:
 // - oldBuffer - the text buffer to copy the contents FROM
 // - newBuffer - the text buffer to copy the contents TO
@@ -1966,6 +2862,58 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
                            TextBuffer& newBuffer,
                            const std::optional<Viewport> lastCharacterViewport,
                            std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
+{
+    return _Reflow(oldBuffer, newBuffer, std::nullopt, lastCharacterViewport, positionInfo);
+}
+
+// Function Description:
+// - Reflow the contents from the old buffer into the new buffer like Reflow
+//   does, but only copy the bottom rows of the reflowed text right away. The
+//   rest of the scrollback is copied in when it's first written to, or by
+//   ReflowPendingRows, ReflowPendingRowsAt and ReflowAllPendingRows. Reading
+//   the buffer doesn't copy in rows, so until then, they read as blank.
+// - Laying out the whole buffer is cheap compared to copying it, so the
+//   result (cursor and positionInfo included) is the same as Reflow's.
+// - If the old buffer still has pending rows of its own, they aren't copied
+//   into it. The new buffer reads them from wherever the old buffer would.
+//   This way resizing repeatedly (e.g. while dragging the window border)
+//   never copies the scrollback more than once.
+// - The caller must hand the old buffer to the new one with KeepReflowSource
+//   when it's done with the old buffer.
+// Arguments:
+// - oldBuffer - the text buffer to copy the contents FROM
+// - newBuffer - the text buffer to copy the contents TO
+// - eagerRows - how many rows at the bottom of the reflowed text to copy now.
+//   Callers should cover the viewport, plus some margin.
+// - lastCharacterViewport - see Reflow.
+// - positionInfo - see Reflow.
+// Return Value:
+// - S_OK if we successfully reflowed the contents into the new buffer, otherwise an appropriate HRESULT.
+HRESULT TextBuffer::ReflowLazily(TextBuffer& oldBuffer,
+                                 TextBuffer& newBuffer,
+                                 const size_t eagerRows,
+                                 const std::optional<Viewport> lastCharacterViewport,
+                                 std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
+{
+    return _Reflow(oldBuffer, newBuffer, eagerRows, lastCharacterViewport, positionInfo);
+}
+
+// Function Description:
+// - Implements Reflow and ReflowLazily.
+// Arguments:
+// - oldBuffer - the text buffer to copy the contents FROM
+// - newBuffer - the text buffer to copy the contents TO
+// - eagerRows - Optional. If given, only this many rows at the bottom of the
+//   reflowed text are copied now, and the rest are left pending.
+// - lastCharacterViewport - see Reflow.
+// - positionInfo - see Reflow.
+// Return Value:
+// - S_OK if we successfully reflowed the contents into the new buffer, otherwise an appropriate HRESULT.
+HRESULT TextBuffer::_Reflow(TextBuffer& oldBuffer,
+                            TextBuffer& newBuffer,
+                            const std::optional<size_t> eagerRows,
+                            const std::optional<Viewport> lastCharacterViewport,
+                            std::optional<std::reference_wrapper<PositionInformation>> positionInfo)
 {
     Cursor& oldCursor = oldBuffer.GetCursor();
     Cursor& newCursor = newBuffer.GetCursor();
@@ -1987,91 +2935,103 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
     bool foundOldMutable = false;
     bool foundOldVisible = false;
     HRESULT hr = S_OK;
-    // Loop through all the rows of the old buffer and reprint them into the new buffer
-    for (short iOldRow = 0; iOldRow < cOldRowsTotal; iOldRow++)
-    {
-        // Fetch the row and its "right" which is the last printable character.
-        const ROW& row = oldBuffer.GetRowByOffset(iOldRow);
-        const CharRow& charRow = row.GetCharRow();
-        short iRight = gsl::narrow_cast<short>(charRow.MeasureRight());
-
-        // There is a special case here. If the row has a "wrap"
-        // flag on it, but the right isn't equal to the width (one
-        // index past the final valid index in the row) then there
-        // were a bunch trailing of spaces in the row.
-        // (But the measuring functions for each row Left/Right do
-        // not count spaces as "displayable" so they're not
-        // included.)
-        // As such, adjust the "right" to be the width of the row
-        // to capture all these spaces
-        if (charRow.WasWrapForced())
-        {
-            iRight = cOldColsTotal;
-
-            // And a combined special case.
-            // If we wrapped off the end of the row by adding a
-            // piece of padding because of a double byte LEADING
-            // character, then remove one from the "right" to
-            // leave this padding out of the copy process.
-            if (charRow.WasDoubleBytePadded())
-            {
-                iRight--;
-            }
-        }
+    try
+    {
+        ReflowLayout layout{ oldBuffer, newBuffer.GetSize().Dimensions(), newCursor.GetPosition() };
 
-        // Loop through every character in the current row (up to
-        // the "right" boundary, which is one past the final valid
-        // character)
-        for (short iOldCol = 0; iOldCol < iRight; iOldCol++)
+        // Rows of the old buffer that its own lazy reflow left pending are
+        // assembled in here, rather than copied into the old buffer.
+        ROW scratch{ 0, cOldColsTotal, oldBuffer.GetCurrentAttributes(), &oldBuffer };
+
+        // Loop through all the rows of the old buffer and lay them out in the new buffer
+        for (short iOldRow = 0; iOldRow < cOldRowsTotal; iOldRow++)
         {
-            if (iOldCol == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
+            // Fetch the row and its "right" which is the last printable character.
+            const CharRow& charRow = oldBuffer._PeekCharRow(iOldRow, scratch);
+            short iRight = gsl::narrow_cast<short>(charRow.MeasureRight());
+
+            // There is a special case here. If the row has a "wrap"
+            // flag on it, but the right isn't equal to the width (one
+            // index past the final valid index in the row) then there
+            // were a bunch trailing of spaces in the row.
+            // (But the measuring functions for each row Left/Right do
+            // not count spaces as "displayable" so they're not
+            // included.)
+            // As such, adjust the "right" to be the width of the row
+            // to capture all these spaces
+            if (charRow.WasWrapForced())
             {
-                cNewCursorPos = newCursor.GetPosition();
-                fFoundCursorPos = true;
+                iRight = cOldColsTotal;
+
+                // And a combined special case.
+                // If we wrapped off the end of the row by adding a
+                // piece of padding because of a double byte LEADING
+                // character, then remove one from the "right" to
+                // leave this padding out of the copy process.
+                if (charRow.WasDoubleBytePadded())
+                {
+                    iRight--;
+                }
             }
 
-            try
+            // Lay out every character in the current row (up to the "right"
+            // boundary, which is one past the final valid character). Runs of
+            // single width characters are placed all at once. Runs stop at
+            // the cursor so that we can record where it lands.
+            const auto dbcsAttrs = charRow.DbcsAttrs();
+            short iOldCol = 0;
+            while (iOldCol < iRight)
             {
-                // TODO: MSFT: 19446208 - this should just use an iterator and the inserter...
-                const auto glyph = row.GetCharRow().GlyphAt(iOldCol);
-                const auto dbcsAttr = row.GetCharRow().DbcsAttrAt(iOldCol);
-                const auto textAttr = row.GetAttrRow().GetAttrByColumn(iOldCol);
+                const bool cursorInRow = iOldRow == cOldCursorPos.Y;
+                if (cursorInRow && iOldCol == cOldCursorPos.X)
+                {
+                    cNewCursorPos = layout.CursorPosition();
+                    fFoundCursorPos = true;
+                }
 
-                if (!newBuffer.InsertCharacter(glyph, dbcsAttr, textAttr))
+                const short iRunLimit = (cursorInRow && cOldCursorPos.X > iOldCol && cOldCursorPos.X < iRight) ? cOldCursorPos.X : iRight;
+                short iRunEnd = iOldCol;
+                while (iRunEnd < iRunLimit && !dbcsAttrs[iRunEnd].IsDbcs())
                 {
-                    hr = E_OUTOFMEMORY;
-                    break;
+                    iRunEnd++;
                 }
-            }
-            CATCH_RETURN();
-        }
 
-        // If we found the old row that the caller was interested in, set the
-        // out value of that parameter to the cursor's current Y position (the
-        // new location of the _end_ of that row in the buffer).
-        if (positionInfo.has_value())
-        {
-            if (!foundOldMutable)
-            {
-                if (iOldRow >= positionInfo.value().get().mutableViewportTop)
+                if (iRunEnd > iOldCol)
                 {
-                    positionInfo.value().get().mutableViewportTop = newCursor.GetPosition().Y;
-                    foundOldMutable = true;
+                    layout.PlaceSingleCells(iOldRow, iOldCol, gsl::narrow_cast<size_t>(iRunEnd) - iOldCol);
+                    iOldCol = iRunEnd;
+                }
+                else
+                {
+                    layout.PlaceCell(iOldRow, iOldCol, dbcsAttrs[iOldCol]);
+                    iOldCol++;
                 }
             }
 
-            if (!foundOldVisible)
+            // If we found the old row that the caller was interested in, set the
+            // out value of that parameter to the cursor's current Y position (the
+            // new location of the _end_ of that row in the buffer).
+            if (positionInfo.has_value())
             {
-                if (iOldRow >= positionInfo.value().get().visibleViewportTop)
+                if (!foundOldMutable)
+                {
+                    if (iOldRow >= positionInfo.value().get().mutableViewportTop)
+                    {
+                        positionInfo.value().get().mutableViewportTop = layout.CursorPosition().Y;
+                        foundOldMutable = true;
+                    }
+                }
+
+                if (!foundOldVisible)
                 {
-                    positionInfo.value().get().visibleViewportTop = newCursor.GetPosition().Y;
-                    foundOldVisible = true;
+                    if (iOldRow >= positionInfo.value().get().visibleViewportTop)
+                    {
+                        positionInfo.value().get().visibleViewportTop = layout.CursorPosition().Y;
+                        foundOldVisible = true;
+                    }
                 }
             }
-        }
 
-        if (SUCCEEDED(hr))
-        {
             // If we didn't have a full row to copy, insert a new
             // line into the new buffer.
             // Only do so if we were not forced to wrap. If we did
@@ -2081,7 +3041,7 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
             {
                 if (iRight == cOldCursorPos.X && iOldRow == cOldCursorPos.Y)
                 {
-                    cNewCursorPos = newCursor.GetPosition();
+                    cNewCursorPos = layout.CursorPosition();
                     fFoundCursorPos = true;
                 }
                 // Only do this if it's not the final line in the buffer.
@@ -2090,7 +3050,7 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
                 // adjustment to follow.
                 if (iOldRow < cOldRowsTotal - 1)
                 {
-                    hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
+                    layout.NewlineCursor();
                 }
                 else
                 {
@@ -2118,18 +3078,76 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
                     // |aaaaaaaaaaaaaaaaaaa| no wrap at the end (preserved hard newline)
                     // |                   |
                     //  ^ and the cursor is now here.
-                    const COORD coordNewCursor = newCursor.GetPosition();
+                    const COORD coordNewCursor = layout.CursorPosition();
                     if (coordNewCursor.X == 0 && coordNewCursor.Y > 0)
                     {
-                        if (newBuffer.GetRowByOffset(gsl::narrow_cast<size_t>(coordNewCursor.Y) - 1).GetCharRow().WasWrapForced())
+                        if (layout.WasWrapForced(layout.CursorRow() - 1))
                         {
-                            hr = newBuffer.NewlineCursor() ? hr : E_OUTOFMEMORY;
+                            layout.NewlineCursor();
                         }
                     }
                 }
             }
         }
+
+        // If the old buffer has rows pending from a lazy reflow of its own,
+        // we copy those cells from where it would have, and hold onto that.
+        const auto source = oldBuffer._ForwardPendingReflow(layout);
+
+        // Everything the cursor moved past the bottom of the new buffer
+        // circled it. Do all of that circling at once, then fill in the rows.
+        const auto circles = layout.CircleCount();
+        if (circles > 0)
+        {
+            newBuffer._renderTarget.TriggerCircling();
+            newBuffer._SetFirstRowIndex(gsl::narrow_cast<SHORT>((newBuffer._firstRow + circles) % newBuffer.TotalRowCount()));
+        }
+
+        // When reflowing lazily, leave everything above the bottom rows
+        // pending. Rows that copy cells from the old buffer itself can only
+        // be left pending if the new buffer gets to keep the old buffer,
+        // which it doesn't if it keeps the old buffer's source instead.
+        const auto endRow = layout.CursorRow() + 1;
+        std::vector<bool> pending;
+        size_t pendingCount = 0;
+        if (eagerRows.has_value())
+        {
+            const auto eagerStart = endRow - std::min(eagerRows.value(), endRow - circles);
+            pending.resize(endRow, false);
+            for (auto row = circles; row < eagerStart; ++row)
+            {
+                const auto segments = layout.RowSegments(row);
+                const auto needsOldBuffer = source && std::any_of(segments.begin(), segments.end(), [&](const ReflowSegment& copy) noexcept {
+                                                return copy.source == &oldBuffer;
+                                            });
+                if (!needsOldBuffer)
+                {
+                    pending.at(row) = true;
+                    ++pendingCount;
+                }
+            }
+        }
+
+        newBuffer._InternReflowAttributes(layout, newBuffer.GetCurrentAttributes());
+        hr = _CopyReflowedRows(newBuffer, layout, pending);
+
+        newCursor.SetPosition(layout.CursorPosition());
+
+        if (SUCCEEDED(hr) && pendingCount > 0)
+        {
+            newBuffer._pendingReflow = std::make_unique<PendingReflow>(std::move(layout),
+                                                                       std::move(pending),
+                                                                       pendingCount,
+                                                                       circles,
+                                                                       newBuffer.GetCurrentAttributes(),
+                                                                       source);
+        }
     }
+    catch (...)
+    {
+        hr = wil::ResultFromCaughtException();
+    }
+
     if (SUCCEEDED(hr))
     {
         // Finish copying remaining parameters from the old text buffer to the new one
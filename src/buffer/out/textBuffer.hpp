@@ -52,6 +52,7 @@ filling in the last row, and updating the screen.
 #include "cursor.h"
 #include "Row.hpp"
 #include "TextAttribute.hpp"
+#include "TextAttributeTable.hpp"
 #include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
@@ -60,6 +61,8 @@ filling in the last row, and updating the screen.
 
 #include "../renderer/inc/IRenderTarget.hpp"
 
+class ReflowLayout;
+
 class TextBuffer final
 {
 public:
@@ -68,6 +71,7 @@ public:
                const UINT cursorSize,
                Microsoft::Console::Render::IRenderTarget& renderTarget);
     TextBuffer(const TextBuffer& a) = delete;
+    ~TextBuffer();
 
     // Used for duplicating properties to another text buffer
     void CopyProperties(const TextBuffer& OtherBuffer) noexcept;
@@ -95,6 +99,17 @@ public:
                                  const std::optional<bool> setWrap = std::nullopt,
                                  const std::optional<size_t> limitRight = std::nullopt);
 
+    void WriteCharInfos(const gsl::span<const CHAR_INFO> charInfos,
+                        const COORD target,
+                        const std::optional<bool> wrap = true);
+
+    void CopyRectangle(const Microsoft::Console::Types::Viewport& source,
+                       const COORD target);
+
+    void FillRectangle(const Microsoft::Console::Types::Viewport& rect,
+                       const wchar_t fillChar,
+                       const std::optional<TextAttribute> fillAttributes);
+
     bool InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool IncrementCursor();
@@ -127,6 +142,9 @@ public:
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
     UnicodeStorage& GetUnicodeStorage() noexcept;
 
+    const TextAttributeTable& GetAttributeTable() const noexcept;
+    TextAttributeTable& GetAttributeTable() noexcept;
+
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget() noexcept;
 
     const COORD GetWordStart(const COORD target, const std::wstring_view wordDelimiters, bool accessibilityMode = false) const;
@@ -177,7 +195,23 @@ public:
                           const std::optional<Microsoft::Console::Types::Viewport> lastCharacterViewport,
                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo);
 
+    static HRESULT ReflowLazily(TextBuffer& oldBuffer,
+                                TextBuffer& newBuffer,
+                                const size_t eagerRows,
+                                const std::optional<Microsoft::Console::Types::Viewport> lastCharacterViewport,
+                                std::optional<std::reference_wrapper<PositionInformation>> positionInfo);
+
+    void KeepReflowSource(std::unique_ptr<TextBuffer> oldBuffer);
+    uint64_t GetPendingReflowGeneration() const noexcept;
+    bool ReflowPendingRows(const uint64_t generation, const size_t maxRows);
+    void ReflowPendingRowsAt(const size_t index, const size_t count);
+    void ReflowAllPendingRows();
+
 private:
+    // The rows store IDs from this table, so it has to outlive them.
+    TextAttributeTable _attributes;
+    size_t _attributeCompactionLimit;
+
     std::deque<ROW> _storage;
     Cursor _cursor;
 
@@ -200,6 +234,13 @@ private:
     void _AdjustWrapOnCurrentRow(const bool fSet);
 
     void _NotifyPaint(const Microsoft::Console::Types::Viewport& viewport) const;
+    Microsoft::Console::Types::Viewport _WidenForSplitGlyphs(const Microsoft::Console::Types::Viewport& rect) const;
+
+    void _CompactAttributesIfNeeded() noexcept;
+    void _CompactAttributes();
+    void _MarkUsedAttributes(std::vector<bool>& used) const;
+    static std::vector<const TextBuffer*> _GetReflowSources(const ReflowLayout& layout);
+    void _InternReflowAttributes(const ReflowLayout& layout, const TextAttribute fillAttributes);
 
     // Assist with maintaining proper buffer state for Double Byte character sequences
     bool _PrepareForDoubleByteSequence(const DbcsAttribute dbcsAttribute);
@@ -216,6 +257,23 @@ private:
     const COORD _GetWordEndForAccessibility(const COORD target, const std::wstring_view wordDelimiters) const;
     const COORD _GetWordEndForSelection(const COORD target, const std::wstring_view wordDelimiters) const;
 
+    static HRESULT _Reflow(TextBuffer& oldBuffer,
+                           TextBuffer& newBuffer,
+                           const std::optional<size_t> eagerRows,
+                           const std::optional<Microsoft::Console::Types::Viewport> lastCharacterViewport,
+                           std::optional<std::reference_wrapper<PositionInformation>> positionInfo);
+
+    // Rows that a lazy reflow hasn't copied in yet
+    struct PendingReflow;
+    std::unique_ptr<PendingReflow> _pendingReflow;
+
+    void _ReflowPendingRow(const size_t index);
+    void _ReleaseFinishedReflow() noexcept;
+    bool _IsRowPendingReflow(const size_t index) const;
+    const CharRow& _PeekCharRow(const size_t index, ROW& scratch) const;
+    void _CirclePendingReflow() noexcept;
+    std::shared_ptr<const TextBuffer> _ForwardPendingReflow(ReflowLayout& layout);
+
 #ifdef UNIT_TESTING
     friend class TextBufferTests;
     friend class UiaTextRangeTests;
@@ -265,3 +265,14 @@ const OutputCellView* TextBufferCellIterator::operator->() const noexcept
 {
     return &_view;
 }
+
+// Routine Description:
+// - Gets the ID of the attributes of the current cell. Cells of the same
+//   buffer have the same attributes if and only if their IDs are equal,
+//   which is cheaper to compare than the attributes themselves.
+// Return Value:
+// - the ID of the attributes in the attribute table of the buffer
+TextAttributeTable::Id TextBufferCellIterator::TextAttrId() const
+{
+    return _attrIter.GetAttributeId();
+}
@@ -0,0 +1,166 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../TextAttributeTable.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class TextAttributeTableTests
+{
+    TEST_CLASS(TextAttributeTableTests);
+
+    static TextAttribute _MakeAttribute(const size_t index)
+    {
+        return TextAttribute{ RGB(index & 0xff, (index >> 8) & 0xff, (index >> 16) & 0xff), RGB(0, 0, 0) };
+    }
+
+    TEST_METHOD(DefaultAttributesHaveDefaultId)
+    {
+        TextAttributeTable table;
+        VERIFY_ARE_EQUAL(size_t{ 1 }, table.Size());
+        VERIFY_ARE_EQUAL(TextAttributeTable::DefaultId, table.Intern(TextAttribute{}));
+        VERIFY_ARE_EQUAL(TextAttribute{}, table.Get(TextAttributeTable::DefaultId));
+    }
+
+    TEST_METHOD(InternDeduplicates)
+    {
+        TextAttributeTable table;
+        const TextAttribute red{ FOREGROUND_RED };
+        const TextAttribute green{ FOREGROUND_GREEN };
+
+        VERIFY_IS_FALSE(table.Find(red).has_value());
+
+        const auto redId = table.Intern(red);
+        const auto greenId = table.Intern(green);
+        VERIFY_ARE_NOT_EQUAL(redId, greenId);
+        VERIFY_ARE_EQUAL(size_t{ 3 }, table.Size());
+
+        Log::Comment(L"Interning equal attributes again hands out the same ID.");
+        VERIFY_ARE_EQUAL(redId, table.Intern(TextAttribute{ FOREGROUND_RED }));
+        VERIFY_ARE_EQUAL(greenId, table.Find(green).value());
+        VERIFY_ARE_EQUAL(size_t{ 3 }, table.Size());
+
+        VERIFY_ARE_EQUAL(red, table.Get(redId));
+        VERIFY_ARE_EQUAL(green, table.Get(greenId));
+    }
+
+    // Interns distinct attributes until only the overflow chunk is left.
+    static void _FillTable(TextAttributeTable& table)
+    {
+        const auto full = TextAttributeTable::Capacity - TextAttributeTable::OverflowCapacity;
+        for (size_t i = 1; i < full; ++i)
+        {
+            VERIFY_ARE_EQUAL(i, static_cast<size_t>(table.Intern(_MakeAttribute(i))));
+        }
+        VERIFY_ARE_EQUAL(full, table.Size());
+    }
+
+    TEST_METHOD(FullTableReclaimsUnusedIds)
+    {
+        TextAttributeTable table;
+        _FillTable(table);
+
+        Log::Comment(L"The owner only still uses the even IDs.");
+        table.SetUsageCallback([](std::vector<bool>& used) {
+            VERIFY_ARE_EQUAL(TextAttributeTable::Capacity, used.size());
+            for (size_t id = 0; id < used.size(); id += 2)
+            {
+                used.at(id) = true;
+            }
+        });
+
+        Log::Comment(L"Attributes that are already interned are still found.");
+        VERIFY_ARE_EQUAL(TextAttributeTable::Id{ 42 }, table.Intern(_MakeAttribute(42)));
+
+        Log::Comment(L"While all IDs are pinned, nothing is reclaimed.");
+        VERIFY_ARE_EQUAL(TextAttributeTable::Id{ 0x4444 }, table.Intern(_MakeAttribute(0x0f4241)));
+        VERIFY_IS_FALSE(table.Find(_MakeAttribute(0x0f4241)).has_value());
+        VERIFY_ARE_EQUAL(_MakeAttribute(43), table.Get(43));
+
+        Log::Comment(L"Once they're released, unused IDs are handed out again, lowest first.");
+        table.ReleasePins();
+        const TextAttribute attr{ RGB(1, 2, 3), RGB(4, 5, 6) };
+        VERIFY_ARE_EQUAL(TextAttributeTable::Id{ 1 }, table.Intern(attr));
+        VERIFY_ARE_EQUAL(attr, table.Get(1));
+        VERIFY_IS_FALSE(table.Find(_MakeAttribute(1)).has_value());
+        VERIFY_ARE_EQUAL(TextAttributeTable::Id{ 3 }, table.Intern(_MakeAttribute(1)));
+
+        Log::Comment(L"The IDs still in use keep their attributes.");
+        for (size_t id = 2; id < 1000; id += 2)
+        {
+            VERIFY_ARE_EQUAL(_MakeAttribute(id), table.Get(gsl::narrow_cast<TextAttributeTable::Id>(id)));
+            VERIFY_ARE_EQUAL(id, static_cast<size_t>(table.Find(_MakeAttribute(id)).value()));
+        }
+        VERIFY_IS_FALSE(table.Find(_MakeAttribute(5)).has_value());
+    }
+
+    TEST_METHOD(FullTableApproximatesColors)
+    {
+        TextAttributeTable table;
+        _FillTable(table);
+
+        Log::Comment(L"Without anything to reclaim, a close color that's interned already is used.");
+        const auto close = table.Intern(TextAttribute{ RGB(0x12, 0x34, 0x01), RGB(0, 0, 0) });
+        VERIFY_ARE_EQUAL((TextAttribute{ RGB(0x11, 0x33, 0x00), RGB(0, 0, 0) }), table.Get(close));
+        VERIFY_ARE_EQUAL(size_t{ 0x3311 }, static_cast<size_t>(close));
+
+        Log::Comment(L"Failing that, the coarsest approximation goes into the overflow chunk.");
+        const auto coarse = table.Intern(TextAttribute{ RGB(0x12, 0x34, 0x96), RGB(0xf0, 0x10, 0x80) });
+        VERIFY_ARE_EQUAL(TextAttributeTable::Capacity - TextAttributeTable::OverflowCapacity, static_cast<size_t>(coarse));
+        VERIFY_ARE_EQUAL((TextAttribute{ RGB(0, 0, 0xff), RGB(0xff, 0, 0xff) }), table.Get(coarse));
+
+        Log::Comment(L"Other attributes with the same approximation share it.");
+        VERIFY_ARE_EQUAL(coarse, table.Intern(TextAttribute{ RGB(0x01, 0x02, 0xff), RGB(0x80, 0x7f, 0xa0) }));
+        VERIFY_ARE_NOT_EQUAL(TextAttributeTable::DefaultId, table.Intern(TextAttribute{ FOREGROUND_RED | COMMON_LVB_UNDERSCORE }));
+        VERIFY_IS_LESS_THAN_OR_EQUAL(table.Size(), TextAttributeTable::Capacity);
+    }
+
+    TEST_METHOD(CompactDropsUnusedAttributes)
+    {
+        TextAttributeTable table;
+        std::vector<TextAttributeTable::Id> ids;
+        for (size_t i = 1; i <= 1000; ++i)
+        {
+            ids.push_back(table.Intern(_MakeAttribute(i)));
+        }
+
+        Log::Comment(L"Keep every third attribute.");
+        std::vector<bool> used(table.Size(), false);
+        for (size_t i = 0; i < ids.size(); i += 3)
+        {
+            used.at(ids.at(i)) = true;
+        }
+
+        const auto remap = table.Compact(used);
+        VERIFY_ARE_EQUAL(size_t{ 1001 }, remap.size());
+        VERIFY_ARE_EQUAL(size_t{ 1 + 334 }, table.Size());
+        VERIFY_ARE_EQUAL(TextAttributeTable::DefaultId, remap.at(TextAttributeTable::DefaultId));
+
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            const auto attr = _MakeAttribute(i + 1);
+            if (i % 3 == 0)
+            {
+                const auto newId = remap.at(ids.at(i));
+                VERIFY_ARE_EQUAL(attr, table.Get(newId));
+                VERIFY_ARE_EQUAL(newId, table.Find(attr).value());
+            }
+            else
+            {
+                VERIFY_ARE_EQUAL(TextAttributeTable::DefaultId, remap.at(ids.at(i)));
+                VERIFY_IS_FALSE(table.Find(attr).has_value());
+            }
+        }
+
+        Log::Comment(L"Dropped attributes can be interned again, past the kept ones.");
+        const auto id = table.Intern(_MakeAttribute(2));
+        VERIFY_ARE_EQUAL(size_t{ 1 + 334 }, static_cast<size_t>(id));
+        VERIFY_ARE_EQUAL(_MakeAttribute(2), table.Get(id));
+    }
+};
@@ -91,6 +91,8 @@ private:
     void _LayerOrCreateColorScheme(const Json::Value& schemeJson);
     ColorScheme* _FindMatchingColorScheme(const Json::Value& schemeJson);
     void _ParseJsonString(std::string_view fileData, const bool isDefaultSettings);
+    bool _LoadSettingsCache(const std::string_view cache, const std::string_view userSettings);
+    std::string _SerializeSettingsCache() const;
     static const Json::Value& _GetProfilesJsonObject(const Json::Value& json);
     static const Json::Value& _GetDisabledProfileSourcesJsonObject(const Json::Value& json);
     bool _PrependSchemaDirective();
@@ -104,6 +106,8 @@ private:
     static void _WriteSettings(const std::string_view content);
     static std::optional<std::string> _ReadUserSettings();
     static std::optional<std::string> _ReadFile(HANDLE hFile);
+    static void _WriteSettingsCache(const std::string_view content);
+    static std::optional<std::string> _ReadSettingsCache();
 
     GUID _GetProfileForIndex(std::optional<int> index) const;
     GUID _GetProfileForArgs(const winrt::TerminalApp::NewTerminalArgs& newTerminalArgs) const;
@@ -7,6 +7,7 @@
 #include "../../types/inc/utils.hpp"
 #include "utils.h"
 #include "JsonUtils.h"
+#include "SettingsCache.h"
 #include <appmodel.h>
 #include <shlobj.h>
 
@@ -25,6 +26,7 @@ using namespace ::Microsoft::Console;
 
 static constexpr std::wstring_view SettingsFilename{ L"settings.json" };
 static constexpr std::wstring_view LegacySettingsFilename{ L"profiles.json" };
+static constexpr std::wstring_view SettingsCacheFilename{ L"settings.cache" };
 static constexpr std::wstring_view UnpackagedSettingsFolderName{ L"Microsoft\\Windows Terminal\\" };
 
 static constexpr std::wstring_view DefaultsFilename{ L"defaults.json" };
@@ -52,25 +54,51 @@ static constexpr std::string_view SettingsSchemaFragment{ "\n"
 // - Also runs and dynamic profile generators. If any of those generators create
 //   new profiles, we'll write the user settings back to the file, with the new
 //   profiles inserted into their list of profiles.
+// - The parsed JSON of both files is kept in a cache next to the user's
+//   settings. As long as neither file changed, the JSON is loaded from there
+//   instead of being parsed again.
 // Return Value:
 // - a unique_ptr containing a new CascadiaSettings object.
 std::unique_ptr<CascadiaSettings> CascadiaSettings::LoadAll()
 {
-    auto resultPtr = LoadDefaults();
-
-    // GH 3588, we need this below to know if the user chose something that wasn't our default.
-    // Collect it up here in case it gets modified by any of the other layers between now and when
-    // the user's preferences are loaded and layered.
-    const auto hardcodedDefaultGuid = resultPtr->GlobalSettings().GetDefaultProfile();
-
     std::optional<std::string> fileData = _ReadUserSettings();
     const bool foundFile = fileData.has_value();
 
     // Make sure the file isn't totally empty. If it is, we'll treat the file
     // like it doesn't exist at all.
     const bool fileHasData = foundFile && !fileData.value().empty();
-    bool needToWriteFile = false;
+
+    // The settings cache only saves us from parsing defaults.json and the
+    // user's settings. Everything from layering onward, including the dynamic
+    // profile generators, runs on every launch. That's why the cache is only
+    // keyed by the JSON texts.
+    auto resultPtr = std::make_unique<CascadiaSettings>();
+    bool loadedFromCache = false;
     if (fileHasData)
+    {
+        if (const auto cache = _ReadSettingsCache())
+        {
+            loadedFromCache = resultPtr->_LoadSettingsCache(cache.value(), fileData.value());
+        }
+    }
+
+    if (!loadedFromCache)
+    {
+        resultPtr->_ParseJsonString(DefaultJson, true);
+    }
+    resultPtr->LayerJson(resultPtr->_defaultSettings);
+
+    // GH 3588, we need this below to know if the user chose something that wasn't our default.
+    // Collect it up here in case it gets modified by any of the other layers between now and when
+    // the user's preferences are loaded and layered.
+    const auto hardcodedDefaultGuid = resultPtr->GlobalSettings().GetDefaultProfile();
+
+    bool needToWriteFile = false;
+    if (loadedFromCache)
+    {
+        // The cache already had the user's settings in it.
+    }
+    else if (fileHasData)
     {
         resultPtr->_ParseJsonString(fileData.value(), false);
     }
@@ -133,6 +161,17 @@ std::unique_ptr<CascadiaSettings> CascadiaSettings::LoadAll()
     // If this throws, the app will catch it and use the default settings
     resultPtr->_ValidateSettings();
 
+    // Save the JSON we parsed for the next launch. Failing to do that only
+    // means that the next launch has to parse it again.
+    if (!loadedFromCache || needToWriteFile)
+    {
+        try
+        {
+            _WriteSettingsCache(resultPtr->_SerializeSettingsCache());
+        }
+        CATCH_LOG();
+    }
+
     // GH 3855 - Gathering Data on custom profiles to inform better defaults
     // Do it after everything else so it won't happen unless validation passed.
     // Also, avoid processing unless someone's listening for measures. The keybindings work, at least,
@@ -329,6 +368,42 @@ void CascadiaSettings::_ParseJsonString(std::string_view fileData, const bool is
     }
 }
 
+// Method Description:
+// - Loads our _defaultSettings and _userSettings from the given settings cache,
+//   instead of parsing them from JSON.
+// Arguments:
+// - cache: the contents of the settings cache.
+// - userSettings: the current contents of the user's settings file. The cache
+//   is only used if it was written for exactly this text.
+// Return Value:
+// - true if the settings were loaded from the cache. false if the cache is out
+//   of date or damaged. Callers should parse the JSON then.
+bool CascadiaSettings::_LoadSettingsCache(const std::string_view cache, const std::string_view userSettings)
+{
+    const auto key = SettingsCache::ComputeKey(DefaultJson, userSettings);
+    if (!SettingsCache::Deserialize(cache, key, _defaultSettings, _userSettings))
+    {
+        return false;
+    }
+
+    _userSettingsString = userSettings;
+    return true;
+}
+
+// Method Description:
+// - Serializes our _defaultSettings and _userSettings into a settings cache,
+//   which _LoadSettingsCache can load as long as the user's settings file
+//   still matches our _userSettingsString.
+// Arguments:
+// - <none>
+// Return Value:
+// - the contents of the settings cache
+std::string CascadiaSettings::_SerializeSettingsCache() const
+{
+    const auto key = SettingsCache::ComputeKey(DefaultJson, _userSettingsString);
+    return SettingsCache::Serialize(key, _defaultSettings, _userSettings);
+}
+
 // Method Description:
 // - Determines whether the user's settings file is missing a schema directive
 //   and, if so, inserts one.
@@ -724,6 +799,65 @@ void CascadiaSettings::_WriteSettings(const std::string_view content)
     THROW_LAST_ERROR_IF(!WriteFile(hOut.get(), content.data(), gsl::narrow<DWORD>(content.size()), nullptr, nullptr));
 }
 
+// Method Description:
+// - Writes the given settings cache next to our settings file, replacing any
+//   cache that's already there.
+// Arguments:
+// - content: the contents of the settings cache.
+// Return Value:
+// - <none>
+//   This can throw an exception if we fail to open the file for writing, or we
+//      fail to write the file
+void CascadiaSettings::_WriteSettingsCache(const std::string_view content)
+{
+    auto pathToCacheFile{ CascadiaSettings::GetSettingsPath() };
+    pathToCacheFile.replace_filename(SettingsCacheFilename);
+
+    wil::unique_hfile hOut{ CreateFileW(pathToCacheFile.c_str(),
+                                        GENERIC_WRITE,
+                                        FILE_SHARE_READ,
+                                        nullptr,
+                                        CREATE_ALWAYS,
+                                        FILE_ATTRIBUTE_NORMAL,
+                                        nullptr) };
+    if (!hOut)
+    {
+        THROW_LAST_ERROR();
+    }
+    THROW_LAST_ERROR_IF(!WriteFile(hOut.get(), content.data(), gsl::narrow<DWORD>(content.size()), nullptr, nullptr));
+}
+
+// Method Description:
+// - Reads the settings cache that's stored next to our settings file.
+// Arguments:
+// - <none>
+// Return Value:
+// - an optional with the contents of the cache, or an empty optional if there
+//   isn't one or it can't be read. We'll just parse the settings then.
+std::optional<std::string> CascadiaSettings::_ReadSettingsCache()
+{
+    try
+    {
+        auto pathToCacheFile{ CascadiaSettings::GetSettingsPath() };
+        pathToCacheFile.replace_filename(SettingsCacheFilename);
+
+        wil::unique_hfile hFile{ CreateFileW(pathToCacheFile.c_str(),
+                                             GENERIC_READ,
+                                             FILE_SHARE_READ,
+                                             nullptr,
+                                             OPEN_EXISTING,
+                                             FILE_ATTRIBUTE_NORMAL,
+                                             nullptr) };
+        if (hFile)
+        {
+            return _ReadFile(hFile.get());
+        }
+    }
+    CATCH_LOG();
+
+    return std::nullopt;
+}
+
 // Method Description:
 // - Reads the content in UTF-8 encoding of our settings file using the Win32 APIs
 // Arguments:
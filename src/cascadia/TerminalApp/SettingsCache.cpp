@@ -0,0 +1,354 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include "SettingsCache.h"
+
+// Bump this whenever the layout below changes, or whenever something changes
+// how the settings are parsed, so that caches from older builds are thrown away.
+static constexpr uint32_t CacheVersion = 1;
+static constexpr uint32_t CacheMagic = 0x43535457; // "WTSC"
+
+// jsoncpp refuses to parse anything nested deeper than this either.
+static constexpr size_t MaxDepth = 1000;
+
+// The type and the two offsets.
+static constexpr size_t MinValueSize = sizeof(uint8_t) + 2 * sizeof(uint32_t);
+
+// The cache starts with this header. The payload after it holds the defaults
+// and the user's settings, one value after the other. Each value is its
+// Json::ValueType as a byte, its offsets into the original text, and then:
+// - int, uint, real, bool: the value itself.
+// - string: its length, then its UTF-8 bytes.
+// - array: the count of elements, then each element.
+// - object: the count of members, then each member as the length of its name,
+//   the name and its value.
+struct CacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+
+// A quick hash in the style of FNV-1a, that takes in 8 bytes at a time.
+// It only needs to tell whether the files changed, not to be hard to forge.
+static uint64_t _Hash(const std::string_view data, uint64_t hash = 14695981039346656037ull) noexcept
+{
+    constexpr uint64_t prime = 1099511628211ull;
+
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= data.size(); i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        memcpy(&word, data.data() + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; i < data.size(); ++i)
+    {
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * prime;
+    }
+    return hash;
+}
+
+template<typename T>
+static void _Append(std::string& out, const T value)
+{
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void _AppendString(std::string& out, const char* const begin, const char* const end)
+{
+    _Append(out, gsl::narrow<uint32_t>(end - begin));
+    out.append(begin, end);
+}
+
+static void _AppendValue(std::string& out, const Json::Value& value)
+{
+    _Append(out, gsl::narrow_cast<uint8_t>(value.type()));
+    _Append(out, gsl::narrow<uint32_t>(value.getOffsetStart()));
+    _Append(out, gsl::narrow<uint32_t>(value.getOffsetLimit()));
+
+    switch (value.type())
+    {
+    case Json::intValue:
+        _Append(out, value.asInt64());
+        break;
+    case Json::uintValue:
+        _Append(out, value.asUInt64());
+        break;
+    case Json::realValue:
+        _Append(out, value.asDouble());
+        break;
+    case Json::booleanValue:
+        _Append(out, gsl::narrow_cast<uint8_t>(value.asBool()));
+        break;
+    case Json::stringValue:
+    {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+        value.getString(&begin, &end);
+        _AppendString(out, begin, end);
+        break;
+    }
+    case Json::arrayValue:
+        _Append(out, gsl::narrow<uint32_t>(value.size()));
+        for (const auto& element : value)
+        {
+            _AppendValue(out, element);
+        }
+        break;
+    case Json::objectValue:
+        _Append(out, gsl::narrow<uint32_t>(value.size()));
+        for (auto it = value.begin(); it != value.end(); ++it)
+        {
+            const char* end = nullptr;
+            const char* begin = it.memberName(&end);
+            _AppendString(out, begin, end);
+            _AppendValue(out, *it);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// Reads the payload back. Every read checks that there's enough data left, so
+// that a truncated or otherwise damaged cache just fails to load.
+class CacheReader
+{
+public:
+    CacheReader(const std::string_view data) noexcept :
+        _data{ data }
+    {
+    }
+
+    bool Done() const noexcept
+    {
+        return _data.empty();
+    }
+
+    // Each value takes up at least this many bytes, so no array or object
+    // can hold more than the data left divided by it.
+    bool CanHold(const uint32_t count) const noexcept
+    {
+        return count <= _data.size() / MinValueSize;
+    }
+
+    template<typename T>
+    bool Read(T& value) noexcept
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (_data.size() < sizeof(value))
+        {
+            return false;
+        }
+        memcpy(&value, _data.data(), sizeof(value));
+        _data.remove_prefix(sizeof(value));
+        return true;
+    }
+
+    bool ReadString(std::string_view& value) noexcept
+    {
+        uint32_t size = 0;
+        if (!Read(size) || _data.size() < size)
+        {
+            return false;
+        }
+        value = _data.substr(0, size);
+        _data.remove_prefix(size);
+        return true;
+    }
+
+    bool ReadValue(Json::Value& value, const size_t depth)
+    {
+        uint8_t type = 0;
+        uint32_t offsetStart = 0;
+        uint32_t offsetLimit = 0;
+        if (depth > MaxDepth || !Read(type) || !Read(offsetStart) || !Read(offsetLimit))
+        {
+            return false;
+        }
+
+        switch (type)
+        {
+        case Json::nullValue:
+            value = Json::Value{};
+            break;
+        case Json::intValue:
+        {
+            Json::Int64 number = 0;
+            if (!Read(number))
+            {
+                return false;
+            }
+            value = Json::Value{ number };
+            break;
+        }
+        case Json::uintValue:
+        {
+            Json::UInt64 number = 0;
+            if (!Read(number))
+            {
+                return false;
+            }
+            value = Json::Value{ number };
+            break;
+        }
+        case Json::realValue:
+        {
+            double number = 0;
+            if (!Read(number))
+            {
+                return false;
+            }
+            value = Json::Value{ number };
+            break;
+        }
+        case Json::booleanValue:
+        {
+            uint8_t flag = 0;
+            if (!Read(flag))
+            {
+                return false;
+            }
+            value = Json::Value{ flag != 0 };
+            break;
+        }
+        case Json::stringValue:
+        {
+            std::string_view text;
+            if (!ReadString(text))
+            {
+                return false;
+            }
+            value = Json::Value{ text.data(), text.data() + text.size() };
+            break;
+        }
+        case Json::arrayValue:
+        {
+            uint32_t count = 0;
+            if (!Read(count) || !CanHold(count))
+            {
+                return false;
+            }
+            value = Json::Value{ Json::arrayValue };
+            value.resize(count);
+            for (Json::ArrayIndex i = 0; i < count; ++i)
+            {
+                if (!ReadValue(value[i], depth + 1))
+                {
+                    return false;
+                }
+            }
+            break;
+        }
+        case Json::objectValue:
+        {
+            uint32_t count = 0;
+            if (!Read(count) || !CanHold(count))
+            {
+                return false;
+            }
+            value = Json::Value{ Json::objectValue };
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                std::string_view name;
+                if (!ReadString(name) || !ReadValue(value[std::string{ name }], depth + 1))
+                {
+                    return false;
+                }
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+
+        value.setOffsetStart(offsetStart);
+        value.setOffsetLimit(offsetLimit);
+        return true;
+    }
+
+private:
+    std::string_view _data;
+};
+
+// Function Description:
+// - Computes the key that a cache of the given JSON documents is stored under.
+// Arguments:
+// - defaultSettings: the text of the defaults.json we're using.
+// - userSettings: the text of the user's settings.json.
+// Return Value:
+// - a hash of both documents
+uint64_t TerminalApp::SettingsCache::ComputeKey(const std::string_view defaultSettings,
+                                                const std::string_view userSettings) noexcept
+{
+    return _Hash(userSettings, _Hash(defaultSettings));
+}
+
+// Function Description:
+// - Serializes the parsed defaults and user settings into a cache that can be
+//   loaded back with Deserialize.
+// Arguments:
+// - key: the key of the JSON documents, from ComputeKey.
+// - defaultSettings: the parsed defaults.json.
+// - userSettings: the parsed settings.json.
+// Return Value:
+// - the contents of the cache.
+std::string TerminalApp::SettingsCache::Serialize(const uint64_t key,
+                                                  const Json::Value& defaultSettings,
+                                                  const Json::Value& userSettings)
+{
+    std::string cache(sizeof(CacheHeader), '\0');
+    _AppendValue(cache, defaultSettings);
+    _AppendValue(cache, userSettings);
+
+    const std::string_view payload{ cache.data() + sizeof(CacheHeader), cache.size() - sizeof(CacheHeader) };
+    const CacheHeader header{ CacheMagic, CacheVersion, key, payload.size(), _Hash(payload) };
+    memcpy(cache.data(), &header, sizeof(header));
+    return cache;
+}
+
+// Function Description:
+// - Loads the parsed defaults and user settings back from a cache that was
+//   written by Serialize.
+// Arguments:
+// - cache: the contents of the cache.
+// - key: the key of the JSON documents we're about to use, from ComputeKey.
+// - defaultSettings: receives the parsed defaults.json.
+// - userSettings: receives the parsed settings.json.
+// Return Value:
+// - true if the cache was loaded. false if it's damaged, or was written by
+//   another version or for other JSON documents. Neither of the values should
+//   be used then.
+bool TerminalApp::SettingsCache::Deserialize(const std::string_view cache,
+                                             const uint64_t key,
+                                             Json::Value& defaultSettings,
+                                             Json::Value& userSettings)
+{
+    CacheHeader header{};
+    if (cache.size() < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, cache.data(), sizeof(header));
+
+    const auto payload = cache.substr(sizeof(header));
+    if (header.magic != CacheMagic ||
+        header.version != CacheVersion ||
+        header.key != key ||
+        header.payloadSize != payload.size() ||
+        header.payloadHash != _Hash(payload))
+    {
+        return false;
+    }
+
+    CacheReader reader{ payload };
+    return reader.ReadValue(defaultSettings, 0) &&
+           reader.ReadValue(userSettings, 0) &&
+           reader.Done();
+}
@@ -0,0 +1,32 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- SettingsCache.h
+
+Abstract:
+- Saves the parsed defaults.json and settings.json documents in a compact
+  binary form, so that the next launch can load them back without parsing any
+  JSON, as long as neither of the files changed in the meantime.
+- The cache is only ever read back on the machine that wrote it. It's keyed by
+  a hash of both JSON files, and anything about it that doesn't look right
+  makes it count as stale. CascadiaSettings then parses the files instead, and
+  replaces the cache.
+--*/
+#pragma once
+
+namespace TerminalApp::SettingsCache
+{
+    uint64_t ComputeKey(const std::string_view defaultSettings,
+                        const std::string_view userSettings) noexcept;
+
+    std::string Serialize(const uint64_t key,
+                          const Json::Value& defaultSettings,
+                          const Json::Value& userSettings);
+
+    bool Deserialize(const std::string_view cache,
+                     const uint64_t key,
+                     Json::Value& defaultSettings,
+                     Json::Value& userSettings);
+};
@@ -166,8 +166,13 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
                                                     Search::Sensitivity::CaseSensitive :
                                                     Search::Sensitivity::CaseInsensitive;
 
-        Search search(*GetUiaData(), text.c_str(), direction, sensitivity);
         auto lock = _terminal->LockForWriting();
+
+        // The search may look at any row, so it can't skip the ones that the
+        // last resize left to reflow.
+        _terminal->ReflowAllPendingRows();
+
+        Search search(*GetUiaData(), text.c_str(), direction, sensitivity);
         if (search.FindNext())
         {
             _terminal->SetBlockSelection(false);
@@ -1371,7 +1376,12 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
 
         // This is a scroll event that wasn't initiated by the terminal
         //      itself - it was initiated by the mouse wheel, or the scrollbar.
-        _terminal->UserScrollViewport(newValue);
+        {
+            // The rows scrolled into view may still have to be reflowed,
+            // which only happens under the write lock.
+            auto lock = _terminal->LockForWriting();
+            _terminal->UserScrollViewport(newValue);
+        }
 
         // We've just told the terminal to update its viewport to reflect the
         // new scroll value so the scroll bar matches the viewport now.
@@ -1582,6 +1592,8 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
     // - Pre-process text pasted (presumably from the clipboard)
     //   before sending it over the terminal's connection, converting
     //   Windows-space \r\n line-endings to \r line-endings
+    // - If the application asked for bracketed paste mode, the text is
+    //   wrapped in the markers, so that it can tell it from typed text.
     void TermControl::_SendPastedTextToConnection(const std::wstring& wstr)
     {
         // Some notes on this implementation:
@@ -1604,6 +1616,12 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
             stripped.replace(pos, 2, L"\r");
         }
 
+        if (_terminal->IsBracketedPasteModeEnabled())
+        {
+            stripped.insert(0, L"\x1b[200~");
+            stripped.append(L"\x1b[201~");
+        }
+
         _connection.WriteInput(stripped);
         _terminal->TrySnapOnInput();
     }
@@ -1769,6 +1787,47 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         if (SUCCEEDED(hr) && hr != S_FALSE)
         {
             _connection.Resize(vp.Height(), vp.Width());
+
+            // The terminal only reflowed the rows around the viewport. Reflow
+            // the rest of the scrollback while we're idle. UIA clients may read
+            // any row at any time, with only the read lock, so if there are
+            // any, everything is reflowed right away instead.
+            if (_uiaEngine)
+            {
+                _terminal->ReflowAllPendingRows();
+            }
+            else if (const auto generation = _terminal->GetPendingReflowGeneration(); generation != 0)
+            {
+                _ReflowScrollbackAsync(generation);
+            }
+        }
+    }
+
+    // Method Description:
+    // - Reflows the scrollback rows that the last resize left to reflow, a
+    //   batch at a time, whenever the UI thread is idle. Stops as soon as the
+    //   terminal is resized again, since that resize starts its own.
+    // Arguments:
+    // - generation: the rows to reflow, from GetPendingReflowGeneration
+    winrt::fire_and_forget TermControl::_ReflowScrollbackAsync(const uint64_t generation)
+    {
+        auto weakThis{ get_weak() };
+
+        while (true)
+        {
+            co_await winrt::resume_foreground(Dispatcher(), CoreDispatcherPriority::Idle);
+
+            auto control{ weakThis.get() };
+            if (!control || _closing.load())
+            {
+                return;
+            }
+
+            auto lock = _terminal->LockForWriting();
+            if (!_terminal->ReflowPendingRows(generation))
+            {
+                return;
+            }
         }
     }
 
@@ -1905,7 +1964,14 @@ namespace winrt::Microsoft::Terminal::TerminalControl::implementation
         _selectionNeedsToBeCopied = false;
 
         // extract text from buffer
-        const auto bufferData = _terminal->RetrieveSelectedTextFromBuffer(singleLine);
+        TextBuffer::TextAndColor bufferData;
+        {
+            // The selection may span rows that the last resize left to
+            // reflow, and those are only reflowed under the write lock.
+            auto lock = _terminal->LockForWriting();
+            _terminal->ReflowAllPendingRows();
+            bufferData = _terminal->RetrieveSelectedTextFromBuffer(singleLine);
+        }
 
         // convert text: vector<string> --> string
         std::wstring textData;
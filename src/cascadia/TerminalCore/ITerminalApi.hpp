@@ -30,6 +30,7 @@ namespace Microsoft::Terminal::Core
         virtual COORD GetCursorPosition() noexcept = 0;
         virtual bool SetCursorVisibility(const bool visible) noexcept = 0;
         virtual bool CursorLineFeed(const bool withReturn) noexcept = 0;
+        virtual bool CursorReverseLineFeed() noexcept = 0;
         virtual bool EnableCursorBlinking(const bool enable) noexcept = 0;
 
         virtual bool DeleteCharacter(const size_t count) noexcept = 0;
@@ -38,6 +39,23 @@ namespace Microsoft::Terminal::Core
         virtual bool EraseInLine(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::EraseType eraseType) noexcept = 0;
         virtual bool EraseInDisplay(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::EraseType eraseType) noexcept = 0;
 
+        virtual bool SetScrollingMargins(const size_t topMargin, const size_t bottomMargin) noexcept = 0;
+        virtual bool InsertLines(const size_t count) noexcept = 0;
+        virtual bool DeleteLines(const size_t count) noexcept = 0;
+        virtual bool ScrollUp(const size_t distance) noexcept = 0;
+        virtual bool ScrollDown(const size_t distance) noexcept = 0;
+
+        virtual bool CopyRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea source,
+                                         const size_t targetTop,
+                                         const size_t targetLeft) noexcept = 0;
+        virtual bool FillRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea area,
+                                         const wchar_t fillChar,
+                                         const bool keepAttributes) noexcept = 0;
+        virtual bool EraseRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea area) noexcept = 0;
+
+        virtual bool UseAlternateScreenBuffer() noexcept = 0;
+        virtual bool UseMainScreenBuffer() noexcept = 0;
+
         virtual bool SetWindowTitle(std::wstring_view title) noexcept = 0;
 
         virtual bool SetColorTableEntry(const size_t tableIndex, const DWORD color) noexcept = 0;
@@ -55,6 +73,8 @@ namespace Microsoft::Terminal::Core
         virtual bool EnableButtonEventMouseMode(const bool enabled) noexcept = 0;
         virtual bool EnableAnyEventMouseMode(const bool enabled) noexcept = 0;
         virtual bool EnableAlternateScrollMode(const bool enabled) noexcept = 0;
+        virtual bool EnableBracketedPasteMode(const bool enabled) noexcept = 0;
+        virtual bool EnableSynchronizedOutput(const bool enabled) noexcept = 0;
 
         virtual bool IsVtInputEnabled() const = 0;
 
@@ -37,6 +37,10 @@ static std::wstring _KeyEventsToText(std::deque<std::unique_ptr<IInputEvent>>& i
 #pragma warning(suppress : 26455) // default constructor is throwing, too much effort to rearrange at this time.
 Terminal::Terminal() :
     _mutableViewport{ Viewport::Empty() },
+    _scrollMargins{ 0 },
+    _mainBuffer{ nullptr },
+    _mainViewport{ Viewport::Empty() },
+    _mainScrollOffset{ 0 },
     _title{},
     _colorTable{},
     _defaultFg{ RGB(255, 255, 255) },
@@ -44,6 +48,7 @@ Terminal::Terminal() :
     _pfnWriteInput{ nullptr },
     _scrollOffset{ 0 },
     _snapOnInput{ true },
+    _bracketedPasteMode{ false },
     _blockSelection{ false },
     _selection{ std::nullopt }
 {
@@ -170,6 +175,13 @@ void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSetting
         return S_FALSE;
     }
 
+    // The alternate buffer has no scrollback to reflow. The main buffer is
+    // resized once we switch back to it.
+    if (_mainBuffer)
+    {
+        return _ResizeAlternateBuffer(viewportSize);
+    }
+
     const auto dx = ::base::ClampSub(viewportSize.X, oldDimensions.X);
 
     const auto oldTop = _mutableViewport.Top();
@@ -213,11 +225,15 @@ void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSetting
         oldRows.mutableViewportTop = oldViewportTop;
         oldRows.visibleViewportTop = newVisibleTop;
 
+        // Only the rows around the new viewport are copied right away. The
+        // rest of the scrollback is copied when it's scrolled to, or by
+        // ReflowPendingRows while we're idle.
         const std::optional<short> oldViewStart{ oldViewportTop };
-        RETURN_IF_FAILED(TextBuffer::Reflow(*_buffer.get(),
-                                            *newTextBuffer.get(),
-                                            _mutableViewport,
-                                            { oldRows }));
+        RETURN_IF_FAILED(TextBuffer::ReflowLazily(*_buffer.get(),
+                                                  *newTextBuffer.get(),
+                                                  gsl::narrow_cast<size_t>(viewportSize.Y) * 2,
+                                                  _mutableViewport,
+                                                  { oldRows }));
 
         newViewportTop = oldRows.mutableViewportTop;
         newVisibleTop = oldRows.visibleViewportTop;
@@ -329,6 +345,13 @@ void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSetting
 
     _buffer.swap(newTextBuffer);
 
+    // The rows that weren't reflowed yet still copy from the old buffer.
+    try
+    {
+        _buffer->KeepReflowSource(std::move(newTextBuffer));
+    }
+    CATCH_LOG();
+
     // GH#3494: Maintain scrollbar position during resize
     // Make sure that we don't scroll past the mutableViewport at the bottom of the buffer
     newVisibleTop = std::min(newVisibleTop, _mutableViewport.Top());
@@ -338,6 +361,7 @@ void Terminal::UpdateSettings(winrt::Microsoft::Terminal::Settings::ICoreSetting
     // If the old scrolloffset was 0, then we weren't scrolled back at all
     // before, and shouldn't be now either.
     _scrollOffset = originalOffsetWasZero ? 0 : ::base::ClampSub(_mutableViewport.Top(), newVisibleTop);
+    _ReflowVisibleRows();
 
     // GH#5029 - make sure to InvalidateAll here, so that we'll paint the entire visible viewport.
     try
@@ -386,6 +410,14 @@ bool Terminal::IsTrackingMouseInput() const noexcept
     return _terminalInput->IsTrackingMouseInput();
 }
 
+// Method Description:
+// - Whether the application asked for pastes to be wrapped in bracketed
+//   paste markers (DECSET 2004).
+bool Terminal::IsBracketedPasteModeEnabled() const noexcept
+{
+    return _bracketedPasteMode;
+}
+
 // Method Description:
 // - Send this particular key event to the terminal. The terminal will translate
 //   the key and the modifiers pressed into the appropriate VT sequence for that
@@ -562,6 +594,66 @@ short Terminal::GetBufferHeight() const noexcept
     return _mutableViewport.BottomExclusive();
 }
 
+// Method Description:
+// - Identifies the scrollback rows that the last resize left to reflow, so
+//   that they can be reflowed in the background with ReflowPendingRows.
+// Return Value:
+// - The generation of the rows left to reflow, or 0 if there are none.
+uint64_t Terminal::GetPendingReflowGeneration() const noexcept
+{
+    // Only the main buffer has any scrollback, even while it's hidden behind
+    // the alternate buffer.
+    return _mainBuffer ? _mainBuffer->GetPendingReflowGeneration() : _buffer->GetPendingReflowGeneration();
+}
+
+// Method Description:
+// - Reflows another batch of the scrollback rows that a resize left to
+//   reflow. The caller should hold the write lock, and call this again
+//   (preferably while idle) until it returns false.
+// Arguments:
+// - generation - the generation from GetPendingReflowGeneration. If the
+//   terminal was resized again since, there's nothing to do.
+// Return Value:
+// - true if there are still rows of that generation left to reflow.
+bool Terminal::ReflowPendingRows(const uint64_t generation) noexcept
+try
+{
+    // Small enough batches that the UI thread stays responsive.
+    constexpr size_t rowsPerBatch = 500;
+    auto& buffer = _mainBuffer ? *_mainBuffer : *_buffer;
+    return buffer.ReflowPendingRows(generation, rowsPerBatch);
+}
+catch (...)
+{
+    LOG_CAUGHT_EXCEPTION();
+    return false;
+}
+
+// Method Description:
+// - Reflows all the scrollback rows that a resize left to reflow, for readers
+//   that may look at any row, like search or copying the selection. Readers
+//   only hold the read lock, so the caller should hold the write lock.
+void Terminal::ReflowAllPendingRows() noexcept
+try
+{
+    auto& buffer = _mainBuffer ? *_mainBuffer : *_buffer;
+    buffer.ReflowAllPendingRows();
+}
+CATCH_LOG()
+
+// Method Description:
+// - Reflows the rows in the visible viewport that a resize left to reflow.
+//   The renderer reads them under the read lock, which doesn't let it copy
+//   them in itself, so this has to be called whenever the visible viewport
+//   moves, with the write lock held.
+void Terminal::_ReflowVisibleRows() noexcept
+try
+{
+    const auto visible = _GetVisibleViewport();
+    _buffer->ReflowPendingRowsAt(gsl::narrow_cast<size_t>(visible.Top()), gsl::narrow_cast<size_t>(visible.Height()));
+}
+CATCH_LOG()
+
 // ViewStartIndex is also the length of the scrollback
 int Terminal::ViewStartIndex() const noexcept
 {
@@ -671,6 +763,20 @@ void Terminal::_AdjustCursorPosition(const COORD proposedPosition)
     const Viewport bufferSize = _buffer->GetSize();
     bool notifyScroll = false;
 
+    // With scrolling margins set, a line feed past the bottom margin only
+    // scrolls the lines between the margins, and the cursor stays on the
+    // bottom margin. Nothing is pushed into the scrollback then.
+    if (_AreMarginsSet())
+    {
+        const auto [top, bottom] = _GetScrollingRegion();
+        const auto oldY = cursor.GetPosition().Y;
+        if (oldY >= top && oldY <= bottom && proposedCursorPosition.Y > bottom)
+        {
+            _ScrollRegion(top, bottom, gsl::narrow_cast<short>(bottom - proposedCursorPosition.Y));
+            proposedCursorPosition.Y = bottom;
+        }
+    }
+
     // If we're about to scroll past the bottom of the buffer, instead cycle the buffer.
     const auto newRows = proposedCursorPosition.Y - bufferSize.Height() + 1;
     if (newRows > 0)
@@ -708,6 +814,129 @@ void Terminal::_AdjustCursorPosition(const COORD proposedPosition)
     _NotifyTerminalCursorPositionChanged();
 }
 
+// Method Description:
+// - Returns true if scrolling margins are set, and still fit into the viewport.
+bool Terminal::_AreMarginsSet() const noexcept
+{
+    return _scrollMargins.Top < _scrollMargins.Bottom &&
+           _scrollMargins.Bottom < _mutableViewport.Height();
+}
+
+// Method Description:
+// - Gets the rows that line feeds, IL/DL and SU/SD scroll: the lines between
+//   the scrolling margins, or the whole viewport if there aren't any.
+// Return Value:
+// - The first and the last row of the region (inclusive), in buffer coordinates.
+std::pair<short, short> Terminal::_GetScrollingRegion() const noexcept
+{
+    const auto viewTop = _mutableViewport.Top();
+    if (_AreMarginsSet())
+    {
+        return { gsl::narrow_cast<short>(viewTop + _scrollMargins.Top),
+                 gsl::narrow_cast<short>(viewTop + _scrollMargins.Bottom) };
+    }
+    return { viewTop, _mutableViewport.BottomInclusive() };
+}
+
+// Method Description:
+// - Scrolls the rows from top to bottom (inclusive) by delta rows. The rows
+//   that scroll out of the region are lost, and the ones that scroll into it
+//   are blank. Rather than copying any text, the rows that remain are just
+//   rotated into place with TextBuffer::ScrollRows.
+// Arguments:
+// - top: the first row of the region, in buffer coordinates.
+// - bottom: the last row of the region, in buffer coordinates.
+// - delta: how far to scroll. Negative values scroll up, positive ones down.
+void Terminal::_ScrollRegion(const short top, const short bottom, const short delta)
+{
+    const auto height = gsl::narrow_cast<short>(bottom - top + 1);
+    const auto distance = std::min(gsl::narrow_cast<short>(std::abs(delta)), height);
+    if (distance <= 0)
+    {
+        return;
+    }
+
+    if (distance < height)
+    {
+        if (delta < 0)
+        {
+            _buffer->ScrollRows(gsl::narrow_cast<short>(top + distance), gsl::narrow_cast<short>(height - distance), -distance);
+        }
+        else
+        {
+            _buffer->ScrollRows(top, gsl::narrow_cast<short>(height - distance), distance);
+        }
+    }
+
+    // Whatever ended up in the rows that scrolled in is left over from the
+    // rows that scrolled out, so it needs to be erased, the same way
+    // conhost erases them.
+    const auto eraseTop = gsl::narrow_cast<short>(delta < 0 ? bottom - distance + 1 : top);
+    auto eraseAttributes = _buffer->GetCurrentAttributes();
+    eraseAttributes.SetStandardErase();
+    for (short row = eraseTop; row < eraseTop + distance; ++row)
+    {
+        _buffer->GetRowByOffset(row).Reset(eraseAttributes);
+    }
+
+    _buffer->GetRenderTarget().TriggerRedraw(Viewport::FromInclusive({ 0, top, _buffer->GetSize().RightInclusive(), bottom }));
+}
+
+// Method Description:
+// - Inserts or deletes lines at the cursor, by scrolling the rows from the
+//   cursor down to the bottom margin. Afterwards the cursor is in the first
+//   column. Nothing happens if the cursor is outside the margins.
+// Arguments:
+// - count: the number of lines to insert or delete.
+// - insert: true to insert lines (IL), false to delete them (DL).
+// Return Value:
+// - true, since there's no way for this to fail other than by throwing.
+bool Terminal::_ModifyLines(const size_t count, const bool insert)
+{
+    auto& cursor = _buffer->GetCursor();
+    const auto cursorPos = cursor.GetPosition();
+    const auto [top, bottom] = _GetScrollingRegion();
+    if (cursorPos.Y < top || cursorPos.Y > bottom)
+    {
+        return true;
+    }
+
+    const auto distance = gsl::narrow_cast<short>(std::min<size_t>(count, gsl::narrow_cast<size_t>(bottom - cursorPos.Y + 1)));
+    _ScrollRegion(cursorPos.Y, bottom, insert ? distance : -distance);
+
+    cursor.SetPosition({ 0, cursorPos.Y });
+    _NotifyTerminalCursorPositionChanged();
+    return true;
+}
+
+// Method Description:
+// - Resizes the alternate buffer. It has no scrollback, so unlike the main
+//   buffer it isn't reflowed, but just cut off or padded at the right and the
+//   bottom. If the cursor would end up below the new viewport, the top rows
+//   are cut off instead, so that the cursor stays on its line.
+// Arguments:
+// - viewportSize: the new size of the viewport, in chars
+// Return Value:
+// - S_OK if we successfully resized the buffer, or an appropriate HRESULT
+[[nodiscard]] HRESULT Terminal::_ResizeAlternateBuffer(const COORD viewportSize) noexcept
+try
+{
+    RETURN_IF_FAILED(_buffer->ResizeTraditional(viewportSize));
+
+    _mutableViewport = Viewport::FromDimensions({ 0, 0 }, viewportSize);
+    _scrollOffset = 0;
+
+    auto& cursor = _buffer->GetCursor();
+    auto cursorPos = cursor.GetPosition();
+    _mutableViewport.Clamp(cursorPos);
+    cursor.SetPosition(cursorPos);
+
+    _buffer->GetRenderTarget().TriggerRedrawAll();
+    _NotifyScrollEvent();
+    return S_OK;
+}
+CATCH_RETURN()
+
 void Terminal::UserScrollViewport(const int viewTop)
 {
     const auto clampedNewTop = std::max(0, viewTop);
@@ -716,6 +945,7 @@ void Terminal::UserScrollViewport(const int viewTop)
     // if viewTop > realTop, we want the offset to be 0.
 
     _scrollOffset = std::max(0, newDelta);
+    _ReflowVisibleRows();
     _buffer->GetRenderTarget().TriggerRedrawAll();
 }
 
@@ -69,6 +69,10 @@ public:
 
     short GetBufferHeight() const noexcept;
 
+    uint64_t GetPendingReflowGeneration() const noexcept;
+    bool ReflowPendingRows(const uint64_t generation) noexcept;
+    void ReflowAllPendingRows() noexcept;
+
     int ViewStartIndex() const noexcept;
     int ViewEndIndex() const noexcept;
 
@@ -88,11 +92,26 @@ public:
     bool SetCursorVisibility(const bool visible) noexcept override;
     bool EnableCursorBlinking(const bool enable) noexcept override;
     bool CursorLineFeed(const bool withReturn) noexcept override;
+    bool CursorReverseLineFeed() noexcept override;
     bool DeleteCharacter(const size_t count) noexcept override;
     bool InsertCharacter(const size_t count) noexcept override;
     bool EraseCharacters(const size_t numChars) noexcept override;
     bool EraseInLine(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::EraseType eraseType) noexcept override;
     bool EraseInDisplay(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::EraseType eraseType) noexcept override;
+    bool SetScrollingMargins(const size_t topMargin, const size_t bottomMargin) noexcept override;
+    bool InsertLines(const size_t count) noexcept override;
+    bool DeleteLines(const size_t count) noexcept override;
+    bool ScrollUp(const size_t distance) noexcept override;
+    bool ScrollDown(const size_t distance) noexcept override;
+    bool CopyRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea source,
+                             const size_t targetTop,
+                             const size_t targetLeft) noexcept override;
+    bool FillRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea area,
+                             const wchar_t fillChar,
+                             const bool keepAttributes) noexcept override;
+    bool EraseRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea area) noexcept override;
+    bool UseAlternateScreenBuffer() noexcept override;
+    bool UseMainScreenBuffer() noexcept override;
     bool SetWindowTitle(std::wstring_view title) noexcept override;
     bool SetColorTableEntry(const size_t tableIndex, const COLORREF color) noexcept override;
     bool SetCursorStyle(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::CursorStyle cursorStyle) noexcept override;
@@ -107,6 +126,8 @@ public:
     bool EnableButtonEventMouseMode(const bool enabled) noexcept override;
     bool EnableAnyEventMouseMode(const bool enabled) noexcept override;
     bool EnableAlternateScrollMode(const bool enabled) noexcept override;
+    bool EnableBracketedPasteMode(const bool enabled) noexcept override;
+    bool EnableSynchronizedOutput(const bool enabled) noexcept override;
 
     bool IsVtInputEnabled() const noexcept override;
 #pragma endregion
@@ -123,6 +144,7 @@ public:
 
     void TrySnapOnInput() override;
     bool IsTrackingMouseInput() const noexcept;
+    bool IsBracketedPasteModeEnabled() const noexcept;
 #pragma endregion
 
 #pragma region IBaseData(base to IRenderData and IUiaData)
@@ -209,6 +231,7 @@ private:
 
     bool _snapOnInput;
     bool _suppressApplicationTitle;
+    bool _bracketedPasteMode;
 
 #pragma region Text Selection
     // a selection is represented as a range between two COORDs (start and end)
@@ -235,6 +258,16 @@ private:
     Microsoft::Console::Types::Viewport _mutableViewport;
     SHORT _scrollbackLines;
 
+    // The top and bottom scrolling margins (DECSTBM), as rows relative to the
+    // top of the viewport. They're not set while Top and Bottom are both 0.
+    SMALL_RECT _scrollMargins;
+
+    // While the alternate screen buffer is active, _buffer is the alternate
+    // buffer and these hold on to the main buffer and its state.
+    std::unique_ptr<TextBuffer> _mainBuffer;
+    Microsoft::Console::Types::Viewport _mainViewport;
+    int _mainScrollOffset;
+
     // _scrollOffset is the number of lines above the viewport that are currently visible
     // If _scrollOffset is 0, then the visible region of the buffer is the viewport.
     int _scrollOffset;
@@ -266,6 +299,15 @@ private:
 
     void _AdjustCursorPosition(const COORD proposedPosition);
 
+    bool _AreMarginsSet() const noexcept;
+    std::pair<short, short> _GetScrollingRegion() const noexcept;
+    void _ScrollRegion(const short top, const short bottom, const short delta);
+    bool _ModifyLines(const size_t count, const bool insert);
+    bool _GetRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea area,
+                             Microsoft::Console::Types::Viewport& rect) const noexcept;
+    [[nodiscard]] HRESULT _ResizeAlternateBuffer(const COORD viewportSize) noexcept;
+    void _ReflowVisibleRows() noexcept;
+
     void _NotifyScrollEvent() noexcept;
 
     void _NotifyTerminalCursorPositionChanged() noexcept;
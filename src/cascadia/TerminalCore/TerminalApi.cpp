@@ -158,6 +158,34 @@ try
 }
 CATCH_LOG_RETURN_FALSE()
 
+// Method Description:
+// - Moves the cursor up one line (RI). At the top of the scrolling region,
+//   the region scrolls down instead, and a blank line appears at its top.
+// Arguments:
+// - <none>
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::CursorReverseLineFeed() noexcept
+try
+{
+    auto& cursor = _buffer->GetCursor();
+    const auto cursorPos = cursor.GetPosition();
+    const auto [top, bottom] = _GetScrollingRegion();
+
+    if (cursorPos.Y == top)
+    {
+        _ScrollRegion(top, bottom, 1);
+    }
+    else if (cursorPos.Y > _mutableViewport.Top())
+    {
+        cursor.SetPosition({ cursorPos.X, gsl::narrow_cast<short>(cursorPos.Y - 1) });
+        _NotifyTerminalCursorPositionChanged();
+    }
+
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
 // Method Description:
 // - deletes count characters starting from the cursor's current position
 // - it moves over the remaining text to 'replace' the deleted text
@@ -405,6 +433,302 @@ try
 }
 CATCH_LOG_RETURN_FALSE()
 
+// Method Description:
+// - Sets the top and bottom scrolling margins (DECSTBM). Line feeds at the
+//   bottom margin then only scroll the lines between the margins.
+// Arguments:
+// - topMargin: the 1-based line of the top margin, or 0 for the first line.
+// - bottomMargin: the 1-based line of the bottom margin, or 0 for the last line.
+// Return value:
+// - true if the margins were valid, false otherwise
+bool Terminal::SetScrollingMargins(const size_t topMargin, const size_t bottomMargin) noexcept
+{
+    const auto screenHeight = gsl::narrow_cast<size_t>(_mutableViewport.Height());
+    const auto actualTop = topMargin == 0 ? 1 : topMargin;
+    const auto actualBottom = bottomMargin == 0 ? screenHeight : bottomMargin;
+
+    // Margins that span the whole viewport are the same as no margins at all.
+    if (actualTop == 1 && actualBottom >= screenHeight)
+    {
+        _scrollMargins = {};
+        return true;
+    }
+
+    if (actualTop >= actualBottom || actualBottom > screenHeight)
+    {
+        return false;
+    }
+
+    _scrollMargins.Top = gsl::narrow_cast<short>(actualTop - 1);
+    _scrollMargins.Bottom = gsl::narrow_cast<short>(actualBottom - 1);
+    return true;
+}
+
+// Method Description:
+// - Inserts count blank lines at the cursor (IL). The lines below it move
+//   down, and the ones pushed past the bottom margin are lost.
+// Arguments:
+// - count, the number of lines to insert
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::InsertLines(const size_t count) noexcept
+try
+{
+    return _ModifyLines(count, true);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - Deletes count lines at the cursor (DL). The lines below it move up, and
+//   blank lines appear at the bottom margin.
+// Arguments:
+// - count, the number of lines to delete
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::DeleteLines(const size_t count) noexcept
+try
+{
+    return _ModifyLines(count, false);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - Scrolls the contents of the scrolling region up (SU), without moving the
+//   cursor. Unlike a line feed, nothing is pushed into the scrollback.
+// Arguments:
+// - distance, the number of lines to scroll
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::ScrollUp(const size_t distance) noexcept
+try
+{
+    const auto [top, bottom] = _GetScrollingRegion();
+    const auto clampedDistance = std::min<size_t>(distance, gsl::narrow_cast<size_t>(bottom - top + 1));
+    _ScrollRegion(top, bottom, -gsl::narrow_cast<short>(clampedDistance));
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - Scrolls the contents of the scrolling region down (SD), without moving
+//   the cursor.
+// Arguments:
+// - distance, the number of lines to scroll
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::ScrollDown(const size_t distance) noexcept
+try
+{
+    const auto [top, bottom] = _GetScrollingRegion();
+    const auto clampedDistance = std::min<size_t>(distance, gsl::narrow_cast<size_t>(bottom - top + 1));
+    _ScrollRegion(top, bottom, gsl::narrow_cast<short>(clampedDistance));
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - Converts the area of a rectangular area operation into a rectangle in the
+//   buffer. The page is the mutable viewport, and coordinates past its edges
+//   are treated as its edges. A bottom or right of 0 is the last line or
+//   column.
+// Arguments:
+// - area, the area in page coordinates
+// - rect, receives the rectangle in the buffer
+// Return value:
+// - true if the area contains any cells, false otherwise
+bool Terminal::_GetRectangularArea(const DispatchTypes::RectangularArea area, Viewport& rect) const noexcept
+{
+    const auto page = _GetMutableViewport();
+
+    const auto toPage = [](const size_t position, const short first, const short count) noexcept {
+        const auto clamped = position == 0 ? count : std::min<size_t>(position, count);
+        return gsl::narrow_cast<short>(first + clamped - 1);
+    };
+
+    const auto top = toPage(std::max<size_t>(area.top, 1), page.Top(), page.Height());
+    const auto left = toPage(std::max<size_t>(area.left, 1), page.Left(), page.Width());
+    const auto bottom = toPage(area.bottom, page.Top(), page.Height());
+    const auto right = toPage(area.right, page.Left(), page.Width());
+    if (top > bottom || left > right)
+    {
+        return false;
+    }
+
+    rect = Viewport::FromInclusive({ left, top, right, bottom });
+    return true;
+}
+
+// Method Description:
+// - Copies a rectangular area of the page to another position on it (DECCRA).
+//   The parts of the copy that wouldn't fit on the page are cut off.
+// Arguments:
+// - source, the area to copy
+// - targetTop, the line to copy the top of the area to
+// - targetLeft, the column to copy the left of the area to
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::CopyRectangularArea(const DispatchTypes::RectangularArea source,
+                                   const size_t targetTop,
+                                   const size_t targetLeft) noexcept
+try
+{
+    Viewport sourceRect;
+    if (_GetRectangularArea(source, sourceRect))
+    {
+        const auto top = std::max<size_t>(targetTop, 1);
+        const auto left = std::max<size_t>(targetLeft, 1);
+        const DispatchTypes::RectangularArea target{ top, left, top + sourceRect.Height() - 1, left + sourceRect.Width() - 1 };
+
+        Viewport targetRect;
+        if (_GetRectangularArea(target, targetRect))
+        {
+            const auto clippedSource = Viewport::FromDimensions(sourceRect.Origin(), targetRect.Dimensions());
+            _buffer->CopyRectangle(clippedSource, targetRect.Origin());
+        }
+    }
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - Fills a rectangular area of the page with the given character (DECFRA,
+//   DECERA and DECSERA).
+// Arguments:
+// - area, the area to fill
+// - fillChar, the character to fill the area with
+// - keepAttributes, if true the cells keep their attributes. Otherwise they
+//   get the current attributes.
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::FillRectangularArea(const DispatchTypes::RectangularArea area,
+                                   const wchar_t fillChar,
+                                   const bool keepAttributes) noexcept
+try
+{
+    Viewport rect;
+    if (_GetRectangularArea(area, rect))
+    {
+        std::optional<TextAttribute> fillAttributes;
+        if (!keepAttributes)
+        {
+            fillAttributes = _buffer->GetCurrentAttributes();
+        }
+        _buffer->FillRectangle(rect, fillChar, fillAttributes);
+    }
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - Erases a rectangular area of the page (DECERA), by filling it with spaces
+//   in the current attributes, less their meta and extended attributes. That's
+//   the same standard erase that conhost uses.
+// Arguments:
+// - area, the area to erase
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::EraseRectangularArea(const DispatchTypes::RectangularArea area) noexcept
+try
+{
+    Viewport rect;
+    if (_GetRectangularArea(area, rect))
+    {
+        auto eraseAttributes = _buffer->GetCurrentAttributes();
+        eraseAttributes.SetStandardErase();
+        _buffer->FillRectangle(rect, UNICODE_SPACE, eraseAttributes);
+    }
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - Switches to a new, blank alternate screen buffer the size of the
+//   viewport. The alternate buffer has no scrollback. The main buffer is
+//   kept as it is, and comes back with UseMainScreenBuffer.
+// - Like in conhost, the scrolling margins are reset.
+// Arguments:
+// - <none>
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::UseAlternateScreenBuffer() noexcept
+try
+{
+    const auto viewportSize = _mutableViewport.Dimensions();
+    const auto& oldCursor = _buffer->GetCursor();
+    auto altBuffer = std::make_unique<TextBuffer>(viewportSize,
+                                                  _buffer->GetCurrentAttributes(),
+                                                  oldCursor.GetSize(),
+                                                  _buffer->GetRenderTarget());
+
+    // The cursor keeps its style, but starts out at the top left like it
+    // does in conhost's alternate buffer.
+    auto& newCursor = altBuffer->GetCursor();
+    newCursor.SetStyle(oldCursor.GetSize(), oldCursor.GetColor(), oldCursor.GetType());
+    newCursor.SetIsVisible(oldCursor.IsVisible());
+    newCursor.SetBlinkingAllowed(oldCursor.IsBlinkingAllowed());
+
+    // Switching again while we're already in the alternate buffer just
+    // starts over with a blank one.
+    if (!_mainBuffer)
+    {
+        _mainBuffer = std::move(_buffer);
+        _mainViewport = _mutableViewport;
+        _mainScrollOffset = _scrollOffset;
+    }
+    _buffer = std::move(altBuffer);
+    _mutableViewport = Viewport::FromDimensions({ 0, 0 }, viewportSize);
+    _scrollOffset = 0;
+    _scrollMargins = {};
+    ClearSelection();
+
+    _terminalInput->UseAlternateScreenBuffer();
+    _buffer->GetRenderTarget().TriggerRedrawAll();
+    _NotifyScrollEvent();
+    _NotifyTerminalCursorPositionChanged();
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - Switches back from the alternate screen buffer to the main one, and
+//   throws the contents of the alternate buffer away. Like in conhost, the
+//   scrolling margins are reset.
+// Arguments:
+// - <none>
+// Return value:
+// - true if succeeded, false otherwise
+bool Terminal::UseMainScreenBuffer() noexcept
+try
+{
+    if (!_mainBuffer)
+    {
+        return true;
+    }
+
+    const auto altViewportSize = _mutableViewport.Dimensions();
+    _buffer = std::move(_mainBuffer);
+    _mutableViewport = _mainViewport;
+    _scrollOffset = _mainScrollOffset;
+    _scrollMargins = {};
+    ClearSelection();
+
+    // If we were resized in the meantime, the main buffer catches up now.
+    // Nothing reflows the rest of its scrollback in the background after a
+    // resize like this one, so we do it right away.
+    if (altViewportSize != _mutableViewport.Dimensions())
+    {
+        LOG_IF_FAILED(UserResize(altViewportSize));
+        _buffer->ReflowAllPendingRows();
+    }
+
+    _terminalInput->UseMainScreenBuffer();
+    _buffer->GetRenderTarget().TriggerRedrawAll();
+    _NotifyScrollEvent();
+    _NotifyTerminalCursorPositionChanged();
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
 bool Terminal::SetWindowTitle(std::wstring_view title) noexcept
 try
 {
@@ -568,6 +892,20 @@ bool Terminal::EnableAlternateScrollMode(const bool enabled) noexcept
     return true;
 }
 
+bool Terminal::EnableBracketedPasteMode(const bool enabled) noexcept
+{
+    _bracketedPasteMode = enabled;
+    return true;
+}
+
+bool Terminal::EnableSynchronizedOutput(const bool enabled) noexcept
+try
+{
+    _buffer->GetRenderTarget().SetSynchronizedOutput(enabled);
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
 bool Terminal::IsVtInputEnabled() const noexcept
 {
     // We should never be getting this call in Terminal.
@@ -102,6 +102,20 @@ try
 }
 CATCH_LOG_RETURN_FALSE()
 
+// Method Description:
+// - Moves the cursor up one line. If it's on the top margin, the text within
+//   the margins scrolls down instead.
+// Arguments:
+// - <none>
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::ReverseLineFeed() noexcept
+try
+{
+    return _terminalApi.CursorReverseLineFeed();
+}
+CATCH_LOG_RETURN_FALSE()
+
 bool TerminalDispatch::EraseCharacters(const size_t numChars) noexcept
 try
 {
@@ -224,6 +238,167 @@ try
 }
 CATCH_LOG_RETURN_FALSE()
 
+// Method Description:
+// - DECSTBM - Sets the top and bottom scrolling margins, and moves the cursor
+//   home. Only the text between the margins scrolls when the cursor moves
+//   past them.
+// Arguments:
+// - topMargin: the line number of the top margin, or 0 for the first line.
+// - bottomMargin: the line number of the bottom margin, or 0 for the last line.
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::SetTopBottomScrollingMargins(const size_t topMargin,
+                                                    const size_t bottomMargin) noexcept
+try
+{
+    return _terminalApi.SetScrollingMargins(topMargin, bottomMargin) && CursorPosition(1, 1);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - IL - Inserts blank lines at the cursor, moving the lines below it down
+//   within the scrolling margins.
+// Arguments:
+// - distance: the number of lines to insert
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::InsertLine(const size_t distance) noexcept
+try
+{
+    return _terminalApi.InsertLines(distance);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - DL - Deletes lines starting at the cursor, moving the lines below it up
+//   within the scrolling margins.
+// Arguments:
+// - distance: the number of lines to delete
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::DeleteLine(const size_t distance) noexcept
+try
+{
+    return _terminalApi.DeleteLines(distance);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - SU - Scrolls the text within the scrolling margins up.
+// Arguments:
+// - distance: the number of lines to scroll
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::ScrollUp(const size_t distance) noexcept
+try
+{
+    return _terminalApi.ScrollUp(distance);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - SD - Scrolls the text within the scrolling margins down.
+// Arguments:
+// - distance: the number of lines to scroll
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::ScrollDown(const size_t distance) noexcept
+try
+{
+    return _terminalApi.ScrollDown(distance);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - DECCRA - Copies a rectangular area of the page to another position on it.
+// Arguments:
+// - source: the area to copy
+// - targetTop: the line to copy the top of the area to
+// - targetLeft: the column to copy the left of the area to
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::CopyRectangularArea(const DispatchTypes::RectangularArea source,
+                                           const size_t targetTop,
+                                           const size_t targetLeft) noexcept
+try
+{
+    return _terminalApi.CopyRectangularArea(source, targetTop, targetLeft);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - DECFRA - Fills a rectangular area of the page with the given character,
+//   in the current attributes.
+// Arguments:
+// - fillChar: the character to fill the area with
+// - area: the area to fill
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::FillRectangularArea(const wchar_t fillChar,
+                                           const DispatchTypes::RectangularArea area) noexcept
+try
+{
+    return _terminalApi.FillRectangularArea(area, fillChar, false);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - DECERA - Erases a rectangular area of the page with spaces in the
+//   standard erase attributes, like conhost does.
+// Arguments:
+// - area: the area to erase
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::EraseRectangularArea(const DispatchTypes::RectangularArea area) noexcept
+try
+{
+    return _terminalApi.EraseRectangularArea(area);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - DECSERA - Erases the characters in a rectangular area of the page,
+//   leaving their attributes alone. Nothing can be protected from it, since
+//   DECSCA isn't supported.
+// Arguments:
+// - area: the area to erase
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::SelectiveEraseRectangularArea(const DispatchTypes::RectangularArea area) noexcept
+try
+{
+    return _terminalApi.FillRectangularArea(area, L' ', true);
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - ASBSET - Switches to a new, empty alternate screen buffer. The main
+//   buffer and its cursor are kept as they are until ASBRST.
+// Arguments:
+// - <none>
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::UseAlternateScreenBuffer() noexcept
+try
+{
+    return _terminalApi.UseAlternateScreenBuffer();
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Method Description:
+// - ASBRST - Switches back to the main screen buffer, and discards the
+//   alternate one. Does nothing if the main buffer is already active.
+// Arguments:
+// - <none>
+// Return Value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::UseMainScreenBuffer() noexcept
+try
+{
+    return _terminalApi.UseMainScreenBuffer();
+}
+CATCH_LOG_RETURN_FALSE()
+
 // - DECKPAM, DECKPNM - Sets the keypad input mode to either Application mode or Numeric mode (true, false respectively)
 // Arguments:
 // - applicationMode - set to true to enable Application Mode Input, false for Numeric Mode Input.
@@ -322,6 +497,31 @@ bool TerminalDispatch::EnableAlternateScroll(const bool enabled) noexcept
     return true;
 }
 
+//Routine Description:
+// Enable Bracketed Paste Mode - Wraps pasted text in ESC[200~ and ESC[201~,
+//      so that the application can tell it from typed text.
+//Arguments:
+// - enabled - true to enable, false to disable.
+// Return value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::EnableBracketedPasteMode(const bool enabled) noexcept
+{
+    _terminalApi.EnableBracketedPasteMode(enabled);
+    return true;
+}
+
+//Routine Description:
+// Enable Synchronized Output - Holds back painting until the application is
+//      done redrawing, and then presents all of it as a single frame.
+//Arguments:
+// - enabled - true to begin a synchronized update, false to end it.
+// Return value:
+// True if handled successfully. False otherwise.
+bool TerminalDispatch::EnableSynchronizedOutput(const bool enabled) noexcept
+{
+    return _terminalApi.EnableSynchronizedOutput(enabled);
+}
+
 bool TerminalDispatch::SetPrivateModes(const std::basic_string_view<DispatchTypes::PrivateModeParams> params) noexcept
 {
     return _SetResetPrivateModes(params, true);
@@ -394,6 +594,15 @@ bool TerminalDispatch::_PrivateModeParamsHelper(const DispatchTypes::PrivateMode
     case DispatchTypes::PrivateModeParams::ATT610_StartCursorBlink:
         success = EnableCursorBlinking(enable);
         break;
+    case DispatchTypes::PrivateModeParams::ASB_AlternateScreenBuffer:
+        success = enable ? UseAlternateScreenBuffer() : UseMainScreenBuffer();
+        break;
+    case DispatchTypes::PrivateModeParams::BRACKETED_PASTE_MODE:
+        success = EnableBracketedPasteMode(enable);
+        break;
+    case DispatchTypes::PrivateModeParams::SYNCHRONIZED_OUTPUT:
+        success = EnableSynchronizedOutput(enable);
+        break;
     default:
         // If no functions to call, overall dispatch was a failure.
         success = false;
@@ -431,11 +640,11 @@ bool TerminalDispatch::SoftReset() noexcept
     {
         success = SetKeypadMode(false); // Numeric characters.
     }
-    // if (success)
-    // {
-    //     // Top margin = 1; bottom margin = page length.
-    //     success = _DoSetTopBottomScrollingMargins(0, 0);
-    // }
+    if (success)
+    {
+        // Top margin = 1; bottom margin = page length.
+        success = _terminalApi.SetScrollingMargins(0, 0);
+    }
     // if (success)
     // {
     //     success = DesignateCharset(DispatchTypes::VTCharacterSets::USASCII); // Default Charset
@@ -468,9 +677,16 @@ bool TerminalDispatch::HardReset() noexcept
     // This code is left here (from its original form in conhost) as a reminder
     // of what needs to be done.
 
+    // If in the alt buffer, switch back to main before doing anything else.
+    bool success = UseMainScreenBuffer();
+
     // Sets the SGR state to normal - this must be done before EraseInDisplay
     //      to ensure that it clears with the default background color.
-    bool success = SoftReset();
+    //      This also clears the scrolling margins.
+    if (success)
+    {
+        success = SoftReset();
+    }
 
     // Clears the screen - Needs to be done in two operations.
     if (success)
@@ -26,6 +26,7 @@ public:
     bool CursorUp(const size_t distance) noexcept override;
 
     bool LineFeed(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::LineFeedType lineFeedType) noexcept override;
+    bool ReverseLineFeed() noexcept override; // RI
 
     bool EraseCharacters(const size_t numChars) noexcept override;
     bool CarriageReturn() noexcept override;
@@ -41,6 +42,23 @@ public:
     bool InsertCharacter(const size_t count) noexcept override;
     bool EraseInDisplay(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::EraseType eraseType) noexcept override;
 
+    bool SetTopBottomScrollingMargins(const size_t topMargin, const size_t bottomMargin) noexcept override; // DECSTBM
+    bool InsertLine(const size_t distance) noexcept override; // IL
+    bool DeleteLine(const size_t distance) noexcept override; // DL
+    bool ScrollUp(const size_t distance) noexcept override; // SU
+    bool ScrollDown(const size_t distance) noexcept override; // SD
+
+    bool CopyRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea source,
+                             const size_t targetTop,
+                             const size_t targetLeft) noexcept override; // DECCRA
+    bool FillRectangularArea(const wchar_t fillChar,
+                             const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea area) noexcept override; // DECFRA
+    bool EraseRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea area) noexcept override; // DECERA
+    bool SelectiveEraseRectangularArea(const ::Microsoft::Console::VirtualTerminal::DispatchTypes::RectangularArea area) noexcept override; // DECSERA
+
+    bool UseAlternateScreenBuffer() noexcept override; // ASBSET
+    bool UseMainScreenBuffer() noexcept override; // ASBRST
+
     bool SetCursorKeysMode(const bool applicationMode) noexcept override; // DECCKM
     bool SetKeypadMode(const bool applicationMode) noexcept override; // DECKPAM, DECKPNM
 
@@ -53,6 +71,8 @@ public:
     bool EnableButtonEventMouseMode(const bool enabled) noexcept override; // ?1002
     bool EnableAnyEventMouseMode(const bool enabled) noexcept override; // ?1003
     bool EnableAlternateScroll(const bool enabled) noexcept override; // ?1007
+    bool EnableBracketedPasteMode(const bool enabled) noexcept override; // ?2004
+    bool EnableSynchronizedOutput(const bool enabled) noexcept override; // ?2026
 
     bool SetPrivateModes(const std::basic_string_view<::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams> /*params*/) noexcept override; // DECSET
     bool ResetPrivateModes(const std::basic_string_view<::Microsoft::Console::VirtualTerminal::DispatchTypes::PrivateModeParams> /*params*/) noexcept override; // DECRST
@@ -165,6 +165,7 @@ void Terminal::SelectNewRegion(const COORD coordStart, const COORD coordEnd)
 
     if (notifyScrollChange)
     {
+        _ReflowVisibleRows();
         _buffer->GetRenderTarget().TriggerRedrawAll();
         _NotifyScrollEvent();
     }
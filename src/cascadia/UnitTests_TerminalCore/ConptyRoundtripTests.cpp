@@ -176,9 +176,14 @@ class TerminalCoreUnitTests::ConptyRoundtripTests final
 
     TEST_METHOD(ScrollWithMargins);
 
+    TEST_METHOD(TestNativeScrollMarginsMatchHost);
+    TEST_METHOD(TestNativeAltBufferMatchesHost);
+    TEST_METHOD(TestNativeAltBufferResetsMargins);
+
 private:
     bool _writeCallback(const char* const pch, size_t const cch);
     void _flushFirstFrame();
+    void _verifySameText(const SCREEN_INFORMATION& hostSi, Terminal& nativeTerm);
     void _resizeConpty(const unsigned short sx, const unsigned short sy);
     std::deque<std::string> expectedOutput;
     std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
@@ -238,6 +243,31 @@ void ConptyRoundtripTests::_flushFirstFrame()
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 }
 
+// Method Description:
+// - Verifies that the viewport of the host and the viewport of a Terminal
+//   hold the same text, and that their cursors are in the same place.
+// Arguments:
+// - hostSi: the host's active screen buffer.
+// - nativeTerm: a Terminal that was fed the same VT as the host.
+void ConptyRoundtripTests::_verifySameText(const SCREEN_INFORMATION& hostSi, Terminal& nativeTerm)
+{
+    const auto& hostTb = hostSi.GetTextBuffer();
+    const auto hostView = hostSi.GetViewport();
+    const auto termView = nativeTerm._mutableViewport;
+    VERIFY_ARE_EQUAL(hostView.Dimensions(), termView.Dimensions());
+
+    for (short y = 0; y < hostView.Height(); ++y)
+    {
+        const auto hostText = hostTb.GetRowByOffset(hostView.Top() + y).GetText();
+        const auto termText = nativeTerm._buffer->GetRowByOffset(termView.Top() + y).GetText();
+        VERIFY_ARE_EQUAL(hostText, termText, NoThrowString().Format(L"Row %d", y));
+    }
+
+    auto hostCursor = hostTb.GetCursor().GetPosition();
+    hostView.ConvertToOrigin(&hostCursor);
+    VERIFY_ARE_EQUAL(hostCursor, nativeTerm.GetCursorPosition());
+}
+
 void ConptyRoundtripTests::_resizeConpty(const unsigned short sx,
                                          const unsigned short sy)
 {
@@ -834,6 +864,10 @@ void ConptyRoundtripTests::TestResizeHeight()
     VERIFY_SUCCEEDED(resizeResult);
     _resizeConpty(newViewportSize.X, newViewportSize.Y);
 
+    // We're about to read the whole scrollback, so reflow the rows that the
+    // resize left to reflow, like TermControl does before a search.
+    term->ReflowAllPendingRows();
+
     // After we resize, make sure to get the new textBuffers
     hostTb = &si.GetTextBuffer();
     termTb = term->_buffer.get();
@@ -1302,3 +1336,155 @@ void ConptyRoundtripTests::ScrollWithMargins()
     // Verify the terminal side.
     verifyBufferAfter(termTb);
 }
+
+void ConptyRoundtripTests::TestNativeScrollMarginsMatchHost()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Feed scroll margins, line feeds, IL/DL and SU/SD to the host and "
+        L"straight to a Terminal, and make sure both end up with the same text."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& hostSm = si.GetStateMachine();
+
+    // Anything the host repaints goes to `term`, so the Terminal we compare
+    // against has to be one of its own. Nothing gets painted in this test.
+    _checkConptyOutput = false;
+    Terminal nativeTerm;
+    nativeTerm.Create({ TerminalViewWidth, TerminalViewHeight }, 100, emptyRT);
+
+    auto writeBoth = [&](const std::wstring_view str) {
+        hostSm.ProcessString(str);
+        nativeTerm.Write(str);
+    };
+
+    Log::Comment(L"Label every row of the screen with its number.");
+    for (auto i = 0; i < TerminalViewHeight; ++i)
+    {
+        std::wstringstream wss;
+        wss << L"\x1b[" << i + 1 << L";1HRow " << i;
+        writeBoth(wss.str());
+    }
+    _verifySameText(si, nativeTerm);
+
+    Log::Comment(L"Set the margins to rows 5-20. This also moves the cursor home.");
+    writeBoth(L"\x1b[5;20r");
+    _verifySameText(si, nativeTerm);
+
+    Log::Comment(L"Line feeds at the bottom margin scroll only the rows between the margins.");
+    writeBoth(L"\x1b[20;3H\n\n");
+    _verifySameText(si, nativeTerm);
+
+    Log::Comment(L"A reverse line feed at the top margin scrolls them back down.");
+    writeBoth(L"\x1b[5;3H\x1bM");
+    _verifySameText(si, nativeTerm);
+
+    Log::Comment(L"Insert and delete lines within the margins.");
+    writeBoth(L"\x1b[10;4H\x1b[3L");
+    _verifySameText(si, nativeTerm);
+    writeBoth(L"\x1b[12;4H\x1b[2M");
+    _verifySameText(si, nativeTerm);
+
+    Log::Comment(L"IL/DL outside of the margins do nothing.");
+    writeBoth(L"\x1b[25;4H\x1b[3L\x1b[2;4H\x1b[2M");
+    _verifySameText(si, nativeTerm);
+
+    Log::Comment(L"Scroll the margins up and down.");
+    writeBoth(L"\x1b[4S");
+    _verifySameText(si, nativeTerm);
+    writeBoth(L"\x1b[2T");
+    _verifySameText(si, nativeTerm);
+
+    Log::Comment(L"Scrolling further than the margins are tall blanks them out.");
+    writeBoth(L"\x1b[100S");
+    _verifySameText(si, nativeTerm);
+
+    Log::Comment(L"Without margins, SU and SD scroll the whole viewport.");
+    writeBoth(L"\x1b[r\x1b[3T");
+    _verifySameText(si, nativeTerm);
+}
+
+void ConptyRoundtripTests::TestNativeAltBufferMatchesHost()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Switch the host and a Terminal to the alternate buffer and back, "
+        L"and make sure both end up with the same text."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& hostSm = gci.GetActiveOutputBuffer().GetStateMachine();
+
+    // See TestNativeScrollMarginsMatchHost.
+    _checkConptyOutput = false;
+    Terminal nativeTerm;
+    nativeTerm.Create({ TerminalViewWidth, TerminalViewHeight }, 100, emptyRT);
+
+    auto writeBoth = [&](const std::wstring_view str) {
+        hostSm.ProcessString(str);
+        nativeTerm.Write(str);
+    };
+
+    writeBoth(L"Main buffer\r\nSecond line\x1b[2;4H");
+    _verifySameText(gci.GetActiveOutputBuffer(), nativeTerm);
+
+    Log::Comment(L"The alternate buffer starts out blank, with the cursor at the top left.");
+    writeBoth(L"\x1b[?1049h");
+    VERIFY_IS_NOT_NULL(nativeTerm._mainBuffer.get());
+    _verifySameText(gci.GetActiveOutputBuffer(), nativeTerm);
+
+    writeBoth(L"\x1b[3;5HAlternate\x1b[5;10r\x1b[10;1H\n\x1b[2L\x1b[r");
+    _verifySameText(gci.GetActiveOutputBuffer(), nativeTerm);
+
+    Log::Comment(L"Switching back brings the main buffer back as it was.");
+    writeBoth(L"\x1b[?1049l");
+    VERIFY_IS_NULL(nativeTerm._mainBuffer.get());
+    _verifySameText(gci.GetActiveOutputBuffer(), nativeTerm);
+    VERIFY_IS_FALSE(gci.GetActiveOutputBuffer()._IsAltBuffer());
+}
+
+void ConptyRoundtripTests::TestNativeAltBufferResetsMargins()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Switch the host and a Terminal between the buffers with scroll "
+        L"margins set, and make sure both reset them."));
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& hostSm = gci.GetActiveOutputBuffer().GetStateMachine();
+
+    // See TestNativeScrollMarginsMatchHost.
+    _checkConptyOutput = false;
+    Terminal nativeTerm;
+    nativeTerm.Create({ TerminalViewWidth, TerminalViewHeight }, 100, emptyRT);
+
+    auto writeBoth = [&](const std::wstring_view str) {
+        hostSm.ProcessString(str);
+        nativeTerm.Write(str);
+    };
+
+    Log::Comment(L"Label every row of the screen with its number.");
+    for (auto i = 0; i < TerminalViewHeight; ++i)
+    {
+        std::wstringstream wss;
+        wss << L"\x1b[" << i + 1 << L";1HRow " << i;
+        writeBoth(wss.str());
+    }
+
+    Log::Comment(L"Margins set in the main buffer don't apply in the alternate buffer.");
+    writeBoth(L"\x1b[5;20r\x1b[?1049h");
+    VERIFY_IS_FALSE(nativeTerm._AreMarginsSet());
+    writeBoth(L"Alternate\r\nBuffer\x1b[1;1H\x1b[1L");
+    _verifySameText(gci.GetActiveOutputBuffer(), nativeTerm);
+
+    Log::Comment(L"Leave the alternate buffer with margins set. They don't apply to the main buffer either.");
+    writeBoth(L"\x1b[5;10r\x1b[?1049l");
+    VERIFY_IS_FALSE(nativeTerm._AreMarginsSet());
+    _verifySameText(gci.GetActiveOutputBuffer(), nativeTerm);
+
+    Log::Comment(L"So DL at the top and SU scroll the whole viewport.");
+    writeBoth(L"\x1b[2;1H\x1b[2M");
+    _verifySameText(gci.GetActiveOutputBuffer(), nativeTerm);
+    writeBoth(L"\x1b[3S");
+    _verifySameText(gci.GetActiveOutputBuffer(), nativeTerm);
+}
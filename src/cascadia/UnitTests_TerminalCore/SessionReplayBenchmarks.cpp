@@ -0,0 +1,540 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+// This file replays terminal sessions through the whole output pipeline of the
+// Terminal: the UTF-8 decoding done by the connection, the StateMachine, the
+// TerminalDispatch writing into the TextBuffer, and the Renderer walking the
+// buffer into a render engine that doesn't draw anything. It needs no window,
+// so it can run on a build machine.
+//
+// Every stream is fed in chunks of 4096 bytes, like ConptyConnection reads
+// them from the pipe, and a frame is painted after each chunk. Each stage is
+// timed on its own.
+//
+// Run it with `te.exe Terminal.Core.Unit.Tests.dll /name:*SessionReplay*`.
+// - /p:SessionFile=<path> replays a recorded session (the raw bytes that an
+//   application wrote, for example captured with `script`) instead of the
+//   built-in streams.
+// - /p:MinMBps=<number> fails the test if the whole pipeline is slower than
+//   that for any of the streams. Use this to gate performance regressions.
+//
+// The allocations made by each stage are counted with the allocation hook of
+// the debug CRT, which is only installed while a stage runs. Release builds of
+// the CRT don't have that hook, so there the stages only report their times.
+
+#include "precomp.h"
+#include <WexTestClass.h>
+
+#include <fstream>
+
+#ifdef _DEBUG
+#include <crtdbg.h>
+#endif
+
+#include "../../renderer/base/Renderer.hpp"
+#include "../../renderer/inc/RenderEngineBase.hpp"
+#include "../../terminal/adapter/termDispatch.hpp"
+#include "../../terminal/parser/OutputStateMachineEngine.hpp"
+#include "../cascadia/TerminalCore/Terminal.hpp"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::VirtualTerminal;
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace
+{
+    // The size of the reads done by ConptyConnection.
+    constexpr size_t ChunkSize = 4096;
+
+    // Counts the allocations made on the current thread for as long as it's
+    // alive, with the allocation hook of the debug CRT. Any other hook is put
+    // back afterwards. Release builds of the CRT have no hook, so nothing is
+    // counted there, and IsAvailable is false.
+    class AllocationCounter final
+    {
+    public:
+#ifdef _DEBUG
+        static constexpr bool IsAvailable = true;
+
+        AllocationCounter() noexcept :
+            _previousCounter{ s_current },
+            _previousHook{ _CrtSetAllocHook(_Hook) }
+        {
+            s_current = this;
+        }
+
+        ~AllocationCounter()
+        {
+            s_current = _previousCounter;
+            _CrtSetAllocHook(_previousHook);
+        }
+#else
+        static constexpr bool IsAvailable = false;
+
+        AllocationCounter() = default;
+#endif
+
+        AllocationCounter(const AllocationCounter&) = delete;
+        AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+        size_t count = 0;
+        size_t bytes = 0;
+
+#ifdef _DEBUG
+    private:
+        // The hook is called on every thread, but only the allocations made
+        // on the thread that's counting are counted.
+        static inline thread_local AllocationCounter* s_current = nullptr;
+
+        AllocationCounter* const _previousCounter;
+        const _CRT_ALLOC_HOOK _previousHook;
+
+        static int __cdecl _Hook(const int allocType,
+                                 void* const /*userData*/,
+                                 const size_t size,
+                                 const int blockType,
+                                 const long /*requestNumber*/,
+                                 const unsigned char* const /*filename*/,
+                                 const int /*lineNumber*/) noexcept
+        {
+            // The CRT's own blocks are left alone, as the CRT asks hooks to.
+            if (blockType != _CRT_BLOCK &&
+                (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) &&
+                s_current != nullptr)
+            {
+                s_current->count++;
+                s_current->bytes += size;
+            }
+            return TRUE;
+        }
+#endif
+    };
+
+    // Throws away everything the StateMachine dispatches, so that the parser
+    // can be timed on its own.
+    class NullDispatch final : public TermDispatch
+    {
+    public:
+        void Execute(const wchar_t /*wchControl*/) override
+        {
+        }
+
+        void Print(const wchar_t /*wchPrintable*/) override
+        {
+        }
+
+        void PrintString(const std::wstring_view /*string*/) override
+        {
+        }
+    };
+
+    // A render engine that draws nothing. It asks for the whole viewport to
+    // be painted in every frame, so that the renderer walks every row and
+    // cluster of the buffer, like it does after the window was resized.
+    class NullRenderEngine final : public RenderEngineBase
+    {
+    public:
+        size_t paintedClusters = 0;
+
+        [[nodiscard]] HRESULT StartPaint() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT EndPaint() noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT Present() noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT ScrollFrame() noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT Invalidate(const SMALL_RECT* const /*psrRegion*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateCursor(const COORD* const /*pcoordCursor*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateSystem(const RECT* const /*prcDirtyClient*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& /*rectangles*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateScroll(const COORD* const /*pcoordDelta*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT InvalidateAll() noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override
+        {
+            *pForcePaint = false;
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT PaintBackground() noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT PaintBufferLine(std::basic_string_view<Cluster> const clusters,
+                                              const COORD /*coord*/,
+                                              const bool /*fTrimLeft*/,
+                                              const bool /*lineWrapped*/) noexcept override
+        {
+            paintedClusters += clusters.size();
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT PaintBufferGridLines(const GridLines /*lines*/,
+                                                   const COLORREF /*color*/,
+                                                   const size_t /*cchLine*/,
+                                                   const COORD /*coordTarget*/) noexcept override
+        {
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT PaintSelection(const SMALL_RECT /*rect*/) noexcept override { return S_OK; }
+        [[nodiscard]] HRESULT PaintCursor(const CursorOptions& /*options*/) noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const COLORREF /*colorForeground*/,
+                                                   const COLORREF /*colorBackground*/,
+                                                   const WORD /*legacyColorAttribute*/,
+                                                   const ExtendedAttributes /*extendedAttrs*/,
+                                                   const bool /*isSettingDefaultBrushes*/) noexcept override
+        {
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& /*FontInfoDesired*/,
+                                         _Out_ FontInfo& /*FontInfo*/) noexcept override
+        {
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT UpdateDpi(const int /*iDpi*/) noexcept override { return S_OK; }
+
+        [[nodiscard]] HRESULT UpdateViewport(const SMALL_RECT srNewViewport) noexcept override
+        {
+            _viewportSize = { gsl::narrow_cast<SHORT>(srNewViewport.Right - srNewViewport.Left + 1),
+                              gsl::narrow_cast<SHORT>(srNewViewport.Bottom - srNewViewport.Top + 1) };
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& /*FontInfoDesired*/,
+                                              _Out_ FontInfo& /*FontInfo*/,
+                                              const int /*iDpi*/) noexcept override
+        {
+            return S_OK;
+        }
+
+        std::vector<til::rectangle> GetDirtyArea() override
+        {
+            return { SMALL_RECT{ 0, 0, gsl::narrow_cast<SHORT>(_viewportSize.X - 1), gsl::narrow_cast<SHORT>(_viewportSize.Y - 1) } };
+        }
+
+        [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override
+        {
+            *pFontSize = { 1, 1 };
+            return S_OK;
+        }
+
+        [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view /*glyph*/, _Out_ bool* const pResult) noexcept override
+        {
+            *pResult = false;
+            return S_OK;
+        }
+
+    protected:
+        [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring& /*newTitle*/) noexcept override
+        {
+            return S_FALSE;
+        }
+
+    private:
+        COORD _viewportSize{ 0, 0 };
+    };
+
+    // The time spent in and the allocations made by one stage of the pipeline.
+    struct StageResult
+    {
+        std::chrono::steady_clock::duration elapsed{};
+        size_t allocationCount = 0;
+        size_t allocationBytes = 0;
+    };
+
+    // Routine Description:
+    // - Runs the given function, adding the time it took and, if they're
+    //   counted, the allocations it made to the result of its stage.
+    template<typename T>
+    void _Measure(StageResult& result, T&& function)
+    {
+        AllocationCounter allocations;
+        const auto start = std::chrono::steady_clock::now();
+
+        function();
+
+        result.elapsed += std::chrono::steady_clock::now() - start;
+        result.allocationCount += allocations.count;
+        result.allocationBytes += allocations.bytes;
+    }
+
+    std::string _ToUtf8(const std::wstring_view text)
+    {
+        std::string utf8;
+        THROW_IF_FAILED(til::u16u8(text, utf8));
+        return utf8;
+    }
+
+    // Routine Description:
+    // - Builds the output of `cat` on a large source file: plain text, with
+    //   the odd line that's long enough to wrap.
+    std::string _BuildCatSession()
+    {
+        std::wstring session;
+        for (size_t line = 0; line < 20000; line++)
+        {
+            switch (line % 4)
+            {
+            case 0:
+                session += L"// Copyright (c) Microsoft Corporation. Licensed under the MIT license.\r\n";
+                break;
+            case 1:
+                session += L"    const auto result = _pData->GetTextBuffer().GetRowByOffset(" + std::to_wstring(line) + L").GetCharRow().size();\r\n";
+                break;
+            case 2:
+                session += L"    // " + std::wstring(line % 150, L'-') + L"\r\n";
+                break;
+            default:
+                session += L"\r\n";
+                break;
+            }
+        }
+        return _ToUtf8(session);
+    }
+
+    // Routine Description:
+    // - Builds the colorized diagnostics of a compiler, the way clang and gcc
+    //   print them: bold locations, colored severities and caret lines.
+    std::string _BuildCompilerSession()
+    {
+        std::wstring session;
+        for (size_t error = 0; error < 5000; error++)
+        {
+            const auto lineNumber = std::to_wstring(error % 900 + 10);
+            session += L"\x1b[1msrc/buffer/out/textBuffer.cpp:" + lineNumber + L":17: \x1b[0m";
+            session += error % 3 ? L"\x1b[0;1;35mwarning: \x1b[0m" : L"\x1b[0;1;31merror: \x1b[0m";
+            session += L"\x1b[1mcomparison of integers of different signs: 'size_t' and 'int' [-Wsign-compare]\x1b[0m\r\n";
+            session += L"  " + lineNumber + L" |     for (size_t i = 0; i < count; ++i)\r\n";
+            session += L"     |                        \x1b[0;1;32m~ ^ ~~~~~\x1b[0m\r\n";
+        }
+        session += L"\x1b[1m5000 warnings and errors generated.\x1b[0m\r\n";
+        return _ToUtf8(session);
+    }
+
+    // Routine Description:
+    // - Builds the output of vim scrolling through a file with syntax
+    //   highlighting: a scroll region, a status line and a command line.
+    std::string _BuildVimSession()
+    {
+        std::wstring session;
+        for (size_t frame = 0; frame < 10000; frame++)
+        {
+            session += L"\x1b[?25l\x1b[1;23r\x1b[23;1H\r\n\x1b[r";
+            session += L"\x1b[23;1H\x1b[33m" + std::to_wstring(frame + 23) + L" \x1b[m\x1b[38;5;130mif\x1b[m (\x1b[1;34mcount\x1b[m > 0) { \x1b[32m// keep going\x1b[m\x1b[K";
+            session += L"\x1b[24;1H\x1b[7m main.cpp [+]\x1b[m\x1b[24;60H" + std::to_wstring(frame) + L",1\x1b[24;75HTop";
+            session += L"\x1b[" + std::to_wstring(frame % 23 + 1) + L";5H\x1b[?25h";
+        }
+        return _ToUtf8(session);
+    }
+
+    // Routine Description:
+    // - Builds the output of htop: meters and a process list that get
+    //   repainted in place.
+    std::string _BuildHtopSession()
+    {
+        std::wstring session;
+        for (size_t frame = 0; frame < 1000; frame++)
+        {
+            session += L"\x1b[?25l\x1b[H";
+            for (size_t cpu = 0; cpu < 4; cpu++)
+            {
+                session += L"\x1b[" + std::to_wstring(cpu + 1) + L";3H\x1b[1;36m" + std::to_wstring(cpu) + L"\x1b[m\x1b[1;37m[\x1b[32m||||\x1b[31m||\x1b[30;1m" + std::wstring(frame % 20, L' ') + L"\x1b[37m" + std::to_wstring(frame * 3 % 100) + L"%]\x1b[m";
+            }
+            session += L"\x1b[6;1H\x1b[30;42m  PID USER      PRI  NI  VIRT   RES   SHR S CPU% MEM%   TIME+  Command\x1b[K\x1b[m";
+            for (size_t row = 0; row < 16; row++)
+            {
+                session += L"\x1b[" + std::to_wstring(row + 7) + L";1H\x1b[m" + std::to_wstring(1000 + row) + L" \x1b[38;5;245mroot\x1b[m       20   0 \x1b[36m 12.3M\x1b[m  4.1M  3.0M S  0.0  0.1  0:00.42 \x1b[1m/usr/bin/daemon\x1b[m\x1b[K";
+            }
+            session += L"\x1b[24;1HF1\x1b[30;46mHelp  \x1b[mF2\x1b[30;46mSetup \x1b[mF10\x1b[30;46mQuit\x1b[K\x1b[m";
+        }
+        return _ToUtf8(session);
+    }
+
+    // Routine Description:
+    // - Builds output that's heavy on emoji and CJK text: surrogate pairs and
+    //   wide characters, in 24 bit color.
+    std::string _BuildEmojiSession()
+    {
+        // U+1F600, U+1F44D, U+1F680 and U+2764 U+FE0F.
+        const std::wstring emoji = L"\xD83D\xDE00\xD83D\xDC4D\xD83D\xDE80\x2764\xFE0F";
+        // "Terminal" in Chinese and Japanese.
+        const std::wstring cjk = L"\x7EC8\x7AEF\x30BF\x30FC\x30DF\x30CA\x30EB";
+
+        std::wstring session;
+        for (size_t line = 0; line < 10000; line++)
+        {
+            session += L"\x1b[38;2;" + std::to_wstring(line % 256) + L";128;255m";
+            for (size_t i = 0; i < 4; i++)
+            {
+                session += emoji + L' ' + cjk + L' ';
+            }
+            session += L"\x1b[m done \xD83C\xDF89\r\n";
+        }
+        return _ToUtf8(session);
+    }
+
+    std::string _ReadSessionFile(const std::wstring& path)
+    {
+        std::ifstream file{ path, std::ios::binary };
+        THROW_HR_IF(E_INVALIDARG, !file);
+        return { std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{} };
+    }
+
+    double _MegabytesPerSecond(const size_t bytes, const std::chrono::steady_clock::duration elapsed)
+    {
+        const std::chrono::duration<double> seconds = elapsed;
+        return seconds.count() > 0 ? bytes / (1024.0 * 1024.0) / seconds.count() : 0.0;
+    }
+}
+
+namespace TerminalCoreUnitTests
+{
+    class SessionReplayBenchmarks;
+};
+using namespace TerminalCoreUnitTests;
+
+class TerminalCoreUnitTests::SessionReplayBenchmarks final
+{
+    TEST_CLASS(SessionReplayBenchmarks);
+
+    BEGIN_TEST_METHOD(ReplaySessions)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
+
+private:
+    double _Replay(const std::string_view session, const wchar_t* const name);
+};
+
+void SessionReplayBenchmarks::ReplaySessions()
+{
+    double minimum = 0.0;
+    String minimumParameter;
+    if (SUCCEEDED(RuntimeParameters::TryGetValue(L"MinMBps", minimumParameter)))
+    {
+        minimum = std::wcstod(minimumParameter, nullptr);
+    }
+
+    std::vector<std::pair<std::wstring, std::string>> sessions;
+
+    String sessionFile;
+    if (SUCCEEDED(RuntimeParameters::TryGetValue(L"SessionFile", sessionFile)))
+    {
+        sessions.emplace_back(static_cast<const wchar_t*>(sessionFile), _ReadSessionFile(static_cast<const wchar_t*>(sessionFile)));
+    }
+    else
+    {
+        sessions.emplace_back(L"cat", _BuildCatSession());
+        sessions.emplace_back(L"compiler", _BuildCompilerSession());
+        sessions.emplace_back(L"vim", _BuildVimSession());
+        sessions.emplace_back(L"htop", _BuildHtopSession());
+        sessions.emplace_back(L"emoji", _BuildEmojiSession());
+    }
+
+    for (const auto& [name, session] : sessions)
+    {
+        const auto throughput = _Replay(session, name.c_str());
+        if (minimum > 0.0)
+        {
+            VERIFY_IS_GREATER_THAN_OR_EQUAL(throughput, minimum, NoThrowString().Format(L"%s must replay at %.2fMB/s or faster", name.c_str(), minimum));
+        }
+    }
+}
+
+// Routine Description:
+// - Replays a session through each stage of the pipeline and logs how long
+//   each stage took and, if they're counted, how many allocations it made.
+// Arguments:
+// - session - the UTF-8 bytes that the application wrote.
+// - name - the name of the session, for the log.
+// Return Value:
+// - the throughput of the whole pipeline, in MB of UTF-8 per second.
+double SessionReplayBenchmarks::_Replay(const std::string_view session, const wchar_t* const name)
+{
+    StageResult decode;
+    StageResult parse;
+    StageResult write;
+    StageResult render;
+
+    // The stages after the decoding all get the same text, so decode it once
+    // for all of them, in the same chunks that the connection would.
+    std::vector<std::wstring> chunks;
+    til::u8state state;
+    for (size_t offset = 0; offset < session.size(); offset += ChunkSize)
+    {
+        auto& chunk = chunks.emplace_back();
+        _Measure(decode, [&]() {
+            THROW_IF_FAILED(til::u8u16(session.substr(offset, ChunkSize), chunk, state));
+        });
+    }
+
+    StateMachine parser{ std::make_unique<OutputStateMachineEngine>(std::make_unique<NullDispatch>()) };
+    for (const auto& chunk : chunks)
+    {
+        _Measure(parse, [&]() {
+            parser.ProcessString(chunk);
+        });
+    }
+
+    NullRenderEngine engine;
+    Terminal term;
+    Renderer renderer{ &term, nullptr, 0, nullptr };
+    renderer.AddRenderEngine(&engine);
+    term.Create({ 80, 24 }, 1000, renderer);
+
+    for (const auto& chunk : chunks)
+    {
+        _Measure(write, [&]() {
+            term.Write(chunk);
+        });
+        _Measure(render, [&]() {
+            THROW_IF_FAILED(renderer.PaintFrame());
+        });
+    }
+
+    const auto total = decode.elapsed + write.elapsed + render.elapsed;
+    const auto throughput = _MegabytesPerSecond(session.size(), total);
+
+    Log::Comment(NoThrowString().Format(L"%s: %zu bytes in %zu chunks, %.2fMB/s through the whole pipeline, %zu clusters painted",
+                                        name,
+                                        session.size(),
+                                        chunks.size(),
+                                        throughput,
+                                        engine.paintedClusters));
+
+    const auto logStage = [&](const StageResult& result, const wchar_t* const stage) {
+        const std::chrono::duration<double, std::milli> elapsed = result.elapsed;
+        if constexpr (AllocationCounter::IsAvailable)
+        {
+            Log::Comment(NoThrowString().Format(L"    %-28s %10.2fms %10.2fMB/s %10zu allocations (%zu bytes)",
+                                                stage,
+                                                elapsed.count(),
+                                                _MegabytesPerSecond(session.size(), result.elapsed),
+                                                result.allocationCount,
+                                                result.allocationBytes));
+        }
+        else
+        {
+            Log::Comment(NoThrowString().Format(L"    %-28s %10.2fms %10.2fMB/s",
+                                                stage,
+                                                elapsed.count(),
+                                                _MegabytesPerSecond(session.size(), result.elapsed)));
+        }
+    };
+    logStage(decode, L"UTF-8 decoding");
+    logStage(parse, L"parsing only");
+    logStage(write, L"parsing, dispatch and buffer");
+    logStage(render, L"rendering");
+
+    return throughput;
+}
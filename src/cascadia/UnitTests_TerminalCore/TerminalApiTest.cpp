@@ -29,6 +29,8 @@ namespace TerminalCoreUnitTests
         TEST_METHOD(CursorVisibility);
         TEST_METHOD(CursorVisibilityViaStateMachine);
 
+        TEST_METHOD(HardResetLeavesAlternateBuffer);
+
         // Terminal::_WriteBuffer used to enter infinite loops under certain conditions.
         // This test ensures that Terminal::_WriteBuffer doesn't get stuck when
         // PrintString() is called with more code units than the buffer width.
@@ -208,3 +210,27 @@ void TerminalApiTest::CursorVisibilityViaStateMachine()
     VERIFY_IS_FALSE(cursor.IsBlinkingAllowed());
     VERIFY_IS_FALSE(cursor.IsVisible());
 }
+
+void TerminalApiTest::HardResetLeavesAlternateBuffer()
+{
+    Terminal term;
+    DummyRenderTarget emptyRT;
+    term.Create({ 100, 100 }, 0, emptyRT);
+
+    auto& stateMachine = *(term._stateMachine);
+
+    stateMachine.ProcessString(L"\x1b[?1049h\x1b[5;20r");
+    VERIFY_IS_NOT_NULL(term._mainBuffer.get());
+    VERIFY_IS_TRUE(term._AreMarginsSet());
+
+    Log::Comment(L"RIS switches back to the main buffer and clears the margins.");
+    stateMachine.ProcessString(L"\x1b" L"c");
+    VERIFY_IS_NULL(term._mainBuffer.get());
+    VERIFY_IS_FALSE(term._AreMarginsSet());
+
+    Log::Comment(L"In the main buffer, it clears the margins, too.");
+    stateMachine.ProcessString(L"\x1b[5;20r");
+    VERIFY_IS_TRUE(term._AreMarginsSet());
+    stateMachine.ProcessString(L"\x1b" L"c");
+    VERIFY_IS_FALSE(term._AreMarginsSet());
+}
@@ -7,6 +7,8 @@
 #include "../TerminalApp/Profile.h"
 #include "../TerminalApp/CascadiaSettings.h"
 #include "../LocalTests_TerminalApp/JsonTestClass.h"
+#include <defaults.h>
+#include <chrono>
 
 using namespace Microsoft::Console;
 using namespace TerminalApp;
@@ -32,6 +34,12 @@ namespace TerminalAppUnitTests
 
         TEST_METHOD(TestWrongValueType);
 
+        TEST_METHOD(SettingsCacheRoundtrips);
+
+        BEGIN_TEST_METHOD(ParseSettingsPerformance)
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD()
+
         TEST_CLASS_SETUP(ClassSetup)
         {
             InitializeJsonReader();
@@ -278,4 +286,144 @@ namespace TerminalAppUnitTests
         VERIFY_ARE_EQUAL(defaults._useAcrylic, profile._useAcrylic);
     }
 
+    void JsonTests::SettingsCacheRoundtrips()
+    {
+        const std::string settingsString{ R"(
+        {
+            "defaultProfile": "{6239a42c-1111-49a3-80bd-e8fdd045185c}",
+            "profiles": {
+                "defaults": {
+                    "fontSize": 14
+                },
+                "list": [
+                    {
+                        "name": "profile0",
+                        "guid": "{6239a42c-1111-49a3-80bd-e8fdd045185c}",
+                        "historySize": 4000000000
+                    },
+                    {
+                        "name": "profile1",
+                        "guid": "{6239a42c-2222-49a3-80bd-e8fdd045185c}",
+                        "padding": "8, 8",
+                        "backgroundImageOpacity": 0.25,
+                        "hidden": false,
+                        "icon": null
+                    }
+                ]
+            },
+            "schemes": [ { "name": "scheme0", "background": "#101010" } ],
+            "keybindings": [ { "command": "copy", "keys": [ "ctrl+c" ] } ]
+        })" };
+
+        auto parsed = CascadiaSettings::LoadDefaults();
+        parsed->_ParseJsonString(settingsString, false);
+        const auto cache = parsed->_SerializeSettingsCache();
+
+        Log::Comment(L"The cache holds the same JSON, including where each value was in the text.");
+        CascadiaSettings loaded;
+        VERIFY_IS_TRUE(loaded._LoadSettingsCache(cache, settingsString));
+        VERIFY_ARE_EQUAL(parsed->_userSettingsString, loaded._userSettingsString);
+        VERIFY_IS_TRUE(parsed->_defaultSettings == loaded._defaultSettings);
+        VERIFY_IS_TRUE(parsed->_userSettings == loaded._userSettings);
+
+        const auto& parsedProfile = parsed->_userSettings["profiles"]["list"][1];
+        const auto& loadedProfile = loaded._userSettings["profiles"]["list"][1];
+        VERIFY_ARE_EQUAL(parsedProfile.getOffsetStart(), loadedProfile.getOffsetStart());
+        VERIFY_ARE_EQUAL(parsedProfile.getOffsetLimit(), loadedProfile.getOffsetLimit());
+
+        Log::Comment(L"Both layer into the same profiles.");
+        loaded.LayerJson(loaded._defaultSettings);
+        for (auto* settings : { parsed.get(), &loaded })
+        {
+            settings->_ApplyDefaultsFromUserSettings();
+            settings->LayerJson(settings->_userSettings);
+        }
+        VERIFY_ARE_EQUAL(parsed->_profiles.size(), loaded._profiles.size());
+        for (size_t i = 0; i < parsed->_profiles.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(parsed->_profiles.at(i).GetName(), loaded._profiles.at(i).GetName());
+            VERIFY_ARE_EQUAL(parsed->_profiles.at(i)._fontSize, loaded._profiles.at(i)._fontSize);
+        }
+
+        Log::Comment(L"A cache for other settings, or a damaged one, isn't used.");
+        CascadiaSettings stale;
+        VERIFY_IS_FALSE(stale._LoadSettingsCache(cache, settingsString + " "));
+        VERIFY_IS_FALSE(stale._LoadSettingsCache(cache.substr(0, cache.size() - 1), settingsString));
+        VERIFY_IS_FALSE(stale._LoadSettingsCache({}, settingsString));
+    }
+
+    void JsonTests::ParseSettingsPerformance()
+    {
+        Log::Comment(L"Builds a settings file with lots of profiles and color schemes.");
+        std::string settingsString{ R"({ "defaultProfile": "{6239a42c-0000-49a3-80bd-000000000000}", "profiles": { "defaults": { "fontSize": 11 }, "list": [)" };
+        constexpr int profileCount = 500;
+        for (int i = 0; i < profileCount; ++i)
+        {
+            char guid[64];
+            sprintf_s(guid, "{6239a42c-0000-49a3-80bd-%012d}", i);
+            settingsString += i == 0 ? "\n" : ",\n";
+            settingsString += R"({ "name": "profile )" + std::to_string(i) + R"(", "guid": ")" + guid +
+                              R"(", "commandline": "cmd.exe /k echo hello", "colorScheme": "scheme )" + std::to_string(i % 50) +
+                              R"(", "padding": "8, 8, 8, 8", "historySize": 9001, "useAcrylic": true, "acrylicOpacity": 0.75 })";
+        }
+        settingsString += R"(] }, "schemes": [)";
+        for (int i = 0; i < 50; ++i)
+        {
+            settingsString += i == 0 ? "\n" : ",\n";
+            settingsString += R"({ "name": "scheme )" + std::to_string(i) +
+                              R"(", "background": "#0C0C0C", "foreground": "#CCCCCC", "black": "#0C0C0C", "red": "#C50F1F", "green": "#13A10E", "blue": "#0037DA" })";
+        }
+        settingsString += "] }";
+
+        // The settings cache only replaces parsing the JSON. Layering it into
+        // profiles is timed on its own, since it runs either way. So do the
+        // dynamic profile generators, which aren't run here at all.
+        using duration = std::chrono::duration<double, std::milli>;
+        duration parseElapsed{};
+        duration cacheElapsed{};
+        duration layerElapsed{};
+        const auto load = [&](const std::string* cache) {
+            auto settings = std::make_unique<CascadiaSettings>();
+            const auto loadStart = std::chrono::steady_clock::now();
+            if (cache)
+            {
+                VERIFY_IS_TRUE(settings->_LoadSettingsCache(*cache, settingsString));
+                cacheElapsed += std::chrono::steady_clock::now() - loadStart;
+            }
+            else
+            {
+                settings->_ParseJsonString(DefaultJson, true);
+                settings->_ParseJsonString(settingsString, false);
+                parseElapsed += std::chrono::steady_clock::now() - loadStart;
+            }
+
+            const auto layerStart = std::chrono::steady_clock::now();
+            settings->LayerJson(settings->_defaultSettings);
+            settings->_ApplyDefaultsFromUserSettings();
+            settings->LayerJson(settings->_userSettings);
+            layerElapsed += std::chrono::steady_clock::now() - layerStart;
+            return settings;
+        };
+
+        constexpr int iterations = 20;
+        const auto expectedProfiles = CascadiaSettings::LoadDefaults()->_profiles.size() + profileCount;
+        const auto cache = load(nullptr)->_SerializeSettingsCache();
+        parseElapsed = {};
+        layerElapsed = {};
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            VERIFY_ARE_EQUAL(expectedProfiles, load(nullptr)->_profiles.size());
+            VERIFY_ARE_EQUAL(expectedProfiles, load(&cache)->_profiles.size());
+        }
+
+        Log::Comment(NoThrowString().Format(L"%d profiles, %zu bytes of JSON, %zu bytes of cache",
+                                            profileCount,
+                                            settingsString.size(),
+                                            cache.size()));
+        Log::Comment(NoThrowString().Format(L"Parsing the JSON: %.2fms per load", parseElapsed.count() / iterations));
+        Log::Comment(NoThrowString().Format(L"From the cache: %.2fms per load", cacheElapsed.count() / iterations));
+        Log::Comment(NoThrowString().Format(L"Layering, either way: %.2fms per load", layerElapsed.count() / (2 * iterations)));
+    }
+
 }
@@ -19,6 +19,8 @@ const std::wstring_view ConsoleArguments::WIDTH_ARG = L"--width";
 const std::wstring_view ConsoleArguments::HEIGHT_ARG = L"--height";
 const std::wstring_view ConsoleArguments::INHERIT_CURSOR_ARG = L"--inheritcursor";
 const std::wstring_view ConsoleArguments::RESIZE_QUIRK = L"--resizeQuirk";
+const std::wstring_view ConsoleArguments::PASSTHROUGH_MODE_ARG = L"--passthrough";
+const std::wstring_view ConsoleArguments::RECTANGULAR_COPY_ARG = L"--rectangularCopy";
 const std::wstring_view ConsoleArguments::FEATURE_ARG = L"--feature";
 const std::wstring_view ConsoleArguments::FEATURE_PTY_ARG = L"pty";
 
@@ -139,6 +141,8 @@ ConsoleArguments& ConsoleArguments::operator=(const ConsoleArguments& other)
         _width = other._width;
         _height = other._height;
         _inheritCursor = other._inheritCursor;
+        _passthroughMode = other._passthroughMode;
+        _rectangularCopy = other._rectangularCopy;
         _receivedEarlySizeChange = other._receivedEarlySizeChange;
     }
 
@@ -486,6 +490,18 @@ void ConsoleArguments::s_ConsumeArg(_Inout_ std::vector<std::wstring>& args, _In
             s_ConsumeArg(args, i);
             hr = S_OK;
         }
+        else if (arg == PASSTHROUGH_MODE_ARG)
+        {
+            _passthroughMode = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
+        else if (arg == RECTANGULAR_COPY_ARG)
+        {
+            _rectangularCopy = true;
+            s_ConsumeArg(args, i);
+            hr = S_OK;
+        }
         else if (arg == CLIENT_COMMANDLINE_ARG)
         {
             // Everything after this is the explicit commandline
@@ -623,6 +639,16 @@ bool ConsoleArguments::IsResizeQuirkEnabled() const
     return _resizeQuirk;
 }
 
+bool ConsoleArguments::IsPassthroughModeEnabled() const
+{
+    return _passthroughMode;
+}
+
+bool ConsoleArguments::IsRectangularCopyEnabled() const
+{
+    return _rectangularCopy;
+}
+
 // Method Description:
 // - Tell us to use a different size than the one parsed as the size of the
 //      console. This is called by the PtySignalInputThread when it receives a
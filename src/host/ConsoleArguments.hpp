@@ -51,6 +51,8 @@ public:
     short GetHeight() const;
     bool GetInheritCursor() const;
     bool IsResizeQuirkEnabled() const;
+    bool IsPassthroughModeEnabled() const;
+    bool IsRectangularCopyEnabled() const;
 
     void SetExpectedSize(COORD dimensions) noexcept;
 
@@ -70,6 +72,8 @@ public:
     static const std::wstring_view HEIGHT_ARG;
     static const std::wstring_view INHERIT_CURSOR_ARG;
     static const std::wstring_view RESIZE_QUIRK;
+    static const std::wstring_view PASSTHROUGH_MODE_ARG;
+    static const std::wstring_view RECTANGULAR_COPY_ARG;
     static const std::wstring_view FEATURE_ARG;
     static const std::wstring_view FEATURE_PTY_ARG;
 
@@ -103,6 +107,8 @@ private:
         _signalHandle(signalHandle),
         _inheritCursor(inheritCursor),
         _resizeQuirk(false),
+        _passthroughMode(false),
+        _rectangularCopy(false),
         _receivedEarlySizeChange{ false },
         _originalWidth{ -1 },
         _originalHeight{ -1 }
@@ -131,6 +137,8 @@ private:
     DWORD _signalHandle;
     bool _inheritCursor;
     bool _resizeQuirk{ false };
+    bool _passthroughMode{ false };
+    bool _rectangularCopy{ false };
 
     bool _receivedEarlySizeChange;
     short _originalWidth;
@@ -110,3 +110,15 @@ void ScreenBufferRenderTarget::TriggerTitleChange()
         pRenderer->TriggerTitleChange();
     }
 }
+
+void ScreenBufferRenderTarget::SetSynchronizedOutput(const bool enabled)
+{
+    // Unlike the triggers above, this isn't about what changed in our buffer.
+    // An application that switches to the alternate buffer in the middle of
+    // a synchronized update still expects it to end when it says so.
+    auto* pRenderer = ServiceLocator::LocateGlobals().pRender;
+    if (pRenderer != nullptr)
+    {
+        pRenderer->SetSynchronizedOutput(enabled);
+    }
+}
@@ -70,6 +70,13 @@ VtInputThread::VtInputThread(_In_ wil::unique_hfile hPipe,
     LockConsole();
     auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
 
+    // Everything in this run goes into the input buffer as one batch, so that
+    //      readers are only woken up once, instead of once per key. This makes
+    //      a big difference for pastes.
+    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    gci.pInputBuffer->BeginWriteBatch();
+    auto EndBatch = wil::scope_exit([&] { gci.pInputBuffer->EndWriteBatch(); });
+
     try
     {
         std::wstring wstr{};
@@ -108,7 +115,9 @@ DWORD WINAPI VtInputThread::StaticVtInputThreadProc(_In_ LPVOID lpParameter)
 // - <none>
 void VtInputThread::DoReadInput(const bool throwOnFail)
 {
-    char buffer[256];
+    // Large enough that a paste arrives in a few big runs, rather than in
+    //      many small ones that each take the console lock.
+    char buffer[4096];
     DWORD dwRead = 0;
     bool fSuccess = !!ReadFile(_hFile.get(), buffer, ARRAYSIZE(buffer), &dwRead, nullptr);
 
@@ -74,6 +74,8 @@ VtIo::VtIo() :
 {
     _lookingForCursorPosition = pArgs->GetInheritCursor();
     _resizeQuirk = pArgs->IsResizeQuirkEnabled();
+    _passthroughMode = pArgs->IsPassthroughModeEnabled();
+    _rectangularCopy = pArgs->IsRectangularCopyEnabled();
 
     // If we were already given VT handles, set up the VT IO engine to use those.
     if (pArgs->InConptyMode())
@@ -194,6 +196,17 @@ VtIo::VtIo() :
             {
                 _pVtRenderEngine->SetTerminalOwner(this);
                 _pVtRenderEngine->SetResizeQuirk(_resizeQuirk);
+
+                // The telnet engine paints without the rectangular area
+                // operations, so only the xterm engines get to use DECCRA.
+                _pVtRenderEngine->SetRectangularCopy(_rectangularCopy && _IoMode != VtIoMode::WIN_TELNET);
+            }
+
+            // Client VT can only be passed through as it is to a terminal
+            // that understands it, and that we send UTF-8 to.
+            if (_passthroughMode && (_IoMode == VtIoMode::XTERM_256 || _IoMode == VtIoMode::XTERM))
+            {
+                _pPassthroughEngine = _pVtRenderEngine.get();
             }
         }
     }
@@ -258,6 +271,8 @@ bool VtIo::IsUsingVt() const
 
     if (_pVtInputThread)
     {
+        const auto& gci = g.getConsoleInformation();
+        LOG_IF_FAILED(SetBracketedPasteMode(!gci.pInputBuffer->IsInVirtualTerminalInputMode()));
         LOG_IF_FAILED(_pVtInputThread->Start());
     }
 
@@ -347,6 +362,25 @@ bool VtIo::IsUsingVt() const
     return hr;
 }
 
+// Method Description:
+// - Asks the terminal to wrap pastes in bracketed paste markers, or to stop.
+//      Clients that read keys get pastes as keys either way, but between the
+//      markers, the InputStateMachineEngine can tell pasted line breaks from
+//      typed ones. Clients in VT input mode handle pastes themselves, and ask
+//      the terminal for the markers if they want them.
+// Arguments:
+// - enabled: true to ask for the markers.
+// Return Value:
+// - S_OK if we asked or there's no terminal to ask, else an appropriate HRESULT
+[[nodiscard]] HRESULT VtIo::SetBracketedPasteMode(const bool enabled)
+{
+    if (_pVtRenderEngine && _pVtInputThread)
+    {
+        return _pVtRenderEngine->RequestBracketedPasteMode(enabled);
+    }
+    return S_OK;
+}
+
 void VtIo::CloseInput()
 {
     // This will release the lock when it goes out of scope
@@ -368,6 +402,7 @@ void VtIo::CloseOutput()
     // given to the Renderer, so we don't want the unique_ptr to delete it. The
     // Renderer will own its lifetime now.
     _pVtRenderEngine.release();
+    _pPassthroughEngine = nullptr;
 
     g.getConsoleInformation().GetActiveOutputBuffer().SetTerminalConnection(nullptr);
 
@@ -447,6 +482,11 @@ void VtIo::EnableConptyModeForTests()
 {
     _objectsCreated = true;
 }
+
+void VtIo::EnablePassthroughForTests(VtEngine* const pEngine)
+{
+    _pPassthroughEngine = pEngine;
+}
 #endif
 
 // Method Description:
@@ -464,3 +504,163 @@ bool VtIo::IsResizeQuirkEnabled() const
 {
     return _resizeQuirk;
 }
+
+// Method Description:
+// - Called when the console is about to copy a rectangle of the active buffer
+//   to another position in it. If we were started with the `--rectangularCopy`
+//   flag, the terminal may be able to make the same copy itself with DECCRA.
+//   If so, EndRectangleCopy has to be called once the console made its copy.
+// Arguments:
+// - source: the rectangle to copy, in buffer coordinates.
+// - target: the position its top left is copied to.
+// Return Value:
+// - true if the terminal is going to make the copy, and the target doesn't need
+//   to be repainted.
+bool VtIo::BeginRectangleCopy(const Viewport& source, const COORD target) noexcept
+{
+    return _pVtRenderEngine && _pVtRenderEngine->BeginRectangleCopy(source, target);
+}
+
+// Method Description:
+// - Called once the console made a copy that BeginRectangleCopy accepted.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtIo::EndRectangleCopy() noexcept
+{
+    if (_pVtRenderEngine)
+    {
+        _pVtRenderEngine->EndRectangleCopy();
+    }
+}
+
+// Method Description:
+// - Returns true if we were started with the `--passthrough` flag, and VT that
+//   clients write can be passed through to the terminal as it is.
+bool VtIo::IsPassthroughEnabled() const noexcept
+{
+    return _pPassthroughEngine != nullptr;
+}
+
+// Method Description:
+// - Writes VT that a client application wrote straight to the terminal,
+//   instead of letting the renderer serialize what it did to our buffer. That
+//   saves the terminal a frame of latency, and us the work of rendering it.
+// - The string is still parsed, so that our buffer stays up to date for
+//   clients that read it back with the legacy APIs. Whatever those APIs
+//   changed before is painted first, so that it reaches the terminal in order.
+//   They keep being rendered like they always were.
+// - Clients may split a sequence across writes. Nothing of ours can be sent
+//   while the terminal is in the middle of one, so the pending paint and the
+//   rendition wait until a write leaves the state machine in the ground state.
+// - Queries that we answer ourselves aren't passed on, or the client would
+//   get a second answer from the terminal.
+// Arguments:
+// - screenInfo: the buffer the client wrote to. It must be the active one.
+// - str: the VT that the client wrote.
+// Return Value:
+// - S_OK, or an appropriate HRESULT if rendering the pending changes failed.
+[[nodiscard]] HRESULT VtIo::PassthroughString(SCREEN_INFORMATION& screenInfo, const std::wstring_view str)
+{
+    Globals& g = ServiceLocator::LocateGlobals();
+    CONSOLE_INFORMATION& gci = g.getConsoleInformation();
+    VtEngine& engine = *_pPassthroughEngine;
+    StateMachine& machine = screenInfo.GetStateMachine();
+
+    if (machine.IsInGroundState())
+    {
+        RETURN_IF_FAILED(g.pRender->PaintFrame());
+
+        // The terminal's rendition is reset after each string that's passed
+        // through, so first give it back the one the client left us with.
+        const auto attributes = screenInfo.GetAttributes();
+        RETURN_IF_FAILED(engine.UpdateDrawingBrushes(gci.renderData.GetForegroundColor(attributes),
+                                                     gci.renderData.GetBackgroundColor(attributes),
+                                                     attributes.GetLegacyAttributes(),
+                                                     attributes.GetExtendedAttributes(),
+                                                     false));
+    }
+
+    _pPassthroughMachine = &machine;
+    _omittedSequences.clear();
+    engine.BeginPassthrough();
+    auto endPassthrough = wil::scope_exit([&]() {
+        _pPassthroughMachine = nullptr;
+        const auto& cursor = gci.GetActiveOutputBuffer().GetTextBuffer().GetCursor();
+        LOG_IF_FAILED(_EndPassthrough(engine, str, cursor.IsVisible(), machine.IsInGroundState()));
+    });
+
+    machine.ProcessString(str);
+    return S_OK;
+}
+
+// Method Description:
+// - Called when we reply to a query. If it came from a client's string that's
+//   being passed through, the query is left out of what the terminal gets, so
+//   that only our reply reaches the client.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtIo::OmitFromPassthrough() noexcept
+{
+    if (_pPassthroughMachine)
+    {
+        const auto sequence = _pPassthroughMachine->GetDispatchingSequence();
+        if (!sequence.empty())
+        {
+            try
+            {
+                _omittedSequences.push_back(sequence);
+            }
+            CATCH_LOG();
+        }
+    }
+}
+
+// Method Description:
+// - Writes the string that was passed through to the terminal, less the
+//   sequences that we answered ourselves.
+// Arguments:
+// - engine: the engine to write to.
+// - str: the VT that the client wrote.
+// - cursorVisible: whether the client left the cursor visible.
+// - inGround: whether the string ended outside of any sequence.
+// Return Value:
+// - S_OK or suitable HRESULT error from writing to the terminal.
+[[nodiscard]] HRESULT VtIo::_EndPassthrough(VtEngine& engine,
+                                            const std::wstring_view str,
+                                            const bool cursorVisible,
+                                            const bool inGround) noexcept
+{
+    std::wstring forwarded;
+    std::wstring_view toWrite{ str };
+
+    if (!_omittedSequences.empty())
+    {
+        try
+        {
+            forwarded.reserve(str.size());
+            auto next = str.data();
+            const auto end = str.data() + str.size();
+            for (const auto sequence : _omittedSequences)
+            {
+                // The sequences are views into str, in the order they were parsed.
+                if (sequence.data() >= next && sequence.data() + sequence.size() <= end)
+                {
+                    forwarded.append(next, sequence.data());
+                    next = sequence.data() + sequence.size();
+                }
+            }
+            forwarded.append(next, end);
+            toWrite = forwarded;
+        }
+        CATCH_LOG();
+
+        _omittedSequences.clear();
+    }
+
+    // However that went, the engine has to stop passing through.
+    return engine.EndPassthrough(toWrite, cursorVisible, inGround);
+}
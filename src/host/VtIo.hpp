@@ -10,9 +10,12 @@
 #include "PtySignalInputThread.hpp"
 
 class ConsoleArguments;
+class SCREEN_INFORMATION;
 
 namespace Microsoft::Console::VirtualTerminal
 {
+    class StateMachine;
+
     class VtIo : public Microsoft::Console::ITerminalOwner
     {
     public:
@@ -32,6 +35,7 @@ namespace Microsoft::Console::VirtualTerminal
 
         [[nodiscard]] HRESULT SuppressResizeRepaint();
         [[nodiscard]] HRESULT SetCursorPosition(const COORD coordCursor);
+        [[nodiscard]] HRESULT SetBracketedPasteMode(const bool enabled);
 
         void CloseInput() override;
         void CloseOutput() override;
@@ -41,9 +45,16 @@ namespace Microsoft::Console::VirtualTerminal
 
 #ifdef UNIT_TESTING
         void EnableConptyModeForTests();
+        void EnablePassthroughForTests(Microsoft::Console::Render::VtEngine* const pEngine);
 #endif
 
         bool IsResizeQuirkEnabled() const;
+        bool BeginRectangleCopy(const Microsoft::Console::Types::Viewport& source, const COORD target) noexcept;
+        void EndRectangleCopy() noexcept;
+
+        bool IsPassthroughEnabled() const noexcept;
+        [[nodiscard]] HRESULT PassthroughString(SCREEN_INFORMATION& screenInfo, const std::wstring_view str);
+        void OmitFromPassthrough() noexcept;
 
     private:
         // After CreateIoHandlers is called, these will be invalid.
@@ -60,8 +71,17 @@ namespace Microsoft::Console::VirtualTerminal
         std::mutex _shutdownLock;
 
         bool _resizeQuirk{ false };
+        bool _passthroughMode{ false };
+        bool _rectangularCopy{ false };
 
         std::unique_ptr<Microsoft::Console::Render::VtEngine> _pVtRenderEngine;
+        // The engine that client VT is passed through to, if passthrough mode
+        // is enabled and the engine speaks xterm.
+        Microsoft::Console::Render::VtEngine* _pPassthroughEngine{ nullptr };
+        // While a string is passed through, the state machine parsing it, and
+        // the sequences in it that we answered ourselves.
+        StateMachine* _pPassthroughMachine{ nullptr };
+        std::vector<std::wstring_view> _omittedSequences;
         std::unique_ptr<Microsoft::Console::VtInputThread> _pVtInputThread;
         std::unique_ptr<Microsoft::Console::PtySignalInputThread> _pPtySignalInputThread;
 
@@ -69,6 +89,11 @@ namespace Microsoft::Console::VirtualTerminal
 
         void _ShutdownIfNeeded();
 
+        [[nodiscard]] HRESULT _EndPassthrough(Microsoft::Console::Render::VtEngine& engine,
+                                              const std::wstring_view str,
+                                              const bool cursorVisible,
+                                              const bool inGround) noexcept;
+
 #ifdef UNIT_TESTING
         friend class VtIoTests;
 #endif
@@ -17,10 +17,15 @@
 
 #include "../types/inc/convert.hpp"
 #include "../types/inc/GlyphWidth.hpp"
+#include "../types/inc/Utf16Parser.hpp"
 #include "../types/inc/Viewport.hpp"
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
+#if defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#endif
+
 #pragma hdrstop
 using namespace Microsoft::Console::Types;
 using Microsoft::Console::Interactivity::ServiceLocator;
@@ -30,6 +35,84 @@ using Microsoft::Console::VirtualTerminal::StateMachine;
 
 constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
 
+// WriteConsoleAImpl keeps its conversion buffer around up to this many characters.
+constexpr size_t RetainedConversionCapacity = 16384;
+
+// Routine Description:
+// - Counts how many characters at the start of the string are printable ASCII.
+//   Those are a single cell wide and are printed as they are in any output
+//   mode, so WriteCharsLegacy can write runs of them without looking at each.
+// Arguments:
+// - pwch - the string to scan.
+// - cch - the most characters to scan.
+// Return Value:
+// - The length of the run of printable ASCII at the start of the string.
+static size_t _CountPrintableAscii(_In_reads_(cch) const wchar_t* const pwch, const size_t cch) noexcept
+{
+    size_t i = 0;
+#if defined(_M_X64) || defined(_M_IX86)
+    // Check 8 characters at a time. Subtracting ' ' wraps everything below it
+    // around to large values, so a character is printable if what's left is at
+    // most '~' - ' '. SSE2 can't compare unsigned words, but subtracting the
+    // limit with saturation only leaves zero for the ones that are in range.
+    const auto first = _mm_set1_epi16(L' ');
+    const auto range = _mm_set1_epi16(L'~' - L' ');
+    const auto zero = _mm_setzero_si128();
+    for (; i + 8 <= cch; i += 8)
+    {
+        const auto chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pwch + i));
+        const auto excess = _mm_subs_epu16(_mm_sub_epi16(chars, first), range);
+        const auto printable = gsl::narrow_cast<unsigned long>(_mm_movemask_epi8(_mm_cmpeq_epi16(excess, zero)));
+        if (printable != 0xffff)
+        {
+            // Each character sets two bits of the mask.
+            unsigned long index = 0;
+            _BitScanForward(&index, ~printable);
+            return i + index / 2;
+        }
+    }
+#endif
+    while (i < cch && pwch[i] >= L' ' && pwch[i] <= L'~')
+    {
+        i++;
+    }
+    return i;
+}
+
+// Routine Description:
+// - Measures the run of glyphs at the start of the string that WriteCharsLegacy
+//   can't copy in bulk, up to the next printable ASCII or control character.
+//   Measuring the whole run at once saves looking up each character on its own.
+// Arguments:
+// - pwch - the string to measure.
+// - cch - the most characters to measure.
+// - fUnprocessed - true if control characters are printed as glyphs, too.
+// - widths - receives the column width of each character in the run, 0 for
+//            the trailing half of a surrogate pair.
+// Return Value:
+// - The length of the run. A surrogate pair is never split at its end.
+static size_t _MeasureGlyphRun(_In_reads_(cch) const wchar_t* const pwch,
+                               const size_t cch,
+                               const bool fUnprocessed,
+                               const gsl::span<BYTE> widths)
+{
+    size_t cchRun = 0;
+    while (cchRun < cch &&
+           (IS_GLYPH_CHAR(pwch[cchRun]) || fUnprocessed) &&
+           !(pwch[cchRun] >= L' ' && pwch[cchRun] <= L'~'))
+    {
+        cchRun++;
+    }
+
+    if (cchRun > 1 && Utf16Parser::IsLeadingSurrogate(pwch[cchRun - 1]))
+    {
+        cchRun--;
+    }
+
+    GetGlyphColumnWidths({ pwch, cchRun }, widths);
+    return cchRun;
+}
+
 // Routine Description:
 // - This routine updates the cursor position.  Its input is the non-special
 //   cased new location of the cursor.  For example, if the cursor were being
@@ -340,6 +423,7 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
     NTSTATUS Status = STATUS_SUCCESS;
     SHORT XPosition;
     WCHAR LocalBuffer[LOCAL_BUFFER_SIZE];
+    BYTE LocalWidths[LOCAL_BUFFER_SIZE];
     size_t TempNumSpaces = 0;
     const bool fUnprocessed = WI_IsFlagClear(screenInfo.OutputMode, ENABLE_PROCESSED_OUTPUT);
     const bool fWrapAtEOL = WI_IsFlagSet(screenInfo.OutputMode, ENABLE_WRAP_AT_EOL_OUTPUT);
@@ -378,23 +462,84 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
         XPosition = cursor.GetPosition().X;
         size_t i = 0;
         wchar_t* LocalBufPtr = LocalBuffer;
+        const wchar_t* WriteBuffer = LocalBuffer;
+
+        // The widths of the glyph run being copied, see _MeasureGlyphRun.
+        size_t cchWidths = 0;
+        size_t iWidth = 0;
+
+        // The trailing halves of surrogate pairs in LocalBuffer, which take up no cells.
+        size_t cchTrailing = 0;
+
+        // Most output is plain text. If this starts out with a run of printable
+        // ASCII, write as much of it as fits on the row straight from the string.
+        if (XPosition < coordScreenBufferSize.X)
+        {
+            const size_t cchRun = _CountPrintableAscii(lpString,
+                                                       std::min<size_t>((BufferSize - *pcb) / sizeof(WCHAR),
+                                                                        gsl::narrow_cast<size_t>(coordScreenBufferSize.X - XPosition)));
+            if (cchRun != 0)
+            {
+                WriteBuffer = lpString;
+                i = cchRun;
+                XPosition += gsl::narrow_cast<SHORT>(cchRun);
+                lpString += cchRun;
+                pwchRealUnicode += cchRun;
+                pwchBuffer += cchRun;
+                *pcb += cchRun * sizeof(WCHAR);
+                goto EndWhile;
+            }
+        }
+
         while (*pcb < BufferSize && i < LOCAL_BUFFER_SIZE && XPosition < coordScreenBufferSize.X)
         {
+            // Copy runs of printable ASCII in bulk, they need none of the checks below.
+            const size_t cchRun = _CountPrintableAscii(lpString,
+                                                       std::min({ (BufferSize - *pcb) / sizeof(WCHAR),
+                                                                  LOCAL_BUFFER_SIZE - i,
+                                                                  gsl::narrow_cast<size_t>(coordScreenBufferSize.X - XPosition) }));
+            if (cchRun != 0)
+            {
+                LocalBufPtr = std::copy_n(lpString, cchRun, LocalBufPtr);
+                i += cchRun;
+                XPosition += gsl::narrow_cast<SHORT>(cchRun);
+                lpString += cchRun;
+                pwchRealUnicode += cchRun;
+                pwchBuffer += cchRun;
+                *pcb += cchRun * sizeof(WCHAR);
+                continue;
+            }
+
 #pragma prefast(suppress : 26019, "Buffer is taken in multiples of 2. Validation is ok.")
             const wchar_t Char = *lpString;
             const wchar_t RealUnicodeChar = *pwchRealUnicode;
             if (IS_GLYPH_CHAR(RealUnicodeChar) || fUnprocessed)
             {
-                if (IsGlyphFullWidth(Char))
+                if (iWidth == cchWidths)
+                {
+                    cchWidths = _MeasureGlyphRun(lpString,
+                                                 std::min((BufferSize - *pcb) / sizeof(WCHAR), LOCAL_BUFFER_SIZE - i),
+                                                 fUnprocessed,
+                                                 LocalWidths);
+                    iWidth = 0;
+                }
+
+                // The trailing half of a surrogate pair takes up no columns of its own,
+                // it's copied together with the leading half.
+                const size_t cchGlyph = (iWidth + 1 < cchWidths && LocalWidths[iWidth + 1] == 0) ? 2 : 1;
+                if (i + cchGlyph > LOCAL_BUFFER_SIZE)
+                {
+                    goto EndWhile;
+                }
+
+                if (LocalWidths[iWidth] == 2)
                 {
                     if (i < (LOCAL_BUFFER_SIZE - 1) && XPosition < (coordScreenBufferSize.X - 1))
                     {
-                        *LocalBufPtr++ = Char;
+                        LocalBufPtr = std::copy_n(lpString, cchGlyph, LocalBufPtr);
 
                         // cursor adjusted by 2 because the char is double width
                         XPosition += 2;
-                        i += 1;
-                        pwchBuffer++;
                     }
                     else
                     {
@@ -403,11 +548,19 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
                 }
                 else
                 {
-                    *LocalBufPtr = Char;
-                    LocalBufPtr++;
+                    LocalBufPtr = std::copy_n(lpString, cchGlyph, LocalBufPtr);
                     XPosition++;
-                    i++;
-                    pwchBuffer++;
+                }
+
+                i += cchGlyph;
+                iWidth += cchGlyph;
+                pwchBuffer += cchGlyph;
+                if (cchGlyph == 2)
+                {
+                    cchTrailing++;
+                    lpString++;
+                    pwchRealUnicode++;
+                    *pcb += sizeof(WCHAR);
                 }
             }
             else
@@ -526,13 +679,14 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
             CursorPosition = cursor.GetPosition();
 
             // Make sure we don't write past the end of the buffer.
-            if (i > gsl::narrow_cast<size_t>(coordScreenBufferSize.X) - CursorPosition.X)
+            const size_t cchFits = gsl::narrow_cast<size_t>(coordScreenBufferSize.X) - CursorPosition.X + cchTrailing;
+            if (i > cchFits)
             {
-                i = gsl::narrow_cast<size_t>(coordScreenBufferSize.X) - CursorPosition.X;
+                i = cchFits;
             }
 
             // line was wrapped if we're writing up to the end of the current row
-            OutputCellIterator it(std::wstring_view(LocalBuffer, i), Attributes);
+            OutputCellIterator it(std::wstring_view(WriteBuffer, i), Attributes);
             const auto itEnd = screenInfo.Write(it);
 
             // Notify accessibility
@@ -939,7 +1093,21 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
                 StateMachine& machine = screenInfo.GetStateMachine();
                 size_t const cch = BufferSize / sizeof(WCHAR);
 
-                machine.ProcessString({ pwchRealUnicode, cch });
+                // In conpty's passthrough mode, the terminal gets the client's
+                // VT as it is, rather than what we render from our buffer.
+                // Writes to a buffer that isn't shown can't be passed through.
+                CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+                auto* const pVtIo = gci.GetVtIo();
+                if (gci.IsInVtIoMode() &&
+                    pVtIo->IsPassthroughEnabled() &&
+                    &screenInfo.GetActiveBuffer() == &gci.GetActiveOutputBuffer())
+                {
+                    LOG_IF_FAILED(pVtIo->PassthroughString(screenInfo, { pwchRealUnicode, cch }));
+                }
+                else
+                {
+                    machine.ProcessString({ pwchRealUnicode, cch });
+                }
                 *pcb += BufferSize;
             }
         }
@@ -1086,9 +1254,18 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
         const auto codepage{ consoleInfo.OutputCP };
         auto leadByteCaptured{ false };
         auto leadByteConsumed{ false };
-        std::wstring wstr{};
         static til::u8state u8State{};
 
+        // Like the UTF-8 state, the converted text is kept across calls under the console lock,
+        // so that most writes can reuse the allocation of the previous one.
+        static std::wstring wstr{};
+        auto releaseLargeBuffer{ wil::scope_exit([&]() noexcept {
+            if (wstr.capacity() > RetainedConversionCapacity)
+            {
+                wstr = std::wstring{};
+            }
+        }) };
+
         // Convert our input parameters to Unicode
         if (codepage == CP_UTF8)
         {
@@ -24,22 +24,26 @@
 
 using Microsoft::Console::Interactivity::ServiceLocator;
 
+// Alias and EXE names are compared without regard to case. Hashing folds
+// each character as it goes, so that lookups don't copy the key first.
 struct case_insensitive_hash
 {
-    std::size_t operator()(const std::wstring& key) const
+    std::size_t operator()(const std::wstring_view key) const noexcept
     {
-        std::wstring lower(key);
-        std::transform(lower.begin(), lower.end(), lower.begin(), ::towlower);
-        std::hash<std::wstring> hash;
-        return hash(lower);
+        size_t hash = 0;
+        for (const auto ch : key)
+        {
+            hash = hash * 31 + ::towlower(ch);
+        }
+        return hash;
     }
 };
 
 struct case_insensitive_equality
 {
-    bool operator()(const std::wstring& lhs, const std::wstring& rhs) const
+    bool operator()(const std::wstring_view lhs, const std::wstring_view rhs) const noexcept
     {
-        return 0 == _wcsicmp(lhs.data(), rhs.data());
+        return lhs.size() == rhs.size() && 0 == _wcsnicmp(lhs.data(), rhs.data(), lhs.size());
     }
 };
 
@@ -52,6 +56,9 @@ std::unordered_map<std::wstring,
                    case_insensitive_equality>
     g_aliasData;
 
+// The expansion buffer of s_MatchAndCopyAliasLegacy is kept around up to this many characters.
+static constexpr size_t RetainedExpansionCapacity = 4096;
+
 // Routine Description:
 // - Adds a command line alias to the global set.
 // - Converts and calls the W version of this function.
@@ -824,53 +831,64 @@ void Alias::s_ClearCmdExeAliases()
 // - Trims leading spaces off of a string
 // Arguments:
 // - str - String to trim
-void Alias::s_TrimLeadingSpaces(std::wstring& str)
+// Return Value:
+// - The part of str starting at the first character that isn't a space.
+std::wstring_view Alias::s_TrimLeadingSpaces(const std::wstring_view str) noexcept
 {
-    // Erase from the beginning of the string up until the first
+    // Skip from the beginning of the string up until the first
     // character found that is not a space.
-    str.erase(str.begin(),
-              std::find_if(str.begin(), str.end(), [](wchar_t ch) { return !std::iswspace(ch); }));
+    const auto first = std::find_if(str.cbegin(), str.cend(), [](wchar_t ch) { return !std::iswspace(ch); });
+    return str.substr(first - str.cbegin());
 }
 
 // Routine Description:
 // - Trims trailing \r\n off of a string
 // Arguments:
 // - str - String to trim
-void Alias::s_TrimTrailingCrLf(std::wstring& str)
+// Return Value:
+// - The part of str in front of the last carriage return, or all of str if it has none.
+std::wstring_view Alias::s_TrimTrailingCrLf(const std::wstring_view str) noexcept
 {
     const auto trailingCrLfPos = str.find_last_of(UNICODE_CARRIAGERETURN);
-    if (std::wstring::npos != trailingCrLfPos)
-    {
-        str.erase(trailingCrLfPos);
-    }
+    return str.substr(0, trailingCrLfPos);
+}
+
+// Routine Description:
+// - Gets the first token of a command string, which is the alias to look up.
+// Arguments:
+// - str - String with leading spaces already trimmed off.
+// Return Value:
+// - All text up to the first space character.
+std::wstring_view Alias::s_GetAliasName(const std::wstring_view str) noexcept
+{
+    return str.substr(0, str.find(L' '));
 }
 
 // Routine Description:
 // - Tokenizes a string into a collection using space as a separator
+// - Macros can only refer to the alias and the first nine arguments,
+//   so splitting stops once those were found. The last token is
+//   never cut off, it just doesn't include the rest of the string.
 // Arguments:
 // - str - String to tokenize
 // Return Value:
-// - Collection of tokenized strings
-std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
+// - Collection of tokens, each one pointing into str.
+Alias::Tokens Alias::s_Tokenize(const std::wstring_view str)
 {
-    std::deque<std::wstring> result;
+    Tokens result;
 
     size_t prevIndex = 0;
     auto spaceIndex = str.find(L' ');
-    while (std::wstring::npos != spaceIndex)
+    while (std::wstring_view::npos != spaceIndex && result.size() < MaxTokens - 1)
     {
-        const auto length = spaceIndex - prevIndex;
-
-        result.emplace_back(str.substr(prevIndex, length));
-
-        spaceIndex++;
-        prevIndex = spaceIndex;
+        result.push_back(str.substr(prevIndex, spaceIndex - prevIndex));
 
-        spaceIndex = str.find(L' ', spaceIndex);
+        prevIndex = spaceIndex + 1;
+        spaceIndex = str.find(L' ', prevIndex);
     }
 
     // Place the final one into the set.
-    result.emplace_back(str.substr(prevIndex));
+    result.push_back(str.substr(prevIndex, spaceIndex - prevIndex));
 
     return result;
 }
@@ -882,20 +900,15 @@ std::deque<std::wstring> Alias::s_Tokenize(const std::wstring& str)
 // - str - String to split into just args
 // Return Value:
 // - Only the arguments part of the string or empty if there are no arguments.
-std::wstring Alias::s_GetArgString(const std::wstring& str)
+std::wstring_view Alias::s_GetArgString(const std::wstring_view str) noexcept
 {
-    std::wstring result;
-    auto firstSpace = str.find_first_of(L' ');
-    if (std::wstring::npos != firstSpace)
+    const auto firstSpace = str.find(L' ');
+    if (std::wstring_view::npos == firstSpace)
     {
-        firstSpace++;
-        if (firstSpace < str.size())
-        {
-            result = str.substr(firstSpace);
-        }
+        return {};
     }
 
-    return result;
+    return str.substr(firstSpace + 1);
 }
 
 // Routine Description:
@@ -910,7 +923,7 @@ std::wstring Alias::s_GetArgString(const std::wstring& str)
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::deque<std::wstring>& tokens)
+                                         const Tokens& tokens)
 {
     if (ch >= L'1' && ch <= L'9')
     {
@@ -919,7 +932,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 
         if (index < tokens.size() && index > 0)
         {
-            appendToStr.append(tokens[index]);
+            appendToStr.append(til::at(tokens, index));
         }
 
         return true;
@@ -940,7 +953,7 @@ bool Alias::s_TryReplaceNumberedArgMacro(const wchar_t ch,
 // - False if the given character doesn't match this macro.
 bool Alias::s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                          std::wstring& appendToStr,
-                                         const std::wstring fullArgString)
+                                         const std::wstring_view fullArgString)
 {
     if (L'*' == ch)
     {
@@ -1052,155 +1065,135 @@ void Alias::s_AppendCrLf(std::wstring& appendToStr,
 }
 
 // Routine Description:
-// - Searches through the given string for macros and replaces them
-//   with the matching action
+// - Searches through the given alias target for macros and writes it
+//   out with each of them replaced by the matching action.
+// - Runs of plain text between macros are copied over in one go.
 // Arguments:
-// - str - On input, the string to search. On output, the string is replaced.
+// - target - The text of the alias to search for macros.
 // - tokens - The tokenized command line input. 0 is the alias, 1-N are arguments.
 // - fullArgString - Shorthand to 1-N argument string in case of wildcard match.
+// - finalText - Receives the replaced text. Anything in it beforehand is discarded,
+//               but its allocation is reused.
 // Return Value:
 // - The number of commands in the final string (line feeds, CRLFs)
-size_t Alias::s_ReplaceMacros(std::wstring& str,
-                              const std::deque<std::wstring>& tokens,
-                              const std::wstring& fullArgString)
+size_t Alias::s_ReplaceMacros(const std::wstring_view target,
+                              const Tokens& tokens,
+                              const std::wstring_view fullArgString,
+                              std::wstring& finalText)
 {
     size_t lineCount = 0;
-    std::wstring finalText;
+    finalText.clear();
 
     // The target text may contain substitution macros indicated by $.
     // Walk through and substitute them as appropriate.
-    for (auto ch = str.cbegin(); ch < str.cend(); ch++)
+    size_t pos = 0;
+    while (pos < target.size())
     {
-        if (L'$' == *ch)
+        const auto macroPos = target.find(L'$', pos);
+        if (std::wstring_view::npos == macroPos)
         {
-            // Attempt to read ahead by one character.
-            const auto chNext = ch + 1;
+            // No more macros, the rest is copied through.
+            finalText.append(target.substr(pos));
+            break;
+        }
 
-            if (chNext < str.cend())
-            {
-                auto isProcessed = s_TryReplaceNumberedArgMacro(*chNext, finalText, tokens);
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceWildcardArgMacro(*chNext, finalText, fullArgString);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceInputRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceOutputRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplacePipeRedirMacro(*chNext, finalText);
-                }
-                if (!isProcessed)
-                {
-                    isProcessed = s_TryReplaceNextCommandMacro(*chNext, finalText, lineCount);
-                }
-                if (!isProcessed)
-                {
-                    // If nothing matches, just push these two characters in.
-                    finalText.push_back(*ch);
-                    finalText.push_back(*chNext);
-                }
+        finalText.append(target.substr(pos, macroPos - pos));
 
-                // Since we read ahead and used that character,
-                // advance the iterator one extra to compensate.
-                ch++;
-            }
-            else
-            {
-                // If no read-ahead, just push this character and be done.
-                finalText.push_back(*ch);
-            }
+        // Attempt to read ahead by one character.
+        const auto nextPos = macroPos + 1;
+        if (nextPos >= target.size())
+        {
+            // If no read-ahead, just push this character and be done.
+            finalText.push_back(L'$');
+            break;
         }
-        else
+
+        const auto chNext = til::at(target, nextPos);
+        const auto isProcessed = s_TryReplaceNumberedArgMacro(chNext, finalText, tokens) ||
+                                 s_TryReplaceWildcardArgMacro(chNext, finalText, fullArgString) ||
+                                 s_TryReplaceInputRedirMacro(chNext, finalText) ||
+                                 s_TryReplaceOutputRedirMacro(chNext, finalText) ||
+                                 s_TryReplacePipeRedirMacro(chNext, finalText) ||
+                                 s_TryReplaceNextCommandMacro(chNext, finalText, lineCount);
+        if (!isProcessed)
         {
-            // If it didn't match the macro specifier $, push the character.
-            finalText.push_back(*ch);
+            // If nothing matches, just push these two characters in.
+            finalText.push_back(L'$');
+            finalText.push_back(chNext);
         }
+
+        // Since we read ahead and used that character, continue behind it.
+        pos = nextPos + 1;
     }
 
     // We always terminate with a CRLF to symbolize end of command.
     s_AppendCrLf(finalText, lineCount);
 
-    // Give back the final text and count.
-    str.swap(finalText);
     return lineCount;
 }
 
 // Routine Description:
 // - Takes the source text and searches it for an alias belonging to exe name's list.
+// - The first word of the source text is looked up before anything else is
+//   done with it, so that lines without an alias cost next to nothing.
 // Arguments:
 // - sourceText - The string to search for an alias
 // - exeName - The name of the EXE that has aliases associated
+// - targetText - Receives the processed data if we found a matching alias.
+//                Its allocation is reused, so callers can keep it around.
 // - lineCount - Number of lines worth of text processed.
 // Return Value:
-// - If we found a matching alias, this will be the processed data
+// - True if we found a matching alias. targetText holds the processed data
 //   and lineCount is updated to the new number of lines.
-// - If we didn't match and process an alias, return an empty string.
-std::wstring Alias::s_MatchAndCopyAlias(const std::wstring& sourceText,
-                                        const std::wstring& exeName,
-                                        size_t& lineCount)
+// - False if we didn't match and process an alias. targetText is left alone.
+bool Alias::s_MatchAndCopyAlias(const std::wstring_view sourceText,
+                                const std::wstring& exeName,
+                                std::wstring& targetText,
+                                size_t& lineCount)
 {
-    // Copy source text into a local for manipulation.
-    std::wstring sourceCopy(sourceText);
-
-    // Trim trailing \r\n off of sourceCopy if it has one.
-    s_TrimTrailingCrLf(sourceCopy);
-
-    // Trim leading spaces off of sourceCopy if it has any.
-    s_TrimLeadingSpaces(sourceCopy);
-
     // Check if we have an EXE in the list that matches the request first.
-    auto exeIter = g_aliasData.find(exeName);
+    const auto exeIter = g_aliasData.find(exeName);
     if (exeIter == g_aliasData.end())
     {
-        // We found no data for this exe. Give back an empty string.
-        return std::wstring();
+        // We found no data for this exe.
+        return false;
     }
 
-    auto exeList = exeIter->second;
-    if (exeList.size() == 0)
+    const auto& exeList = exeIter->second;
+    if (exeList.empty())
     {
-        // If there's no match, give back an empty string.
-        return std::wstring();
+        return false;
     }
 
-    // Tokenize the text by spaces
-    const auto tokens = s_Tokenize(sourceCopy);
+    // Trim trailing \r\n and leading spaces off of the source text.
+    const auto source = s_TrimLeadingSpaces(s_TrimTrailingCrLf(sourceText));
 
-    // If there are no tokens, return an empty string
-    if (tokens.size() == 0)
-    {
-        return std::wstring();
-    }
+    // Find alias. The key buffer is reused from line to line, so
+    // this doesn't allocate for all the lines that have no alias.
+    static std::wstring aliasName;
+    aliasName.assign(s_GetAliasName(source));
 
-    // Find alias. If there isn't one, return an empty string
-    const auto alias = tokens.front();
-    const auto aliasIter = exeList.find(alias);
+    const auto aliasIter = exeList.find(aliasName);
     if (aliasIter == exeList.end())
     {
-        // We found no alias pair with this name. Give back an empty string.
-        return std::wstring();
+        // We found no alias pair with this name.
+        return false;
     }
 
-    const auto target = aliasIter->second;
-    if (target.size() == 0)
+    const auto& target = aliasIter->second;
+    if (target.empty())
     {
-        return std::wstring();
+        return false;
     }
 
-    // Get the string of all parameters as a shorthand for $* later.
-    const auto allParams = s_GetArgString(sourceCopy);
+    // Only now that there's something to expand, split up the arguments.
+    const auto tokens = s_Tokenize(source);
 
     // The final text will be the target but with macros replaced.
-    std::wstring finalText(target);
-    lineCount = s_ReplaceMacros(finalText, tokens, allParams);
+    // $* is shorthand for the string of all parameters.
+    lineCount = s_ReplaceMacros(target, tokens, s_GetArgString(source), targetText);
 
-    return finalText;
+    return true;
 }
 
 // Routine Description:
@@ -1226,13 +1219,21 @@ void Alias::s_MatchAndCopyAliasLegacy(_In_reads_bytes_(cbSource) PWCHAR pwchSour
 {
     try
     {
-        std::wstring sourceText(pwchSource, cbSource / sizeof(WCHAR));
-        size_t lineCount = lines;
+        // Expansions are written into the same buffer every time. Should
+        // an unusually long one make it grow a lot, it's given back below.
+        static std::wstring targetText;
+        auto releaseBuffer = wil::scope_exit([&]() noexcept {
+            if (targetText.capacity() > RetainedExpansionCapacity)
+            {
+                targetText = std::wstring();
+            }
+        });
 
-        const auto targetText = s_MatchAndCopyAlias(sourceText, exeName, lineCount);
+        const std::wstring_view sourceText(pwchSource, cbSource / sizeof(WCHAR));
+        size_t lineCount = lines;
 
-        // Only return data if the reply was non-empty (we had a match).
-        if (!targetText.empty())
+        // Only return data if we had a match.
+        if (s_MatchAndCopyAlias(sourceText, exeName, targetText, lineCount))
         {
             const auto cchTargetSize = cbTargetSize / sizeof(wchar_t);
 
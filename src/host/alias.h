@@ -24,25 +24,32 @@ public:
                                           const std::wstring& exeName,
                                           DWORD& lines);
 
-    static std::wstring s_MatchAndCopyAlias(const std::wstring& sourceText,
-                                            const std::wstring& exeName,
-                                            size_t& lineCount);
+    static bool s_MatchAndCopyAlias(const std::wstring_view sourceText,
+                                    const std::wstring& exeName,
+                                    std::wstring& targetText,
+                                    size_t& lineCount);
 
 private:
-    static void s_TrimLeadingSpaces(std::wstring& str);
-    static void s_TrimTrailingCrLf(std::wstring& str);
-    static std::deque<std::wstring> s_Tokenize(const std::wstring& str);
-    static std::wstring s_GetArgString(const std::wstring& str);
-    static size_t s_ReplaceMacros(std::wstring& str,
-                                  const std::deque<std::wstring>& tokens,
-                                  const std::wstring& fullArgString);
+    // The alias itself and up to 9 arguments, which is all that macros can refer to.
+    static constexpr size_t MaxTokens = 10;
+    using Tokens = til::small_vector<std::wstring_view, MaxTokens>;
+
+    static std::wstring_view s_TrimLeadingSpaces(const std::wstring_view str) noexcept;
+    static std::wstring_view s_TrimTrailingCrLf(const std::wstring_view str) noexcept;
+    static std::wstring_view s_GetAliasName(const std::wstring_view str) noexcept;
+    static Tokens s_Tokenize(const std::wstring_view str);
+    static std::wstring_view s_GetArgString(const std::wstring_view str) noexcept;
+    static size_t s_ReplaceMacros(const std::wstring_view target,
+                                  const Tokens& tokens,
+                                  const std::wstring_view fullArgString,
+                                  std::wstring& finalText);
 
     static bool s_TryReplaceNumberedArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::deque<std::wstring>& tokens);
+                                             const Tokens& tokens);
     static bool s_TryReplaceWildcardArgMacro(const wchar_t ch,
                                              std::wstring& appendToStr,
-                                             const std::wstring fullArgString);
+                                             const std::wstring_view fullArgString);
 
     static bool s_TryReplaceInputRedirMacro(const wchar_t ch,
                                             std::wstring& appendToStr);
@@ -299,25 +299,50 @@ void RedrawCommandLine(COOKED_READ_DATA& cookedReadData)
 // - This routine copies the commandline specified by Index into the cooked read buffer
 void SetCurrentCommandLine(COOKED_READ_DATA& cookedReadData, _In_ SHORT Index) // index, not command number
 {
-    DeleteCommandLine(cookedReadData, TRUE);
+    // Commands next to each other in the history often start out the same.
+    // The part that's shared with what's on the screen doesn't need to be redrawn.
+    const std::wstring_view shown{ cookedReadData.BufferStartPtr(), cookedReadData.BytesRead() / sizeof(wchar_t) };
+    const auto command = cookedReadData.History().GetNth(Index);
+    const auto unchanged = gsl::narrow_cast<size_t>(std::mismatch(shown.cbegin(), shown.cend(), command.cbegin(), command.cend()).first - shown.cbegin());
+
+    // Both ways of clearing the old line need to see it as it was shown,
+    // to tell whether a wide glyph at its end was cut in half.
+    const auto shownCells = cookedReadData.ShownCells();
+    const auto redraw = cookedReadData.CanRedrawFrom(unchanged);
+    if (!redraw)
+    {
+        DeleteCommandLine(cookedReadData, false);
+        cookedReadData.VisibleCharCount() = 0;
+    }
+
     FAIL_FAST_IF_FAILED(cookedReadData.History().RetrieveNth(Index,
                                                              cookedReadData.SpanWholeBuffer(),
                                                              cookedReadData.BytesRead()));
-    FAIL_FAST_IF(!(cookedReadData.BufferStartPtr() == cookedReadData.BufferCurrentPtr()));
-    if (cookedReadData.IsEchoInput())
+
+    NTSTATUS Status = STATUS_SUCCESS;
+    SHORT ScrollY = 0;
+    if (redraw)
     {
-        SHORT ScrollY = 0;
-        FAIL_FAST_IF_NTSTATUS_FAILED(WriteCharsLegacy(cookedReadData.ScreenInfo(),
-                                                      cookedReadData.BufferStartPtr(),
-                                                      cookedReadData.BufferCurrentPtr(),
-                                                      cookedReadData.BufferCurrentPtr(),
-                                                      &cookedReadData.BytesRead(),
-                                                      &cookedReadData.VisibleCharCount(),
-                                                      cookedReadData.OriginalCursorPosition().X,
-                                                      WC_DESTRUCTIVE_BACKSPACE | WC_KEEP_CURSOR_VISIBLE | WC_ECHO,
-                                                      &ScrollY));
-        cookedReadData.OriginalCursorPosition().Y += ScrollY;
+        cookedReadData.RedrawFrom(unchanged,
+                                  shownCells,
+                                  WC_DESTRUCTIVE_BACKSPACE | WC_KEEP_CURSOR_VISIBLE | WC_ECHO,
+                                  Status,
+                                  ScrollY);
+    }
+    else if (cookedReadData.IsEchoInput())
+    {
+        Status = WriteCharsLegacy(cookedReadData.ScreenInfo(),
+                                  cookedReadData.BufferStartPtr(),
+                                  cookedReadData.BufferStartPtr(),
+                                  cookedReadData.BufferStartPtr(),
+                                  &cookedReadData.BytesRead(),
+                                  &cookedReadData.VisibleCharCount(),
+                                  cookedReadData.OriginalCursorPosition().X,
+                                  WC_DESTRUCTIVE_BACKSPACE | WC_KEEP_CURSOR_VISIBLE | WC_ECHO,
+                                  &ScrollY);
     }
+    FAIL_FAST_IF_NTSTATUS_FAILED(Status);
+    cookedReadData.OriginalCursorPosition().Y += ScrollY;
 
     size_t const CharsToWrite = cookedReadData.BytesRead() / sizeof(WCHAR);
     cookedReadData.InsertionPoint() = CharsToWrite;
@@ -461,6 +461,40 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
     return _WriteConsoleInputWImplHelper(*pInputBuffer, events, eventsWritten, append);
 }
 
+// Routine Description:
+// - Writes input records to the input buffer (private call)
+// Arguments:
+// - context - the input buffer to write to
+// - records - the records to write
+// - written  - on output, the number of events written
+// - append - true if events should be written to the end of the input
+// buffer, false if they should be written to the front
+// Return Value:
+// - HRESULT indicating success or failure
+[[nodiscard]] HRESULT DoSrvPrivateWriteConsoleInputW(_Inout_ InputBuffer* const pInputBuffer,
+                                                     const gsl::span<const INPUT_RECORD> records,
+                                                     _Out_ size_t& eventsWritten,
+                                                     const bool append) noexcept
+{
+    try
+    {
+        eventsWritten = 0;
+
+        // add to InputBuffer
+        if (append)
+        {
+            eventsWritten = pInputBuffer->Write(records);
+        }
+        else
+        {
+            eventsWritten = pInputBuffer->Prepend(records);
+        }
+
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
 // Routine Description:
 // - Writes events to the input buffer, translating from codepage to unicode first
 // Arguments:
@@ -858,43 +892,48 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
         // The final "request rectangle" or the area inside the buffer we want to read, is the clipped dimensions.
         const auto clippedRequestRectangle = Viewport::FromExclusive(clip);
 
-        // We will start reading the buffer at the point of the top left corner (origin) of the (potentially adjusted) request
-        const auto sourcePoint = clippedRequestRectangle.Origin();
+        // The clipped request has to be a non-empty area inside the storage buffer.
+        RETURN_HR_IF(E_INVALIDARG, !storageBuffer.GetBufferSize().IsInBounds(clippedRequestRectangle));
+        RETURN_HR_IF(E_INVALIDARG, !clippedRequestRectangle.IsInBounds(clippedRequestRectangle.Origin()));
 
-        // Get an iterator to the beginning of the return buffer
-        // We might have to seek this forward or skip around if we clipped the request.
-        auto targetIter = targetBuffer.begin();
-        COORD targetPos = { 0 };
-        const auto targetLimit = Viewport::FromDimensions(targetPoint, clippedRequestRectangle.Dimensions());
+        // Copy the request a whole row at a time. The chars and the DBCS attributes are read right out of
+        // the planes of the row, and the colors are only converted to legacy attributes once per run.
+        const auto& textBuffer = storageBuffer.GetTextBuffer();
+        const ptrdiff_t width = clippedRequestRectangle.Width();
+        std::vector<TextAttributeRun> runs;
 
-        // Get an iterator to the beginning of the request inside the screen buffer
-        // This should walk exactly along every cell of the clipped request.
-        auto sourceIter = storageBuffer.GetCellDataAt(sourcePoint, clippedRequestRectangle);
-
-        // Walk through every cell of the target, advancing the buffer.
-        // Validate that we always still have a valid iterator to the backing store,
-        // that we always are writing inside the user's buffer (before the end)
-        // and we're always targeting the user's buffer inside its original bounds.
-        while (sourceIter && targetIter < targetBuffer.end())
+        for (auto sourceY = clippedRequestRectangle.Top(); sourceY < clippedRequestRectangle.BottomExclusive(); sourceY++)
         {
-            // If the point we're trying to write is inside the limited buffer write zone...
-            if (targetLimit.IsInBounds(targetPos))
+            // Find where this row goes in the user's buffer, which we might have offset if we clipped the request.
+            // Stop early if the user's buffer is too short to hold all of it.
+            const ptrdiff_t targetRow = targetPoint.Y + (sourceY - clippedRequestRectangle.Top());
+            const ptrdiff_t targetOffset = targetRow * targetSize.X + targetPoint.X;
+            if (targetOffset >= targetBuffer.size())
             {
-                // Copy the data into position...
-                *targetIter = gci.AsCharInfo(*sourceIter);
-                // ... and advance the read iterator.
-                sourceIter++;
+                break;
             }
 
-            // Always advance the write iterator, we might have skipped it due to clipping.
-            targetIter++;
+            const auto count = std::min(width, targetBuffer.size() - targetOffset);
+            const auto target = targetBuffer.subspan(targetOffset, count);
+
+            const auto& row = textBuffer.GetRowByOffset(sourceY);
+            const auto chars = row.GetCharRow().Chars().subspan(clippedRequestRectangle.Left(), count);
+            const auto dbcsAttrs = row.GetCharRow().DbcsAttrs().subspan(clippedRequestRectangle.Left(), count);
 
-            // Increment the target
-            targetPos.X++;
-            if (targetPos.X >= targetSize.X)
+            runs.clear();
+            row.GetAttrRow().AppendRuns(clippedRequestRectangle.Left(), gsl::narrow_cast<size_t>(count), runs);
+
+            ptrdiff_t column = 0;
+            for (const auto& run : runs)
             {
-                targetPos.X = 0;
-                targetPos.Y++;
+                const auto legacyAttr = gci.GenerateLegacyAttributes(run.GetAttributes());
+                const auto runEnd = column + gsl::narrow<ptrdiff_t>(run.GetLength());
+                for (; column < runEnd; column++)
+                {
+                    auto& charInfo = til::at(target, column);
+                    charInfo.Char.UnicodeChar = til::at(chars, column);
+                    charInfo.Attributes = legacyAttr | til::at(dbcsAttrs, column).GeneratePublicApiAttributeFormat();
+                }
             }
         }
 
@@ -1042,12 +1081,8 @@ void EventsToUnicode(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
             // Now we make a subspan starting from that offset for as much of the original request as would fit
             const auto subspan = buffer.subspan(totalOffset, writeRectangle.Width());
 
-            // Convert to a CHAR_INFO view to fit into the iterator
-            const auto charInfos = std::basic_string_view<CHAR_INFO>(subspan.data(), subspan.size());
-
-            // Make the iterator and write to the target position.
-            OutputCellIterator it(charInfos);
-            storageBuffer.Write(it, target);
+            // Write the whole line of the request to the target position.
+            storageBuffer.GetTextBuffer().WriteCharInfos(subspan, target);
         }
 
         // Since we've managed to write part of the request, return the clamped part that we actually used.
@@ -351,9 +351,18 @@ void ApiRoutines::GetNumberOfConsoleMouseButtonsImpl(ULONG& buttons) noexcept
             WI_ClearFlag(gci.Flags, CONSOLE_USE_PRIVATE_FLAGS);
         }
 
+        const bool wasVtInput = WI_IsFlagSet(context.InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
         context.InputMode = mode;
         WI_ClearAllFlags(context.InputMode, PRIVATE_MODES);
 
+        // Clients in VT input mode ask the terminal for bracketed paste
+        // markers themselves. Everyone else gets them through conpty.
+        const bool isVtInput = WI_IsFlagSet(context.InputMode, ENABLE_VIRTUAL_TERMINAL_INPUT);
+        if (gci.IsInVtIoMode() && isVtInput != wasVtInput)
+        {
+            LOG_IF_FAILED(gci.GetVtIo()->SetBracketedPasteMode(!isVtInput));
+        }
+
         // NOTE: For compatibility reasons, we need to set the modes and then return the error codes, not the other way around
         //       as might be expected.
         //       This is a bug from a long time ago and some applications depend on this functionality to operate properly.
@@ -1587,6 +1596,20 @@ void DoSrvPrivateEnableAlternateScroll(const bool fEnable)
     gci.GetActiveInputBuffer()->GetTerminalInput().EnableAlternateScroll(fEnable);
 }
 
+// Routine Description:
+// - A private API call for beginning or ending a synchronized update. While
+//     one is in progress, the renderer doesn't paint any of the changes to the
+//     buffer, and then paints all of them at once when it ends.
+// Parameters:
+// - screenInfo - the screen buffer the application is writing to.
+// - fEnable - true to begin a synchronized update, false to end it.
+// Return value:
+// None
+void DoSrvPrivateEnableSynchronizedOutput(SCREEN_INFORMATION& screenInfo, const bool fEnable)
+{
+    screenInfo.GetRenderTarget().SetSynchronizedOutput(fEnable);
+}
+
 // Routine Description:
 // - A private API call for performing a VT-style erase all operation on the buffer.
 //      See SCREEN_INFORMATION::VtEraseAll's description for details.
@@ -2242,3 +2265,60 @@ void DoSrvPrivateMoveToBottom(SCREEN_INFORMATION& screenInfo)
     }
     CATCH_RETURN();
 }
+
+// Routine Description:
+// - A private API call for copying a rectangle of cells to another position
+//    in the screen buffer. Unlike a scroll, the source cells are left as is.
+// Arguments:
+// - screenInfo - Reference to screen buffer info.
+// - source - The inclusive rectangle of cells to copy.
+// - target - Upper left corner to copy the cells to.
+// Return value:
+// - S_OK or failure code from thrown exception
+[[nodiscard]] HRESULT DoSrvPrivateCopyRectangle(SCREEN_INFORMATION& screenInfo,
+                                                const SMALL_RECT source,
+                                                const COORD target) noexcept
+{
+    try
+    {
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+        const auto sourceRect = Viewport::FromInclusive(source);
+        screenInfo.GetTextBuffer().CopyRectangle(sourceRect, target);
+
+        // Notify accessibility
+        const auto targetRect = Viewport::FromDimensions(target, sourceRect.Dimensions());
+        screenInfo.NotifyAccessibilityEventing(targetRect.Left(), targetRect.Top(), targetRect.RightInclusive(), targetRect.BottomInclusive());
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
+
+// Routine Description:
+// - A private API call for filling a rectangle of cells in the screen buffer.
+// Arguments:
+// - screenInfo - Reference to screen buffer info.
+// - rect - The inclusive rectangle of cells to fill.
+// - fillChar - Character to fill the rectangle with.
+// - fillAttrs - Attributes to fill the rectangle with, or empty to keep the existing ones.
+// Return value:
+// - S_OK or failure code from thrown exception
+[[nodiscard]] HRESULT DoSrvPrivateFillRectangle(SCREEN_INFORMATION& screenInfo,
+                                                const SMALL_RECT rect,
+                                                const wchar_t fillChar,
+                                                const std::optional<TextAttribute> fillAttrs) noexcept
+{
+    try
+    {
+        LockConsole();
+        auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+        screenInfo.GetTextBuffer().FillRectangle(Viewport::FromInclusive(rect), fillChar, fillAttrs);
+
+        // Notify accessibility
+        screenInfo.NotifyAccessibilityEventing(rect.Left, rect.Top, rect.Right, rect.Bottom);
+        return S_OK;
+    }
+    CATCH_RETURN();
+}
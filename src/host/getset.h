@@ -48,6 +48,7 @@ void DoSrvPrivateEnableSGRExtendedMouseMode(const bool fEnable);
 void DoSrvPrivateEnableButtonEventMouseMode(const bool fEnable);
 void DoSrvPrivateEnableAnyEventMouseMode(const bool fEnable);
 void DoSrvPrivateEnableAlternateScroll(const bool fEnable);
+void DoSrvPrivateEnableSynchronizedOutput(SCREEN_INFORMATION& screenInfo, const bool fEnable);
 
 void DoSrvPrivateSetConsoleXtermTextAttribute(SCREEN_INFORMATION& screenInfo,
                                               const int iXtermTableEntry,
@@ -101,3 +102,12 @@ void DoSrvPrivateMoveToBottom(SCREEN_INFORMATION& screenInfo);
                                                const std::optional<SMALL_RECT> clipRect,
                                                const COORD destinationOrigin,
                                                const bool standardFillAttrs) noexcept;
+
+[[nodiscard]] HRESULT DoSrvPrivateCopyRectangle(SCREEN_INFORMATION& screenInfo,
+                                                const SMALL_RECT source,
+                                                const COORD target) noexcept;
+
+[[nodiscard]] HRESULT DoSrvPrivateFillRectangle(SCREEN_INFORMATION& screenInfo,
+                                                const SMALL_RECT rect,
+                                                const wchar_t fillChar,
+                                                const std::optional<TextAttribute> fillAttrs) noexcept;
@@ -24,23 +24,28 @@
 
 using Microsoft::Console::Interactivity::ServiceLocator;
 
-// I need to be a list because we rearrange elements inside to maintain a
-// "least recently used" state. Doing many rearrangement operations with
-// a list will maintain the iterator pointers as valid to the elements
-// (where other collections like deque do not.)
-// If CommandHistory::s_Allocate and friends stop shuffling elements
-// for maintaining LRU, then this datatype can be changed.
+// I need to be a list because the lookup tables below point at the elements,
+// and a list keeps those pointers valid no matter how many histories get added.
+// Which history was used least recently is tracked with _lastUsed instead of
+// the order of the list, so nothing ever has to be moved around.
 std::list<CommandHistory> CommandHistory::s_historyLists;
 
+// The allocated histories by the process they belong to.
+std::unordered_map<HANDLE, CommandHistory*> CommandHistory::s_historiesByProcess;
+
+// All histories by their lowercased app name. Several processes of the same app
+// can each have one, so the most recently used one has to be picked out of those.
+std::unordered_multimap<std::wstring, CommandHistory*> CommandHistory::s_historiesByApp;
+
+size_t CommandHistory::s_lastUsed = 0;
+
 CommandHistory* CommandHistory::s_Find(const HANDLE processHandle)
 {
-    for (auto& historyList : s_historyLists)
+    const auto it = s_historiesByProcess.find(processHandle);
+    if (it != s_historiesByProcess.end())
     {
-        if (historyList._processHandle == processHandle)
-        {
-            FAIL_FAST_IF(WI_IsFlagClear(historyList.Flags, CLE_ALLOCATED));
-            return &historyList;
-        }
+        FAIL_FAST_IF(WI_IsFlagClear(it->second->Flags, CLE_ALLOCATED));
+        return it->second;
     }
 
     return nullptr;
@@ -57,6 +62,7 @@ void CommandHistory::s_Free(const HANDLE processHandle)
     {
         WI_ClearFlag(History->Flags, CLE_ALLOCATED);
         History->_processHandle = nullptr;
+        s_historiesByProcess.erase(processHandle);
     }
 }
 
@@ -77,6 +83,71 @@ static bool CaseInsensitiveEquality(wchar_t a, wchar_t b)
     return ::towlower(a) == ::towlower(b);
 }
 
+// Routine Description:
+// - Lowercases the text the same way CaseInsensitiveEquality compares it,
+//   so that comparing folded strings gives the same result.
+std::wstring CommandHistory::_FoldCase(const std::wstring_view text)
+{
+    std::wstring folded(text.size(), UNICODE_NULL);
+    std::transform(text.cbegin(), text.cend(), folded.begin(), [](const wchar_t wch) { return gsl::narrow_cast<wchar_t>(::towlower(wch)); });
+    return folded;
+}
+
+// Routine Description:
+// - Records that the slot with the given sequence number holds the given command.
+void CommandHistory::_IndexInsert(const size_t sequence, const std::wstring_view command)
+{
+    auto& sequences = _index[_FoldCase(command)];
+    sequences.insert(std::upper_bound(sequences.cbegin(), sequences.cend(), sequence), sequence);
+}
+
+// Routine Description:
+// - Forgets that the slot with the given sequence number holds the given command.
+void CommandHistory::_IndexErase(const size_t sequence, const std::wstring_view command)
+{
+    const auto it = _index.find(_FoldCase(command));
+    if (it == _index.end())
+    {
+        return;
+    }
+
+    auto& sequences = it->second;
+    const auto found = std::lower_bound(sequences.cbegin(), sequences.cend(), sequence);
+    if (found != sequences.cend() && *found == sequence)
+    {
+        sequences.erase(found);
+    }
+
+    if (sequences.empty())
+    {
+        _index.erase(it);
+    }
+}
+
+// Routine Description:
+// - Numbers all slots anew and indexes their commands again.
+//   Used whenever _commands was changed wholesale.
+void CommandHistory::_RebuildIndex()
+{
+    _index.clear();
+    _sequences.clear();
+    _nextSequence = 0;
+
+    for (const auto& command : _commands)
+    {
+        _sequences.push_back(_nextSequence);
+        _IndexInsert(_nextSequence, command);
+        ++_nextSequence;
+    }
+}
+
+void CommandHistory::_ClearCommands() noexcept
+{
+    _commands.clear();
+    _sequences.clear();
+    _index.clear();
+}
+
 bool CommandHistory::IsAppNameMatch(const std::wstring_view other) const
 {
     return std::equal(_appName.cbegin(), _appName.cend(), other.cbegin(), other.cend(), CaseInsensitiveEquality);
@@ -124,7 +195,9 @@ void CommandHistory::_Reset()
             // find free record.  if all records are used, free the lru one.
             if ((SHORT)_commands.size() == _maxCommands)
             {
+                _IndexErase(_sequences.front(), _commands.front());
                 _commands.erase(_commands.cbegin());
+                _sequences.erase(_sequences.cbegin());
                 // move LastDisplayed back one in order to stay synced with the
                 // command it referred to before erasing the lru one
                 --LastDisplayed;
@@ -139,6 +212,9 @@ void CommandHistory::_Reset()
             {
                 _commands.emplace_back(newCommand);
             }
+            _sequences.push_back(_nextSequence);
+            _IndexInsert(_nextSequence, _commands.back());
+            ++_nextSequence;
 
             if (LastDisplayed == -1 ||
                 _commands.at(LastDisplayed).size() != newCommand.size() ||
@@ -248,7 +324,7 @@ std::wstring_view CommandHistory::GetLastCommand() const
 
 void CommandHistory::Empty()
 {
-    _commands.clear();
+    _ClearCommands();
     LastDisplayed = -1;
     WI_SetFlag(Flags, CLE_RESET);
 }
@@ -290,6 +366,7 @@ void CommandHistory::Realloc(const size_t commands)
     {
         _commands.emplace_back(oldCommands[i]);
     }
+    _RebuildIndex();
 
     WI_SetFlag(Flags, CLE_RESET);
     LastDisplayed = gsl::narrow<SHORT>(_commands.size()) - 1;
@@ -298,31 +375,59 @@ void CommandHistory::Realloc(const size_t commands)
 
 void CommandHistory::s_ReallocExeToFront(const std::wstring_view appName, const size_t commands)
 {
-    for (auto it = s_historyLists.begin(); it != s_historyLists.end(); it++)
+    CommandHistory* const history = s_FindByAppName(appName, true);
+    if (history)
     {
-        if (WI_IsFlagSet(it->Flags, CLE_ALLOCATED) && it->IsAppNameMatch(appName))
-        {
-            CommandHistory backup = *it;
-            backup.Realloc(commands);
+        history->Realloc(commands);
+        history->_lastUsed = ++s_lastUsed;
+    }
+}
 
-            s_historyLists.erase(it);
-            s_historyLists.push_front(backup);
+CommandHistory* CommandHistory::s_FindByExe(const std::wstring_view appName)
+{
+    return s_FindByAppName(appName, true);
+}
 
-            return;
+// Routine Description:
+// - Finds the most recently used history for the given app name.
+// Arguments:
+// - appName - the name of the app, matched case insensitively.
+// - allocated - whether to look for a history that is in use by a process, or one that is free.
+// Return Value:
+// - The history, or nullptr if there is none.
+CommandHistory* CommandHistory::s_FindByAppName(const std::wstring_view appName, const bool allocated)
+{
+    CommandHistory* best = nullptr;
+
+    const auto range = s_historiesByApp.equal_range(_FoldCase(appName));
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const auto history = it->second;
+        if (WI_IsFlagSet(history->Flags, CLE_ALLOCATED) == allocated && (!best || history->_lastUsed > best->_lastUsed))
+        {
+            best = history;
         }
     }
+
+    return best;
 }
 
-CommandHistory* CommandHistory::s_FindByExe(const std::wstring_view appName)
+// Routine Description:
+// - Changes the app name of this history, keeping the lookup by app name up to date.
+void CommandHistory::_SetAppName(const std::wstring_view appName)
 {
-    for (auto& historyList : s_historyLists)
+    const auto range = s_historiesByApp.equal_range(_FoldCase(_appName));
+    for (auto it = range.first; it != range.second; ++it)
     {
-        if (WI_IsFlagSet(historyList.Flags, CLE_ALLOCATED) && historyList.IsAppNameMatch(appName))
+        if (it->second == this)
         {
-            return &historyList;
+            s_historiesByApp.erase(it);
+            break;
         }
     }
-    return nullptr;
+
+    _appName = appName;
+    s_historiesByApp.emplace(_FoldCase(_appName), this);
 }
 
 size_t CommandHistory::s_CountOfHistories()
@@ -341,65 +446,53 @@ CommandHistory* CommandHistory::s_Allocate(const std::wstring_view appName, cons
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
     // Reuse a history buffer.  The buffer must be !CLE_ALLOCATED.
     // If possible, the buffer should have the same app name.
-    std::optional<CommandHistory> BestCandidate;
-    bool SameApp = false;
-
-    for (auto it = s_historyLists.cbegin(); it != s_historyLists.cend(); it++)
-    {
-        if (WI_IsFlagClear(it->Flags, CLE_ALLOCATED))
-        {
-            // use LRU history buffer with same app name
-            if (it->IsAppNameMatch(appName))
-            {
-                BestCandidate = *it;
-                SameApp = true;
-                s_historyLists.erase(it);
-                break;
-            }
-        }
-    }
+    // use LRU history buffer with same app name
+    CommandHistory* BestCandidate = s_FindByAppName(appName, false);
+    const bool SameApp = BestCandidate != nullptr;
 
     // if there isn't a free buffer for the app name and the maximum number of
     // command history buffers hasn't been allocated, allocate a new one.
     if (!SameApp && s_historyLists.size() < gci.GetNumberOfHistoryBuffers())
     {
-        CommandHistory History;
+        CommandHistory& History = s_historyLists.emplace_front();
 
-        History._appName = appName;
+        History._SetAppName(appName);
         History.Flags = CLE_ALLOCATED;
         History.LastDisplayed = -1;
         History._maxCommands = gsl::narrow<SHORT>(gci.GetHistoryBufferSize());
         History._processHandle = processHandle;
-        return &s_historyLists.emplace_front(History);
+        History._lastUsed = ++s_lastUsed;
+        s_historiesByProcess.insert_or_assign(processHandle, &History);
+        return &History;
     }
-    else if (!BestCandidate.has_value() && s_historyLists.size() > 0)
+    else if (!BestCandidate)
     {
-        // If we have no candidate already and we need one, take the LRU (which is the back/last one) which isn't allocated.
-        for (auto it = s_historyLists.crbegin(); it != s_historyLists.crend(); it++)
+        // If we have no candidate already and we need one, take the least recently used one which isn't allocated.
+        for (auto& history : s_historyLists)
         {
-            if (WI_IsFlagClear(it->Flags, CLE_ALLOCATED))
+            if (WI_IsFlagClear(history.Flags, CLE_ALLOCATED) && (!BestCandidate || history._lastUsed < BestCandidate->_lastUsed))
             {
-                BestCandidate = *it;
-                s_historyLists.erase(std::next(it).base()); // trickery to turn reverse iterator into forward iterator for erase.
-                break;
+                BestCandidate = &history;
             }
         }
     }
 
     // If the app name doesn't match, copy in the new app name and free the old commands.
-    if (BestCandidate.has_value())
+    if (BestCandidate)
     {
         if (!SameApp)
         {
-            BestCandidate->_commands.clear();
+            BestCandidate->_ClearCommands();
             BestCandidate->LastDisplayed = -1;
-            BestCandidate->_appName = appName;
+            BestCandidate->_SetAppName(appName);
         }
 
         BestCandidate->_processHandle = processHandle;
         WI_SetFlag(BestCandidate->Flags, CLE_ALLOCATED);
+        BestCandidate->_lastUsed = ++s_lastUsed;
+        s_historiesByProcess.insert_or_assign(processHandle, BestCandidate);
 
-        return &s_historyLists.emplace_front(BestCandidate.value());
+        return BestCandidate;
     }
 
     return nullptr;
@@ -472,6 +565,9 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
     {
         const auto str = _commands.at(iDel);
 
+        _IndexErase(_sequences.at(iDel), str);
+        _sequences.erase(_sequences.cbegin() + iDel);
+
         if (iDel < iLast)
         {
             _commands.erase(_commands.cbegin() + iDel);
@@ -529,22 +625,47 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 
     try
     {
-        for (size_t i = 0; i < _commands.size(); i++)
+        // Walking backwards from indexFound, the first match is the one with the highest sequence number
+        // that isn't past indexFound. If there is none, the search wraps around to the last match.
+        const auto startSequence = _sequences.at(indexFound);
+        std::optional<size_t> beforeStart;
+        std::optional<size_t> last;
+        const auto consider = [&](const std::vector<size_t>& sequences) {
+            const auto it = std::upper_bound(sequences.cbegin(), sequences.cend(), startSequence);
+            if (it != sequences.cbegin() && (!beforeStart || *(it - 1) > *beforeStart))
+            {
+                beforeStart = *(it - 1);
+            }
+            if (!last || sequences.back() > *last)
+            {
+                last = sequences.back();
+            }
+        };
+
+        const auto folded = _FoldCase(givenCommand);
+        if (WI_IsFlagSet(options, MatchOptions::ExactMatch))
         {
-            const auto& storedCommand = _commands.at(indexFound);
-            if ((WI_IsFlagClear(options, MatchOptions::ExactMatch) && (givenCommand.size() <= storedCommand.size())) || (givenCommand.size() == storedCommand.size()))
+            const auto it = _index.find(folded);
+            if (it != _index.end())
             {
-                if (std::equal(storedCommand.begin(),
-                               storedCommand.begin() + givenCommand.size(),
-                               givenCommand.begin(),
-                               givenCommand.end(),
-                               CaseInsensitiveEquality))
-                {
-                    return true;
-                }
+                consider(it->second);
             }
+        }
+        else
+        {
+            // All commands starting with the given one sort right after it.
+            for (auto it = _index.lower_bound(folded); it != _index.end() && it->first.compare(0, folded.size(), folded) == 0; ++it)
+            {
+                consider(it->second);
+            }
+        }
 
-            _Prev(indexFound);
+        const auto found = beforeStart ? beforeStart : last;
+        if (found)
+        {
+            const auto slot = std::lower_bound(_sequences.cbegin(), _sequences.cend(), *found);
+            indexFound = gsl::narrow<SHORT>(slot - _sequences.cbegin());
+            return true;
         }
     }
     CATCH_LOG();
@@ -555,6 +676,8 @@ std::wstring CommandHistory::Remove(const SHORT iDel)
 #ifdef UNIT_TESTING
 void CommandHistory::s_ClearHistoryListStorage()
 {
+    s_historiesByProcess.clear();
+    s_historiesByApp.clear();
     s_historyLists.clear();
 }
 #endif
@@ -566,7 +689,21 @@ void CommandHistory::s_ClearHistoryListStorage()
 // - indexB - index of one history item to swap
 void CommandHistory::Swap(const short indexA, const short indexB)
 {
-    std::swap(_commands.at(indexA), _commands.at(indexB));
+    auto& commandA = _commands.at(indexA);
+    auto& commandB = _commands.at(indexB);
+    if (indexA == indexB)
+    {
+        return;
+    }
+
+    // The slots keep their sequence numbers, only the commands move.
+    const auto sequenceA = _sequences.at(indexA);
+    const auto sequenceB = _sequences.at(indexB);
+    _IndexErase(sequenceA, commandA);
+    _IndexErase(sequenceB, commandB);
+    std::swap(commandA, commandB);
+    _IndexInsert(sequenceA, commandA);
+    _IndexInsert(sequenceB, commandB);
 }
 
 // Routine Description:
@@ -83,13 +83,33 @@ private:
     void _Dec(SHORT& ind) const;
     void _Inc(SHORT& ind) const;
 
+    static std::wstring _FoldCase(const std::wstring_view text);
+    void _IndexInsert(const size_t sequence, const std::wstring_view command);
+    void _IndexErase(const size_t sequence, const std::wstring_view command);
+    void _RebuildIndex();
+    void _ClearCommands() noexcept;
+
+    static CommandHistory* s_FindByAppName(const std::wstring_view appName, const bool allocated);
+    void _SetAppName(const std::wstring_view appName);
+
     std::vector<std::wstring> _commands;
     SHORT _maxCommands;
 
+    // Every slot in _commands has a sequence number, which only ever grow from the front to the back.
+    // _index maps the lowercased commands to the sequence numbers of the slots holding them,
+    // so that searches only need to look at the commands that match.
+    std::vector<size_t> _sequences;
+    std::map<std::wstring, std::vector<size_t>> _index;
+    size_t _nextSequence{ 0 };
+
     std::wstring _appName;
     HANDLE _processHandle;
+    size_t _lastUsed{ 0 }; // the higher, the more recently this history was handed out
 
     static std::list<CommandHistory> s_historyLists;
+    static std::unordered_map<HANDLE, CommandHistory*> s_historiesByProcess;
+    static std::unordered_multimap<std::wstring, CommandHistory*> s_historiesByApp;
+    static size_t s_lastUsed;
 
 public:
     DWORD Flags;
@@ -164,6 +164,74 @@ void InputBuffer::WakeUpReadersWaitingForData()
     WaitQueue.NotifyWaiters(false);
 }
 
+// Routine Description:
+// - Starts a batch of writes. Until the matching EndWriteBatch, writes only
+//   store their events and readers aren't woken up. Batches may be nested.
+// Arguments:
+// - None
+// Return Value:
+// - None
+// Note:
+// - The console lock must be held for the whole batch.
+void InputBuffer::BeginWriteBatch() noexcept
+{
+    ++_writeBatchDepth;
+}
+
+// Routine Description:
+// - Ends a batch of writes. When the outermost batch ends, the input event
+//   is set and readers are woken up once for everything written during it.
+// Arguments:
+// - None
+// Return Value:
+// - None
+// Note:
+// - The console lock must be held when calling this routine.
+void InputBuffer::EndWriteBatch() noexcept
+{
+    FAIL_FAST_IF(_writeBatchDepth == 0);
+    if (--_writeBatchDepth != 0)
+    {
+        return;
+    }
+
+    const bool setWaitEvent = std::exchange(_batchSetWaitEvent, false);
+    if (std::exchange(_batchWakeReaders, false))
+    {
+        try
+        {
+            _SignalReaders(setWaitEvent);
+        }
+        CATCH_LOG();
+    }
+}
+
+// Routine Description:
+// - Lets readers know that events were written, or remembers to do so
+//   later if a write batch is open.
+// Arguments:
+// - setWaitEvent - true if the input event needs to be set, because the
+//   buffer went from empty to non-empty.
+// Return Value:
+// - None
+void InputBuffer::_SignalReaders(const bool setWaitEvent)
+{
+    if (_writeBatchDepth != 0)
+    {
+        _batchSetWaitEvent |= setWaitEvent;
+        _batchWakeReaders = true;
+        return;
+    }
+
+    if (setWaitEvent)
+    {
+        ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
+    }
+
+    // Alert any writers waiting for space.
+    WakeUpReadersWaitingForData();
+}
+
 // Routine Description:
 // - Wakes up any readers waiting for data when a ctrl-c or ctrl-break is input.
 // Arguments:
@@ -212,10 +280,9 @@ void InputBuffer::Flush()
 // - The console lock must be held when calling this routine.
 void InputBuffer::FlushAllButKeys()
 {
-    auto newEnd = std::remove_if(_storage.begin(), _storage.end(), [](const std::unique_ptr<IInputEvent>& event) {
-        return event->EventType() != InputEventType::KeyEvent;
+    _storage.remove_if([](const INPUT_RECORD& record) noexcept {
+        return record.EventType != KEY_EVENT;
     });
-    _storage.erase(newEnd, _storage.end());
 }
 
 // Routine Description:
@@ -241,6 +308,51 @@ void InputBuffer::FlushAllButKeys()
                                          const bool WaitForData,
                                          const bool Unicode,
                                          const bool Stream)
+{
+    try
+    {
+        std::vector<INPUT_RECORD> records;
+        const auto Status = Read(records,
+                                 AmountToRead,
+                                 Peek,
+                                 WaitForData,
+                                 Unicode,
+                                 Stream);
+
+        for (const auto& record : records)
+        {
+            OutEvents.push_back(IInputEvent::Create(record));
+        }
+        return Status;
+    }
+    catch (...)
+    {
+        return NTSTATUS_FROM_HRESULT(wil::ResultFromCaughtException());
+    }
+}
+
+// Routine Description:
+// - This routine reads from the input buffer without creating an IInputEvent for every record.
+// - It otherwise behaves exactly like the IInputEvent based Read.
+// Note:
+// - The console lock must be held when calling this routine.
+// Arguments:
+// - outRecords - vector the read records are appended to
+// - AmountToRead - the amount of events to try to read
+// - Peek - If true, copy events to pInputRecord but don't remove them from the input buffer.
+// - WaitForData - if true, wait until an event is input (if there aren't enough to fill client buffer). if false, return immediately
+// - Unicode - true if the data in key events should be treated as unicode. false if they should be converted by the current input CP.
+// - Stream - true if read should unpack KeyEvents that have a >1 repeat count. AmountToRead must be 1 if Stream is true.
+// Return Value:
+// - STATUS_SUCCESS if records were read into the client buffer and everything is OK.
+// - CONSOLE_STATUS_WAIT if there weren't enough records to satisfy the request (and waits are allowed)
+// - otherwise a suitable memory/math/string error in NTSTATUS form.
+[[nodiscard]] NTSTATUS InputBuffer::Read(_Out_ std::vector<INPUT_RECORD>& outRecords,
+                                         const size_t AmountToRead,
+                                         const bool Peek,
+                                         const bool WaitForData,
+                                         const bool Unicode,
+                                         const bool Stream)
 {
     try
     {
@@ -254,10 +366,9 @@ void InputBuffer::FlushAllButKeys()
         }
 
         // read from buffer
-        std::deque<std::unique_ptr<IInputEvent>> events;
         size_t eventsRead;
         bool resetWaitEvent;
-        _ReadBuffer(events,
+        _ReadBuffer(outRecords,
                     AmountToRead,
                     eventsRead,
                     Peek,
@@ -265,13 +376,6 @@ void InputBuffer::FlushAllButKeys()
                     Unicode,
                     Stream);
 
-        // copy events to outEvents
-        while (!events.empty())
-        {
-            OutEvents.push_back(std::move(events.front()));
-            events.pop_front();
-        }
-
         if (resetWaitEvent)
         {
             ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
@@ -309,16 +413,16 @@ void InputBuffer::FlushAllButKeys()
     NTSTATUS Status;
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
-        Status = Read(outEvents,
+        std::vector<INPUT_RECORD> records;
+        Status = Read(records,
                       1,
                       Peek,
                       WaitForData,
                       Unicode,
                       Stream);
-        if (!outEvents.empty())
+        if (!records.empty())
         {
-            outEvent.swap(outEvents.front());
+            outEvent = IInputEvent::Create(records.front());
         }
     }
     catch (...)
@@ -332,7 +436,7 @@ void InputBuffer::FlushAllButKeys()
 // Routine Description:
 // - This routine reads from a buffer. It does the buffer manipulation.
 // Arguments:
-// - outEvents - where read events are placed
+// - outRecords - where read records are appended
 // - readCount - amount of events to read
 // - eventsRead - where to store number of events read
 // - peek - if true , don't remove data from buffer, just copy it.
@@ -343,7 +447,7 @@ void InputBuffer::FlushAllButKeys()
 // - <none>
 // Note:
 // - The console lock must be held when calling this routine.
-void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+void InputBuffer::_ReadBuffer(_Out_ std::vector<INPUT_RECORD>& outRecords,
                               const size_t readCount,
                               _Out_ size_t& eventsRead,
                               const bool peek,
@@ -356,94 +460,55 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
     FAIL_FAST_IF(streamRead && readCount != 1);
 
     resetWaitEvent = false;
+    eventsRead = 0;
 
-    std::deque<std::unique_ptr<IInputEvent>> readEvents;
     // we need another var to keep track of how many we've read
     // because dbcs records count for two when we aren't doing a
     // unicode read but the eventsRead count should return the number
     // of events actually put into outRecords.
     size_t virtualReadCount = 0;
+    // the amount of records to remove from the front of the storage
+    // once we're done. Records are only copied out until then, which
+    // means peeking doesn't need to put anything back.
+    size_t consumed = 0;
 
-    while (!_storage.empty() && virtualReadCount < readCount)
+    while (consumed < _storage.size() && virtualReadCount < readCount)
     {
-        bool performNormalRead = true;
+        auto record = _storage[consumed];
+
         // for stream reads we need to split any key events that have been coalesced
-        if (streamRead)
+        if (streamRead &&
+            record.EventType == KEY_EVENT &&
+            record.Event.KeyEvent.wRepeatCount > 1)
         {
-            if (_storage.front()->EventType() == InputEventType::KeyEvent)
+            record.Event.KeyEvent.wRepeatCount = 1;
+            if (!peek)
             {
-                KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.front().get());
-                if (pKeyEvent->GetRepeatCount() > 1)
-                {
-                    // split the key event
-                    std::unique_ptr<KeyEvent> streamKeyEvent = std::make_unique<KeyEvent>(*pKeyEvent);
-                    streamKeyEvent->SetRepeatCount(1);
-                    readEvents.push_back(std::move(streamKeyEvent));
-                    pKeyEvent->SetRepeatCount(pKeyEvent->GetRepeatCount() - 1);
-                    performNormalRead = false;
-                }
+                --_storage[consumed].Event.KeyEvent.wRepeatCount;
             }
         }
-
-        if (performNormalRead)
+        else
         {
-            readEvents.push_back(std::move(_storage.front()));
-            _storage.pop_front();
+            ++consumed;
         }
 
+        outRecords.push_back(record);
+        ++eventsRead;
+
         ++virtualReadCount;
         if (!unicode)
         {
-            if (readEvents.back()->EventType() == InputEventType::KeyEvent)
+            if (record.EventType == KEY_EVENT &&
+                IsGlyphFullWidth(record.Event.KeyEvent.uChar.UnicodeChar))
             {
-                const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(readEvents.back().get());
-                if (IsGlyphFullWidth(pKeyEvent->GetCharData()))
-                {
-                    ++virtualReadCount;
-                }
+                ++virtualReadCount;
             }
         }
     }
 
-    // the amount of events that were actually read
-    eventsRead = readEvents.size();
-
-    // copy the events back if we were supposed to peek
-    if (peek)
+    if (!peek)
     {
-        if (streamRead)
-        {
-            // we need to check and see if the event was split from a coalesced key event
-            // or if it was unrelated to the current front event in storage
-            if (!readEvents.empty() &&
-                !_storage.empty() &&
-                readEvents.back()->EventType() == InputEventType::KeyEvent &&
-                _storage.front()->EventType() == InputEventType::KeyEvent &&
-                _CanCoalesce(static_cast<const KeyEvent&>(*readEvents.back()),
-                             static_cast<const KeyEvent&>(*_storage.front())))
-            {
-                KeyEvent& keyEvent = static_cast<KeyEvent&>(*_storage.front());
-                keyEvent.SetRepeatCount(keyEvent.GetRepeatCount() + 1);
-            }
-            else
-            {
-                _storage.push_front(IInputEvent::Create(readEvents.back()->ToInputRecord()));
-            }
-        }
-        else
-        {
-            for (auto it = readEvents.crbegin(); it != readEvents.crend(); ++it)
-            {
-                _storage.push_front(IInputEvent::Create((*it)->ToInputRecord()));
-            }
-        }
-    }
-
-    // move events read to proper deque
-    while (!readEvents.empty())
-    {
-        outEvents.push_back(std::move(readEvents.front()));
-        readEvents.pop_front();
+        _storage.pop_front(consumed);
     }
 
     // signal if we emptied the buffer
@@ -457,19 +522,42 @@ void InputBuffer::_ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& ou
 // -  Writes events to the beginning of the input buffer.
 // Arguments:
 // - inEvents - events to write to buffer.
-// - eventsWritten - The number of events written to the buffer on exit.
 // Return Value:
-// S_OK if successful.
+// - The number of events that were written to the buffer.
 // Note:
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Prepend(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// -  Writes records to the beginning of the input buffer.
+// Arguments:
+// - inRecords - records to write to buffer.
+// Return Value:
+// - The number of events that were written to the buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Prepend(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> filteredRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, filteredRecords);
+        if (records.empty())
         {
             return STATUS_SUCCESS;
         }
@@ -478,23 +566,28 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // this way to handle any coalescing that might occur.
 
         // get all of the existing records, "emptying" the buffer
-        std::deque<std::unique_ptr<IInputEvent>> existingStorage;
-        existingStorage.swap(_storage);
+        std::vector<INPUT_RECORD> existingRecords;
+        existingRecords.reserve(_storage.size());
+        for (size_t i = 0; i < _storage.size(); ++i)
+        {
+            existingRecords.push_back(_storage[i]);
+        }
+        _storage.clear();
 
         // We will need this variable to pass to _WriteBuffer so it can attempt to determine wait status.
-        // However, because we swapped the storage out from under it with an empty deque, it will always
-        // return true after the first one (as it is filling the newly emptied backing deque.)
+        // However, because we emptied the storage out from under it, it will always
+        // return true after the first one (as it is filling the newly emptied storage.)
         // Then after the second one, because we've inserted some input, it will always say false.
         bool unusedWaitStatus = false;
 
         // write the prepend records
         size_t prependEventsWritten;
-        _WriteBuffer(inEvents, prependEventsWritten, unusedWaitStatus);
+        _WriteBuffer(records, prependEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(unusedWaitStatus));
 
         // write all previously existing records
         size_t existingEventsWritten;
-        _WriteBuffer(existingStorage, existingEventsWritten, unusedWaitStatus);
+        _WriteBuffer(existingRecords, existingEventsWritten, unusedWaitStatus);
         FAIL_FAST_IF(!(!unusedWaitStatus));
 
         // We need to set the wait event if there were 0 events in the
@@ -502,9 +595,9 @@ size_t InputBuffer::Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& in
         // Because we did interesting manipulation of the wait queue
         // in order to prepend, we can't trust what _WriteBuffer said
         // and instead need to set the event if the original backing
-        // buffer (the one we swapped out at the top) was empty
+        // buffer (the one we emptied at the top) was empty
         // when this whole thing started.
-        if (existingStorage.empty())
+        if (existingRecords.empty())
         {
             ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
         }
@@ -534,9 +627,9 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 {
     try
     {
-        std::deque<std::unique_ptr<IInputEvent>> inEvents;
-        inEvents.push_back(std::move(inEvent));
-        return Write(inEvents);
+        const auto record = inEvent->ToInputRecord();
+        inEvent.reset();
+        return Write(gsl::span<const INPUT_RECORD>{ &record, 1 });
     }
     catch (...)
     {
@@ -555,13 +648,38 @@ size_t InputBuffer::Write(_Inout_ std::unique_ptr<IInputEvent> inEvent)
 // Note:
 // - The console lock must be held when calling this routine.
 size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+{
+    try
+    {
+        const auto records = IInputEvent::ToInputRecords(inEvents);
+        inEvents.clear();
+        return Write(records);
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return 0;
+    }
+}
+
+// Routine Description:
+// - Writes records to the input buffer. Wakes up any readers that are
+// waiting for additional input events.
+// Arguments:
+// - inRecords - input records to store in the buffer.
+// Return Value:
+// - The number of events that were written to input buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::Write(const gsl::span<const INPUT_RECORD> inRecords)
 {
     try
     {
         _vtInputShouldSuppress = true;
         auto resetVtInputSuppress = wil::scope_exit([&]() { _vtInputShouldSuppress = false; });
-        _HandleConsoleSuspensionEvents(inEvents);
-        if (inEvents.empty())
+        std::vector<INPUT_RECORD> filteredRecords;
+        const auto records = _HandleConsoleSuspensionEvents(inRecords, filteredRecords);
+        if (records.empty())
         {
             return 0;
         }
@@ -569,15 +687,9 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
         // Write to buffer.
         size_t EventsWritten;
         bool SetWaitEvent;
-        _WriteBuffer(inEvents, EventsWritten, SetWaitEvent);
+        _WriteBuffer(records, EventsWritten, SetWaitEvent);
 
-        if (SetWaitEvent)
-        {
-            ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
-        }
-
-        // Alert any writers waiting for space.
-        WakeUpReadersWaitingForData();
+        _SignalReaders(SetWaitEvent);
         return EventsWritten;
     }
     catch (...)
@@ -588,9 +700,92 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 }
 
 // Routine Description:
-// - Coalesces input events and transfers them to storage queue.
+// - Reads a run of plainly typed text from the front of the buffer.
+// - This is what a paste turns into: a key down and a key up per character,
+//   with shift pressed and released around upper case ones. The run ends at
+//   the first event that a stream read (see GetChar) handles on its own:
+//   - control characters, command line editing keys and repeated keys,
+//   - anything with ctrl, alt or the enhanced key flag in its modifier
+//     state, which cooked reads hand back to the client,
+//   - releasing alt, which can produce a character typed on the numpad,
+//   - pressing any modifier other than shift, and anything but key events.
+//   - releasing any other key than shift or the last one in the run.
+//   The key ups and shift presses left are ones that a stream read skips
+//   without looking at them, so they're consumed along with the run.
 // Arguments:
-// - inRecords - The events to store.
+// - text - receives the characters of the run.
+// - maxChars - the most characters to read.
+// Return Value:
+// - The number of characters read into text.
+// Note:
+// - The console lock must be held when calling this routine.
+size_t InputBuffer::ReadTextRun(std::wstring& text, const size_t maxChars)
+{
+    text.clear();
+
+    WORD lastVirtualKey = 0;
+    size_t consumed = 0;
+    for (; consumed < _storage.size(); ++consumed)
+    {
+        const auto& record = _storage[consumed];
+        if (record.EventType != KEY_EVENT)
+        {
+            break;
+        }
+
+        const auto& keyEvent = record.Event.KeyEvent;
+        const wchar_t wch = keyEvent.uChar.UnicodeChar;
+        if (WI_IsAnyFlagSet(keyEvent.dwControlKeyState, CTRL_PRESSED | ALT_PRESSED | ENHANCED_KEY) ||
+            keyEvent.wVirtualKeyCode == VK_MENU)
+        {
+            break;
+        }
+
+        if (!keyEvent.bKeyDown)
+        {
+            // Only the releases of the keys in the run belong to it.
+            if (keyEvent.wVirtualKeyCode != lastVirtualKey && keyEvent.wVirtualKeyCode != VK_SHIFT)
+            {
+                break;
+            }
+            continue;
+        }
+
+        if (text.size() == maxChars)
+        {
+            break;
+        }
+
+        if (keyEvent.wVirtualKeyCode == VK_SHIFT)
+        {
+            continue;
+        }
+
+        if (wch < UNICODE_SPACE ||
+            wch == UNICODE_DEL ||
+            keyEvent.wRepeatCount != 1 ||
+            KeyEvent{ keyEvent }.IsCommandLineEditingKey())
+        {
+            break;
+        }
+
+        text.push_back(wch);
+        lastVirtualKey = keyEvent.wVirtualKeyCode;
+    }
+
+    _storage.pop_front(consumed);
+    if (_storage.empty())
+    {
+        ServiceLocator::LocateGlobals().hInputEvent.ResetEvent();
+    }
+
+    return text.size();
+}
+
+// Routine Description:
+// - Coalesces input records and transfers them to storage queue.
+// Arguments:
+// - inRecords - The records to store.
 // - eventsWritten - The number of events written since this function
 // was called.
 // - setWaitEvent - on exit, true if buffer became non-empty.
@@ -599,28 +794,31 @@ size_t InputBuffer::Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEv
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw on failure
-void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents,
+void InputBuffer::_WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                                _Out_ size_t& eventsWritten,
                                _Out_ bool& setWaitEvent)
 {
     eventsWritten = 0;
     setWaitEvent = false;
     const bool initiallyEmptyQueue = _storage.empty();
-    const size_t initialInEventsSize = inEvents.size();
+    const size_t initialInEventsSize = inRecords.size();
     const bool vtInputMode = IsInVirtualTerminalInputMode();
 
-    while (!inEvents.empty())
+    // Make room for everything up front, so that large writes grow the storage once.
+    if (!vtInputMode)
+    {
+        _storage.reserve(_storage.size() + initialInEventsSize);
+    }
+
+    for (const auto& inRecord : inRecords)
     {
-        // Pop the next event.
         // If we're in vt mode, try and handle it with the vt input module.
         // If it was handled, do nothing else for it.
         // If there was one event passed in, try coalescing it with the previous event currently in the buffer.
         // If it's not coalesced, append it to the buffer.
-        std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-        inEvents.pop_front();
         if (vtInputMode)
         {
-            const bool handled = _termInput.HandleKey(inEvent.get());
+            const bool handled = _WriteToTerminalInput(inRecord);
             if (handled)
             {
                 eventsWritten++;
@@ -634,40 +832,17 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
         // that was depending on it.
         if (initialInEventsSize == 1 && !_storage.empty())
         {
-            // coalescing requires a deque of events, so push it back onto the front.
-            inEvents.push_front(std::move(inEvent));
-
-            bool coalesced = false;
             // this looks kinda weird but we don't want to coalesce a
             // mouse event and then try to coalesce a key event right after.
-            //
-            // we also pass the whole deque to the coalescing methods
-            // even though they only want one event because it should
-            // be their responsibility to maintain the correct state
-            // of the deque if they process any records in it.
-            if (_CoalesceMouseMovedEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            else if (_CoalesceRepeatedKeyPressEvents(inEvents))
-            {
-                coalesced = true;
-            }
-            if (coalesced)
+            if (_CoalesceMouseMovedEvents(inRecord) ||
+                _CoalesceRepeatedKeyPressEvents(inRecord))
             {
                 eventsWritten = 1;
                 return;
             }
-            else
-            {
-                // We didn't coalesce the event. pull it from the queue again,
-                //  to keep the state consistent with the start of this block.
-                inEvent = std::move(inEvents.front());
-                inEvents.pop_front();
-            }
         }
         // At this point, the event was neither coalesced, nor processed by VT.
-        _storage.push_back(std::move(inEvent));
+        _storage.push_back(inRecord);
         ++eventsWritten;
     }
     if (initiallyEmptyQueue && !_storage.empty())
@@ -677,67 +852,97 @@ void InputBuffer::_WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>&
 }
 
 // Routine Description:
-// - Checks if the last saved event and the first event of inRecords are
+// - Hands a record to the vt input module.
+// - TerminalInput only deals in IInputEvents, so this wraps the record in
+//   one for the duration of the call, without allocating it.
+// Arguments:
+// - inRecord - The record to translate.
+// Return Value:
+// - true if the vt input module handled the record, false if it should be
+//   stored as is.
+bool InputBuffer::_WriteToTerminalInput(const INPUT_RECORD& inRecord)
+{
+    switch (inRecord.EventType)
+    {
+    case KEY_EVENT:
+    {
+        const KeyEvent event{ inRecord.Event.KeyEvent };
+        return _termInput.HandleKey(&event);
+    }
+    case MOUSE_EVENT:
+    {
+        const MouseEvent event{ inRecord.Event.MouseEvent };
+        return _termInput.HandleKey(&event);
+    }
+    case WINDOW_BUFFER_SIZE_EVENT:
+    {
+        const WindowBufferSizeEvent event{ inRecord.Event.WindowBufferSizeEvent };
+        return _termInput.HandleKey(&event);
+    }
+    case MENU_EVENT:
+    {
+        const MenuEvent event{ inRecord.Event.MenuEvent };
+        return _termInput.HandleKey(&event);
+    }
+    case FOCUS_EVENT:
+    {
+        const FocusEvent event{ inRecord.Event.FocusEvent };
+        return _termInput.HandleKey(&event);
+    }
+    default:
+        THROW_HR(E_INVALIDARG);
+    }
+}
+
+// Routine Description:
+// - Checks if the last saved event and inRecord are
 // both MOUSE_MOVED events. If they are, the last saved event is
-// updated with the new mouse position and the first event of inRecords is
-// dropped.
+// updated with the new mouse position and inRecord is dropped.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
+// - The storage must not be empty.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::MouseEvent &&
-        pLastStoredEvent->EventType() == InputEventType::MouseEvent)
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == MOUSE_EVENT &&
+        lastRecord.EventType == MOUSE_EVENT &&
+        inRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED &&
+        lastRecord.Event.MouseEvent.dwEventFlags == MOUSE_MOVED)
     {
-        const MouseEvent* const pInMouseEvent = static_cast<const MouseEvent* const>(pFirstInEvent);
-        const MouseEvent* const pLastMouseEvent = static_cast<const MouseEvent* const>(pLastStoredEvent);
-
-        if (pInMouseEvent->IsMouseMoveEvent() &&
-            pLastMouseEvent->IsMouseMoveEvent())
-        {
-            // update mouse moved position
-            MouseEvent* const pMouseEvent = static_cast<MouseEvent* const>(_storage.back().release());
-            pMouseEvent->SetPosition(pInMouseEvent->GetPosition());
-            std::unique_ptr<IInputEvent> tempPtr(pMouseEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
-            return true;
-        }
+        // update mouse moved position
+        lastRecord.Event.MouseEvent.dwMousePosition = inRecord.Event.MouseEvent.dwMousePosition;
+        return true;
     }
     return false;
 }
 
 // Routine Description:
-// - checks two KeyEvents to see if they're similar enough to be coalesced
+// - checks two key event records to see if they're similar enough to be coalesced
 // Arguments:
-// - a - the first KeyEvent
-// - b - the other KeyEvent
+// - a - the first key event record
+// - b - the other key event record
 // Return Value:
 // - true if the events could be coalesced, false otherwise
-bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept
+bool InputBuffer::_CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept
 {
-    if (WI_IsFlagSet(a.GetActiveModifierKeys(), NLS_IME_CONVERSION) &&
-        a.GetCharData() == b.GetCharData() &&
-        a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    if (WI_IsFlagSet(a.dwControlKeyState, NLS_IME_CONVERSION) &&
+        a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+        a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
     // other key events check
-    else if (a.GetVirtualScanCode() == b.GetVirtualScanCode() &&
-             a.GetCharData() == b.GetCharData() &&
-             a.GetActiveModifierKeys() == b.GetActiveModifierKeys())
+    else if (a.wVirtualScanCode == b.wVirtualScanCode &&
+             a.uChar.UnicodeChar == b.uChar.UnicodeChar &&
+             a.dwControlKeyState == b.dwControlKeyState)
     {
         return true;
     }
@@ -745,44 +950,36 @@ bool InputBuffer::_CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexc
 }
 
 // Routine Description::
-// - If the last input event saved and the first input event in inRecords
-// are both a keypress down event for the same key, update the repeat
-// count of the saved event and drop the first from inRecords.
+// - If the last input event saved and inRecord are both a keypress down
+// event for the same key, update the repeat count of the saved event and
+// drop inRecord.
 // Arguments:
-// - inRecords - The incoming records to process.
+// - inRecord - The incoming record to process.
 // Return Value:
 // true if events were coalesced, false if they were not.
 // Note:
-// - The size of inRecords must be 1.
+// - The storage must not be empty.
 // - Coalescing here means updating a record that already exists in
 // the buffer with updated values from an incoming event, instead of
 // storing the incoming event (which would make the original one
 // redundant/out of date with the most current state).
-bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+bool InputBuffer::_CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord)
 {
-    FAIL_FAST_IF(!(inEvents.size() == 1));
     FAIL_FAST_IF(_storage.empty());
-    const IInputEvent* const pFirstInEvent = inEvents.front().get();
-    const IInputEvent* const pLastStoredEvent = _storage.back().get();
-    if (pFirstInEvent->EventType() == InputEventType::KeyEvent &&
-        pLastStoredEvent->EventType() == InputEventType::KeyEvent)
-    {
-        const KeyEvent* const pInKeyEvent = static_cast<const KeyEvent* const>(pFirstInEvent);
-        const KeyEvent* const pLastKeyEvent = static_cast<const KeyEvent* const>(pLastStoredEvent);
-
-        if (pInKeyEvent->IsKeyDown() &&
-            pLastKeyEvent->IsKeyDown() &&
-            !IsGlyphFullWidth(pInKeyEvent->GetCharData()) &&
-            _CanCoalesce(*pInKeyEvent, *pLastKeyEvent))
+    auto& lastRecord = _storage.back();
+    if (inRecord.EventType == KEY_EVENT &&
+        lastRecord.EventType == KEY_EVENT)
+    {
+        const auto& inKeyEvent = inRecord.Event.KeyEvent;
+        auto& lastKeyEvent = lastRecord.Event.KeyEvent;
+
+        if (inKeyEvent.bKeyDown &&
+            lastKeyEvent.bKeyDown &&
+            !IsGlyphFullWidth(inKeyEvent.uChar.UnicodeChar) &&
+            _CanCoalesce(inKeyEvent, lastKeyEvent))
         {
             // increment repeat count
-            KeyEvent* const pKeyEvent = static_cast<KeyEvent* const>(_storage.back().release());
-            WORD repeatCount = pKeyEvent->GetRepeatCount() + pInKeyEvent->GetRepeatCount();
-            pKeyEvent->SetRepeatCount(repeatCount);
-            std::unique_ptr<IInputEvent> tempPtr(pKeyEvent);
-            tempPtr.swap(_storage.back());
-
-            inEvents.pop_front();
+            lastKeyEvent.wRepeatCount = gsl::narrow_cast<WORD>(lastKeyEvent.wRepeatCount + inKeyEvent.wRepeatCount);
             return true;
         }
     }
@@ -792,42 +989,66 @@ bool InputBuffer::_CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique
 // Routine Description:
 // - Handles records that suspend/resume the console.
 // Arguments:
-// - records - records to check for pause/unpause events
+// - inRecords - records to check for pause/unpause events
+// - filteredRecords - storage for the remaining records, used only if
+//   some of them had to be removed
 // Return Value:
-// - None
+// - The records that should be written to the buffer. This is inRecords
+//   itself unless some of them were pause/unpause events.
 // Note:
 // - The console lock must be held when calling this routine.
 // - will throw exception on error
-void InputBuffer::_HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents)
+gsl::span<const INPUT_RECORD> InputBuffer::_HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                          _Inout_ std::vector<INPUT_RECORD>& filteredRecords)
 {
-    CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-
-    std::deque<std::unique_ptr<IInputEvent>> outEvents;
-    while (!inEvents.empty())
+    bool filtering = false;
+    for (auto it = inRecords.begin(); it != inRecords.end(); ++it)
     {
-        std::unique_ptr<IInputEvent> currEvent = std::move(inEvents.front());
-        inEvents.pop_front();
-        if (currEvent->EventType() == InputEventType::KeyEvent)
+        if (_HandleConsoleSuspensionEvent(*it))
         {
-            const KeyEvent* const pKeyEvent = static_cast<const KeyEvent* const>(currEvent.get());
-            if (pKeyEvent->IsKeyDown())
+            // Only start copying once the first record is dropped.
+            // Most writes don't contain any, so they're passed through as is.
+            if (!filtering)
             {
-                if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
-                    !IsSystemKey(pKeyEvent->GetVirtualKeyCode()))
-                {
-                    UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
-                    continue;
-                }
-                else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && pKeyEvent->IsPauseKey())
-                {
-                    WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
-                    continue;
-                }
+                filteredRecords.assign(inRecords.begin(), it);
+                filtering = true;
             }
         }
-        outEvents.push_back(std::move(currEvent));
+        else if (filtering)
+        {
+            filteredRecords.push_back(*it);
+        }
+    }
+    return filtering ? gsl::span<const INPUT_RECORD>{ filteredRecords } : inRecords;
+}
+
+// Routine Description:
+// - Suspends or resumes the console if the record is a pause/unpause event.
+// Arguments:
+// - inRecord - the record to check
+// Return Value:
+// - true if the record was consumed and mustn't be written to the buffer.
+// Note:
+// - The console lock must be held when calling this routine.
+bool InputBuffer::_HandleConsoleSuspensionEvent(const INPUT_RECORD& inRecord)
+{
+    if (inRecord.EventType == KEY_EVENT && inRecord.Event.KeyEvent.bKeyDown)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const auto virtualKeyCode = inRecord.Event.KeyEvent.wVirtualKeyCode;
+        if (WI_IsFlagSet(gci.Flags, CONSOLE_SUSPENDED) &&
+            !IsSystemKey(virtualKeyCode))
+        {
+            UnblockWriteConsole(CONSOLE_OUTPUT_SUSPENDED);
+            return true;
+        }
+        else if (WI_IsFlagSet(InputMode, ENABLE_LINE_INPUT) && virtualKeyCode == VK_PAUSE)
+        {
+            WI_SetFlag(gci.Flags, CONSOLE_SUSPENDED);
+            return true;
+        }
     }
-    inEvents.swap(outEvents);
+    return false;
 }
 
 // Routine Description:
@@ -853,17 +1074,16 @@ void InputBuffer::_HandleTerminalInputCallback(std::deque<std::unique_ptr<IInput
     try
     {
         // add all input events to the storage queue
-        while (!inEvents.empty())
+        _storage.reserve(_storage.size() + inEvents.size());
+        for (const auto& inEvent : inEvents)
         {
-            std::unique_ptr<IInputEvent> inEvent = std::move(inEvents.front());
-            inEvents.pop_front();
-            _storage.push_back(std::move(inEvent));
+            _storage.push_back(inEvent->ToInputRecord());
         }
+        inEvents.clear();
 
         if (!_vtInputShouldSuppress)
         {
-            ServiceLocator::LocateGlobals().hInputEvent.SetEvent();
-            WakeUpReadersWaitingForData();
+            _SignalReaders(true);
         }
     }
     catch (...)
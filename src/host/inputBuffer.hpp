@@ -19,6 +19,7 @@ Revision History:
 #pragma once
 
 #include "inputReadHandleData.h"
+#include "inputRecordQueue.hpp"
 #include "readData.hpp"
 #include "../types/inc/IInputEvent.hpp"
 
@@ -50,6 +51,8 @@ public:
 
     void ReinitializeInputBuffer();
     void WakeUpReadersWaitingForData();
+    void BeginWriteBatch() noexcept;
+    void EndWriteBatch() noexcept;
     void TerminateRead(_In_ WaitTerminationReason Flag);
     size_t GetNumberOfReadyEvents() const noexcept;
     void Flush();
@@ -62,6 +65,13 @@ public:
                                 const bool Unicode,
                                 const bool Stream);
 
+    [[nodiscard]] NTSTATUS Read(_Out_ std::vector<INPUT_RECORD>& outRecords,
+                                const size_t AmountToRead,
+                                const bool Peek,
+                                const bool WaitForData,
+                                const bool Unicode,
+                                const bool Stream);
+
     [[nodiscard]] NTSTATUS Read(_Out_ std::unique_ptr<IInputEvent>& inEvent,
                                 const bool Peek,
                                 const bool WaitForData,
@@ -69,15 +79,19 @@ public:
                                 const bool Stream);
 
     size_t Prepend(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Prepend(const gsl::span<const INPUT_RECORD> inRecords);
 
     size_t Write(_Inout_ std::unique_ptr<IInputEvent> inEvent);
     size_t Write(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    size_t Write(const gsl::span<const INPUT_RECORD> inRecords);
+
+    size_t ReadTextRun(std::wstring& text, const size_t maxChars);
 
     bool IsInVirtualTerminalInputMode() const;
     Microsoft::Console::VirtualTerminal::TerminalInput& GetTerminalInput();
 
 private:
-    std::deque<std::unique_ptr<IInputEvent>> _storage;
+    InputRecordQueue _storage;
     std::unique_ptr<IInputEvent> _readPartialByteSequence;
     std::unique_ptr<IInputEvent> _writePartialByteSequence;
     Microsoft::Console::VirtualTerminal::TerminalInput _termInput;
@@ -88,7 +102,15 @@ private:
     // Otherwise, we should be calling them.
     bool _vtInputShouldSuppress{ false };
 
-    void _ReadBuffer(_Out_ std::deque<std::unique_ptr<IInputEvent>>& outEvents,
+    // While a write batch is open, waking up readers is deferred until the
+    // batch ends, so that a large paste signals them once instead of per key.
+    size_t _writeBatchDepth{ 0 };
+    bool _batchSetWaitEvent{ false };
+    bool _batchWakeReaders{ false };
+
+    void _SignalReaders(const bool setWaitEvent);
+
+    void _ReadBuffer(_Out_ std::vector<INPUT_RECORD>& outRecords,
                      const size_t readCount,
                      _Out_ size_t& eventsRead,
                      const bool peek,
@@ -96,14 +118,18 @@ private:
                      const bool unicode,
                      const bool streamRead);
 
-    void _WriteBuffer(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inRecords,
+    void _WriteBuffer(const gsl::span<const INPUT_RECORD> inRecords,
                       _Out_ size_t& eventsWritten,
                       _Out_ bool& setWaitEvent);
 
-    bool _CanCoalesce(const KeyEvent& a, const KeyEvent& b) const noexcept;
-    bool _CoalesceMouseMovedEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    bool _CoalesceRepeatedKeyPressEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
-    void _HandleConsoleSuspensionEvents(_Inout_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
+    bool _WriteToTerminalInput(const INPUT_RECORD& inRecord);
+
+    bool _CanCoalesce(const KEY_EVENT_RECORD& a, const KEY_EVENT_RECORD& b) const noexcept;
+    bool _CoalesceMouseMovedEvents(const INPUT_RECORD& inRecord) noexcept;
+    bool _CoalesceRepeatedKeyPressEvents(const INPUT_RECORD& inRecord);
+    gsl::span<const INPUT_RECORD> _HandleConsoleSuspensionEvents(const gsl::span<const INPUT_RECORD> inRecords,
+                                                                 _Inout_ std::vector<INPUT_RECORD>& filteredRecords);
+    bool _HandleConsoleSuspensionEvent(const INPUT_RECORD& inRecord);
 
     void _HandleTerminalInputCallback(_In_ std::deque<std::unique_ptr<IInputEvent>>& inEvents);
 
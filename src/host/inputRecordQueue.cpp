@@ -0,0 +1,169 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "inputRecordQueue.hpp"
+
+// The ring starts out this big the first time something gets pushed.
+static constexpr size_t InitialCapacity = 64;
+
+// A large paste can leave a ring of several megabytes behind. Once it has
+// been read out completely, rings bigger than this are freed again.
+static constexpr size_t RetainedCapacity = 4096;
+
+InputRecordQueue::InputRecordQueue() noexcept :
+    _buffer{},
+    _capacity{ 0 },
+    _head{ 0 },
+    _size{ 0 }
+{
+}
+
+bool InputRecordQueue::empty() const noexcept
+{
+    return _size == 0;
+}
+
+size_t InputRecordQueue::size() const noexcept
+{
+    return _size;
+}
+
+size_t InputRecordQueue::capacity() const noexcept
+{
+    return _capacity;
+}
+
+// Routine Description:
+// - Returns the record at the given position, counted from the front of the queue.
+// Arguments:
+// - index - the position of the record. Must be less than size().
+INPUT_RECORD& InputRecordQueue::operator[](const size_t index) noexcept
+{
+    return _buffer[_Wrap(index)];
+}
+
+const INPUT_RECORD& InputRecordQueue::operator[](const size_t index) const noexcept
+{
+    return _buffer[_Wrap(index)];
+}
+
+INPUT_RECORD& InputRecordQueue::front() noexcept
+{
+    return (*this)[0];
+}
+
+const INPUT_RECORD& InputRecordQueue::front() const noexcept
+{
+    return (*this)[0];
+}
+
+INPUT_RECORD& InputRecordQueue::back() noexcept
+{
+    return (*this)[_size - 1];
+}
+
+const INPUT_RECORD& InputRecordQueue::back() const noexcept
+{
+    return (*this)[_size - 1];
+}
+
+// Routine Description:
+// - Makes sure that at least the given amount of records fit without growing again.
+// Arguments:
+// - capacity - the amount of records to make room for.
+// Return Value:
+// - <none>, throws if the ring couldn't be allocated.
+void InputRecordQueue::reserve(const size_t capacity)
+{
+    if (capacity <= _capacity)
+    {
+        return;
+    }
+
+    auto newCapacity = std::max(_capacity * 2, InitialCapacity);
+    while (newCapacity < capacity)
+    {
+        newCapacity *= 2;
+    }
+
+    auto newBuffer = std::make_unique<INPUT_RECORD[]>(newCapacity);
+
+    // Unwrap the records, so that the front ends up at the start of the new ring.
+    for (size_t i = 0; i < _size; ++i)
+    {
+        newBuffer[i] = (*this)[i];
+    }
+
+    _buffer = std::move(newBuffer);
+    _capacity = newCapacity;
+    _head = 0;
+}
+
+void InputRecordQueue::push_back(const INPUT_RECORD& record)
+{
+    reserve(_size + 1);
+    _buffer[_Wrap(_size)] = record;
+    ++_size;
+}
+
+void InputRecordQueue::push_front(const INPUT_RECORD& record)
+{
+    reserve(_size + 1);
+    _head = _Wrap(_capacity - 1);
+    _buffer[_head] = record;
+    ++_size;
+}
+
+// Routine Description:
+// - Removes records from the front of the queue.
+// Arguments:
+// - count - the amount of records to remove. Must not be more than size().
+// Return Value:
+// - <none>
+void InputRecordQueue::pop_front(const size_t count) noexcept
+{
+    _head = _Wrap(count);
+    _size -= count;
+    _ReleaseIfDrained();
+}
+
+void InputRecordQueue::clear() noexcept
+{
+    _size = 0;
+    _ReleaseIfDrained();
+}
+
+void InputRecordQueue::swap(InputRecordQueue& other) noexcept
+{
+    std::swap(_buffer, other._buffer);
+    std::swap(_capacity, other._capacity);
+    std::swap(_head, other._head);
+    std::swap(_size, other._size);
+}
+
+// Routine Description:
+// - Maps a position counted from the front of the queue to an index into the ring.
+size_t InputRecordQueue::_Wrap(const size_t offset) const noexcept
+{
+    return (_head + offset) & (_capacity - 1);
+}
+
+// Routine Description:
+// - Called whenever records were removed. An empty queue starts over at the
+//   beginning of the ring, and gives back a ring that grew unusually large.
+void InputRecordQueue::_ReleaseIfDrained() noexcept
+{
+    if (_size != 0)
+    {
+        return;
+    }
+
+    _head = 0;
+    if (_capacity > RetainedCapacity)
+    {
+        _buffer.reset();
+        _capacity = 0;
+    }
+}
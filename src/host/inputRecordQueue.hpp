@@ -0,0 +1,73 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- inputRecordQueue.hpp
+
+Abstract:
+- A first-in first-out queue of INPUT_RECORDs, stored by value in a ring buffer.
+- The input buffer keeps its pending events in here. Since records are plain
+  values, writing and reading them doesn't allocate once the ring is big enough,
+  and it only needs to grow when more events are pending than ever before.
+--*/
+
+#pragma once
+
+class InputRecordQueue final
+{
+public:
+    InputRecordQueue() noexcept;
+
+    bool empty() const noexcept;
+    size_t size() const noexcept;
+    size_t capacity() const noexcept;
+
+    INPUT_RECORD& operator[](const size_t index) noexcept;
+    const INPUT_RECORD& operator[](const size_t index) const noexcept;
+
+    INPUT_RECORD& front() noexcept;
+    const INPUT_RECORD& front() const noexcept;
+    INPUT_RECORD& back() noexcept;
+    const INPUT_RECORD& back() const noexcept;
+
+    void reserve(const size_t capacity);
+    void push_back(const INPUT_RECORD& record);
+    void push_front(const INPUT_RECORD& record);
+    void pop_front(const size_t count = 1) noexcept;
+    void clear() noexcept;
+    void swap(InputRecordQueue& other) noexcept;
+
+    // Routine Description:
+    // - Removes all records that match the predicate, keeping the order of the others.
+    // Arguments:
+    // - pred - called with each record, returns true if the record should be removed.
+    template<typename Predicate>
+    void remove_if(Predicate pred)
+    {
+        size_t kept = 0;
+        for (size_t i = 0; i < _size; ++i)
+        {
+            const auto& record = (*this)[i];
+            if (!pred(record))
+            {
+                (*this)[kept++] = record;
+            }
+        }
+        _size = kept;
+        _ReleaseIfDrained();
+    }
+
+private:
+    std::unique_ptr<INPUT_RECORD[]> _buffer;
+    size_t _capacity; // always 0 or a power of two, so indices wrap with a mask
+    size_t _head;
+    size_t _size;
+
+    size_t _Wrap(const size_t offset) const noexcept;
+    void _ReleaseIfDrained() noexcept;
+
+#ifdef UNIT_TESTING
+    friend class InputBufferTests;
+#endif
+};
@@ -428,6 +428,21 @@ void ScrollRegion(SCREEN_INFORMATION& screenInfo,
     // If the target region is valid, let's do this.
     if (target.IsValid())
     {
+        // In conpty, a terminal that supports DECCRA may be able to make the
+        // same copy itself, and then the target doesn't need to be repainted.
+        // That has to be settled before the copy, while the terminal still has
+        // what we have in the source.
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        const bool terminalCopies = screenInfo.IsActiveScreenBuffer() &&
+                                    gci.IsInVtIoMode() &&
+                                    gci.GetVtIo()->BeginRectangleCopy(source, target.Origin());
+        auto endRectangleCopy = wil::scope_exit([&]() {
+            if (terminalCopies)
+            {
+                gci.GetVtIo()->EndRectangleCopy();
+            }
+        });
+
         // Perform the copy from the source to the target.
         _CopyRectangle(screenInfo, source, target.Origin());
 
@@ -307,6 +307,27 @@ bool ConhostInternalGetSet::PrivateWriteConsoleInputW(std::deque<std::unique_ptr
                                                     true)); // append
 }
 
+// Routine Description:
+// - Connects the WriteConsoleInput API call directly into our Driver Message servicing call inside Conhost.exe
+// - Unlike the IInputEvent version, the records are copied into the input
+//   buffer as they are, without allocating an event for each of them.
+// Arguments:
+// - records - the input records to be appended to the input buffer
+//             for the underlying attached process
+// - eventsWritten - on output, the number of events written
+// Return Value:
+// - true if successful (see DoSrvWriteConsoleInput). false otherwise.
+bool ConhostInternalGetSet::PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
+                                                      size_t& eventsWritten)
+{
+    eventsWritten = 0;
+
+    return SUCCEEDED(DoSrvPrivateWriteConsoleInputW(_io.GetActiveInputBuffer(),
+                                                    records,
+                                                    eventsWritten,
+                                                    true)); // append
+}
+
 // Routine Description:
 // - Connects the SetConsoleWindowInfo API call directly into our Driver Message servicing call inside Conhost.exe
 // Arguments:
@@ -575,6 +596,20 @@ bool ConhostInternalGetSet::PrivateEnableAlternateScroll(const bool enabled)
     return true;
 }
 
+// Routine Description:
+// - Connects the PrivateEnableSynchronizedOutput call directly into our Driver Message servicing call inside Conhost.exe
+//   PrivateEnableSynchronizedOutput is an internal-only "API" call that the vt commands can execute,
+//     but it is not represented as a function call on out public API surface.
+// Arguments:
+// - enabled - set to true to begin a synchronized update, false to end it
+// Return Value:
+// - true if successful (see DoSrvPrivateEnableSynchronizedOutput). false otherwise.
+bool ConhostInternalGetSet::PrivateEnableSynchronizedOutput(const bool enabled)
+{
+    DoSrvPrivateEnableSynchronizedOutput(_io.GetActiveOutputBuffer(), enabled);
+    return true;
+}
+
 // Routine Description:
 // - Connects the PrivateEraseAll call directly into our Driver Message servicing call inside Conhost.exe
 //   PrivateEraseAll is an internal-only "API" call that the vt commands can execute,
@@ -625,9 +660,18 @@ bool ConhostInternalGetSet::PrivateGetConsoleScreenBufferAttributes(WORD& attrib
 bool ConhostInternalGetSet::PrivatePrependConsoleInput(std::deque<std::unique_ptr<IInputEvent>>& events,
                                                        size_t& eventsWritten)
 {
-    return SUCCEEDED(DoSrvPrivatePrependConsoleInput(_io.GetActiveInputBuffer(),
-                                                     events,
-                                                     eventsWritten));
+    const bool success = SUCCEEDED(DoSrvPrivatePrependConsoleInput(_io.GetActiveInputBuffer(),
+                                                                   events,
+                                                                   eventsWritten));
+
+    // This is a reply to a query, so if the query is being passed through to
+    // the terminal, keep it from there. The client should only get our reply.
+    if (success)
+    {
+        ServiceLocator::LocateGlobals().getConsoleInformation().GetVtIo()->OmitFromPassthrough();
+    }
+
+    return success;
 }
 
 // Routine Description:
@@ -821,6 +865,40 @@ bool ConhostInternalGetSet::PrivateScrollRegion(const SMALL_RECT scrollRect,
                                               standardFillAttrs));
 }
 
+// Routine Description:
+// - Connects the PrivateCopyRectangle call directly into our Driver Message servicing
+//    call inside Conhost.exe
+//   PrivateCopyRectangle is an internal-only "API" call that the vt commands can execute,
+//    but it is not represented as a function call on our public API surface.
+// Arguments:
+// - source - The inclusive rectangle of cells to copy.
+// - target - Upper left corner to copy the cells to.
+// Return value:
+// - true if successful (see DoSrvPrivateCopyRectangle). false otherwise.
+bool ConhostInternalGetSet::PrivateCopyRectangle(const SMALL_RECT source,
+                                                 const COORD target) noexcept
+{
+    return SUCCEEDED(DoSrvPrivateCopyRectangle(_io.GetActiveOutputBuffer(), source, target));
+}
+
+// Routine Description:
+// - Connects the PrivateFillRectangle call directly into our Driver Message servicing
+//    call inside Conhost.exe
+//   PrivateFillRectangle is an internal-only "API" call that the vt commands can execute,
+//    but it is not represented as a function call on our public API surface.
+// Arguments:
+// - rect - The inclusive rectangle of cells to fill.
+// - fillChar - Character to fill the rectangle with.
+// - fillAttrs - Attributes to fill the rectangle with, or empty to keep the existing ones.
+// Return value:
+// - true if successful (see DoSrvPrivateFillRectangle). false otherwise.
+bool ConhostInternalGetSet::PrivateFillRectangle(const SMALL_RECT rect,
+                                                 const wchar_t fillChar,
+                                                 const std::optional<TextAttribute> fillAttrs) noexcept
+{
+    return SUCCEEDED(DoSrvPrivateFillRectangle(_io.GetActiveOutputBuffer(), rect, fillChar, fillAttrs));
+}
+
 // Routine Description:
 // - Checks if the InputBuffer is willing to accept VT Input directly
 //   PrivateIsVtInputEnabled is an internal-only "API" call that the vt commands can execute,
@@ -86,6 +86,8 @@ public:
 
     bool PrivateWriteConsoleInputW(std::deque<std::unique_ptr<IInputEvent>>& events,
                                    size_t& eventsWritten) override;
+    bool PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
+                                   size_t& eventsWritten) override;
 
     bool SetConsoleWindowInfo(bool const absolute,
                               const SMALL_RECT& window) override;
@@ -119,6 +121,7 @@ public:
     bool PrivateEnableButtonEventMouseMode(const bool enabled) override;
     bool PrivateEnableAnyEventMouseMode(const bool enabled) override;
     bool PrivateEnableAlternateScroll(const bool enabled) override;
+    bool PrivateEnableSynchronizedOutput(const bool enabled) override;
     bool PrivateEraseAll() override;
 
     bool PrivateGetConsoleScreenBufferAttributes(WORD& attributes) override;
@@ -160,6 +163,13 @@ public:
                              const COORD destinationOrigin,
                              const bool standardFillAttrs) noexcept override;
 
+    bool PrivateCopyRectangle(const SMALL_RECT source,
+                              const COORD target) noexcept override;
+
+    bool PrivateFillRectangle(const SMALL_RECT rect,
+                              const wchar_t fillChar,
+                              const std::optional<TextAttribute> fillAttrs) noexcept override;
+
     bool PrivateIsVtInputEnabled() const override;
 
 private:
@@ -579,6 +579,12 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
         bool CallWrite = true;
         const SHORT sScreenBufferSizeX = _screenInfo.GetBufferSize().Width();
 
+        // the first character of the line that's different from what's on the screen
+        size_t firstChanged = 0;
+
+        // the cells the line takes up before it's changed, for RedrawFrom to clear
+        const size_t shownCells = ShownCells();
+
         // processing in the middle of the line is more complex:
 
         // calculate new cursor position
@@ -642,6 +648,7 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
                         loop = true;
                     }
                 }
+                firstChanged = _currentPosition;
             }
             else
             {
@@ -686,6 +693,7 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
                 *_bufPtr = wch;
                 _bufPtr += 1;
                 _currentPosition += 1;
+                firstChanged = _currentPosition - 1;
 
                 // calculate new cursor position
                 if (_echoInput)
@@ -707,29 +715,35 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
             CursorPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
             CursorPosition.X = (SHORT)(CursorPosition.X + NumSpaces);
 
-            // clear the current command line from the screen
-            // clang-format off
+            // Only the part of the line from the edit onward has changed. Redraw just
+            // that if we can tell where it's on the screen, and the whole line if not.
+            if (wch == UNICODE_CARRIAGERETURN ||
+                !RedrawFrom(firstChanged, shownCells, WC_DESTRUCTIVE_BACKSPACE | WC_ECHO, status, ScrollY))
+            {
+                // clear the current command line from the screen
+                // clang-format off
 #pragma prefast(suppress: __WARNING_BUFFER_OVERFLOW, "Not sure why prefast doesn't like this call.")
-            // clang-format on
-            DeleteCommandLine(*this, FALSE);
+                // clang-format on
+                DeleteCommandLine(*this, FALSE);
 
-            // write the new command line to the screen
-            NumToWrite = _bytesRead;
+                // write the new command line to the screen
+                NumToWrite = _bytesRead;
 
-            DWORD dwFlags = WC_DESTRUCTIVE_BACKSPACE | WC_ECHO;
-            if (wch == UNICODE_CARRIAGERETURN)
-            {
-                dwFlags |= WC_KEEP_CURSOR_VISIBLE;
+                DWORD dwFlags = WC_DESTRUCTIVE_BACKSPACE | WC_ECHO;
+                if (wch == UNICODE_CARRIAGERETURN)
+                {
+                    dwFlags |= WC_KEEP_CURSOR_VISIBLE;
+                }
+                status = WriteCharsLegacy(_screenInfo,
+                                          _backupLimit,
+                                          _backupLimit,
+                                          _backupLimit,
+                                          &NumToWrite,
+                                          &_visibleCharCount,
+                                          _originalCursorPosition.X,
+                                          dwFlags,
+                                          &ScrollY);
             }
-            status = WriteCharsLegacy(_screenInfo,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      _backupLimit,
-                                      &NumToWrite,
-                                      &_visibleCharCount,
-                                      _originalCursorPosition.X,
-                                      dwFlags,
-                                      &ScrollY);
             if (!NT_SUCCESS(status))
             {
                 RIPMSG1(RIP_WARNING, "WriteCharsLegacy failed 0x%x", status);
@@ -815,6 +829,153 @@ bool COOKED_READ_DATA::ProcessInput(const wchar_t wchOrig,
     return false;
 }
 
+// Routine Description:
+// - Gets how many cells the echoed edit line takes up, counting from the
+//   original cursor position. These are the cells DeleteCommandLine clears.
+// - This looks at the characters in the buffer to tell where wide glyphs end,
+//   so it has to be called before they're changed.
+// Arguments:
+// - <none>
+// Return Value:
+// - The number of cells the shown line takes up.
+size_t COOKED_READ_DATA::ShownCells() const
+{
+    size_t cells = _visibleCharCount;
+    if (!CheckBisectStringW(_backupLimit,
+                            cells,
+                            gsl::narrow_cast<size_t>(_screenInfo.GetBufferSize().Width()) - _originalCursorPosition.X))
+    {
+        cells++;
+    }
+    return cells;
+}
+
+// Routine Description:
+// - Checks whether RedrawFrom can bring the line up to date from the given
+//   character onward. Only the characters in front of it are looked at, so
+//   this can be asked before the rest of the buffer changes.
+// Arguments:
+// - firstChanged - the first character of the buffer that's about to change.
+// Return Value:
+// - true if RedrawFrom will redraw the line. false if the caller has to redraw it all.
+bool COOKED_READ_DATA::CanRedrawFrom(const size_t firstChanged) const
+{
+    COORD position;
+    size_t cellsBefore = 0;
+    return _findOnScreen(firstChanged, position, cellsBefore);
+}
+
+// Routine Description:
+// - Brings the echoed edit line up to date after the characters from the given
+//   one onward have changed, leaving the part of the line in front of it alone.
+// Arguments:
+// - firstChanged - the first character of the buffer that differs from what's shown.
+// - shownCells - the cells the line took up before it changed, see ShownCells.
+// - dwFlags - the WC_* flags to write the changed part of the line with.
+// - status - receives the result of writing the changed part of the line.
+// - scrollY - adjusted by how far the screen buffer scrolled while writing.
+// Return Value:
+// - true if the line was redrawn. false if nothing was done, because the line
+//   can't be followed up to firstChanged. The caller has to redraw it all then.
+bool COOKED_READ_DATA::RedrawFrom(const size_t firstChanged,
+                                  const size_t shownCells,
+                                  const DWORD dwFlags,
+                                  NTSTATUS& status,
+                                  SHORT& scrollY)
+{
+    COORD position;
+    size_t cellsBefore = 0;
+    if (!_findOnScreen(firstChanged, position, cellsBefore))
+    {
+        return false;
+    }
+
+    // Blank the rest of the old line. These are the cells DeleteCommandLine
+    // would have cleared, without the ones in front of the change.
+    const COORD bufferSize = _screenInfo.GetBufferSize().Dimensions();
+    const auto lineEnd = gsl::narrow_cast<ptrdiff_t>(_originalCursorPosition.Y) * bufferSize.X + _originalCursorPosition.X + gsl::narrow_cast<ptrdiff_t>(shownCells);
+    const auto changedAt = gsl::narrow_cast<ptrdiff_t>(position.Y) * bufferSize.X + position.X;
+    if (lineEnd > changedAt)
+    {
+        try
+        {
+            _screenInfo.Write(OutputCellIterator(UNICODE_SPACE, gsl::narrow_cast<size_t>(lineEnd - changedAt)), position);
+        }
+        CATCH_LOG();
+    }
+
+    LOG_IF_FAILED(_screenInfo.SetCursorPosition(position, true));
+
+    size_t bytesToWrite = _bytesRead - firstChanged * sizeof(wchar_t);
+    size_t cellsWritten = 0;
+    status = WriteCharsLegacy(_screenInfo,
+                              _backupLimit,
+                              _backupLimit + firstChanged,
+                              _backupLimit + firstChanged,
+                              &bytesToWrite,
+                              &cellsWritten,
+                              _originalCursorPosition.X,
+                              dwFlags,
+                              &scrollY);
+    if (NT_SUCCESS(status))
+    {
+        _visibleCharCount = cellsBefore + cellsWritten;
+    }
+    return true;
+}
+
+// Routine Description:
+// - Finds where the given character of the edit line is on the screen.
+// - This follows the line the way WriteCharsLegacy laid it out: wide glyphs take
+//   up two cells, and move on to the next row if only one is left, which stays
+//   behind as padding. Tabs and control characters aren't followed here.
+// Arguments:
+// - index - the character to find.
+// - position - receives the position of the character.
+// - cellsBefore - receives the number of cells the characters in front of it take up.
+// Return Value:
+// - true if the character was found. false if the line can't be followed up to it.
+bool COOKED_READ_DATA::_findOnScreen(const size_t index, COORD& position, size_t& cellsBefore) const
+{
+    if (!_echoInput ||
+        WI_IsFlagClear(_screenInfo.OutputMode, ENABLE_PROCESSED_OUTPUT) ||
+        WI_IsFlagClear(_screenInfo.OutputMode, ENABLE_WRAP_AT_EOL_OUTPUT) ||
+        _originalCursorPosition.X < 0 ||
+        _originalCursorPosition.Y < 0)
+    {
+        return false;
+    }
+
+    const COORD bufferSize = _screenInfo.GetBufferSize().Dimensions();
+    position = _originalCursorPosition;
+    cellsBefore = 0;
+    for (size_t i = 0; i < index; ++i)
+    {
+        const wchar_t wch = _backupLimit[i];
+        if (wch < UNICODE_SPACE || wch == 0x007F)
+        {
+            return false;
+        }
+
+        const SHORT width = IsGlyphFullWidth(wch) ? 2 : 1;
+        if (width == 2 && position.X >= bufferSize.X - 1)
+        {
+            position.X = 0;
+            position.Y++;
+        }
+
+        position.X += width;
+        cellsBefore += width;
+        if (position.X >= bufferSize.X)
+        {
+            position.X = 0;
+            position.Y++;
+        }
+    }
+
+    return position.Y < bufferSize.Y;
+}
+
 // Routine Description:
 // - Writes string to current position in prompt line. can overwrite text to the right of the cursor.
 // Arguments:
@@ -924,6 +1085,13 @@ void COOKED_READ_DATA::SavePendingInput(const size_t index, const bool multiline
 
     while (_bytesRead < _bufferSize)
     {
+        // Take plain text (like a paste) in one go if there is some,
+        // instead of a character at a time.
+        if (_readTextRun())
+        {
+            continue;
+        }
+
         wchar_t wch = UNICODE_NULL;
         bool commandLineEditingKeys = false;
         DWORD keyState = 0;
@@ -991,6 +1159,50 @@ void COOKED_READ_DATA::SavePendingInput(const size_t index, const bool multiline
     return Status;
 }
 
+// Routine Description:
+// - Reads a run of plain text from the input buffer straight into the edit
+//   line, and echoes all of it at once.
+// - This only happens at the end of the line, where each of those characters
+//   would have been appended anyway. Everything else (control characters,
+//   editing keys, typing in the middle of the line) is left to ProcessInput.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if any characters were read, false if ProcessInput needs to handle
+//   the next input.
+bool COOKED_READ_DATA::_readTextRun() noexcept
+{
+    // ProcessInput keeps room for a carriage return and a line feed at the
+    // end of the buffer, so leave that room too.
+    const size_t reservedBytes = 2 * sizeof(wchar_t);
+    if (!AtEol() || _bytesRead + reservedBytes >= _bufferSize)
+    {
+        return false;
+    }
+
+    try
+    {
+        const size_t maxChars = (_bufferSize - reservedBytes - _bytesRead) / sizeof(wchar_t);
+        if (_pInputBuffer->ReadTextRun(_textRun, maxChars) == 0)
+        {
+            return false;
+        }
+
+        if (_originalCursorPosition.X == -1)
+        {
+            _originalCursorPosition = _screenInfo.GetTextBuffer().GetCursor().GetPosition();
+        }
+
+        Write(_textRun);
+        return true;
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return false;
+    }
+}
+
 // Routine Description:
 // - handles any tasks that need to be completed after the read input loop finishes
 // Arguments:
@@ -60,6 +60,14 @@ public:
 
     size_t Write(const std::wstring_view wstr);
 
+    size_t ShownCells() const;
+    bool CanRedrawFrom(const size_t firstChanged) const;
+    bool RedrawFrom(const size_t firstChanged,
+                    const size_t shownCells,
+                    const DWORD dwFlags,
+                    NTSTATUS& status,
+                    SHORT& scrollY);
+
     void ProcessAliases(DWORD& lineCount);
 
     [[nodiscard]] HRESULT Read(const bool isUnicode,
@@ -133,6 +141,7 @@ private:
 
     std::unique_ptr<byte[]> _buffer;
     std::wstring _exeName;
+    std::wstring _textRun; // reused by _readTextRun, so that it doesn't allocate every time
     std::unique_ptr<ConsoleHandleData> _tempHandle;
 
     // TODO MSFT:11285829 make this something other than a deletable pointer
@@ -156,5 +165,9 @@ private:
 
     [[nodiscard]] NTSTATUS _readCharInputLoop(const bool isUnicode, size_t& numBytes) noexcept;
 
+    bool _readTextRun() noexcept;
+
+    bool _findOnScreen(const size_t index, COORD& position, size_t& cellsBefore) const;
+
     [[nodiscard]] NTSTATUS _handlePostCharInputLoop(const bool isUnicode, size_t& numBytes, ULONG& controlKeyState) noexcept;
 };
@@ -7,6 +7,8 @@
 
 #include "alias.h"
 
+#include <chrono>
+
 using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -389,9 +391,9 @@ class AliasTests
         _ReplacePercentWithCRLF(target);
         _ReplacePercentWithCRLF(expected);
 
-        Alias::s_TrimTrailingCrLf(target);
+        const std::wstring actual{ Alias::s_TrimTrailingCrLf(target) };
 
-        VERIFY_ARE_EQUAL(String(expected.data()), String(target.data()));
+        VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
     }
 
     TEST_METHOD(Tokenize)
@@ -408,10 +410,22 @@ class AliasTests
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(std::wstring(tokensActual[i]).data()));
         }
     }
 
+    TEST_METHOD(TokenizeStopsAfterNinthArg)
+    {
+        std::wstring tokenStr(L"alias one two three four five six seven eight nine ten eleven");
+
+        auto tokensActual = Alias::s_Tokenize(tokenStr);
+
+        Log::Comment(L"Only the arguments that macros can refer to are split off.");
+        VERIFY_ARE_EQUAL(10u, tokensActual.size());
+        VERIFY_ARE_EQUAL(String(L"alias"), String(std::wstring(tokensActual[0]).data()));
+        VERIFY_ARE_EQUAL(String(L"nine"), String(std::wstring(tokensActual[9]).data()));
+    }
+
     TEST_METHOD(TokenizeNothing)
     {
         std::wstring tokenStr(L"alias");
@@ -424,7 +438,7 @@ class AliasTests
 
         for (size_t i = 0; i < tokensExpected.size(); i++)
         {
-            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(tokensActual[i].data()));
+            VERIFY_ARE_EQUAL(String(tokensExpected[i].data()), String(std::wstring(tokensActual[i]).data()));
         }
     }
 
@@ -442,7 +456,7 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        std::wstring actual = Alias::s_GetArgString(target);
+        const std::wstring actual{ Alias::s_GetArgString(target) };
 
         VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
     }
@@ -470,18 +484,7 @@ class AliasTests
         std::wstring expected;
         _RetrieveTargetExpectedPair(target, expected);
 
-        std::deque<std::wstring> tokens;
-        tokens.emplace_back(L"alias");
-        tokens.emplace_back(L"one");
-        tokens.emplace_back(L"two");
-        tokens.emplace_back(L"three");
-        tokens.emplace_back(L"four");
-        tokens.emplace_back(L"five");
-        tokens.emplace_back(L"six");
-        tokens.emplace_back(L"seven");
-        tokens.emplace_back(L"eight");
-        tokens.emplace_back(L"nine");
-        tokens.emplace_back(L"ten");
+        const auto tokens = Alias::s_Tokenize(L"alias one two three four five six seven eight nine ten");
 
         // if we expect non-empty results, then we should get a bool back saying it was processed
         const bool returnExpected = !expected.empty();
@@ -647,4 +650,88 @@ class AliasTests
         VERIFY_ARE_EQUAL(String(expected.data()), String(actual.data()));
         VERIFY_ARE_EQUAL(lineCountExpected, lineCountActual);
     }
+
+    TEST_METHOD(MatchAndCopyPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        std::wstring exe(L"cmd.exe");
+
+        Log::Comment(L"Build a batch script like a build would run it through cmd.exe, one line per cooked read.");
+        const size_t lineCount = 10000;
+        std::vector<std::wstring> script;
+        script.reserve(lineCount);
+        for (size_t i = 0; i < lineCount; ++i)
+        {
+            switch (i % 4)
+            {
+            case 0:
+                script.emplace_back(L"cl.exe /c /nologo src\\module" + std::to_wstring(i) + L".cpp /Foobj\\\r\n");
+                break;
+            case 1:
+                script.emplace_back(L"  copy /y obj\\module" + std::to_wstring(i) + L".obj out\\ > nul\r\n");
+                break;
+            case 2:
+                script.emplace_back(L"ll out\\module" + std::to_wstring(i) + L".obj\r\n");
+                break;
+            default:
+                script.emplace_back(L"if errorlevel 1 goto :fail\r\n");
+                break;
+            }
+        }
+
+        const auto runScript = [&](size_t& matched) {
+            const size_t cchBuffer = 256;
+            auto buffer = std::make_unique<wchar_t[]>(cchBuffer);
+
+            matched = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (const auto& line : script)
+            {
+                std::copy(line.cbegin(), line.cend(), buffer.get());
+                size_t cbWritten = line.size() * sizeof(wchar_t);
+                DWORD lines = 0;
+
+                Alias::s_MatchAndCopyAliasLegacy(buffer.get(),
+                                                 cbWritten,
+                                                 buffer.get(),
+                                                 cchBuffer * sizeof(wchar_t),
+                                                 cbWritten,
+                                                 exe,
+                                                 lines);
+                if (lines != 0)
+                {
+                    ++matched;
+                }
+            }
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count();
+        };
+
+        size_t matched = 0;
+        const auto withoutAliases = runScript(matched);
+        VERIFY_ARE_EQUAL(0u, matched);
+
+        Log::Comment(L"Now define some aliases, one of which is used by every fourth line.");
+        std::wstring alias(L"ll");
+        std::wstring target(L"dir /a $* $gnul $t echo $1");
+        Alias::s_TestAddAlias(exe, alias, target);
+        for (size_t i = 0; i < 50; ++i)
+        {
+            std::wstring unused = L"alias" + std::to_wstring(i);
+            std::wstring unusedTarget = L"echo " + unused + L" $*";
+            Alias::s_TestAddAlias(exe, unused, unusedTarget);
+        }
+
+        const auto withAliases = runScript(matched);
+        VERIFY_ARE_EQUAL(lineCount / 4, matched);
+
+        Log::Comment(NoThrowString().Format(L"%zu lines without aliases in %.2fms, with aliases in %.2fms (%zu expanded)",
+                                            lineCount,
+                                            withoutAliases,
+                                            withAliases,
+                                            matched));
+    }
 };
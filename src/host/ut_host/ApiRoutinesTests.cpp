@@ -14,6 +14,8 @@
 
 #include "..\interactivity\inc\ServiceLocator.hpp"
 
+#include <chrono>
+
 using namespace Microsoft::Console::Types;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -472,6 +474,245 @@ class ApiRoutinesTests
         }
     }
 
+    TEST_METHOD(ApiWriteConsoleWPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        const auto previousMode = si.OutputMode;
+        WI_ClearFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        auto RestoreMode = wil::scope_exit([&] { si.OutputMode = previousMode; });
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        Log::Comment(L"Build some output like a legacy build tool would write it.");
+        std::wstring output;
+        const int lineCount = 20000;
+        for (int line = 0; line < lineCount; ++line)
+        {
+            if (line % 10 == 9)
+            {
+                output += L"warning C4996: 'strcpy': This function may be unsafe. \x00e9\x00e8\r\n";
+            }
+            else
+            {
+                output += L"  cl.exe /c /nologo src\\module" + std::to_wstring(line) + L".cpp\t-> obj\\module" + std::to_wstring(line) + L".obj\r\n";
+            }
+        }
+        output += L"Build succeeded.\r\n";
+
+        const size_t chunkSize = 4096;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < output.size(); offset += chunkSize)
+        {
+            const auto chunk = std::wstring_view{ output }.substr(offset, chunkSize);
+            size_t cchRead = 0;
+            std::unique_ptr<IWaitRoutine> waiter;
+            VERIFY_ARE_EQUAL(S_OK, _pApiRoutines->WriteConsoleWImpl(si, chunk, cchRead, waiter));
+            VERIFY_ARE_EQUAL(chunk.size(), cchRead);
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto& textBuffer = si.GetTextBuffer();
+        const auto lastLine = textBuffer.GetRowByOffset(textBuffer.GetCursor().GetPosition().Y - 1).GetText();
+        VERIFY_ARE_EQUAL(std::wstring{ L"Build succeeded." }, lastLine.substr(0, 16));
+
+        Log::Comment(WEX::Common::NoThrowString().Format(L"%zu characters written in %.1fms (%.1f million per second)",
+                                                         output.size(),
+                                                         elapsed.count(),
+                                                         output.size() / elapsed.count() / 1000.0));
+    }
+
+    TEST_METHOD(ApiWriteConsoleAUtf8Performance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        const auto previousMode = si.OutputMode;
+        WI_ClearFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+        auto RestoreMode = wil::scope_exit([&] { si.OutputMode = previousMode; });
+
+        const auto previousCodepage = gci.OutputCP;
+        gci.OutputCP = CP_UTF8;
+        auto RestoreCodepage = wil::scope_exit([&] { gci.OutputCP = previousCodepage; });
+
+        gci.LockConsole();
+        auto Unlock = wil::scope_exit([&] { gci.UnlockConsole(); });
+
+        Log::Comment(L"Build some output like a script would print it after switching to UTF-8.");
+        std::wstring text;
+        const int lineCount = 20000;
+        for (int line = 0; line < lineCount; ++line)
+        {
+            if (line % 10 == 9)
+            {
+                text += L"  \x2714 caf\x00e9 \x65e5\x672c\x8a9e \xD83D\xDE80 done\r\n";
+            }
+            else
+            {
+                text += L"Collecting package-" + std::to_wstring(line) + L" (from -r requirements.txt (line " + std::to_wstring(line) + L"))\r\n";
+            }
+        }
+        text += L"Build succeeded.\r\n";
+        const auto output = til::u16u8(text);
+
+        // 4096 byte chunks regularly cut multi-byte sequences in half.
+        const size_t chunkSize = 4096;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t offset = 0; offset < output.size(); offset += chunkSize)
+        {
+            const auto chunk = std::string_view{ output }.substr(offset, chunkSize);
+            size_t cbRead = 0;
+            std::unique_ptr<IWaitRoutine> waiter;
+            VERIFY_ARE_EQUAL(S_OK, _pApiRoutines->WriteConsoleAImpl(si, chunk, cbRead, waiter));
+            VERIFY_ARE_EQUAL(chunk.size(), cbRead);
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto& textBuffer = si.GetTextBuffer();
+        const auto lastLine = textBuffer.GetRowByOffset(textBuffer.GetCursor().GetPosition().Y - 1).GetText();
+        VERIFY_ARE_EQUAL(std::wstring{ L"Build succeeded." }, lastLine.substr(0, 16));
+
+        Log::Comment(WEX::Common::NoThrowString().Format(L"%zu bytes written in %.1fms (%.1f MB/s)",
+                                                         output.size(),
+                                                         elapsed.count(),
+                                                         output.size() / elapsed.count() / 1000.0));
+    }
+
+    // Fills a buffer of the given size the way a full screen TUI would draw a frame:
+    // a title bar, a few panels of colored text with borders, and a status line.
+    static std::vector<CHAR_INFO> _MakeFrame(const COORD size, const int frame)
+    {
+        std::vector<CHAR_INFO> cells(size.X * size.Y);
+        for (short y = 0; y < size.Y; ++y)
+        {
+            for (short x = 0; x < size.X; ++x)
+            {
+                auto& cell = cells.at(y * size.X + x);
+                const auto panel = x / 40;
+                if (y == 0 || y == size.Y - 1)
+                {
+                    cell.Char.UnicodeChar = gsl::narrow_cast<wchar_t>(L'A' + (x + frame) % 26);
+                    cell.Attributes = gsl::narrow_cast<WORD>(BACKGROUND_BLUE | BACKGROUND_GREEN | (x < 20 ? 0 : FOREGROUND_INTENSITY));
+                }
+                else if (x % 40 == 0 || x % 40 == 39)
+                {
+                    cell.Char.UnicodeChar = L'|';
+                    cell.Attributes = BACKGROUND_BLUE | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
+                }
+                else
+                {
+                    cell.Char.UnicodeChar = gsl::narrow_cast<wchar_t>(L'a' + (x * 7 + y + frame) % 26);
+                    cell.Attributes = gsl::narrow_cast<WORD>(BACKGROUND_BLUE | ((y + panel + frame) % 7 + 1));
+                }
+            }
+        }
+        return cells;
+    }
+
+    TEST_METHOD(ApiWriteReadConsoleOutputWRoundTrip)
+    {
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        const auto bufferSize = si.GetBufferSize().Dimensions();
+
+        const COORD size{ bufferSize.X, 10 };
+        auto frame = _MakeFrame(size, 0);
+        const auto original = frame;
+
+        Viewport written;
+        VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, frame, Viewport::FromDimensions({ 0, 2 }, size), written));
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 0, 2 }, size).ToInclusive(), written.ToInclusive());
+
+        Log::Comment(L"Reading the area back gives the same cells.");
+        std::vector<CHAR_INFO> readBack(frame.size());
+        Viewport read;
+        VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, readBack, Viewport::FromDimensions({ 0, 2 }, size), read));
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 0, 2 }, size).ToInclusive(), read.ToInclusive());
+        for (size_t i = 0; i < original.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(original.at(i), readBack.at(i));
+        }
+
+        Log::Comment(L"A read that starts left of the buffer leaves the cells that would be outside of it alone.");
+        const COORD clippedSize{ 4, 2 };
+        CHAR_INFO untouched;
+        untouched.Char.UnicodeChar = L'?';
+        untouched.Attributes = FOREGROUND_RED;
+        std::vector<CHAR_INFO> clipped(clippedSize.X * clippedSize.Y, untouched);
+        VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, clipped, Viewport::FromDimensions({ -1, 2 }, clippedSize), read));
+        VERIFY_ARE_EQUAL(Viewport::FromDimensions({ 0, 2 }, { 3, 2 }).ToInclusive(), read.ToInclusive());
+        for (short y = 0; y < clippedSize.Y; ++y)
+        {
+            VERIFY_ARE_EQUAL(L'?', clipped.at(y * clippedSize.X).Char.UnicodeChar);
+            for (short x = 1; x < clippedSize.X; ++x)
+            {
+                VERIFY_ARE_EQUAL(original.at(y * size.X + x - 1), clipped.at(y * clippedSize.X + x));
+            }
+        }
+    }
+
+    TEST_METHOD(ApiWriteReadConsoleOutputWPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        Log::Comment(L"Use a 200x60 window without any scrollback, like a full screen TUI would.");
+        const COORD size{ 200, 60 };
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->PrepareGlobalScreenBuffer(size.X, size.Y, size.X, size.Y);
+
+        CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        SCREEN_INFORMATION& si = gci.GetActiveOutputBuffer();
+        const auto window = Viewport::FromDimensions({ 0, 0 }, size);
+
+        const int frameCount = 1000;
+        std::vector<std::vector<CHAR_INFO>> frames;
+        for (int frame = 0; frame < 8; ++frame)
+        {
+            frames.push_back(_MakeFrame(size, frame));
+        }
+        std::vector<CHAR_INFO> readBack(frames.front().size());
+
+        // Each frame, the whole window is drawn and then read back again.
+        std::chrono::duration<double, std::milli> writeElapsed{};
+        std::chrono::duration<double, std::milli> readElapsed{};
+        for (int frame = 0; frame < frameCount; ++frame)
+        {
+            auto& cells = frames.at(frame % frames.size());
+            Viewport written;
+            Viewport read;
+
+            const auto writeStart = std::chrono::steady_clock::now();
+            VERIFY_SUCCEEDED(_pApiRoutines->WriteConsoleOutputWImpl(si, cells, window, written));
+            const auto readStart = std::chrono::steady_clock::now();
+            VERIFY_SUCCEEDED(_pApiRoutines->ReadConsoleOutputWImpl(si, readBack, window, read));
+            const auto readEnd = std::chrono::steady_clock::now();
+
+            writeElapsed += readStart - writeStart;
+            readElapsed += readEnd - readStart;
+        }
+
+        const auto& last = frames.at((frameCount - 1) % frames.size());
+        VERIFY_ARE_EQUAL(last.back(), readBack.back());
+
+        Log::Comment(WEX::Common::NoThrowString().Format(L"%d frames of %dx%d: written in %.1fms, read in %.1fms (%.3fms per round trip)",
+                                                         frameCount,
+                                                         size.X,
+                                                         size.Y,
+                                                         writeElapsed.count(),
+                                                         readElapsed.count(),
+                                                         (writeElapsed + readElapsed).count() / frameCount));
+    }
+
     void ValidateScreen(SCREEN_INFORMATION& si,
                         const CHAR_INFO background,
                         const CHAR_INFO fill,
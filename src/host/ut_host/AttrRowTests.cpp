@@ -12,6 +12,8 @@
 
 #include "input.h"
 
+#include <chrono>
+
 using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -63,6 +65,7 @@ namespace WEX
 
 class AttrRowTests
 {
+    TextAttributeTable _table;
     ATTR_ROW* pSingle;
     ATTR_ROW* pChain;
 
@@ -80,9 +83,30 @@ class AttrRowTests
 
     TEST_CLASS(AttrRowTests);
 
+    // Rows store the IDs of their attributes in a table. These convert
+    // them to and from runs of the attributes themselves.
+    std::vector<TextAttributeRun> _GetRuns(const ATTR_ROW& row)
+    {
+        std::vector<TextAttributeRun> runs;
+        for (const auto& run : row._list)
+        {
+            runs.emplace_back(run.length, _table.Get(run.id));
+        }
+        return runs;
+    }
+
+    void _SetRuns(ATTR_ROW& row, const std::vector<TextAttributeRun>& runs)
+    {
+        row._list.clear();
+        for (const auto& run : runs)
+        {
+            row._list.push_back(TextAttributeIdRun{ _table.Intern(run.GetAttributes()), gsl::narrow<uint16_t>(run.GetLength()) });
+        }
+    }
+
     TEST_METHOD_SETUP(MethodSetup)
     {
-        pSingle = new ATTR_ROW(_sDefaultLength, _DefaultAttr);
+        pSingle = new ATTR_ROW(_sDefaultLength, _DefaultAttr, _table);
 
         // Segment length is the expected length divided by the row length
         // E.g. row of 80, 4 segments, 20 segment length each
@@ -102,13 +126,13 @@ class AttrRowTests
         }
 
         // Create the chain
-        pChain = new ATTR_ROW(_sDefaultLength, _DefaultAttr);
-        pChain->_list.resize(sChainSegmentsNeeded);
+        pChain = new ATTR_ROW(_sDefaultLength, _DefaultAttr, _table);
+        std::vector<TextAttributeRun> chain(sChainSegmentsNeeded);
 
         // Attach all chain segments that are even multiples of the row length
         for (short iChain = 0; iChain < _sDefaultChainLength; iChain++)
         {
-            TextAttributeRun* pRun = &pChain->_list[iChain];
+            TextAttributeRun* pRun = &chain[iChain];
 
             pRun->SetAttributesFromLegacy(iChain); // Just use the chain position as the value
             pRun->SetLength(sChainSegLength);
@@ -118,12 +142,14 @@ class AttrRowTests
         {
             // If we had a leftover, then this chain is one longer than we expected (the default length)
             // So use it as the index (because indices start at 0)
-            TextAttributeRun* pRun = &pChain->_list[_sDefaultChainLength];
+            TextAttributeRun* pRun = &chain[_sDefaultChainLength];
 
             pRun->SetAttributes(_DefaultChainAttr);
             pRun->SetLength(sChainLeftover);
         }
 
+        _SetRuns(*pChain, chain);
+
         return true;
     }
 
@@ -151,9 +177,10 @@ class AttrRowTests
 
             pUnderTest->Reset(attr);
 
-            VERIFY_ARE_EQUAL(pUnderTest->_list.size(), 1u);
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetAttributes(), attr);
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetLength(), (unsigned int)_sDefaultLength);
+            const auto runs = _GetRuns(*pUnderTest);
+            VERIFY_ARE_EQUAL(runs.size(), 1u);
+            VERIFY_ARE_EQUAL(runs[0].GetAttributes(), attr);
+            VERIFY_ARE_EQUAL(runs[0].GetLength(), (unsigned int)_sDefaultLength);
         }
     }
 
@@ -266,16 +293,17 @@ class AttrRowTests
 
         // Set up our "original row" that we are going to try to insert into.
         // This will represent a 10 column run of R3->B5->G2 that we will use for all tests.
-        ATTR_ROW originalRow{ static_cast<UINT>(_sDefaultLength), _DefaultAttr };
-        originalRow._list.resize(3);
+        ATTR_ROW originalRow{ static_cast<UINT>(_sDefaultLength), _DefaultAttr, _table };
+        std::vector<TextAttributeRun> originalRuns(3);
         originalRow._cchRowWidth = 10;
-        originalRow._list[0].SetAttributesFromLegacy('R');
-        originalRow._list[0].SetLength(3);
-        originalRow._list[1].SetAttributesFromLegacy('B');
-        originalRow._list[1].SetLength(5);
-        originalRow._list[2].SetAttributesFromLegacy('G');
-        originalRow._list[2].SetLength(2);
-        LogChain(L"Original: ", originalRow._list);
+        originalRuns[0].SetAttributesFromLegacy('R');
+        originalRuns[0].SetLength(3);
+        originalRuns[1].SetAttributesFromLegacy('B');
+        originalRuns[1].SetLength(5);
+        originalRuns[2].SetAttributesFromLegacy('G');
+        originalRuns[2].SetLength(2);
+        _SetRuns(originalRow, originalRuns);
+        LogChain(L"Original: ", originalRuns);
 
         // Set up our "insertion run"
         size_t cInsertRow = 1;
@@ -347,17 +375,18 @@ class AttrRowTests
         VERIFY_SUCCEEDED(originalRow.InsertAttrRuns({ insertRow.data(), insertRow.size() }, uiStartPos, uiEndPos, (UINT)originalRow._cchRowWidth));
 
         // Compare and ensure that the expected and actual match.
-        VERIFY_ARE_EQUAL(cPackedRun, originalRow._list.size(), L"Ensure that number of array elements required for RLE are the same.");
+        auto actualRuns = _GetRuns(originalRow);
+        VERIFY_ARE_EQUAL(cPackedRun, actualRuns.size(), L"Ensure that number of array elements required for RLE are the same.");
 
         std::vector<TextAttributeRun> packedRunExpected;
         std::copy_n(packedRun.get(), cPackedRun, std::back_inserter(packedRunExpected));
 
         LogChain(L"Expected: ", packedRunExpected);
-        LogChain(L"Actual: ", originalRow._list);
+        LogChain(L"Actual: ", actualRuns);
 
         for (size_t testIndex = 0; testIndex < cPackedRun; testIndex++)
         {
-            VERIFY_ARE_EQUAL(packedRun[testIndex], originalRow._list[testIndex]);
+            VERIFY_ARE_EQUAL(packedRun[testIndex], actualRuns[testIndex]);
         }
     }
 
@@ -451,6 +480,153 @@ class AttrRowTests
         }
     }
 
+    TEST_METHOD(TestInsertAttrRunsInPlace)
+    {
+        const TextAttribute red{ FOREGROUND_RED };
+        const TextAttribute green{ FOREGROUND_GREEN };
+        const TextAttributeIdRun redCell{ _table.Intern(red), 1 };
+        const TextAttributeIdRun greenCell{ _table.Intern(green), 1 };
+
+        Log::Comment(L"Write a few colored words one cell at a time, like a line of compiler output.");
+        for (size_t column = 0; column < 10; ++column)
+        {
+            const auto& cell = column < 5 ? redCell : greenCell;
+            VERIFY_SUCCEEDED(pSingle->InsertAttrIdRuns({ &cell, 1 }, column, column, _sDefaultLength));
+        }
+
+        auto runs = _GetRuns(*pSingle);
+        VERIFY_ARE_EQUAL(3u, runs.size());
+        VERIFY_ARE_EQUAL(TextAttributeRun(5, red), runs[0]);
+        VERIFY_ARE_EQUAL(TextAttributeRun(5, green), runs[1]);
+        VERIFY_ARE_EQUAL(TextAttributeRun(_sDefaultLength - 10, _DefaultAttr), runs[2]);
+        VERIFY_IS_TRUE(pSingle->_list.is_inline(), L"A handful of runs doesn't allocate.");
+
+        Log::Comment(L"Overwriting cells with the attributes they already have changes nothing.");
+        const auto data = pSingle->_list.data();
+        VERIFY_SUCCEEDED(pSingle->InsertAttrIdRuns({ &redCell, 1 }, 2, 2, _sDefaultLength));
+        VERIFY_ARE_EQUAL(data, pSingle->_list.data());
+        VERIFY_ARE_EQUAL(3u, pSingle->GetNumberOfRuns());
+        VERIFY_ARE_EQUAL(runs[0], _GetRuns(*pSingle)[0]);
+
+        Log::Comment(L"Writing up to the end of the row cuts off the runs after the start.");
+        const TextAttributeIdRun greenToEnd{ greenCell.id, gsl::narrow<uint16_t>(_sDefaultLength - 7) };
+        VERIFY_SUCCEEDED(pSingle->InsertAttrIdRuns({ &greenToEnd, 1 }, 7, _sDefaultLength - 1, _sDefaultLength));
+        runs = _GetRuns(*pSingle);
+        VERIFY_ARE_EQUAL(2u, runs.size());
+        VERIFY_ARE_EQUAL(TextAttributeRun(5, red), runs[0]);
+        VERIFY_ARE_EQUAL(TextAttributeRun(_sDefaultLength - 5, green), runs[1]);
+
+        Log::Comment(L"Runs past the inline capacity spill onto the heap.");
+        for (size_t column = 20; column < 40; column += 2)
+        {
+            VERIFY_SUCCEEDED(pSingle->InsertAttrIdRuns({ &redCell, 1 }, column, column, _sDefaultLength));
+        }
+        VERIFY_ARE_EQUAL(22u, pSingle->GetNumberOfRuns());
+        VERIFY_IS_FALSE(pSingle->_list.is_inline());
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(pSingle->_list.capacity(), 22u);
+
+        Log::Comment(L"Resetting the row keeps the allocation around for the next busy line.");
+        const auto capacity = pSingle->_list.capacity();
+        pSingle->Reset(_DefaultAttr);
+        VERIFY_ARE_EQUAL(1u, pSingle->GetNumberOfRuns());
+        VERIFY_ARE_EQUAL(TextAttributeRun(_sDefaultLength, _DefaultAttr), _GetRuns(*pSingle)[0]);
+        VERIFY_ARE_EQUAL(capacity, pSingle->_list.capacity());
+
+        Log::Comment(L"Invalid ranges are rejected without touching the row.");
+        VERIFY_ARE_EQUAL(E_INVALIDARG, pSingle->InsertAttrIdRuns({ &redCell, 1 }, 3, 2, _sDefaultLength));
+        VERIFY_ARE_EQUAL(E_INVALIDARG, pSingle->InsertAttrIdRuns({ &redCell, 1 }, 0, _sDefaultLength, _sDefaultLength));
+        VERIFY_ARE_EQUAL(1u, pSingle->GetNumberOfRuns());
+    }
+
+    TEST_METHOD(EqualityComparesRuns)
+    {
+        const TextAttribute red{ FOREGROUND_RED };
+        ATTR_ROW a{ _sDefaultLength, _DefaultAttr, _table };
+        ATTR_ROW b{ _sDefaultLength, _DefaultAttr, _table };
+        VERIFY_IS_TRUE(a == b, L"Rows with separate storage but the same runs are equal.");
+
+        const TextAttributeIdRun redCell{ _table.Intern(red), 1 };
+        VERIFY_SUCCEEDED(a.InsertAttrIdRuns({ &redCell, 1 }, 3, 3, _sDefaultLength));
+        VERIFY_IS_FALSE(a == b);
+
+        VERIFY_SUCCEEDED(b.InsertAttrIdRuns({ &redCell, 1 }, 3, 3, _sDefaultLength));
+        VERIFY_IS_TRUE(a == b);
+
+        Log::Comment(L"Rows of different tables are compared by their attributes.");
+        TextAttributeTable table;
+        table.Intern(TextAttribute{ FOREGROUND_GREEN });
+        ATTR_ROW c{ _sDefaultLength, _DefaultAttr, table };
+        const TextAttributeIdRun otherRedCell{ table.Intern(red), 1 };
+        VERIFY_SUCCEEDED(c.InsertAttrIdRuns({ &otherRedCell, 1 }, 3, 3, _sDefaultLength));
+        VERIFY_IS_TRUE(a == c);
+    }
+
+    TEST_METHOD(InsertAttrRunsPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        // Colors a row the way compiler diagnostics do: a file name, a
+        // position, a colored severity and a plain message, one cell at a time.
+        const UINT width = 120;
+        const int rows = 20000;
+        const std::array<TextAttributeIdRun, 4> cells{
+            TextAttributeIdRun{ _table.Intern(TextAttribute{ FOREGROUND_INTENSITY }), 1 },
+            TextAttributeIdRun{ _table.Intern(TextAttribute{ FOREGROUND_BLUE | FOREGROUND_GREEN }), 1 },
+            TextAttributeIdRun{ _table.Intern(TextAttribute{ FOREGROUND_RED | FOREGROUND_INTENSITY }), 1 },
+            TextAttributeIdRun{ _table.Intern(_DefaultAttr), 1 },
+        };
+        const std::array<size_t, 4> spans{ 30, 8, 10, width - 48 };
+
+        ATTR_ROW row{ width, _DefaultAttr, _table };
+        size_t maxRuns = 0;
+        bool succeeded = true;
+
+        const auto cellsStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < rows; ++i)
+        {
+            row.Reset(_DefaultAttr);
+            size_t column = 0;
+            for (size_t span = 0; span < spans.size(); ++span)
+            {
+                for (size_t end = column + spans.at(span); column < end; ++column)
+                {
+                    succeeded &= SUCCEEDED(row.InsertAttrIdRuns({ &cells.at(span), 1 }, column, column, width));
+                }
+            }
+            maxRuns = std::max(maxRuns, row.GetNumberOfRuns());
+        }
+        const auto cellsEnd = std::chrono::steady_clock::now();
+
+        Log::Comment(L"Also write every cell to the end of the row, like inserting characters at the cursor does.");
+        for (int i = 0; i < rows; ++i)
+        {
+            row.Reset(_DefaultAttr);
+            size_t column = 0;
+            for (size_t span = 0; span < spans.size(); ++span)
+            {
+                for (size_t end = column + spans.at(span); column < end; ++column)
+                {
+                    succeeded &= row.SetAttrToEnd(gsl::narrow<UINT>(column), _table.Get(cells.at(span).id));
+                }
+            }
+        }
+        const auto toEndEnd = std::chrono::steady_clock::now();
+
+        const std::chrono::duration<double, std::milli> cellTime = cellsEnd - cellsStart;
+        const std::chrono::duration<double, std::milli> toEndTime = toEndEnd - cellsEnd;
+        Log::Comment(NoThrowString().Format(L"Colored %d rows of %u cells: %.1fms cell by cell, %.1fms to the end of the row",
+                                            rows,
+                                            width,
+                                            cellTime.count(),
+                                            toEndTime.count()));
+
+        VERIFY_IS_TRUE(succeeded);
+        VERIFY_ARE_EQUAL(spans.size(), maxRuns);
+        VERIFY_IS_TRUE(row._list.is_inline());
+    }
+
     TEST_METHOD(TestUnpackAttrs)
     {
         Log::Comment(L"Checking unpack of a single color for the entire length");
@@ -539,31 +715,33 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate through ubuntu prompt");
         {
             // Create attr row representing a buffer that's 121 wide.
-            auto chain = std::make_unique<ATTR_ROW>(121, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(121, _DefaultAttr, _table);
 
             // The repro case had 4 chain segments.
-            chain->_list.resize(4);
+            std::vector<TextAttributeRun> runs(4);
 
             // The color 10 went for the first 18.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(18);
+            runs[0].SetAttributes(TextAttribute(0xA));
+            runs[0].SetLength(18);
 
             // Default color for the next 1
-            chain->_list[1].SetAttributes(TextAttribute());
-            chain->_list[1].SetLength(1);
+            runs[1].SetAttributes(TextAttribute());
+            runs[1].SetLength(1);
 
             // Color 12 for the next 29
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(29);
+            runs[2].SetAttributes(TextAttribute(0xC));
+            runs[2].SetLength(29);
 
             // Then default color to end the run
-            chain->_list[3].SetAttributes(TextAttribute());
-            chain->_list[3].SetLength(73);
+            runs[3].SetAttributes(TextAttribute());
+            runs[3].SetLength(73);
+
+            _SetRuns(*chain, runs);
 
             // The sum of the lengths should be 121.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength + chain->_list[3]._cchLength);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength() + runs[3].GetLength());
 
-            auto index = chain->_list[0].GetLength();
+            auto index = runs[0].GetLength();
             auto stepSize = 1;
             testWalk(chain.get(), index, stepSize);
         }
@@ -571,25 +749,27 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate across a text run in the chain");
         {
             // Create attr row representing a buffer that's 3 wide.
-            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr, _table);
 
             // The repro case had 3 chain segments.
-            chain->_list.resize(3);
+            std::vector<TextAttributeRun> runs(3);
 
             // The color 10 went for the first 1.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(1);
+            runs[0].SetAttributes(TextAttribute(0xA));
+            runs[0].SetLength(1);
 
             // The color 11 for the next 1
-            chain->_list[1].SetAttributes(TextAttribute(0xB));
-            chain->_list[1].SetLength(1);
+            runs[1].SetAttributes(TextAttribute(0xB));
+            runs[1].SetLength(1);
 
             // Color 12 for the next 1
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(1);
+            runs[2].SetAttributes(TextAttribute(0xC));
+            runs[2].SetLength(1);
+
+            _SetRuns(*chain, runs);
 
             // The sum of the lengths should be 3.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength());
 
             // on 'ABC', step from B to A
             auto index = 1;
@@ -600,25 +780,27 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate across two text runs in the chain");
         {
             // Create attr row representing a buffer that's 3 wide.
-            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr, _table);
 
             // The repro case had 3 chain segments.
-            chain->_list.resize(3);
+            std::vector<TextAttributeRun> runs(3);
 
             // The color 10 went for the first 1.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(1);
+            runs[0].SetAttributes(TextAttribute(0xA));
+            runs[0].SetLength(1);
 
             // The color 11 for the next 1
-            chain->_list[1].SetAttributes(TextAttribute(0xB));
-            chain->_list[1].SetLength(1);
+            runs[1].SetAttributes(TextAttribute(0xB));
+            runs[1].SetLength(1);
 
             // Color 12 for the next 1
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(1);
+            runs[2].SetAttributes(TextAttribute(0xC));
+            runs[2].SetLength(1);
+
+            _SetRuns(*chain, runs);
 
             // The sum of the lengths should be 3.
-            VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength);
+            VERIFY_ARE_EQUAL(chain->_cchRowWidth, runs[0].GetLength() + runs[1].GetLength() + runs[2].GetLength());
 
             // on 'ABC', step from C to A
             auto index = 2;
@@ -638,37 +820,39 @@ class AttrRowTests
 
         Log::Comment(L"SetAttrToEnd for single color applied to whole string.");
         pSingle->SetAttrToEnd(iTestIndex, TestAttr);
+        const auto singleRuns = _GetRuns(*pSingle);
 
         // Was 1 (single), should now have 2 segments
-        VERIFY_ARE_EQUAL(pSingle->_list.size(), 2u);
+        VERIFY_ARE_EQUAL(singleRuns.size(), 2u);
 
-        VERIFY_ARE_EQUAL(pSingle->_list[0].GetAttributes(), _DefaultAttr);
-        VERIFY_ARE_EQUAL(pSingle->_list[0].GetLength(), (unsigned int)(_sDefaultLength - (_sDefaultLength - iTestIndex)));
+        VERIFY_ARE_EQUAL(singleRuns[0].GetAttributes(), _DefaultAttr);
+        VERIFY_ARE_EQUAL(singleRuns[0].GetLength(), (unsigned int)(_sDefaultLength - (_sDefaultLength - iTestIndex)));
 
-        VERIFY_ARE_EQUAL(pSingle->_list[1].GetAttributes(), TestAttr);
-        VERIFY_ARE_EQUAL(pSingle->_list[1].GetLength(), (unsigned int)(_sDefaultLength - iTestIndex));
+        VERIFY_ARE_EQUAL(singleRuns[1].GetAttributes(), TestAttr);
+        VERIFY_ARE_EQUAL(singleRuns[1].GetLength(), (unsigned int)(_sDefaultLength - iTestIndex));
 
         Log::Comment(L"SetAttrToEnd for existing chain of multiple colors.");
         pChain->SetAttrToEnd(iTestIndex, TestAttr);
+        const auto chainRuns = _GetRuns(*pChain);
 
         // From 7 segments down to 5.
-        VERIFY_ARE_EQUAL(pChain->_list.size(), 5u);
+        VERIFY_ARE_EQUAL(chainRuns.size(), 5u);
 
         // Verify chain colors and lengths
-        VERIFY_ARE_EQUAL(TextAttribute(0), pChain->_list[0].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[0].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(0), chainRuns[0].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[0].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(1), pChain->_list[1].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[1].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(1), chainRuns[1].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[1].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(2), pChain->_list[2].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[2].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(2), chainRuns[2].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[2].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(3), pChain->_list[3].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[3].GetLength(), (unsigned int)11);
+        VERIFY_ARE_EQUAL(TextAttribute(3), chainRuns[3].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[3].GetLength(), (unsigned int)11);
 
-        VERIFY_ARE_EQUAL(TestAttr, pChain->_list[4].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[4].GetLength(), (unsigned int)30);
+        VERIFY_ARE_EQUAL(TestAttr, chainRuns[4].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[4].GetLength(), (unsigned int)30);
 
         Log::Comment(L"SECOND: Set index to 0 to test replacing anything with a single");
 
@@ -679,15 +863,16 @@ class AttrRowTests
             ATTR_ROW* pUnderTest = pTestItems[iIndex];
 
             pUnderTest->SetAttrToEnd(0, TestAttr);
+            const auto runs = _GetRuns(*pUnderTest);
 
             // should be down to 1 attribute set from beginning to end of string
-            VERIFY_ARE_EQUAL(pUnderTest->_list.size(), 1u);
+            VERIFY_ARE_EQUAL(runs.size(), 1u);
 
             // singular pair should contain the color
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetAttributes(), TestAttr);
+            VERIFY_ARE_EQUAL(runs[0].GetAttributes(), TestAttr);
 
             // and its length should be the length of the whole string
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetLength(), (unsigned int)_sDefaultLength);
+            VERIFY_ARE_EQUAL(runs[0].GetLength(), (unsigned int)_sDefaultLength);
         }
     }
 
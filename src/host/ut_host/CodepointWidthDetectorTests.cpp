@@ -8,6 +8,9 @@
 
 #include "../types/inc/CodepointWidthDetector.hpp"
 
+#include <chrono>
+
+using namespace WEX::Common;
 using namespace WEX::Logging;
 
 static constexpr std::wstring_view emoji = L"\xD83E\xDD22"; // U+1F922 nauseated face
@@ -98,4 +101,113 @@ class CodepointWidthDetectorTests
         widthDetector.NotifyFontChanged();
         VERIFY_ARE_EQUAL(0u, widthDetector._fallbackCache.size());
     }
+
+    // The width of a single wchar, the way it was determined before there was a BMP table.
+    static CodepointWidth LookUpWidth(const CodepointWidthDetector& widthDetector, const wchar_t wch)
+    {
+        const auto width = GetQuickCharWidth(wch);
+        if (width == CodepointWidth::Invalid || width == CodepointWidth::Ambiguous)
+        {
+            return widthDetector._lookupGlyphWidthWithCache({ &wch, 1 });
+        }
+        return width;
+    }
+
+    TEST_METHOD(BmpTableMatchesLookup)
+    {
+        CodepointWidthDetector widthDetector;
+
+        size_t mismatches = 0;
+        for (unsigned int codepoint = 0; codepoint <= 0xFFFF; ++codepoint)
+        {
+            const auto wch = gsl::narrow_cast<wchar_t>(codepoint);
+            const auto expected = LookUpWidth(widthDetector, wch);
+            const auto actual = widthDetector.GetWidth({ &wch, 1 });
+            if (expected != actual)
+            {
+                Log::Comment(NoThrowString().Format(L"U+%04X: expected %d, got %d", codepoint, static_cast<int>(expected), static_cast<int>(actual)));
+                ++mismatches;
+            }
+        }
+        VERIFY_ARE_EQUAL(0u, mismatches);
+
+        Log::Comment(L"Glyphs that depend on the font must still ask the fallback.");
+        widthDetector.SetFallbackMethod([](const std::wstring_view) { return true; });
+        VERIFY_IS_TRUE(widthDetector.IsWide(ambiguous.front()));
+        VERIFY_ARE_EQUAL(1u, widthDetector._fallbackCache.size());
+        VERIFY_IS_FALSE(widthDetector.IsWide(L'A'));
+    }
+
+    TEST_METHOD(CanGetColumnWidths)
+    {
+        CodepointWidthDetector widthDetector;
+
+        // narrow, wide, an emoji surrogate pair, and a lone leading surrogate at the end
+        const std::wstring text{ L"a\x306A\xD83D\xDC7E\xD83D" };
+        std::array<BYTE, 5> widths{};
+        const auto columns = widthDetector.GetColumnWidths(text, widths);
+
+        VERIFY_ARE_EQUAL(1, widths.at(0));
+        VERIFY_ARE_EQUAL(2, widths.at(1));
+        VERIFY_ARE_EQUAL(2, widths.at(2));
+        VERIFY_ARE_EQUAL(0, widths.at(3));
+        VERIFY_ARE_EQUAL(widthDetector.IsWide(text.back()) ? 2 : 1, widths.at(4));
+        VERIFY_ARE_EQUAL(size_t{ widths.at(0) } + widths.at(1) + widths.at(2) + widths.at(4), columns);
+
+        Log::Comment(L"The widths must fit into the output.");
+        std::array<BYTE, 4> tooShort{};
+        VERIFY_THROWS(widthDetector.GetColumnWidths(text, tooShort), wil::ResultException);
+    }
+
+    TEST_METHOD(GlyphWidthPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        CodepointWidthDetector widthDetector;
+
+        const std::wstring_view cjkLine{ L"\x65E5\x672C\x8A9E\x306E\x30C6\x30AD\x30B9\x30C8\x3068\x6F22\x5B57\x3001\xD55C\xAD6D\xC5B4\x3002" };
+        const std::wstring_view mixedLine{ L"src\\host\\_stream.cpp(42): \x8B66\x544A C4996: 'wcscpy' \x00D7 3 \x2713 \x00E9t\x00E9 \xD83D\xDE00\r\n" };
+
+        for (const auto& [name, line] : { std::pair{ L"CJK", cjkLine }, std::pair{ L"mixed", mixedLine } })
+        {
+            std::wstring corpus;
+            while (corpus.size() < 1000000)
+            {
+                corpus.append(line);
+            }
+
+            size_t legacyWide = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (const auto wch : corpus)
+            {
+                legacyWide += LookUpWidth(widthDetector, wch) == CodepointWidth::Wide;
+            }
+            const std::chrono::duration<double, std::milli> legacy = std::chrono::steady_clock::now() - start;
+
+            size_t wide = 0;
+            start = std::chrono::steady_clock::now();
+            for (const auto wch : corpus)
+            {
+                wide += widthDetector.IsWide(wch);
+            }
+            const std::chrono::duration<double, std::milli> table = std::chrono::steady_clock::now() - start;
+
+            std::vector<BYTE> widths(corpus.size());
+            start = std::chrono::steady_clock::now();
+            const auto columns = widthDetector.GetColumnWidths(corpus, widths);
+            const std::chrono::duration<double, std::milli> bulk = std::chrono::steady_clock::now() - start;
+
+            VERIFY_ARE_EQUAL(legacyWide, wide);
+            VERIFY_IS_GREATER_THAN_OR_EQUAL(columns, corpus.size());
+
+            Log::Comment(NoThrowString().Format(L"%s: %zu characters, lookup %.1fms, table %.1fms, bulk %.1fms",
+                                                name,
+                                                corpus.size(),
+                                                legacy.count(),
+                                                table.count(),
+                                                bulk.count()));
+        }
+    }
 };
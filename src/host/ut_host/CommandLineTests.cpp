@@ -10,6 +10,7 @@
 #include "../../interactivity/inc/ServiceLocator.hpp"
 
 #include "../cmdline.h"
+#include "../_stream.h"
 
 using namespace WEX::Common;
 using namespace WEX::Logging;
@@ -103,6 +104,50 @@ class CommandLineTests
         cookedReadData._bufPtr = cookedReadData._backupLimit + column;
     }
 
+    std::vector<std::wstring> GetEditLineRows(COOKED_READ_DATA& cookedReadData, const SHORT rows)
+    {
+        const auto& textBuffer = cookedReadData.ScreenInfo().GetTextBuffer();
+        std::vector<std::wstring> text;
+        for (SHORT y = 0; y < rows; ++y)
+        {
+            text.push_back(textBuffer.GetRowByOffset(cookedReadData.OriginalCursorPosition().Y + y).GetText());
+        }
+        return text;
+    }
+
+    // Erases and redraws the whole edit line the way it used to be done after
+    // every edit, and checks that this doesn't change anything on the screen.
+    void VerifyMatchesFullRedraw(COOKED_READ_DATA& cookedReadData)
+    {
+        auto& screenInfo = cookedReadData.ScreenInfo();
+        const SHORT rows = 4;
+        const auto edited = GetEditLineRows(cookedReadData, rows);
+        const auto visibleCharCount = cookedReadData.VisibleCharCount();
+        const auto cursorPosition = screenInfo.GetTextBuffer().GetCursor().GetPosition();
+
+        DeleteCommandLine(cookedReadData, false);
+        RedrawCommandLine(cookedReadData);
+
+        const auto redrawn = GetEditLineRows(cookedReadData, rows);
+        for (SHORT y = 0; y < rows; ++y)
+        {
+            VERIFY_ARE_EQUAL(redrawn.at(y), edited.at(y));
+        }
+        VERIFY_ARE_EQUAL(visibleCharCount, cookedReadData.VisibleCharCount());
+
+        VERIFY_SUCCEEDED(screenInfo.SetCursorPosition(cursorPosition, true));
+    }
+
+    void MoveCursorLeft(COOKED_READ_DATA& cookedReadData, const size_t count)
+    {
+        auto& commandLine = CommandLine::Instance();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const COORD cursorPos = commandLine._moveCursorLeft(cookedReadData);
+            VERIFY_IS_TRUE(NT_SUCCESS(AdjustCursorPosition(cookedReadData.ScreenInfo(), cursorPos, true, nullptr)));
+        }
+    }
+
     TEST_METHOD(CanCycleCommandHistory)
     {
         auto buffer = std::make_unique<wchar_t[]>(PROMPT_SIZE);
@@ -468,6 +513,76 @@ class CommandLineTests
         VerifyPromptText(cookedReadData, L"inflammable");
     }
 
+    TEST_METHOD(EditingInsideLineMatchesFullRedraw)
+    {
+        auto buffer = std::make_unique<wchar_t[]>(PROMPT_SIZE);
+        VERIFY_IS_NOT_NULL(buffer.get());
+
+        auto& cookedReadData = ServiceLocator::LocateGlobals().getConsoleInformation().CookedReadData();
+        InitCookedReadData(cookedReadData, m_pHistory, buffer.get(), PROMPT_SIZE);
+        cookedReadData.SetInsertMode(true);
+
+        Log::Comment(L"Type a line that wraps onto the next rows, with a wide glyph that's padded onto the second row.");
+        std::wstring text(79, L'a');
+        text += L"\x30ab";
+        text.append(40, L'b');
+        text += L"\x30ac\x30ad";
+        text.append(60, L'c');
+        VERIFY_ARE_EQUAL(text.size(), cookedReadData.Write(text));
+        VerifyPromptText(cookedReadData, text);
+
+        NTSTATUS status = STATUS_SUCCESS;
+
+        Log::Comment(L"Insert in the middle of the line.");
+        MoveCursorLeft(cookedReadData, 50);
+        cookedReadData.ProcessInput(L'x', 0, status);
+        VERIFY_IS_TRUE(NT_SUCCESS(status));
+        VerifyMatchesFullRedraw(cookedReadData);
+
+        Log::Comment(L"Insert a wide glyph, which moves everything behind it by two cells.");
+        cookedReadData.ProcessInput(L'\x30ae', 0, status);
+        VERIFY_IS_TRUE(NT_SUCCESS(status));
+        VerifyMatchesFullRedraw(cookedReadData);
+
+        Log::Comment(L"Delete both again.");
+        cookedReadData.ProcessInput(UNICODE_BACKSPACE, 0, status);
+        VerifyMatchesFullRedraw(cookedReadData);
+        cookedReadData.ProcessInput(UNICODE_BACKSPACE, 0, status);
+        VerifyMatchesFullRedraw(cookedReadData);
+
+        Log::Comment(L"Overwrite a character.");
+        cookedReadData.SetInsertMode(false);
+        cookedReadData.ProcessInput(L'y', 0, status);
+        VERIFY_IS_TRUE(NT_SUCCESS(status));
+        VerifyMatchesFullRedraw(cookedReadData);
+
+        Log::Comment(L"Insert on the first row, in front of the padded wide glyph, so that it doesn't need padding anymore.");
+        cookedReadData.SetInsertMode(true);
+        MoveCursorLeft(cookedReadData, 100);
+        cookedReadData.ProcessInput(L'z', 0, status);
+        VERIFY_IS_TRUE(NT_SUCCESS(status));
+        VerifyMatchesFullRedraw(cookedReadData);
+
+        Log::Comment(L"Recall commands from the history that start out the same as the line and each other.");
+        VERIFY_SUCCEEDED(m_pHistory->Add(text.substr(0, 100) + L"one", false));
+        VERIFY_SUCCEEDED(m_pHistory->Add(text.substr(0, 120) + L"\x30af two", false));
+        SetCurrentCommandLine(cookedReadData, 1);
+        VerifyPromptText(cookedReadData, text.substr(0, 120) + L"\x30af two");
+        VerifyMatchesFullRedraw(cookedReadData);
+        SetCurrentCommandLine(cookedReadData, 0);
+        VerifyPromptText(cookedReadData, text.substr(0, 100) + L"one");
+        VerifyMatchesFullRedraw(cookedReadData);
+
+        Log::Comment(L"Recall a shorter command after one that ends in wide glyphs, which have to be cleared completely.");
+        VERIFY_SUCCEEDED(m_pHistory->Add(text.substr(0, 100) + L"\x30ab\x30ac\x30ad", false));
+        SetCurrentCommandLine(cookedReadData, 2);
+        VerifyPromptText(cookedReadData, text.substr(0, 100) + L"\x30ab\x30ac\x30ad");
+        VerifyMatchesFullRedraw(cookedReadData);
+        SetCurrentCommandLine(cookedReadData, 0);
+        VerifyPromptText(cookedReadData, text.substr(0, 100) + L"one");
+        VerifyMatchesFullRedraw(cookedReadData);
+    }
+
     TEST_METHOD(CmdlineCtrlHomeFullwidthChars)
     {
         Log::Comment(L"Set up buffers, create cooked read data, get screen information.");
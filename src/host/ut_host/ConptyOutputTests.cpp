@@ -117,6 +117,10 @@ class ConptyOutputTests
     TEST_METHOD(WriteTwoLinesUsesNewline);
     TEST_METHOD(WriteAFewSimpleLines);
     TEST_METHOD(InvalidateUntilOneBeforeEnd);
+    TEST_METHOD(SynchronizedOutputPaintsOneFrame);
+    TEST_METHOD(PassthroughWritesClientVtVerbatim);
+    TEST_METHOD(PassthroughWaitsForSplitSequences);
+    TEST_METHOD(PassthroughOmitsAnsweredQueries);
 
 private:
     bool _writeCallback(const char* const pch, size_t const cch);
@@ -371,3 +375,156 @@ void ConptyOutputTests::InvalidateUntilOneBeforeEnd()
 
     VERIFY_SUCCEEDED(renderer.PaintFrame());
 }
+
+void ConptyOutputTests::SynchronizedOutputPaintsOneFrame()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Redraw a few lines inside of a synchronized update. Nothing should be "
+        L"painted until the update ends, and then all of it in a single frame."));
+    VERIFY_IS_NOT_NULL(_pVtRenderEngine.get());
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& renderer = *g.pRender;
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& sm = si.GetStateMachine();
+
+    _flushFirstFrame();
+
+    size_t frames = 0;
+    const auto paintFrame = [&]() {
+        const auto outputBefore = expectedOutput.size();
+        VERIFY_SUCCEEDED(renderer.PaintFrame());
+        // Every write the engine made has been checked against (and popped
+        // from) the expected output, so any change here means we painted.
+        if (expectedOutput.size() != outputBefore)
+        {
+            ++frames;
+        }
+    };
+
+    expectedOutput.push_back("AAA");
+    expectedOutput.push_back("\r\n");
+    expectedOutput.push_back("BBB");
+    expectedOutput.push_back("\r\n");
+    expectedOutput.push_back("CCC");
+
+    sm.ProcessString(L"\x1b[?2026h");
+
+    sm.ProcessString(L"AAA");
+    paintFrame();
+    sm.ProcessString(L"\x1b[2;1H");
+    sm.ProcessString(L"BBB");
+    paintFrame();
+    sm.ProcessString(L"\x1b[3;1H");
+    sm.ProcessString(L"CCC");
+    paintFrame();
+
+    VERIFY_ARE_EQUAL(0u, frames, L"Nothing should be painted during a synchronized update.");
+    VERIFY_ARE_EQUAL(5u, expectedOutput.size());
+
+    sm.ProcessString(L"\x1b[?2026l");
+    paintFrame();
+
+    VERIFY_ARE_EQUAL(1u, frames, L"Ending the update should paint everything as one frame.");
+    VERIFY_ARE_EQUAL(0u, expectedOutput.size());
+
+    // With nothing left to paint, the next frame is empty.
+    paintFrame();
+    VERIFY_ARE_EQUAL(1u, frames);
+}
+
+void ConptyOutputTests::PassthroughWritesClientVtVerbatim()
+{
+    Log::Comment(NoThrowString().Format(
+        L"With passthrough enabled, VT the client writes should go to the "
+        L"terminal as-is, followed by a reset of the rendition. The buffer "
+        L"should still be updated, without painting any of it again."));
+    VERIFY_IS_NOT_NULL(_pVtRenderEngine.get());
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& vtIo = *gci.GetVtIo();
+
+    _flushFirstFrame();
+
+    vtIo.EnablePassthroughForTests(_pVtRenderEngine.get());
+    auto resetPassthrough = wil::scope_exit([&]() { vtIo.EnablePassthroughForTests(nullptr); });
+
+    expectedOutput.push_back("\x1b[31mAAA\x1b[m\r\nBBB");
+    expectedOutput.push_back("\x1b[m");
+
+    VERIFY_SUCCEEDED(vtIo.PassthroughString(si, L"\x1b[31mAAA\x1b[m\r\nBBB"));
+    VERIFY_ARE_EQUAL(0u, expectedOutput.size());
+
+    auto iter = si.GetTextBuffer().GetCellDataAt({ 0, 0 });
+    _verifySpanOfText(L"A", iter, 0, 3);
+    iter = si.GetTextBuffer().GetCellDataAt({ 0, 1 });
+    _verifySpanOfText(L"B", iter, 0, 3);
+}
+
+void ConptyOutputTests::PassthroughWaitsForSplitSequences()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Write a sequence split across two writes with passthrough enabled. "
+        L"Nothing of ours should be written in between its halves, neither "
+        L"the reset of the rendition nor a frame."));
+    VERIFY_IS_NOT_NULL(_pVtRenderEngine.get());
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& vtIo = *gci.GetVtIo();
+
+    _flushFirstFrame();
+
+    vtIo.EnablePassthroughForTests(_pVtRenderEngine.get());
+    auto resetPassthrough = wil::scope_exit([&]() { vtIo.EnablePassthroughForTests(nullptr); });
+
+    expectedOutput.push_back("\x1b[3");
+    VERIFY_SUCCEEDED(vtIo.PassthroughString(si, L"\x1b[3"));
+    VERIFY_ARE_EQUAL(0u, expectedOutput.size());
+
+    // Any write the frame made would fail the test, since none is expected.
+    VERIFY_SUCCEEDED(_pVtRenderEngine->InvalidateAll());
+    VERIFY_SUCCEEDED(g.pRender->PaintFrame());
+
+    expectedOutput.push_back("1mX");
+    expectedOutput.push_back("\x1b[m");
+    VERIFY_SUCCEEDED(vtIo.PassthroughString(si, L"1mX"));
+    VERIFY_ARE_EQUAL(0u, expectedOutput.size());
+
+    auto iter = si.GetTextBuffer().GetCellDataAt({ 0, 0 });
+    _verifySpanOfText(L"X", iter, 0, 1);
+}
+
+void ConptyOutputTests::PassthroughOmitsAnsweredQueries()
+{
+    Log::Comment(NoThrowString().Format(
+        L"Write a cursor position query with passthrough enabled. We answer "
+        L"it ourselves, so it shouldn't reach the terminal, or the client "
+        L"would get a second answer."));
+    VERIFY_IS_NOT_NULL(_pVtRenderEngine.get());
+
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& vtIo = *gci.GetVtIo();
+
+    _flushFirstFrame();
+
+    vtIo.EnablePassthroughForTests(_pVtRenderEngine.get());
+    auto resetPassthrough = wil::scope_exit([&]() {
+        vtIo.EnablePassthroughForTests(nullptr);
+        gci.pInputBuffer->Flush();
+    });
+
+    expectedOutput.push_back("AB\x1b[0mC");
+    expectedOutput.push_back("\x1b[m");
+    VERIFY_SUCCEEDED(vtIo.PassthroughString(si, L"A\x1b[6nB\x1b[0mC\x1b[c"));
+    VERIFY_ARE_EQUAL(0u, expectedOutput.size());
+
+    // Both replies are ours: "\x1b[1;2R" and "\x1b[?1;0c", as key downs and ups.
+    VERIFY_ARE_EQUAL(26u, gci.pInputBuffer->GetNumberOfReadyEvents());
+}
@@ -9,6 +9,8 @@
 
 #include "search.h"
 
+#include <chrono>
+
 using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -242,6 +244,110 @@ class HistoryTests
         VERIFY_ARE_EQUAL(2ul, history->GetNumberOfCommands());
     }
 
+    // Searches the history the way FindMatchingCommand always did: one command after the other,
+    // going backwards from the one before the starting index.
+    static bool FindMatchingCommandByScan(const CommandHistory& history, const std::wstring_view givenCommand, SHORT startingIndex, const bool exactMatch, SHORT& indexFound)
+    {
+        const auto count = gsl::narrow<SHORT>(history.GetNumberOfCommands());
+        for (SHORT i = 0; i < count; ++i)
+        {
+            startingIndex = startingIndex <= 0 ? count - 1 : startingIndex - 1;
+            const auto stored = history.GetNth(startingIndex);
+            if ((exactMatch ? stored.size() == givenCommand.size() : stored.size() >= givenCommand.size()) &&
+                std::equal(givenCommand.cbegin(), givenCommand.cend(), stored.cbegin(), [](auto a, auto b) { return ::towlower(a) == ::towlower(b); }))
+            {
+                indexFound = startingIndex;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    TEST_METHOD(FindMatchingCommandAgreesWithScan)
+    {
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+        history->Realloc(_manyHistoryItems.size() * 2);
+
+        for (const auto& item : _manyHistoryItems)
+        {
+            VERIFY_SUCCEEDED(history->Add(item, false));
+        }
+        VERIFY_SUCCEEDED(history->Add(L"DIR /W", false));
+        VERIFY_SUCCEEDED(history->Add(L"ping localhost", false));
+
+        Log::Comment(L"Move commands around the way the command list popup does.");
+        history->Swap(0, 5);
+        history->Swap(7, 8);
+        history->Remove(3);
+
+        const std::array<std::wstring_view, 8> searches{ L"dir", L"DIR /w", L"ip", L"ping", L"p", L"git push", L"nothing", L"dir /p /w" };
+        for (const auto search : searches)
+        {
+            for (SHORT start = 0; start < gsl::narrow<SHORT>(history->GetNumberOfCommands()); ++start)
+            {
+                for (const auto exactMatch : { false, true })
+                {
+                    const auto options = CommandHistory::MatchOptions::JustLooking | (exactMatch ? CommandHistory::MatchOptions::ExactMatch : CommandHistory::MatchOptions::None);
+
+                    SHORT expected = -1;
+                    const auto expectedFound = FindMatchingCommandByScan(*history, search, start, exactMatch, expected);
+
+                    SHORT actual = 0;
+                    VERIFY_ARE_EQUAL(expectedFound, history->FindMatchingCommand(search, start, actual, options));
+                    if (expectedFound)
+                    {
+                        VERIFY_ARE_EQUAL(expected, actual);
+                    }
+                }
+            }
+        }
+    }
+
+    TEST_METHOD(PrefixSearchPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        const size_t commandCount = 10000;
+        auto history = CommandHistory::s_Allocate(_manyApps[0], _MakeHandle(0));
+        VERIFY_IS_NOT_NULL(history);
+        history->Realloc(commandCount);
+
+        Log::Comment(L"Fill the history, then add every command again. Duplicates are suppressed, so the second round moves them to the end.");
+        const auto addStart = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < commandCount * 2; ++i)
+        {
+            const auto command = L"msbuild project" + std::to_wstring(i % commandCount) + L".vcxproj /p:Configuration=Release";
+            VERIFY_SUCCEEDED(history->Add(command, true));
+        }
+        const std::chrono::duration<double, std::milli> addElapsed = std::chrono::steady_clock::now() - addStart;
+        VERIFY_ARE_EQUAL(commandCount, history->GetNumberOfCommands());
+
+        Log::Comment(L"Search it like repeated F8 presses would.");
+        const size_t searchCount = 10000;
+        size_t found = 0;
+        const auto searchStart = std::chrono::steady_clock::now();
+        SHORT index = history->LastDisplayed;
+        for (size_t i = 0; i < searchCount; ++i)
+        {
+            const auto prefix = L"MSBuild project" + std::to_wstring(i % 100);
+            if (history->FindMatchingCommand(prefix, index, index, CommandHistory::MatchOptions::None))
+            {
+                ++found;
+            }
+        }
+        const std::chrono::duration<double, std::milli> searchElapsed = std::chrono::steady_clock::now() - searchStart;
+        VERIFY_ARE_EQUAL(searchCount, found);
+
+        Log::Comment(NoThrowString().Format(L"%zu adds in %.1fms, %zu prefix searches in %.1fms",
+                                            commandCount * 2,
+                                            addElapsed.count(),
+                                            searchCount,
+                                            searchElapsed.count()));
+    }
+
 private:
     const std::array<std::wstring, 5> _manyApps = {
         L"foo.exe",
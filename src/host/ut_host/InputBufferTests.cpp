@@ -9,6 +9,8 @@
 #include "..\interactivity\inc\ServiceLocator.hpp"
 #include "..\types\inc\IInputEvent.hpp"
 
+#include <chrono>
+
 using namespace WEX::Logging;
 using Microsoft::Console::Interactivity::ServiceLocator;
 
@@ -78,7 +80,7 @@ class InputBufferTests
             INPUT_RECORD record;
             record.EventType = MENU_EVENT;
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back()->ToInputRecord());
+            VERIFY_ARE_EQUAL(record, inputBuffer._storage.back());
         }
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT);
     }
@@ -98,7 +100,7 @@ class InputBufferTests
         // verify that the events are the same in storage
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i]->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i], record);
         }
     }
 
@@ -121,10 +123,9 @@ class InputBufferTests
         // check that they coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 1u);
         // check that the mouse position is being updated correctly
-        const IInputEvent* const pOutEvent = inputBuffer._storage.front().get();
-        const MouseEvent* const pMouseEvent = static_cast<const MouseEvent* const>(pOutEvent);
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().X, static_cast<SHORT>(RECORD_INSERT_COUNT));
-        VERIFY_ARE_EQUAL(pMouseEvent->GetPosition().Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
+        const MOUSE_EVENT_RECORD& outMouseEvent = inputBuffer._storage.front().Event.MouseEvent;
+        VERIFY_ARE_EQUAL(outMouseEvent.dwMousePosition.X, static_cast<SHORT>(RECORD_INSERT_COUNT));
+        VERIFY_ARE_EQUAL(outMouseEvent.dwMousePosition.Y, static_cast<SHORT>(RECORD_INSERT_COUNT * 2));
 
         // add a key event and another mouse event to make sure that
         // an event between two mouse events stopped the coalescing.
@@ -162,10 +163,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), mouseRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), mouseRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), mouseRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], mouseRecords[i]);
         }
     }
 
@@ -221,10 +222,10 @@ class InputBufferTests
         // no events should have been coalesced
         VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), RECORD_INSERT_COUNT + 1);
         // check that the events stored match those inserted
-        VERIFY_ARE_EQUAL(inputBuffer._storage.front()->ToInputRecord(), keyRecords[0]);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front(), keyRecords[0]);
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
-            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1]->ToInputRecord(), keyRecords[i]);
+            VERIFY_ARE_EQUAL(inputBuffer._storage[i + 1], keyRecords[i]);
         }
     }
 
@@ -239,7 +240,7 @@ class InputBufferTests
         for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
         {
             VERIFY_IS_GREATER_THAN(inputBuffer.Write(IInputEvent::Create(record)), 0u);
-            VERIFY_ARE_EQUAL(inputBuffer._storage.back()->ToInputRecord(), record);
+            VERIFY_ARE_EQUAL(inputBuffer._storage.back(), record);
         }
 
         // The events shouldn't be coalesced
@@ -382,10 +383,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read one record, make sure ResetWaitEvent isn't set
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords;
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 1,
                                 eventsRead,
                                 false,
@@ -396,8 +397,8 @@ class InputBufferTests
         VERIFY_IS_FALSE(!!resetWaitEvent);
 
         // read the rest, resetWaitEvent should be set to true
-        outEvents.clear();
-        inputBuffer._ReadBuffer(outEvents,
+        outRecords.clear();
+        inputBuffer._ReadBuffer(outRecords,
                                 RECORD_INSERT_COUNT - 1,
                                 eventsRead,
                                 false,
@@ -431,10 +432,10 @@ class InputBufferTests
         VERIFY_IS_GREATER_THAN(inputBuffer.Write(inEvents), 0u);
 
         // read them out non-unicode style and compare
-        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        std::vector<INPUT_RECORD> outRecords;
         size_t eventsRead = 0;
         bool resetWaitEvent = false;
-        inputBuffer._ReadBuffer(outEvents,
+        inputBuffer._ReadBuffer(outRecords,
                                 recordInsertCount,
                                 eventsRead,
                                 false,
@@ -444,10 +445,10 @@ class InputBufferTests
         // the dbcs record should have counted for two elements in
         // the array, making it so that we get less events read
         VERIFY_ARE_EQUAL(eventsRead, recordInsertCount - 1);
-        VERIFY_ARE_EQUAL(eventsRead, outEvents.size());
+        VERIFY_ARE_EQUAL(eventsRead, outRecords.size());
         for (size_t i = 0; i < eventsRead; ++i)
         {
-            VERIFY_ARE_EQUAL(outEvents[i]->ToInputRecord(), inRecords[i]);
+            VERIFY_ARE_EQUAL(outRecords[i], inRecords[i]);
         }
     }
 
@@ -589,22 +590,17 @@ class InputBufferTests
     {
         InputBuffer inputBuffer;
         INPUT_RECORD record = MakeKeyEvent(true, 1, L'a', 0, L'a', 0);
-        std::unique_ptr<IInputEvent> inputEvent = IInputEvent::Create(record);
         size_t eventsWritten;
         bool waitEvent = false;
         inputBuffer.Flush();
         // write one event to an empty buffer
-        std::deque<std::unique_ptr<IInputEvent>> storage;
-        storage.push_back(std::move(inputEvent));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record, 1 }, eventsWritten, waitEvent);
         VERIFY_IS_TRUE(waitEvent);
         // write another, it shouldn't signal this time
         INPUT_RECORD record2 = MakeKeyEvent(true, 1, L'b', 0, L'b', 0);
-        std::unique_ptr<IInputEvent> inputEvent2 = IInputEvent::Create(record2);
         // write another event to a non-empty buffer
         waitEvent = false;
-        storage.push_back(std::move(inputEvent2));
-        inputBuffer._WriteBuffer(storage, eventsWritten, waitEvent);
+        inputBuffer._WriteBuffer({ &record2, 1 }, eventsWritten, waitEvent);
 
         VERIFY_IS_FALSE(waitEvent);
     }
@@ -625,7 +621,7 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount - 1);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount - 1);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
 
@@ -645,7 +641,236 @@ class InputBufferTests
                                                  true));
         VERIFY_ARE_EQUAL(outEvents.size(), 1u);
         VERIFY_ARE_EQUAL(inputBuffer._storage.size(), 1u);
-        VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*inputBuffer._storage.front()).GetRepeatCount(), repeatCount);
+        VERIFY_ARE_EQUAL(inputBuffer._storage.front().Event.KeyEvent.wRepeatCount, repeatCount);
         VERIFY_ARE_EQUAL(static_cast<const KeyEvent&>(*outEvents.front()).GetRepeatCount(), 1u);
     }
+
+    TEST_METHOD(StorageWrapsAroundWhenPartiallyRead)
+    {
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> records;
+        for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            const auto ch = static_cast<WCHAR>(L'A' + i);
+            records.push_back(MakeKeyEvent(TRUE, 1, ch, 0, ch, 0));
+        }
+
+        Log::Comment(L"Reading part of the records moves the front of the ring.");
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT, inputBuffer.Write(records));
+        std::vector<INPUT_RECORD> outRecords;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, RECORD_INSERT_COUNT - 2, false, false, true, false));
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT - 2, outRecords.size());
+
+        const auto capacity = inputBuffer._storage.capacity();
+        std::vector<INPUT_RECORD> wrapping;
+        std::vector<INPUT_RECORD> growing;
+        for (size_t i = 0; i < capacity; ++i)
+        {
+            if (i < capacity - 4)
+            {
+                wrapping.push_back(records[i % RECORD_INSERT_COUNT]);
+            }
+            growing.push_back(records[(i + 5) % RECORD_INSERT_COUNT]);
+        }
+
+        Log::Comment(L"Writing up to the capacity wraps around the end of the ring.");
+        VERIFY_ARE_EQUAL(wrapping.size(), inputBuffer.Write(wrapping));
+        VERIFY_ARE_EQUAL(capacity, inputBuffer._storage.capacity());
+
+        Log::Comment(L"Writing past the capacity grows the ring.");
+        VERIFY_ARE_EQUAL(growing.size(), inputBuffer.Write(growing));
+        VERIFY_IS_GREATER_THAN(inputBuffer._storage.capacity(), capacity);
+
+        Log::Comment(L"Prepending puts records in front of the others.");
+        VERIFY_ARE_EQUAL(1u, inputBuffer.Prepend({ records.data(), 1 }));
+
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 3, false, false, true, false));
+        VERIFY_ARE_EQUAL(records[0], outRecords[RECORD_INSERT_COUNT - 2]);
+        VERIFY_ARE_EQUAL(records[RECORD_INSERT_COUNT - 2], outRecords[RECORD_INSERT_COUNT - 1]);
+        VERIFY_ARE_EQUAL(records[RECORD_INSERT_COUNT - 1], outRecords[RECORD_INSERT_COUNT]);
+
+        outRecords.clear();
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, wrapping.size() + growing.size(), false, false, true, false));
+        VERIFY_ARE_EQUAL(wrapping.size() + growing.size(), outRecords.size());
+        for (size_t i = 0; i < wrapping.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(wrapping[i], outRecords[i]);
+        }
+        for (size_t i = 0; i < growing.size(); ++i)
+        {
+            VERIFY_ARE_EQUAL(growing[i], outRecords[wrapping.size() + i]);
+        }
+        VERIFY_ARE_EQUAL(inputBuffer.GetNumberOfReadyEvents(), 0u);
+    }
+
+    TEST_METHOD(WriteBatchSignalsOnceAtTheEnd)
+    {
+        InputBuffer inputBuffer;
+        auto& inputEvent = ServiceLocator::LocateGlobals().hInputEvent;
+        inputBuffer.Flush();
+        VERIFY_IS_FALSE(inputEvent.is_signaled());
+
+        inputBuffer.BeginWriteBatch();
+        for (size_t i = 0; i < RECORD_INSERT_COUNT; ++i)
+        {
+            const auto ch = static_cast<WCHAR>(L'A' + i);
+            const auto record = MakeKeyEvent(TRUE, 1, ch, 0, ch, 0);
+            VERIFY_ARE_EQUAL(1u, inputBuffer.Write({ &record, 1 }));
+        }
+
+        Log::Comment(L"Nested batches don't signal either.");
+        inputBuffer.BeginWriteBatch();
+        inputBuffer.EndWriteBatch();
+        VERIFY_IS_FALSE(inputEvent.is_signaled());
+        VERIFY_ARE_EQUAL(RECORD_INSERT_COUNT, inputBuffer.GetNumberOfReadyEvents());
+
+        inputBuffer.EndWriteBatch();
+        VERIFY_IS_TRUE(inputEvent.is_signaled());
+    }
+
+    TEST_METHOD(CanReadTextRuns)
+    {
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> records;
+        for (const auto ch : std::wstring_view{ L"Hi there" })
+        {
+            if (ch == L'H')
+            {
+                records.push_back(MakeKeyEvent(TRUE, 1, VK_SHIFT, 0, 0, SHIFT_PRESSED));
+            }
+            // letters use their upper case as virtual key, like they do when typed
+            const auto vkey = static_cast<WORD>(std::towupper(ch));
+            records.push_back(MakeKeyEvent(TRUE, 1, vkey, 0, ch, 0));
+            records.push_back(MakeKeyEvent(FALSE, 1, vkey, 0, ch, 0));
+        }
+        records.push_back(MakeKeyEvent(TRUE, 1, VK_RETURN, 0, UNICODE_CARRIAGERETURN, 0));
+        records.push_back(MakeKeyEvent(TRUE, 1, L'X', 0, L'x', 0));
+        VERIFY_ARE_EQUAL(records.size(), inputBuffer.Write(records));
+
+        Log::Comment(L"The run stops after as many characters as asked for.");
+        std::wstring text;
+        VERIFY_ARE_EQUAL(3u, inputBuffer.ReadTextRun(text, 3));
+        VERIFY_ARE_EQUAL(L"Hi ", text);
+
+        Log::Comment(L"Key ups are consumed with the run, the carriage return ends it.");
+        VERIFY_ARE_EQUAL(5u, inputBuffer.ReadTextRun(text, 100));
+        VERIFY_ARE_EQUAL(L"there", text);
+        VERIFY_ARE_EQUAL(0u, inputBuffer.ReadTextRun(text, 100));
+        VERIFY_ARE_EQUAL(2u, inputBuffer.GetNumberOfReadyEvents());
+
+        std::vector<INPUT_RECORD> outRecords;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 1, false, false, true, false));
+        VERIFY_ARE_EQUAL(records[records.size() - 2], outRecords[0]);
+
+        Log::Comment(L"Reading the rest of the buffer resets the wait event.");
+        VERIFY_ARE_EQUAL(1u, inputBuffer.ReadTextRun(text, 100));
+        VERIFY_ARE_EQUAL(L"x", text);
+        VERIFY_ARE_EQUAL(0u, inputBuffer.GetNumberOfReadyEvents());
+        VERIFY_IS_FALSE(ServiceLocator::LocateGlobals().hInputEvent.is_signaled());
+    }
+
+    TEST_METHOD(TextRunsStopAtKeysReadsHandleThemselves)
+    {
+        InputBuffer inputBuffer;
+        const std::vector<INPUT_RECORD> records{
+            MakeKeyEvent(TRUE, 1, L'A', 0, L'a', 0),
+            MakeKeyEvent(FALSE, 1, L'A', 0, L'a', 0),
+            MakeKeyEvent(TRUE, 1, VK_CONTROL, 0, 0, LEFT_CTRL_PRESSED),
+            MakeKeyEvent(TRUE, 1, L'B', 0, L'b', LEFT_CTRL_PRESSED),
+            MakeKeyEvent(TRUE, 1, L'C', 0, L'c', 0),
+            MakeKeyEvent(FALSE, 1, L'Z', 0, L'z', 0),
+            MakeKeyEvent(TRUE, 1, L'D', 0, L'd', 0),
+            MakeKeyEvent(FALSE, 1, VK_MENU, 0, L'e', 0),
+        };
+        VERIFY_ARE_EQUAL(records.size(), inputBuffer.Write(records));
+
+        std::wstring text;
+        Log::Comment(L"Pressing ctrl ends the run.");
+        VERIFY_ARE_EQUAL(1u, inputBuffer.ReadTextRun(text, 100));
+        VERIFY_ARE_EQUAL(L"a", text);
+        VERIFY_ARE_EQUAL(0u, inputBuffer.ReadTextRun(text, 100));
+
+        Log::Comment(L"So do characters typed with ctrl, whose modifiers cooked reads hand back.");
+        std::vector<INPUT_RECORD> outRecords;
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 1, false, false, true, false));
+        VERIFY_ARE_EQUAL(0u, inputBuffer.ReadTextRun(text, 100));
+        outRecords.clear();
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 1, false, false, true, false));
+        VERIFY_ARE_EQUAL(records[3], outRecords[0]);
+
+        Log::Comment(L"Releasing a key that isn't part of the run ends it.");
+        VERIFY_ARE_EQUAL(1u, inputBuffer.ReadTextRun(text, 100));
+        VERIFY_ARE_EQUAL(L"c", text);
+        VERIFY_ARE_EQUAL(3u, inputBuffer.GetNumberOfReadyEvents());
+        VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, 1, false, false, true, false));
+
+        Log::Comment(L"Releasing alt ends it too, since it can type a character on the numpad.");
+        VERIFY_ARE_EQUAL(1u, inputBuffer.ReadTextRun(text, 100));
+        VERIFY_ARE_EQUAL(L"d", text);
+        VERIFY_ARE_EQUAL(1u, inputBuffer.GetNumberOfReadyEvents());
+    }
+
+    TEST_METHOD(WriteAndReadPerformance)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+        END_TEST_METHOD_PROPERTIES()
+
+        const size_t eventCount = 1000000;
+        const size_t readSize = 4096;
+        std::vector<INPUT_RECORD> records;
+        records.reserve(eventCount);
+        for (size_t i = 0; i < eventCount; ++i)
+        {
+            // alternate between two keys so that nothing gets coalesced
+            const auto ch = (i % 2) ? L'b' : L'a';
+            records.push_back(MakeKeyEvent(TRUE, 1, ch, 0, ch, 0));
+        }
+
+        InputBuffer inputBuffer;
+        std::vector<INPUT_RECORD> outRecords;
+        outRecords.reserve(eventCount);
+
+        const auto bulkStart = std::chrono::steady_clock::now();
+        VERIFY_ARE_EQUAL(eventCount, inputBuffer.Write(records));
+        while (inputBuffer.GetNumberOfReadyEvents() != 0)
+        {
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, readSize, false, false, true, false));
+        }
+        const auto bulkEnd = std::chrono::steady_clock::now();
+        VERIFY_ARE_EQUAL(eventCount, outRecords.size());
+
+        outRecords.clear();
+        for (const auto& record : records)
+        {
+            inputBuffer.Write({ &record, 1 });
+        }
+        while (inputBuffer.GetNumberOfReadyEvents() != 0)
+        {
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outRecords, readSize, false, false, true, false));
+        }
+        const auto singleEnd = std::chrono::steady_clock::now();
+        VERIFY_ARE_EQUAL(eventCount, outRecords.size());
+
+        Log::Comment(L"For comparison, the same through the IInputEvent adapters.");
+        auto inEvents = IInputEvent::Create(gsl::make_span(records));
+        std::deque<std::unique_ptr<IInputEvent>> outEvents;
+        const auto adapterStart = std::chrono::steady_clock::now();
+        VERIFY_ARE_EQUAL(eventCount, inputBuffer.Write(inEvents));
+        while (inputBuffer.GetNumberOfReadyEvents() != 0)
+        {
+            VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(outEvents, readSize, false, false, true, false));
+        }
+        const auto adapterEnd = std::chrono::steady_clock::now();
+        VERIFY_ARE_EQUAL(eventCount, outEvents.size());
+
+        const std::chrono::duration<double, std::milli> bulk = bulkEnd - bulkStart;
+        const std::chrono::duration<double, std::milli> single = singleEnd - bulkEnd;
+        const std::chrono::duration<double, std::milli> adapter = adapterEnd - adapterStart;
+        Log::Comment(WEX::Common::NoThrowString().Format(L"%zu key events written and read: %.1fms in bulk, %.1fms one by one, %.1fms through IInputEvent",
+                                                         eventCount,
+                                                         bulk.count(),
+                                                         single.count(),
+                                                         adapter.count()));
+    }
 };
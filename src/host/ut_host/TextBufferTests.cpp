@@ -17,6 +17,8 @@
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../renderer/inc/DummyRenderTarget.hpp"
 
+#include <chrono>
+
 using namespace Microsoft::Console::Types;
 using namespace Microsoft::Console::Interactivity;
 using namespace Microsoft::Console::VirtualTerminal;
@@ -152,6 +154,24 @@ class TextBufferTests
 
     TEST_METHOD(GetTextRects);
     TEST_METHOD(GetText);
+
+    void FillBufferForReflow(TextBuffer& buffer, const size_t lineCount);
+    void ReflowByInsertion(TextBuffer& oldBuffer, TextBuffer& newBuffer);
+    void VerifyBuffersMatch(const TextBuffer& expected, const TextBuffer& actual);
+    TEST_METHOD(ReflowMatchesInsertion);
+    TEST_METHOD(ReflowPerformance);
+    TEST_METHOD(LazyReflowMatchesReflow);
+
+    TEST_METHOD(AttributeTableIsCompacted);
+    TEST_METHOD(ColorizedOutputPerformance);
+
+    TEST_METHOD(CharRowMeasuresStoredGlyphs);
+    TEST_METHOD(CharRowPerformance);
+
+    TEST_METHOD(WriteCharInfosMatchesCellIterator);
+
+    TEST_METHOD(CopyAndFillRectangle);
+    TEST_METHOD(CopyRectanglePerformance);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -2468,3 +2488,681 @@ void TextBufferTests::GetText()
         VERIFY_ARE_EQUAL(expectedText, result);
     }
 }
+
+// Fills the buffer with lines of varying lengths and colors, including wide
+// glyphs and glyphs that need the UnicodeStorage, so that reflowing it
+// exercises wrapping, double byte padding and circling.
+void TextBufferTests::FillBufferForReflow(TextBuffer& buffer, const size_t lineCount)
+{
+    const std::wstring_view peach{ L"\xD83C\xDF51" };
+    const DbcsAttribute single{};
+    const DbcsAttribute leading{ DbcsAttribute::Attribute::Leading };
+    const DbcsAttribute trailing{ DbcsAttribute::Attribute::Trailing };
+
+    for (size_t line = 0; line < lineCount; ++line)
+    {
+        const TextAttribute attr{ gsl::narrow_cast<WORD>(line % 16) };
+        const TextAttribute altAttr{ gsl::narrow_cast<WORD>((line + 5) % 16) };
+        const auto length = (line * 7) % 45;
+
+        for (size_t col = 0; col < length; ++col)
+        {
+            if (col % 11 == 3)
+            {
+                VERIFY_IS_TRUE(buffer.InsertCharacter(L'\x30a2', leading, altAttr));
+                VERIFY_IS_TRUE(buffer.InsertCharacter(L'\x30a2', trailing, altAttr));
+            }
+            else if (col % 13 == 5)
+            {
+                VERIFY_IS_TRUE(buffer.InsertCharacter(peach, single, attr));
+            }
+            else
+            {
+                const auto wch = gsl::narrow_cast<wchar_t>(L'A' + (line + col) % 26);
+                VERIFY_IS_TRUE(buffer.InsertCharacter(wch, single, col % 4 ? attr : altAttr));
+            }
+        }
+
+        if (line % 5 != 4)
+        {
+            VERIFY_IS_TRUE(buffer.NewlineCursor());
+        }
+    }
+}
+
+// The cell-by-cell reflow algorithm, which TextBuffer::Reflow must match.
+void TextBufferTests::ReflowByInsertion(TextBuffer& oldBuffer, TextBuffer& newBuffer)
+{
+    const COORD oldCursorPos = oldBuffer.GetCursor().GetPosition();
+    const COORD oldLastChar = oldBuffer.GetLastNonSpaceCharacter();
+    const short oldRowsTotal = oldLastChar.Y + 1;
+    const short oldColsTotal = oldBuffer.GetSize().Width();
+
+    COORD newCursorPos{ 0 };
+    bool foundCursorPos = false;
+    for (short oldRow = 0; oldRow < oldRowsTotal; oldRow++)
+    {
+        const ROW& row = oldBuffer.GetRowByOffset(oldRow);
+        const CharRow& charRow = row.GetCharRow();
+        short right = gsl::narrow_cast<short>(charRow.MeasureRight());
+        if (charRow.WasWrapForced())
+        {
+            right = charRow.WasDoubleBytePadded() ? oldColsTotal - 1 : oldColsTotal;
+        }
+
+        for (short oldCol = 0; oldCol < right; oldCol++)
+        {
+            if (oldCol == oldCursorPos.X && oldRow == oldCursorPos.Y)
+            {
+                newCursorPos = newBuffer.GetCursor().GetPosition();
+                foundCursorPos = true;
+            }
+
+            VERIFY_IS_TRUE(newBuffer.InsertCharacter(charRow.GlyphAt(oldCol),
+                                                     charRow.DbcsAttrAt(oldCol),
+                                                     row.GetAttrRow().GetAttrByColumn(oldCol)));
+        }
+
+        if (right < oldColsTotal && !charRow.WasWrapForced())
+        {
+            if (right == oldCursorPos.X && oldRow == oldCursorPos.Y)
+            {
+                newCursorPos = newBuffer.GetCursor().GetPosition();
+                foundCursorPos = true;
+            }
+
+            if (oldRow < oldRowsTotal - 1)
+            {
+                VERIFY_IS_TRUE(newBuffer.NewlineCursor());
+            }
+            else
+            {
+                const COORD cursor = newBuffer.GetCursor().GetPosition();
+                if (cursor.X == 0 && cursor.Y > 0 && newBuffer.GetRowByOffset(cursor.Y - 1).GetCharRow().WasWrapForced())
+                {
+                    VERIFY_IS_TRUE(newBuffer.NewlineCursor());
+                }
+            }
+        }
+    }
+
+    // The buffers used by ReflowMatchesInsertion always end with the cursor
+    // in the text, so the cursor is always found.
+    VERIFY_IS_TRUE(foundCursorPos);
+    newBuffer.GetCursor().SetPosition(newCursorPos);
+}
+
+void TextBufferTests::VerifyBuffersMatch(const TextBuffer& expected, const TextBuffer& actual)
+{
+    VERIFY_ARE_EQUAL(expected.GetSize().Dimensions(), actual.GetSize().Dimensions());
+    VERIFY_ARE_EQUAL(expected.GetCursor().GetPosition(), actual.GetCursor().GetPosition());
+
+    for (short y = 0; y < expected.GetSize().Height(); y++)
+    {
+        const auto& expectedRow = expected.GetRowByOffset(y).GetCharRow();
+        const auto& actualRow = actual.GetRowByOffset(y).GetCharRow();
+        VERIFY_ARE_EQUAL(expectedRow.WasWrapForced(), actualRow.WasWrapForced(), NoThrowString().Format(L"Wrap flag of row %d", y));
+        VERIFY_ARE_EQUAL(expectedRow.WasDoubleBytePadded(), actualRow.WasDoubleBytePadded(), NoThrowString().Format(L"Padding flag of row %d", y));
+
+        for (short x = 0; x < expected.GetSize().Width(); x++)
+        {
+            const auto expectedCell = *expected.GetCellDataAt({ x, y });
+            const auto actualCell = *actual.GetCellDataAt({ x, y });
+            const auto location = NoThrowString().Format(L"Cell (Y=%d, X=%d)", y, x);
+            VERIFY_ARE_EQUAL(String(expectedCell.Chars().data(), gsl::narrow<int>(expectedCell.Chars().size())),
+                             String(actualCell.Chars().data(), gsl::narrow<int>(actualCell.Chars().size())),
+                             location);
+            VERIFY_ARE_EQUAL(expectedCell.DbcsAttr().IsLeading(), actualCell.DbcsAttr().IsLeading(), location);
+            VERIFY_ARE_EQUAL(expectedCell.DbcsAttr().IsTrailing(), actualCell.DbcsAttr().IsTrailing(), location);
+            VERIFY_ARE_EQUAL(expectedCell.TextAttr(), actualCell.TextAttr(), location);
+        }
+    }
+}
+
+void TextBufferTests::ReflowMatchesInsertion()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"Data:newWidth", L"{2, 3, 7, 19, 20, 21, 64}")
+        TEST_METHOD_PROPERTY(L"Data:newHeight", L"{1, 7, 40, 300}")
+    END_TEST_METHOD_PROPERTIES();
+
+    short newWidth;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"newWidth", newWidth), L"Width of the reflowed buffer");
+
+    short newHeight;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"newHeight", newHeight), L"Height of the reflowed buffer");
+
+    const TextAttribute attr{ 0x7 };
+    TextBuffer oldBuffer({ 20, 50 }, attr, 12, _renderTarget);
+    FillBufferForReflow(oldBuffer, 60);
+
+    TextBuffer expected({ newWidth, newHeight }, attr, 12, _renderTarget);
+    TextBuffer actual({ newWidth, newHeight }, attr, 12, _renderTarget);
+
+    Log::Comment(L"Reflow the buffer character by character and with TextBuffer::Reflow.");
+    ReflowByInsertion(oldBuffer, expected);
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, actual, std::nullopt, std::nullopt));
+
+    VerifyBuffersMatch(expected, actual);
+}
+
+void TextBufferTests::ReflowPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const TextAttribute attr{ 0x7 };
+    const short scrollback = 30000;
+    TextBuffer oldBuffer({ 120, scrollback }, attr, 12, _renderTarget);
+    FillBufferForReflow(oldBuffer, scrollback);
+
+    for (const short newWidth : { 80, 119, 121, 200 })
+    {
+        TextBuffer expected({ newWidth, scrollback }, attr, 12, _renderTarget);
+        TextBuffer actual({ newWidth, scrollback }, attr, 12, _renderTarget);
+
+        const auto insertionStart = std::chrono::steady_clock::now();
+        ReflowByInsertion(oldBuffer, expected);
+        const auto insertionEnd = std::chrono::steady_clock::now();
+
+        VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, actual, std::nullopt, std::nullopt));
+        const auto reflowEnd = std::chrono::steady_clock::now();
+
+        const std::chrono::duration<double, std::milli> insertion = insertionEnd - insertionStart;
+        const std::chrono::duration<double, std::milli> reflow = reflowEnd - insertionEnd;
+        Log::Comment(NoThrowString().Format(L"Reflow of %d rows from width 120 to %d: %.1fms by insertion, %.1fms by TextBuffer::Reflow",
+                                            scrollback,
+                                            newWidth,
+                                            insertion.count(),
+                                            reflow.count()));
+
+        VerifyBuffersMatch(expected, actual);
+    }
+}
+
+void TextBufferTests::LazyReflowMatchesReflow()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"Data:newWidth", L"{3, 19, 21, 64}")
+        TEST_METHOD_PROPERTY(L"Data:newHeight", L"{7, 40, 300}")
+    END_TEST_METHOD_PROPERTIES();
+
+    short newWidth;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"newWidth", newWidth), L"Width of the reflowed buffer");
+
+    short newHeight;
+    VERIFY_SUCCEEDED(TestData::TryGetValue(L"newHeight", newHeight), L"Height of the reflowed buffer");
+
+    const TextAttribute attr{ 0x7 };
+    const COORD oldSize{ 20, 50 };
+    const COORD midSize{ 17, 60 };
+    const COORD newSize{ newWidth, newHeight };
+    const size_t eagerRows = 2;
+
+    TextBuffer oldBuffer(oldSize, attr, 12, _renderTarget);
+    FillBufferForReflow(oldBuffer, 60);
+
+    Log::Comment(L"Reflow the buffer twice, like resizing does while dragging the window border.");
+    TextBuffer expectedMid(midSize, attr, 12, _renderTarget);
+    TextBuffer expected(newSize, attr, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(oldBuffer, expectedMid, std::nullopt, std::nullopt));
+    VERIFY_SUCCEEDED(TextBuffer::Reflow(expectedMid, expected, std::nullopt, std::nullopt));
+
+    Log::Comment(L"Do the same lazily, so that the second reflow reads rows the first one left pending.");
+    auto lazyOld = std::make_unique<TextBuffer>(oldSize, attr, 12, _renderTarget);
+    FillBufferForReflow(*lazyOld, 60);
+    auto lazyMid = std::make_unique<TextBuffer>(midSize, attr, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::ReflowLazily(*lazyOld, *lazyMid, eagerRows, std::nullopt, std::nullopt));
+    lazyMid->KeepReflowSource(std::move(lazyOld));
+
+    auto actual = std::make_unique<TextBuffer>(newSize, attr, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::ReflowLazily(*lazyMid, *actual, eagerRows, std::nullopt, std::nullopt));
+    actual->KeepReflowSource(std::move(lazyMid));
+
+    Log::Comment(L"Reading the buffer leaves the pending rows alone.");
+    const auto readGeneration = actual->GetPendingReflowGeneration();
+    for (UINT row = 0; row < actual->TotalRowCount(); ++row)
+    {
+        std::as_const(*actual).GetRowByOffset(row);
+    }
+    VERIFY_ARE_EQUAL(readGeneration, actual->GetPendingReflowGeneration());
+
+    Log::Comment(L"Copy in the visible rows, then the rest of them.");
+    actual->ReflowPendingRowsAt(newHeight / 2, 3);
+    actual->ReflowAllPendingRows();
+    VerifyBuffersMatch(expected, *actual);
+    VERIFY_ARE_EQUAL(uint64_t{ 0 }, actual->GetPendingReflowGeneration());
+
+    Log::Comment(L"Background work for rows that were copied in already has nothing left to do.");
+    VERIFY_IS_FALSE(actual->ReflowPendingRows(readGeneration, 3));
+
+    Log::Comment(L"Copy the pending rows in the background instead.");
+    auto background = std::make_unique<TextBuffer>(newSize, attr, 12, _renderTarget);
+    VERIFY_SUCCEEDED(TextBuffer::ReflowLazily(expectedMid, *background, eagerRows, std::nullopt, std::nullopt));
+    const auto generation = background->GetPendingReflowGeneration();
+    while (background->ReflowPendingRows(generation, 3))
+    {
+        VERIFY_ARE_EQUAL(generation, background->GetPendingReflowGeneration());
+    }
+    VERIFY_ARE_EQUAL(uint64_t{ 0 }, background->GetPendingReflowGeneration());
+    VerifyBuffersMatch(expected, *background);
+}
+
+void TextBufferTests::AttributeTableIsCompacted()
+{
+    const TextAttribute attr{ 0x7 };
+    const short height = 10;
+    TextBuffer buffer({ 20, height }, attr, 12, _renderTarget);
+
+    Log::Comment(L"Write far more distinct colors than the attribute table holds, a few at a time.");
+    const int lines = 3 * TextAttributeTable::Capacity;
+    for (int i = 0; i < lines; ++i)
+    {
+        const TextAttribute color{ RGB(i & 0xff, (i >> 8) & 0xff, (i >> 16) & 0xff), RGB(0, 0, 0) };
+        buffer.WriteLine(OutputCellIterator{ L"text", color }, { 0, gsl::narrow<SHORT>(i % height) });
+    }
+
+    Log::Comment(L"Colors that were overwritten were dropped from the table.");
+    VERIFY_IS_LESS_THAN(buffer.GetAttributeTable().Size(), TextAttributeTable::Capacity);
+
+    Log::Comment(L"The colors that are still in the buffer survived compaction.");
+    for (int i = lines - height; i < lines; ++i)
+    {
+        const TextAttribute color{ RGB(i & 0xff, (i >> 8) & 0xff, (i >> 16) & 0xff), RGB(0, 0, 0) };
+        const auto& attrRow = buffer.GetRowByOffset(i % height).GetAttrRow();
+        VERIFY_ARE_EQUAL(color, attrRow.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(attr, attrRow.GetAttrByColumn(4));
+        VERIFY_ARE_EQUAL(buffer.GetAttributeTable().Find(color).value(), attrRow.GetAttrIdByColumn(3));
+    }
+}
+
+void TextBufferTests::ColorizedOutputPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    // Replays the output of a colorized recursive directory listing
+    // (ls -R --color) into a buffer with a full scrollback: directory
+    // headers, then rows of names colored by their file type.
+    const TextAttribute attr{ 0x7 };
+    const TextAttribute directory{ FOREGROUND_BLUE | FOREGROUND_INTENSITY };
+    const TextAttribute executable{ FOREGROUND_GREEN | FOREGROUND_INTENSITY };
+    const TextAttribute symlink{ FOREGROUND_BLUE | FOREGROUND_GREEN | FOREGROUND_INTENSITY };
+    const std::array<const TextAttribute*, 4> kinds{ &attr, &directory, &executable, &symlink };
+
+    const short width = 120;
+    const short height = 9001;
+    const int lines = 100000;
+    TextBuffer buffer({ width, height }, attr, 12, _renderTarget);
+
+    const auto writeStart = std::chrono::steady_clock::now();
+    short y = 0;
+    for (int line = 0; line < lines; ++line)
+    {
+        if (line % 20 == 0)
+        {
+            const auto header = NoThrowString().Format(L"./src/module%d/sub%d:", line / 400, line / 20);
+            buffer.WriteLine(OutputCellIterator{ std::wstring_view{ header.GetBuffer(), gsl::narrow<size_t>(header.GetLength()) }, attr }, { 0, y });
+        }
+        else
+        {
+            short x = 0;
+            for (int column = 0; column < 6; ++column)
+            {
+                const auto name = NoThrowString().Format(L"file%05d.ext  ", line * 6 + column);
+                const auto& kind = *kinds.at((line + column * 3) % kinds.size());
+                buffer.WriteLine(OutputCellIterator{ std::wstring_view{ name.GetBuffer(), gsl::narrow<size_t>(name.GetLength()) }, kind }, { x, y });
+                x += gsl::narrow<short>(name.GetLength());
+            }
+        }
+
+        if (y < height - 1)
+        {
+            ++y;
+        }
+        else
+        {
+            VERIFY_IS_TRUE(buffer.IncrementCircularBuffer());
+        }
+    }
+    const auto writeEnd = std::chrono::steady_clock::now();
+
+    Log::Comment(L"Split every row into runs of equal attributes, like the renderer does.");
+    size_t runs = 0;
+    size_t storedRuns = 0;
+    for (short row = 0; row < height; ++row)
+    {
+        auto it = buffer.GetCellLineDataAt({ 0, row });
+        auto runId = it.TextAttrId();
+        ++runs;
+        for (; it; ++it)
+        {
+            if (it.TextAttrId() != runId)
+            {
+                runId = it.TextAttrId();
+                ++runs;
+            }
+        }
+        storedRuns += buffer.GetRowByOffset(row).GetAttrRow().GetNumberOfRuns();
+    }
+    const auto splitEnd = std::chrono::steady_clock::now();
+
+    const std::chrono::duration<double, std::milli> write = writeEnd - writeStart;
+    const std::chrono::duration<double, std::milli> split = splitEnd - writeEnd;
+    Log::Comment(NoThrowString().Format(L"Wrote %d lines in %.1fms and split %zu runs in %.1fms",
+                                        lines,
+                                        write.count(),
+                                        runs,
+                                        split.count()));
+    Log::Comment(NoThrowString().Format(L"%zu stored runs take %zu bytes, %zu bytes with a TextAttribute per run. %zu attributes interned.",
+                                        storedRuns,
+                                        storedRuns * sizeof(TextAttributeIdRun),
+                                        storedRuns * sizeof(TextAttributeRun),
+                                        buffer.GetAttributeTable().Size()));
+
+    // Each change of ID starts a new stored run, so there can't be more runs than the rows store.
+    VERIFY_IS_LESS_THAN_OR_EQUAL(runs, storedRuns);
+}
+
+void TextBufferTests::CharRowMeasuresStoredGlyphs()
+{
+    const TextAttribute attr{ 0x7 };
+    TextBuffer buffer({ 20, 2 }, attr, 12, _renderTarget);
+    CharRow& charRow = buffer.GetRowByOffset(0).GetCharRow();
+
+    Log::Comment(L"A stored glyph isn't blank, even when it starts with a space.");
+    charRow.GlyphAt(9) = std::wstring_view{ L" \x0301" };
+    VERIFY_ARE_EQUAL(10u, charRow.MeasureRight());
+    VERIFY_ARE_EQUAL(9u, charRow.MeasureLeft());
+    VERIFY_IS_TRUE(charRow.ContainsText());
+
+    Log::Comment(L"The text skips trailing cells and includes stored glyphs.");
+    charRow.GlyphAt(0) = std::wstring_view{ L"A" };
+    charRow.DbcsAttrAt(2).SetLeading();
+    charRow.GlyphAt(2) = std::wstring_view{ L"\x304b" };
+    charRow.DbcsAttrAt(3).SetTrailing();
+    charRow.GlyphAt(3) = std::wstring_view{ L"\x304b" };
+    VERIFY_ARE_EQUAL(std::wstring{ L"A \x304b     "
+                                   L" \x0301"
+                                   L"          " },
+                     charRow.GetText());
+
+    Log::Comment(L"Clearing the stored glyph makes its cell blank again.");
+    charRow.ClearGlyph(9);
+    VERIFY_ARE_EQUAL(4u, charRow.MeasureRight());
+    VERIFY_ARE_EQUAL(0u, charRow.MeasureLeft());
+}
+
+void TextBufferTests::WriteCharInfosMatchesCellIterator()
+{
+    const TextAttribute attr{ 0x7 };
+    const short width = 20;
+    TextBuffer expected({ width, 4 }, attr, 12, _renderTarget);
+    TextBuffer actual({ width, 4 }, attr, 12, _renderTarget);
+
+    // Row 0 gets several runs of colors, the last of which are underlined as well.
+    std::vector<CHAR_INFO> colors;
+    for (short x = 0; x < width; ++x)
+    {
+        CHAR_INFO charInfo;
+        charInfo.Char.UnicodeChar = gsl::narrow_cast<wchar_t>(L'a' + x);
+        charInfo.Attributes = gsl::narrow_cast<WORD>((x / 3) % 4 + 1);
+        if (x >= 15)
+        {
+            charInfo.Attributes |= COMMON_LVB_UNDERSCORE;
+        }
+        colors.push_back(charInfo);
+    }
+
+    // Row 1 is written from the middle to the end, so it gets wrapped.
+    const std::vector<CHAR_INFO> tail(colors.cbegin(), colors.cbegin() + 8);
+
+    // Row 2 holds a double byte character, which has to be lined up cell by cell.
+    std::vector<CHAR_INFO> dbcs(colors.cbegin(), colors.cbegin() + 6);
+    dbcs.at(2).Char.UnicodeChar = L'\x304b';
+    dbcs.at(2).Attributes = FOREGROUND_RED | COMMON_LVB_LEADING_BYTE;
+    dbcs.at(3).Char.UnicodeChar = L'\x304b';
+    dbcs.at(3).Attributes = FOREGROUND_RED | COMMON_LVB_TRAILING_BYTE;
+
+    // Then a write longer than what's left of row 2 continues on row 3.
+    const std::vector<CHAR_INFO> overflow(colors.cbegin(), colors.cbegin() + 12);
+
+    const auto write = [&](const std::vector<CHAR_INFO>& charInfos, const COORD target) {
+        expected.Write(OutputCellIterator({ charInfos.data(), charInfos.size() }), target);
+        actual.WriteCharInfos({ charInfos.data(), gsl::narrow<ptrdiff_t>(charInfos.size()) }, target);
+    };
+
+    write(colors, { 0, 0 });
+    write(tail, { 12, 1 });
+    write(dbcs, { 4, 2 });
+    write(overflow, { 14, 2 });
+
+    VerifyBuffersMatch(expected, actual);
+    Log::Comment(L"Both pack the colors of the first row into the same runs.");
+    VERIFY_ARE_EQUAL(expected.GetRowByOffset(0).GetAttrRow().GetNumberOfRuns(), actual.GetRowByOffset(0).GetAttrRow().GetNumberOfRuns());
+}
+
+void TextBufferTests::CharRowPerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const TextAttribute attr{ 0x7 };
+    const short width = 120;
+    const short height = 9001;
+    const size_t textWidth = 80;
+    const int passes = 10;
+    TextBuffer buffer({ width, height }, attr, 12, _renderTarget);
+
+    // Every row is written in full, and is blank past the first 80 columns.
+    std::wstring line(width, L' ');
+    for (size_t i = 0; i < textWidth; ++i)
+    {
+        line.at(i) = gsl::narrow_cast<wchar_t>(L'!' + i % 90);
+    }
+
+    const auto writeStart = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (short row = 0; row < height; ++row)
+        {
+            buffer.WriteLine(OutputCellIterator{ line, attr }, { 0, row });
+        }
+    }
+    const auto writeEnd = std::chrono::steady_clock::now();
+
+    size_t measured = 0;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (short row = 0; row < height; ++row)
+        {
+            measured += buffer.GetRowByOffset(row).GetCharRow().MeasureRight();
+        }
+    }
+    const auto measureEnd = std::chrono::steady_clock::now();
+
+    size_t copied = 0;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (short row = 0; row < height; ++row)
+        {
+            copied += buffer.GetRowByOffset(row).GetCharRow().GetText().size();
+        }
+    }
+    const auto textEnd = std::chrono::steady_clock::now();
+
+    const auto rows = gsl::narrow_cast<double>(height) * passes;
+    const std::chrono::duration<double, std::nano> write = writeEnd - writeStart;
+    const std::chrono::duration<double, std::nano> measure = measureEnd - writeEnd;
+    const std::chrono::duration<double, std::nano> text = textEnd - measureEnd;
+    Log::Comment(NoThrowString().Format(L"Per row of %d cells: %.0fns to write, %.0fns for MeasureRight, %.0fns for GetText",
+                                        width,
+                                        write.count() / rows,
+                                        measure.count() / rows,
+                                        text.count() / rows));
+
+    VERIFY_ARE_EQUAL(textWidth * height * passes, measured);
+    VERIFY_ARE_EQUAL(gsl::narrow_cast<size_t>(width) * height * passes, copied);
+}
+
+void TextBufferTests::CopyAndFillRectangle()
+{
+    const TextAttribute attr{ 0x7 };
+    const TextAttribute red{ FOREGROUND_RED };
+    const TextAttribute green{ FOREGROUND_GREEN };
+    TextBuffer buffer({ 10, 4 }, attr, 12, _renderTarget);
+
+    const auto rowText = [&](const short row) {
+        return buffer.GetRowByOffset(row).GetCharRow().GetText();
+    };
+    const auto reset = [&]() {
+        buffer.WriteLine(OutputCellIterator{ L"abcdefghij", red }, { 0, 0 });
+        buffer.WriteLine(OutputCellIterator{ L"0123456789", green }, { 0, 1 });
+    };
+
+    Log::Comment(L"Copying to another row brings the attributes along.");
+    reset();
+    buffer.CopyRectangle(Viewport::FromInclusive({ 0, 0, 3, 0 }), { 2, 1 });
+    VERIFY_ARE_EQUAL(std::wstring{ L"01abcd6789" }, rowText(1));
+    VERIFY_ARE_EQUAL(red, buffer.GetCellDataAt({ 2, 1 })->TextAttr());
+    VERIFY_ARE_EQUAL(green, buffer.GetCellDataAt({ 6, 1 })->TextAttr());
+
+    Log::Comment(L"Overlapping copies read the source before it's overwritten, in either direction.");
+    reset();
+    buffer.CopyRectangle(Viewport::FromInclusive({ 0, 0, 5, 1 }), { 2, 0 });
+    VERIFY_ARE_EQUAL(std::wstring{ L"ababcdefij" }, rowText(0));
+    VERIFY_ARE_EQUAL(std::wstring{ L"0101234589" }, rowText(1));
+    reset();
+    buffer.CopyRectangle(Viewport::FromInclusive({ 0, 1, 9, 1 }), { 0, 0 });
+    buffer.CopyRectangle(Viewport::FromInclusive({ 4, 0, 9, 0 }), { 1, 0 });
+    VERIFY_ARE_EQUAL(std::wstring{ L"0456789789" }, rowText(0));
+
+    Log::Comment(L"Filling without attributes keeps those of the cells.");
+    reset();
+    buffer.FillRectangle(Viewport::FromInclusive({ 1, 0, 2, 1 }), L'#', std::nullopt);
+    VERIFY_ARE_EQUAL(std::wstring{ L"a##defghij" }, rowText(0));
+    VERIFY_ARE_EQUAL(std::wstring{ L"0##3456789" }, rowText(1));
+    VERIFY_ARE_EQUAL(red, buffer.GetCellDataAt({ 1, 0 })->TextAttr());
+    VERIFY_ARE_EQUAL(green, buffer.GetCellDataAt({ 2, 1 })->TextAttr());
+
+    Log::Comment(L"Filling with attributes replaces them.");
+    buffer.FillRectangle(Viewport::FromInclusive({ 8, 0, 9, 1 }), L' ', attr);
+    VERIFY_ARE_EQUAL(attr, buffer.GetCellDataAt({ 8, 0 })->TextAttr());
+    VERIFY_ARE_EQUAL(attr, buffer.GetCellDataAt({ 9, 1 })->TextAttr());
+    VERIFY_ARE_EQUAL(green, buffer.GetCellDataAt({ 7, 1 })->TextAttr());
+
+    Log::Comment(L"Wide characters cut in half by the edge of the rectangle are blanked.");
+    std::vector<CHAR_INFO> wide(4);
+    for (auto& charInfo : wide)
+    {
+        charInfo.Char.UnicodeChar = L'\x304b';
+        charInfo.Attributes = FOREGROUND_RED;
+    }
+    wide.at(0).Attributes |= COMMON_LVB_LEADING_BYTE;
+    wide.at(1).Attributes |= COMMON_LVB_TRAILING_BYTE;
+    wide.at(2).Attributes |= COMMON_LVB_LEADING_BYTE;
+    wide.at(3).Attributes |= COMMON_LVB_TRAILING_BYTE;
+    buffer.WriteLine(OutputCellIterator{ L"xxxxxxxxxx", attr }, { 0, 2 });
+    buffer.WriteCharInfos({ wide.data(), gsl::narrow<ptrdiff_t>(wide.size()) }, { 2, 2 });
+    buffer.FillRectangle(Viewport::FromInclusive({ 3, 2, 4, 2 }), L'-', std::nullopt);
+    VERIFY_ARE_EQUAL(std::wstring{ L"xx -- xxxx" }, rowText(2));
+    VERIFY_IS_TRUE(buffer.GetCellDataAt({ 2, 2 })->DbcsAttr().IsSingle());
+    VERIFY_IS_TRUE(buffer.GetCellDataAt({ 5, 2 })->DbcsAttr().IsSingle());
+
+    Log::Comment(L"And so are those the copy lands on half of.");
+    buffer.WriteCharInfos({ wide.data(), gsl::narrow<ptrdiff_t>(wide.size()) }, { 2, 3 });
+    buffer.CopyRectangle(Viewport::FromInclusive({ 0, 0, 0, 0 }), { 3, 3 });
+    VERIFY_ARE_EQUAL(L' ', rowText(3).at(2));
+    VERIFY_ARE_EQUAL(L'a', rowText(3).at(3));
+    VERIFY_IS_TRUE(buffer.GetCellDataAt({ 2, 3 })->DbcsAttr().IsSingle());
+    VERIFY_IS_TRUE(buffer.GetCellDataAt({ 4, 3 })->DbcsAttr().IsLeading());
+}
+
+void TextBufferTests::CopyRectanglePerformance()
+{
+    BEGIN_TEST_METHOD_PROPERTIES()
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD_PROPERTIES()
+
+    const TextAttribute attr{ 0x7 };
+    const short width = 120;
+    const short height = 50;
+    const int passes = 1000;
+    TextBuffer buffer({ width, height }, attr, 12, _renderTarget);
+
+    // Every row gets a few colors, so that the attributes have runs to copy.
+    std::wstring line(width, L' ');
+    for (size_t i = 0; i < line.size(); ++i)
+    {
+        line.at(i) = gsl::narrow_cast<wchar_t>(L'!' + i % 90);
+    }
+    for (short row = 0; row < height; ++row)
+    {
+        buffer.WriteLine(OutputCellIterator{ line, TextAttribute{ gsl::narrow_cast<WORD>(row % 15 + 1) } }, { 0, row });
+    }
+
+    // Both move an 80x40 area one line down and one column right, the way an
+    // application scrolls a pane.
+    const auto source = Viewport::FromDimensions({ 10, 2 }, { 80, 40 });
+    const COORD target{ 11, 3 };
+
+    const auto cellsStart = std::chrono::steady_clock::now();
+    std::vector<OutputCell> cells;
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (short row = source.BottomInclusive(); row >= source.Top(); --row)
+        {
+            cells.clear();
+            auto it = buffer.GetCellDataAt({ source.Left(), row }, source);
+            for (short column = 0; column < source.Width(); ++column, ++it)
+            {
+                cells.emplace_back(*it);
+            }
+            const COORD position{ target.X, gsl::narrow_cast<short>(target.Y + row - source.Top()) };
+            buffer.WriteLine(OutputCellIterator{ std::basic_string_view<OutputCell>{ cells.data(), cells.size() } }, position);
+        }
+    }
+    const auto cellsEnd = std::chrono::steady_clock::now();
+
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        buffer.CopyRectangle(source, target);
+    }
+    const auto rectangleEnd = std::chrono::steady_clock::now();
+
+    const auto fillStart = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        for (short row = source.Top(); row <= source.BottomInclusive(); ++row)
+        {
+            buffer.WriteLine(OutputCellIterator{ L'#', attr, gsl::narrow_cast<size_t>(source.Width()) }, { source.Left(), row });
+        }
+    }
+    const auto fillEnd = std::chrono::steady_clock::now();
+
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        buffer.FillRectangle(source, L'#', attr);
+    }
+    const auto fillRectangleEnd = std::chrono::steady_clock::now();
+
+    const std::chrono::duration<double, std::micro> cellsCopy = cellsEnd - cellsStart;
+    const std::chrono::duration<double, std::micro> rectangleCopy = rectangleEnd - cellsEnd;
+    const std::chrono::duration<double, std::micro> cellsFill = fillEnd - fillStart;
+    const std::chrono::duration<double, std::micro> rectangleFill = fillRectangleEnd - fillEnd;
+    Log::Comment(NoThrowString().Format(L"Copying %dx%d cells: %.1fus cell by cell, %.1fus with CopyRectangle",
+                                        source.Width(),
+                                        source.Height(),
+                                        cellsCopy.count() / passes,
+                                        rectangleCopy.count() / passes));
+    Log::Comment(NoThrowString().Format(L"Filling %dx%d cells: %.1fus with WriteLine, %.1fus with FillRectangle",
+                                        source.Width(),
+                                        source.Height(),
+                                        cellsFill.count() / passes,
+                                        rectangleFill.count() / passes));
+
+    VERIFY_ARE_EQUAL(L'#', *buffer.GetCellDataAt({ source.Left(), source.Top() })->Chars().data());
+}
@@ -13,6 +13,11 @@
 #include "..\..\renderer\base\Renderer.hpp"
 #include "..\Settings.hpp"
 #include "..\VtIo.hpp"
+#include "..\VtInputThread.hpp"
+#include "CommonState.hpp"
+
+#include <chrono>
+#include <thread>
 
 using namespace WEX::Common;
 using namespace WEX::Logging;
@@ -38,6 +43,10 @@ class Microsoft::Console::VirtualTerminal::VtIoTests
     TEST_METHOD(RendererDtorAndThreadAndDx);
 
     TEST_METHOD(BasicAnonymousPipeOpeningWithSignalChannelTest);
+
+    BEGIN_TEST_METHOD(BracketedPasteThroughputTest)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
 };
 
 class VtIoTestColorProvider : public Microsoft::Console::IDefaultColorProvider
@@ -425,3 +434,101 @@ void VtIoTests::BasicAnonymousPipeOpeningWithSignalChannelTest()
     VERIFY_IS_TRUE(vtio.IsUsingVt());
     VERIFY_ARE_NOT_EQUAL(nullptr, vtio._pPtySignalInputThread);
 }
+
+void VtIoTests::BracketedPasteThroughputTest()
+{
+    Log::Comment(L"Paste a megabyte of text through the vt input pipe, and "
+                 L"measure how long it takes to arrive in the input buffer.");
+
+    CommonState state;
+    state.InitEvents();
+    state.PrepareGlobalInputBuffer();
+    auto cleanupInputBuffer = wil::scope_exit([&] { state.CleanupGlobalInputBuffer(); });
+
+    std::string text;
+    const size_t textLength = 1024 * 1024;
+    text.reserve(textLength);
+    for (size_t i = 0; i < textLength; ++i)
+    {
+        // Mostly lowercase letters, with words and lines like a real paste.
+        if (i % 80 == 79)
+        {
+            text.push_back('\r');
+        }
+        else if (i % 7 == 6)
+        {
+            text.push_back(' ');
+        }
+        else
+        {
+            text.push_back(static_cast<char>('a' + (i % 26)));
+        }
+    }
+
+    wil::unique_handle pipeReadSide;
+    wil::unique_handle pipeWriteSide;
+    VERIFY_WIN32_BOOL_SUCCEEDED(CreatePipe(&pipeReadSide, &pipeWriteSide, nullptr, 0), L"Create anonymous in pipe.");
+
+    VtInputThread inputThread{ wil::unique_hfile{ pipeReadSide.release() }, false };
+    InputBuffer& inputBuffer = *Interactivity::ServiceLocator::LocateGlobals().getConsoleInformation().pInputBuffer;
+
+    // The input engine flushes sequences that are cut in half at the end of
+    // a read, so the paste markers are written on their own, when nothing
+    // else is in the pipe.
+    const auto writeAll = [&](const std::string_view str) {
+        size_t offset = 0;
+        while (offset < str.size())
+        {
+            DWORD written = 0;
+            const auto chunk = gsl::narrow_cast<DWORD>(std::min<size_t>(str.size() - offset, 64 * 1024));
+            if (!WriteFile(pipeWriteSide.get(), str.data() + offset, chunk, &written, nullptr))
+            {
+                return false;
+            }
+            offset += written;
+        }
+        return true;
+    };
+    VERIFY_IS_TRUE(writeAll("\x1b[200~"));
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Write from another thread, so that the pipe never fills up.
+    std::thread writer([&]() { writeAll(text); });
+    auto joinWriter = wil::scope_exit([&] { writer.join(); });
+
+    // Every character turns into a key down and a key up.
+    const size_t expectedEvents = textLength * 2;
+    for (size_t reads = 0; inputBuffer.GetNumberOfReadyEvents() < expectedEvents && reads <= textLength; ++reads)
+    {
+        inputThread.DoReadInput(true);
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    VERIFY_ARE_EQUAL(expectedEvents, inputBuffer.GetNumberOfReadyEvents());
+
+    joinWriter.reset();
+    VERIFY_IS_TRUE(writeAll("\x1b[201~"));
+    inputThread.DoReadInput(true);
+    VERIFY_ARE_EQUAL(expectedEvents, inputBuffer.GetNumberOfReadyEvents());
+
+    Log::Comment(L"The paste markers were swallowed, and the text arrived in order.");
+    std::vector<INPUT_RECORD> records;
+    VERIFY_SUCCESS_NTSTATUS(inputBuffer.Read(records, expectedEvents, false, false, true, false));
+    std::string received;
+    received.reserve(textLength);
+    for (const auto& record : records)
+    {
+        VERIFY_ARE_EQUAL(KEY_EVENT, record.EventType);
+        if (record.Event.KeyEvent.bKeyDown)
+        {
+            received.push_back(static_cast<char>(record.Event.KeyEvent.uChar.UnicodeChar));
+        }
+    }
+    VERIFY_IS_TRUE(text == received);
+
+    Log::Comment(NoThrowString().Format(L"%zu bytes pasted in %.1fms (%.1f MB/s)",
+                                        textLength,
+                                        elapsed.count(),
+                                        textLength / (1024.0 * 1024.0) / (elapsed.count() / 1000.0)));
+}
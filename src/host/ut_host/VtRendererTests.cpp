@@ -121,6 +121,8 @@ class Microsoft::Console::Render::VtRendererTest
 
     TEST_METHOD(TestCursorVisibility);
 
+    TEST_METHOD(TestRectangularCopy);
+
     void Test16Colors(VtEngine* engine);
 
     std::deque<std::string> qExpectedInput;
@@ -1612,3 +1614,57 @@ void VtRendererTest::FormattedString()
     qExpectedInput.push_back("\x1b[28;3;500;500;500m");
     VERIFY_SUCCEEDED(engine->_WriteFormattedString(&bigFormat, bigValue, bigValue, bigValue));
 }
+
+void VtRendererTest::TestRectangularCopy()
+{
+    Viewport view = SetUpViewport();
+    wil::unique_hfile hFile = wil::unique_hfile(INVALID_HANDLE_VALUE);
+    auto engine = std::make_unique<Xterm256Engine>(std::move(hFile), p, view, g_ColorTable, static_cast<WORD>(COLOR_TABLE_SIZE));
+    auto pfn = std::bind(&VtRendererTest::WriteCallback, this, std::placeholders::_1, std::placeholders::_2);
+    engine->SetTestCallback(pfn);
+
+    // Verify the first paint emits a clear
+    qExpectedInput.push_back("\x1b[2J");
+    TestPaint(*engine, [&]() {
+        VERIFY_IS_FALSE(engine->_firstPaint);
+    });
+
+    const auto source = Viewport::FromDimensions({ 1, 2 }, { 10, 3 });
+    const COORD target{ 5, 1 };
+    const auto targetRect = Viewport::FromDimensions(target, source.Dimensions());
+    SMALL_RECT invalid = targetRect.ToExclusive();
+
+    Log::Comment(NoThrowString().Format(
+        L"Without --rectangularCopy, the target has to be painted like always."));
+    VERIFY_IS_FALSE(engine->BeginRectangleCopy(source, target));
+
+    engine->SetRectangularCopy(true);
+
+    Log::Comment(NoThrowString().Format(
+        L"Copy a rectangle. Its target shouldn't be invalidated, and the next "
+        L"frame should have the terminal copy it with DECCRA."));
+    VERIFY_IS_TRUE(engine->BeginRectangleCopy(source, target));
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    engine->EndRectangleCopy();
+    VERIFY_IS_FALSE(engine->_invalidMap.any());
+
+    TestPaint(*engine, [&]() {
+        qExpectedInput.push_back("\x1b[3;2;5;11;1;2;6;1$v");
+        VERIFY_SUCCEEDED(engine->ScrollFrame());
+    });
+    VERIFY_IS_FALSE(engine->_pendingCopySource.has_value());
+
+    Log::Comment(NoThrowString().Format(
+        L"Once the copy is done, invalidating the target counts again."));
+    VERIFY_SUCCEEDED(engine->Invalidate(&invalid));
+    VERIFY_IS_TRUE(engine->_invalidMap.any());
+    TestPaint(*engine, [&]() {});
+
+    Log::Comment(NoThrowString().Format(
+        L"If part of the source still has to be painted, the terminal doesn't "
+        L"have what we'd copy, so the copy has to be declined."));
+    SMALL_RECT sourceCell = { 1, 2, 2, 3 };
+    VERIFY_SUCCEEDED(engine->Invalidate(&sourceCell));
+    VERIFY_IS_FALSE(engine->BeginRectangleCopy(source, target));
+    TestPaint(*engine, [&]() {});
+}
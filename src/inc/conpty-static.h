@@ -16,6 +16,8 @@ extern "C" {
 #endif
 
 #define PSEUDOCONSOLE_RESIZE_QUIRK (2u)
+#define PSEUDOCONSOLE_PASSTHROUGH_MODE (8u)
+#define PSEUDOCONSOLE_RECTANGULAR_COPY (16u)
 
 HRESULT WINAPI ConptyCreatePseudoConsole(COORD size, HANDLE hInput, HANDLE hOutput, DWORD dwFlags, HPCON* phPC);
 
@@ -9,6 +9,7 @@
 #include "til/color.h"
 #include "til/math.h"
 #include "til/some.h"
+#include "til/small_vector.h"
 #include "til/size.h"
 #include "til/point.h"
 #include "til/rectangle.h"
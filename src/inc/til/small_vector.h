@@ -0,0 +1,350 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#pragma once
+
+#include <array>
+
+namespace til // Terminal Implementation Library. Also: "Today I Learned"
+{
+    // A vector that keeps up to N elements inline and only allocates once it
+    // grows past that. It's meant for short lists of small values, like the
+    // attribute runs of a row, so it only holds trivially copyable types and
+    // shuffles them around without running any constructors.
+    template<class T, size_t N>
+    class small_vector
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "small_vector only holds trivially copyable types");
+        static_assert(N > 0, "small_vector needs room for at least one element inline");
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using difference_type = ptrdiff_t;
+        using pointer = T*;
+        using const_pointer = const T*;
+        using reference = T&;
+        using const_reference = const T&;
+
+        using iterator = T*;
+        using const_iterator = const T*;
+
+        small_vector() noexcept :
+            _inline{},
+            _heap{},
+            _data{ _inline.data() },
+            _size{ 0 },
+            _capacity{ N }
+        {
+        }
+
+        small_vector(std::initializer_list<T> init) :
+            small_vector()
+        {
+            assign(init.begin(), init.end());
+        }
+
+        small_vector(const small_vector& other) :
+            small_vector()
+        {
+            assign(other.cbegin(), other.cend());
+        }
+
+        small_vector(small_vector&& other) noexcept :
+            small_vector()
+        {
+            _steal(other);
+        }
+
+        ~small_vector() = default;
+
+        small_vector& operator=(const small_vector& other)
+        {
+            if (this != &other)
+            {
+                assign(other.cbegin(), other.cend());
+            }
+            return *this;
+        }
+
+        small_vector& operator=(small_vector&& other) noexcept
+        {
+            if (this != &other)
+            {
+                _heap.reset();
+                _data = _inline.data();
+                _capacity = N;
+                _steal(other);
+            }
+            return *this;
+        }
+
+        bool operator==(const small_vector& other) const noexcept
+        {
+            return std::equal(cbegin(), cend(), other.cbegin(), other.cend());
+        }
+
+        bool operator!=(const small_vector& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+        iterator begin() noexcept
+        {
+            return _data;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return _data;
+        }
+
+        iterator end() noexcept
+        {
+            return _data + _size;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return _data + _size;
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return begin();
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return end();
+        }
+
+        size_type size() const noexcept
+        {
+            return _size;
+        }
+
+        size_type capacity() const noexcept
+        {
+            return _capacity;
+        }
+
+        bool empty() const noexcept
+        {
+            return !_size;
+        }
+
+        // Routine Description:
+        // - Whether the elements are stored inline, without an allocation.
+        bool is_inline() const noexcept
+        {
+            return !_heap;
+        }
+
+        T* data() noexcept
+        {
+            return _data;
+        }
+
+        const T* data() const noexcept
+        {
+            return _data;
+        }
+
+        reference at(size_type pos)
+        {
+            if (_size <= pos)
+            {
+                _outOfRange();
+            }
+            return _data[pos];
+        }
+
+        const_reference at(size_type pos) const
+        {
+            if (_size <= pos)
+            {
+                _outOfRange();
+            }
+            return _data[pos];
+        }
+
+        reference operator[](size_type pos) noexcept
+        {
+            return _data[pos];
+        }
+
+        const_reference operator[](size_type pos) const noexcept
+        {
+            return _data[pos];
+        }
+
+        reference front() noexcept
+        {
+            return _data[0];
+        }
+
+        const_reference front() const noexcept
+        {
+            return _data[0];
+        }
+
+        reference back() noexcept
+        {
+            return _data[_size - 1];
+        }
+
+        const_reference back() const noexcept
+        {
+            return _data[_size - 1];
+        }
+
+        void reserve(size_type capacity)
+        {
+            if (capacity <= _capacity)
+            {
+                return;
+            }
+
+            auto heap = std::make_unique<T[]>(capacity);
+            std::copy_n(_data, _size, heap.get());
+            _heap = std::move(heap);
+            _data = _heap.get();
+            _capacity = capacity;
+        }
+
+        // Routine Description:
+        // - Removes all elements. Any allocation is kept, to be reused.
+        void clear() noexcept
+        {
+            _size = 0;
+        }
+
+        void push_back(const T& val)
+        {
+            const T copy = val; // val might live in our own storage, which _grow can free.
+            _grow(_size + 1);
+            _data[_size++] = copy;
+        }
+
+        void pop_back()
+        {
+            if (!_size)
+            {
+                _outOfRange();
+            }
+            --_size;
+        }
+
+        void resize(size_type size)
+        {
+            resize(size, T{});
+        }
+
+        void resize(size_type size, const T& val)
+        {
+            const T copy = val;
+            _grow(size);
+            if (size > _size)
+            {
+                std::fill(_data + _size, _data + size, copy);
+            }
+            _size = size;
+        }
+
+        // Routine Description:
+        // - Replaces the elements with the given range, which must not be
+        //   part of this vector.
+        template<typename InputIt>
+        void assign(InputIt first, InputIt last)
+        {
+            const auto count = gsl::narrow<size_type>(std::distance(first, last));
+            _size = 0;
+            _grow(count);
+            std::copy(first, last, _data);
+            _size = count;
+        }
+
+        iterator insert(const_iterator pos, const T& val)
+        {
+            const T copy = val;
+            return insert(pos, &copy, &copy + 1);
+        }
+
+        // Routine Description:
+        // - Inserts the given range before pos. The range must not be part
+        //   of this vector.
+        template<typename InputIt>
+        iterator insert(const_iterator pos, InputIt first, InputIt last)
+        {
+            const auto offset = pos - cbegin();
+            const auto count = gsl::narrow<size_type>(std::distance(first, last));
+            _grow(_size + count);
+
+            const auto where = _data + offset;
+            std::copy_backward(where, _data + _size, _data + _size + count);
+            std::copy(first, last, where);
+            _size += count;
+
+            return where;
+        }
+
+        iterator erase(const_iterator pos) noexcept
+        {
+            return erase(pos, pos + 1);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) noexcept
+        {
+            const auto where = _data + (first - cbegin());
+            std::copy(last, cend(), where);
+            _size -= last - first;
+            return where;
+        }
+
+    private:
+        std::array<T, N> _inline;
+        std::unique_ptr<T[]> _heap;
+        T* _data;
+        size_type _size;
+        size_type _capacity;
+
+        void _grow(size_type size)
+        {
+            if (size > _capacity)
+            {
+                reserve(std::max(size, _capacity * 2));
+            }
+        }
+
+        // Takes over the elements of other, which is left empty. This vector
+        // must be empty and inline beforehand.
+        void _steal(small_vector& other) noexcept
+        {
+            if (other._heap)
+            {
+                _heap = std::move(other._heap);
+                _data = _heap.get();
+                _capacity = other._capacity;
+            }
+            else
+            {
+                std::copy_n(other._inline.cbegin(), other._size, _inline.begin());
+            }
+            _size = other._size;
+
+            other._data = other._inline.data();
+            other._size = 0;
+            other._capacity = N;
+        }
+
+        [[noreturn]] void _outOfRange() const
+        {
+            throw std::out_of_range("invalid small_vector<T, N> subscript");
+        }
+
+#ifdef UNIT_TESTING
+        friend class SmallVectorTests;
+#endif
+    };
+}
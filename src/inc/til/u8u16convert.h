@@ -14,6 +14,8 @@ could overcome disadvantages of syscalls. Test results can be read up
 in PR #4093 and the test algorithms are available in src\tools\U8U16Test.
 Based on the results the decision was made to keep using the platform
 functions MultiByteToWideChar and WideCharToMultiByte.
+Runs of ASCII are the exception: they are widened directly, and only
+the stretches in between are handed to MultiByteToWideChar.
 
 Author(s):
 - Steffen Illhardt (german-one) 2020
@@ -21,8 +23,70 @@ Author(s):
 
 #pragma once
 
+#if defined(_M_X64) || defined(_M_IX86)
+#include <emmintrin.h>
+#endif
+
 namespace til // Terminal Implementation Library. Also: "Today I Learned"
 {
+    namespace details
+    {
+        // Routine Description:
+        // - Counts the ASCII code units at the start of a UTF-8 string.
+        // Arguments:
+        // - str - the UTF-8 string to scan
+        // - len - the number of code units in str
+        // Return Value:
+        // - the length of the run of ASCII at the start of the string
+        inline size_t count_ascii(_In_reads_(len) const char* const str, const size_t len) noexcept
+        {
+            size_t i = 0;
+#if defined(_M_X64) || defined(_M_IX86)
+            // Every code unit of a non-ASCII character has the MSB set, which is just what movemask collects.
+            for (; i + 16 <= len; i += 16)
+            {
+                const auto units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+                const auto nonAscii = gsl::narrow_cast<unsigned long>(_mm_movemask_epi8(units));
+                if (nonAscii != 0)
+                {
+                    unsigned long index = 0;
+                    _BitScanForward(&index, nonAscii);
+                    return i + index;
+                }
+            }
+#endif
+            while (i < len && (str[i] & 0x80) == 0)
+            {
+                ++i;
+            }
+            return i;
+        }
+
+        // Routine Description:
+        // - Converts ASCII to UTF-16, which for ASCII only means zero extending each code unit.
+        // Arguments:
+        // - str - the ASCII string to convert
+        // - len - the number of code units in str
+        // - out - receives len UTF-16 code units
+        inline void widen_ascii(_In_reads_(len) const char* const str, const size_t len, _Out_writes_(len) wchar_t* const out) noexcept
+        {
+            size_t i = 0;
+#if defined(_M_X64) || defined(_M_IX86)
+            const auto zero = _mm_setzero_si128();
+            for (; i + 16 <= len; i += 16)
+            {
+                const auto units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(units, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(units, zero));
+            }
+#endif
+            for (; i < len; ++i)
+            {
+                out[i] = static_cast<wchar_t>(str[i]);
+            }
+        }
+    }
+
     template<class charT>
     class u8u16state final
     {
@@ -38,7 +102,8 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         //   If it receives an incomplete codepoint, it will cache it until it can be completed.
         // Arguments:
         // - in - UTF-8 string_view potentially containing partial code points
-        // - out - on return, populated with complete codepoints at the string end
+        // - out - on return, populated with complete codepoints at the string end.
+        //         It refers to either `in` or an internal buffer, so it must be used before either one changes.
         // Return Value:
         // - S_OK          - the resulting string doesn't end with a partial
         // - S_FALSE       - the resulting string contains the previously cached partials only
@@ -51,63 +116,40 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         {
             try
             {
+                // Without cached partials the complete code points can be handed out right where they are.
+                if (_partialsLen == 0u)
+                {
+                    const auto partialsLen{ _trailingPartialLength(in) };
+                    std::copy(in.cend() - partialsLen, in.cend(), _utfPartials.begin());
+                    _partialsLen = partialsLen;
+                    out = in.substr(0u, in.length() - partialsLen);
+                    return S_OK;
+                }
+
                 size_t capacity{};
                 RETURN_HR_IF(E_ABORT, !base::CheckAdd(in.length(), _partialsLen).AssignIfValid(&capacity));
 
                 _buffer.clear();
                 _buffer.reserve(capacity);
 
-                // copy UTF-8 code units that were remaining from the previous call (if any)
-                if (_partialsLen != 0u)
-                {
-                    _buffer.assign(_utfPartials.cbegin(), _utfPartials.cbegin() + _partialsLen);
-                    _partialsLen = 0u;
-                }
+                // copy UTF-8 code units that were remaining from the previous call
+                _buffer.assign(_utfPartials.cbegin(), _utfPartials.cbegin() + _partialsLen);
+                _partialsLen = 0u;
 
                 if (in.empty())
                 {
                     out = _buffer;
-                    if (_buffer.empty())
-                    {
-                        return S_OK;
-                    }
-
                     return S_FALSE; // the partial is populated
                 }
 
                 _buffer.append(in);
-                size_t remainingLength{ _buffer.length() };
 
-                auto backIter = _buffer.end();
-                // If the last byte in the string was a byte belonging to a UTF-8 multi-byte character
-                if ((*(backIter - 1) & _Utf8BitMasks::MaskAsciiByte) > _Utf8BitMasks::IsAsciiByte)
-                {
-                    // Check only up to 3 last bytes, if no Lead Byte was found then the byte before must be the Lead Byte and no partials are in the string
-                    const size_t stopLen{ std::min(_buffer.length(), gsl::narrow_cast<size_t>(3u)) };
-                    for (size_t sequenceLen{ 1u }; sequenceLen <= stopLen; ++sequenceLen)
-                    {
-                        --backIter;
-                        // If Lead Byte found
-                        if ((*backIter & _Utf8BitMasks::MaskContinuationByte) > _Utf8BitMasks::IsContinuationByte)
-                        {
-                            // If the Lead Byte indicates that the last bytes in the string is a partial UTF-8 code point then cache them:
-                            //  Use the bitmask at index `sequenceLen`. Compare the result with the operand having the same index. If they
-                            //  are not equal then the sequence has to be cached because it is a partial code point. Otherwise the
-                            //  sequence is a complete UTF-8 code point and the whole string is ready for the conversion into a UTF-16 string.
-                            if ((*backIter & _cmpMasks.at(sequenceLen)) != _cmpOperands.at(sequenceLen))
-                            {
-                                std::move(backIter, _buffer.end(), _utfPartials.begin());
-                                remainingLength -= sequenceLen;
-                                _partialsLen = sequenceLen;
-                            }
-
-                            break;
-                        }
-                    }
-                }
+                const auto partialsLen{ _trailingPartialLength(_buffer) };
+                std::copy(_buffer.cend() - partialsLen, _buffer.cend(), _utfPartials.begin());
+                _partialsLen = partialsLen;
 
                 // populate the part of the string that contains complete code points only
-                out = { _buffer.data(), remainingLength };
+                out = { _buffer.data(), _buffer.length() - partialsLen };
 
                 return S_OK;
             }
@@ -213,6 +255,44 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
         }
 
     private:
+        // Method Description:
+        // - Finds out whether a UTF-8 string ends in the middle of a code point.
+        // Arguments:
+        // - str - the UTF-8 string to check
+        // Return Value:
+        // - the number of code units at the end of the string that belong to an incomplete code point, or 0
+        static size_t _trailingPartialLength(const std::string_view str)
+        {
+            // If the last byte in the string was a byte belonging to a UTF-8 multi-byte character
+            if (str.empty() || (str.back() & _Utf8BitMasks::MaskAsciiByte) == _Utf8BitMasks::IsAsciiByte)
+            {
+                return 0u;
+            }
+
+            // Check only up to 3 last bytes, if no Lead Byte was found then the byte before must be the Lead Byte and no partials are in the string
+            const size_t stopLen{ std::min(str.length(), gsl::narrow_cast<size_t>(3u)) };
+            for (size_t sequenceLen{ 1u }; sequenceLen <= stopLen; ++sequenceLen)
+            {
+                const auto ch{ str.at(str.length() - sequenceLen) };
+                // If Lead Byte found
+                if ((ch & _Utf8BitMasks::MaskContinuationByte) > _Utf8BitMasks::IsContinuationByte)
+                {
+                    // If the Lead Byte indicates that the last bytes in the string is a partial UTF-8 code point then cache them:
+                    //  Use the bitmask at index `sequenceLen`. Compare the result with the operand having the same index. If they
+                    //  are not equal then the sequence has to be cached because it is a partial code point. Otherwise the
+                    //  sequence is a complete UTF-8 code point and the whole string is ready for the conversion into a UTF-16 string.
+                    if ((ch & _cmpMasks.at(sequenceLen)) != _cmpOperands.at(sequenceLen))
+                    {
+                        return sequenceLen;
+                    }
+
+                    break;
+                }
+            }
+
+            return 0u;
+        }
+
         enum _Utf8BitMasks : BYTE
         {
             IsAsciiByte = 0b0'0000000, // Any byte representing an ASCII character has the MSB set to 0
@@ -243,7 +323,7 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             _Utf8BitMasks::IsLeadByteThreeByteSequence,
         };
 
-        std::basic_string<charT> _buffer; // buffer to which the populated string_view refers
+        std::basic_string<charT> _buffer; // buffer to which the populated string_view refers, unless it refers to the input
         std::array<charT, 4> _utfPartials; // buffer for code units of a partial code point that have to be cached
         size_t _partialsLen{}; // number of cached code units
     };
@@ -279,10 +359,56 @@ namespace til // Terminal Implementation Library. Also: "Today I Learned"
             // The worst ratio of UTF-8 code units to UTF-16 code units is 1 to 1 if UTF-8 consists of ASCII only.
             RETURN_HR_IF(E_ABORT, !base::MakeCheckedNum(in.length()).AssignIfValid(&lengthRequired));
             out.resize(in.length()); // avoid to call MultiByteToWideChar twice only to get the required size
-            const int lengthOut = MultiByteToWideChar(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, in.data(), lengthRequired, out.data(), lengthRequired);
-            out.resize(gsl::narrow_cast<size_t>(lengthOut));
 
-            return lengthOut == 0 ? E_UNEXPECTED : S_OK;
+            // ASCII is widened right here. Everything else goes to MultiByteToWideChar, which also takes care of
+            // invalid sequences. Since ASCII never is a part of a multi-byte sequence, the string can be split up
+            // at ASCII without changing the result. Short runs of ASCII aren't worth an extra call though.
+            constexpr size_t minAsciiRun{ 16u };
+            const auto length{ in.length() };
+            size_t inPos{};
+            size_t outPos{};
+            while (inPos < length)
+            {
+                const auto asciiLen{ details::count_ascii(in.data() + inPos, length - inPos) };
+                details::widen_ascii(in.data() + inPos, asciiLen, out.data() + outPos);
+                inPos += asciiLen;
+                outPos += asciiLen;
+                if (inPos == length)
+                {
+                    break;
+                }
+
+                auto end{ inPos + 1u };
+                while (end < length)
+                {
+                    if ((in[end] & 0x80) == 0)
+                    {
+                        const auto runLen{ details::count_ascii(in.data() + end, length - end) };
+                        if (runLen >= minAsciiRun)
+                        {
+                            break;
+                        }
+                        end += runLen;
+                    }
+                    else
+                    {
+                        ++end;
+                    }
+                }
+
+                const auto lengthIn{ gsl::narrow_cast<int>(end - inPos) };
+                const int lengthOut = MultiByteToWideChar(gsl::narrow_cast<UINT>(CP_UTF8), 0ul, in.data() + inPos, lengthIn, out.data() + outPos, lengthIn);
+                if (lengthOut == 0)
+                {
+                    out.clear();
+                    return E_UNEXPECTED;
+                }
+                inPos = end;
+                outPos += gsl::narrow_cast<size_t>(lengthOut);
+            }
+            out.resize(outPos);
+
+            return S_OK;
         }
         catch (std::length_error&)
         {
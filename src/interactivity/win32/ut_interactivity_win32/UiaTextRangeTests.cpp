@@ -125,9 +125,9 @@ class UiaTextRangeTests
         {
             ROW& row = _pTextBuffer->GetRowByOffset(i);
             auto& charRow = row.GetCharRow();
-            for (auto& cell : charRow)
+            for (size_t col = 0; col < charRow.size(); ++col)
             {
-                cell.Char() = L' ';
+                charRow.ClearGlyph(col);
             }
         }
 
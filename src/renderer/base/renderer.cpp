@@ -12,6 +12,11 @@ using namespace Microsoft::Console::Types;
 
 static constexpr auto maxRetriesForRenderEngine = 3;
 
+// An application that began a synchronized update and never ended it (because
+// it crashed, or was killed halfway through a redraw) shouldn't be able to
+// freeze the screen. Once this much time has passed, we paint regardless.
+static constexpr std::chrono::milliseconds synchronizedOutputTimeout{ 1000 };
+
 // Routine Description:
 // - Creates a new renderer controller for a console.
 // Arguments:
@@ -63,6 +68,15 @@ Renderer::~Renderer()
         return S_FALSE;
     }
 
+    // Hold the frame back while an application is redrawing. The engines keep
+    // collecting the invalidations in the meantime. The thread is asked to come
+    // back, so that the timeout gets noticed even if nothing else changes.
+    if (_IsSynchronizedOutputPending())
+    {
+        _NotifyPaintFrame();
+        return S_FALSE;
+    }
+
     for (IRenderEngine* const pEngine : _rgpEngines)
     {
         auto tries = maxRetriesForRenderEngine;
@@ -167,6 +181,35 @@ void Renderer::_NotifyPaintFrame()
     }
 }
 
+// Routine Description:
+// - Checks whether PaintFrame should hold back the frame, because an
+//   application is in the middle of a synchronized update. Ends the update on
+//   its own once it took longer than synchronizedOutputTimeout.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if the frame shouldn't be painted yet.
+bool Renderer::_IsSynchronizedOutputPending()
+{
+    _pData->LockConsole();
+    auto unlock = wil::scope_exit([&]() {
+        _pData->UnlockConsole();
+    });
+
+    if (!_synchronizedOutputStart.has_value())
+    {
+        return false;
+    }
+
+    if (std::chrono::steady_clock::now() - *_synchronizedOutputStart < synchronizedOutputTimeout)
+    {
+        return true;
+    }
+
+    _synchronizedOutputStart.reset();
+    return false;
+}
+
 // Routine Description:
 // - Called when the system has requested we redraw a portion of the console.
 // Arguments:
@@ -411,6 +454,35 @@ void Renderer::TriggerTitleChange()
     _NotifyPaintFrame();
 }
 
+// Routine Description:
+// - Called when an application begins or ends a synchronized update (DECSET
+//      2026). While one is in progress, PaintFrame doesn't paint anything, so
+//      that a screen that's being redrawn is never shown halfway through.
+//      Ending it requests a frame, which then contains all of the changes.
+// - The console lock is expected to be held by the caller, like it is while
+//      VT sequences are processed.
+// Arguments:
+// - enabled - true to begin a synchronized update, false to end it.
+// Return Value:
+// - <none>
+void Renderer::SetSynchronizedOutput(const bool enabled)
+{
+    if (enabled)
+    {
+        // Beginning another update while one is in progress doesn't extend the
+        // timeout, so that an application can't keep the screen frozen forever.
+        if (!_synchronizedOutputStart.has_value())
+        {
+            _synchronizedOutputStart = std::chrono::steady_clock::now();
+        }
+    }
+    else if (_synchronizedOutputStart.has_value())
+    {
+        _synchronizedOutputStart.reset();
+        _NotifyPaintFrame();
+    }
+}
+
 // Routine Description:
 // - Update the title for a particular engine.
 // Arguments:
@@ -640,6 +712,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
 
         // Retrieve the first color.
         auto color = it->TextAttr();
+        auto colorId = it.TextAttrId();
 
         // And hold the point where we should start drawing.
         auto screenPoint = target;
@@ -672,7 +745,9 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
             // When the color changes, it will save the new color off and break.
             do
             {
-                if (color != it->TextAttr())
+                // Cells of the same buffer share an attribute ID if and only if
+                // their attributes are equal, so that's all we need to compare.
+                if (colorId != it.TextAttrId())
                 {
                     auto newAttr{ it->TextAttr() };
                     // foreground doesn't matter for runs of spaces (!)
@@ -680,6 +755,7 @@ void Renderer::_PaintBufferOutputHelper(_In_ IRenderEngine* const pEngine,
                     if (!_IsAllSpaces(it->Chars()) || !newAttr.HasIdenticalVisualRepresentationForBlankSpace(color, globalInvert))
                     {
                         color = newAttr;
+                        colorId = it.TextAttrId();
                         break; // vend this run
                     }
                 }
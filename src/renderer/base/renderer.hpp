@@ -61,6 +61,8 @@ namespace Microsoft::Console::Render
         void TriggerCircling() override;
         void TriggerTitleChange() override;
 
+        void SetSynchronizedOutput(const bool enabled) override;
+
         void TriggerFontChange(const int iDpi,
                                const FontInfoDesired& FontInfoDesired,
                                _Out_ FontInfo& FontInfo) override;
@@ -84,8 +86,13 @@ namespace Microsoft::Console::Render
         std::unique_ptr<IRenderThread> _pThread;
         bool _destructing = false;
 
+        // Set while an application is in the middle of a synchronized update.
+        std::optional<std::chrono::steady_clock::time_point> _synchronizedOutputStart;
+
         void _NotifyPaintFrame();
 
+        bool _IsSynchronizedOutputPending();
+
         [[nodiscard]] HRESULT _PaintFrameForEngine(_In_ IRenderEngine* const pEngine) noexcept;
 
         bool _CheckViewportAndScroll();
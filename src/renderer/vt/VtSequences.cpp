@@ -109,6 +109,28 @@ using namespace Microsoft::Console::Render;
     return _Write("\x1b[2J");
 }
 
+// Method Description:
+// - Formats and writes a sequence to copy a rectangle of the screen to another
+//      position on it (DECCRA).
+// Arguments:
+// - source: the rectangle to copy, in viewport coordinates.
+// - target: the position to copy the top left of it to, in viewport coordinates.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_CopyRectangularArea(const Microsoft::Console::Types::Viewport& source, const COORD target) noexcept
+{
+    static const std::string format = "\x1b[%d;%d;%d;%d;1;%d;%d;1$v";
+
+    // VT coords start at 1,1
+    return _WriteFormattedString(&format,
+                                 source.Top() + 1,
+                                 source.Left() + 1,
+                                 source.BottomInclusive() + 1,
+                                 source.RightInclusive() + 1,
+                                 target.Y + 1,
+                                 target.X + 1);
+}
+
 // Method Description:
 // - Formats and writes a sequence to either insert or delete a number of lines
 //      into the buffer at the current cursor location.
@@ -310,6 +332,18 @@ using namespace Microsoft::Console::Render;
     return _Write("\x1b[6n");
 }
 
+// Method Description:
+// - Formats and writes a sequence to ask the end terminal to wrap pastes in
+//      bracketed paste markers, or to stop doing so.
+// Arguments:
+// - enabled: true to ask for the markers.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+[[nodiscard]] HRESULT VtEngine::_SetBracketedPasteMode(const bool enabled) noexcept
+{
+    return _Write(enabled ? "\x1b[?2004h" : "\x1b[?2004l");
+}
+
 // Method Description:
 // - Formats and writes a sequence to change the terminal's title string
 // Arguments:
@@ -110,3 +110,16 @@ Xterm256Engine::Xterm256Engine(_In_ wil::unique_hfile hPipe,
 
     return S_OK;
 }
+
+// Method Description:
+// - Resets the terminal's rendition, including the extended attributes we
+//   track here.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT Xterm256Engine::_ResetGraphicsRendition() noexcept
+{
+    _lastExtendedAttrsState = ExtendedAttributes::Normal;
+    return XtermEngine::_ResetGraphicsRendition();
+}
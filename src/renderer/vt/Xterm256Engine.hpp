@@ -39,6 +39,7 @@ namespace Microsoft::Console::Render
 
     private:
         [[nodiscard]] HRESULT _UpdateExtendedAttrs(const ExtendedAttributes extendedAttrs) noexcept;
+        [[nodiscard]] HRESULT _ResetGraphicsRendition() noexcept override;
 
         // We're only using Italics, Blinking, Invisible and Crossed Out for now
         // See GH#2916 for adding a more complete implementation.
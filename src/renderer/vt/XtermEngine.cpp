@@ -41,6 +41,13 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 //      the pipe.
 [[nodiscard]] HRESULT XtermEngine::StartPaint() noexcept
 {
+    // The terminal is in the middle of a sequence that a client is passing
+    // through. Whatever was invalidated meanwhile waits for the rest of it.
+    if (_midPassthroughSequence)
+    {
+        return S_FALSE;
+    }
+
     RETURN_IF_FAILED(VtEngine::StartPaint());
 
     _trace.TraceLastText(_lastText);
@@ -345,6 +352,15 @@ XtermEngine::XtermEngine(_In_ wil::unique_hfile hPipe,
 [[nodiscard]] HRESULT XtermEngine::ScrollFrame() noexcept
 try
 {
+    // A rectangle the console copied goes first. Anything scrolled this frame
+    // was scrolled after it was copied.
+    if (_pendingCopySource.has_value())
+    {
+        const auto source = *_pendingCopySource;
+        _pendingCopySource.reset();
+        RETURN_IF_FAILED(_CopyRectangularArea(source, _pendingCopyTarget));
+    }
+
     if (_scrollDelta.x() != 0)
     {
         // No easy way to shift left-right. Everything needs repainting.
@@ -408,7 +424,8 @@ try
 {
     const til::point delta{ *pcoordDelta };
 
-    if (delta != til::point{ 0, 0 })
+    // Client VT that's passed through scrolls the terminal by itself.
+    if (delta != til::point{ 0, 0 } && !_passingThrough)
     {
         _trace.TraceInvalidateScroll(delta);
 
@@ -456,6 +473,13 @@ CATCH_RETURN();
 // - S_OK or suitable HRESULT error from either conversion or writing pipe.
 [[nodiscard]] HRESULT XtermEngine::WriteTerminalW(const std::wstring_view wstr) noexcept
 {
+    // While client VT is passed through, whatever the state machine wants to
+    // forward is already part of the string that EndPassthrough writes.
+    if (_passingThrough)
+    {
+        return S_OK;
+    }
+
     RETURN_IF_FAILED(_fUseAsciiOnly ?
                          VtEngine::_WriteTerminalAscii(wstr) :
                          VtEngine::_WriteTerminalUtf8(wstr));
@@ -495,3 +519,30 @@ CATCH_RETURN();
     }
     CATCH_RETURN();
 }
+
+// Method Description:
+// - Wrapper for VtEngine::EndPassthrough. The terminal's cursor visibility is
+//   now whatever the client made it, so that's what the next frame compares to.
+// Arguments:
+// - str: the VT that the client wrote.
+// - cursorVisible: whether the client left the cursor visible.
+// - inGround: whether the client's VT ended outside of any sequence.
+// Return Value:
+// - S_OK or suitable HRESULT error from either conversion or writing pipe.
+[[nodiscard]] HRESULT XtermEngine::EndPassthrough(const std::wstring_view str, const bool cursorVisible, const bool inGround) noexcept
+{
+    _lastCursorIsVisible = cursorVisible;
+    return VtEngine::EndPassthrough(str, cursorVisible, inGround);
+}
+
+// Method Description:
+// - Resets the terminal's rendition, including the underline we track here.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT XtermEngine::_ResetGraphicsRendition() noexcept
+{
+    _usingUnderLine = false;
+    return VtEngine::_ResetGraphicsRendition();
+}
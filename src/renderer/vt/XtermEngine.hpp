@@ -56,6 +56,8 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT WriteTerminalW(const std::wstring_view str) noexcept override;
 
+        [[nodiscard]] HRESULT EndPassthrough(const std::wstring_view str, const bool cursorVisible, const bool inGround) noexcept override;
+
     protected:
         const COLORREF* const _ColorTable;
         const WORD _cColorTable;
@@ -69,6 +71,8 @@ namespace Microsoft::Console::Render
 
         [[nodiscard]] HRESULT _UpdateUnderline(const WORD wLegacyAttrs) noexcept;
 
+        [[nodiscard]] HRESULT _ResetGraphicsRendition() noexcept override;
+
         [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring& newTitle) noexcept override;
 
 #ifdef UNIT_TESTING
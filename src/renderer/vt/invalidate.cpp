@@ -49,6 +49,26 @@ using namespace Microsoft::Console::Render;
 [[nodiscard]] HRESULT VtEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
 try
 {
+    // While client VT is passed through, the terminal already gets the change.
+    if (_passingThrough)
+    {
+        return S_OK;
+    }
+
+    // The terminal copies the target of a rectangle copy by itself.
+    if (_copyingRectangle)
+    {
+        const auto copyTarget = Viewport::FromDimensions(_pendingCopyTarget, _pendingCopySource->Dimensions());
+        const auto remaining = Viewport::Subtract(Viewport::FromExclusive(*psrRegion), copyTarget);
+        for (size_t i = 0; i < remaining.size(); i++)
+        {
+            const til::rectangle rect{ remaining.at(i).ToInclusive() };
+            _trace.TraceInvalidate(rect);
+            _invalidMap.set(rect);
+        }
+        return S_OK;
+    }
+
     const til::rectangle rect{ Viewport::FromExclusive(*psrRegion).ToInclusive() };
     _trace.TraceInvalidate(rect);
     _invalidMap.set(rect);
@@ -64,6 +84,11 @@ CATCH_RETURN();
 // - S_OK
 [[nodiscard]] HRESULT VtEngine::InvalidateCursor(const COORD* const pcoordCursor) noexcept
 {
+    if (_passingThrough)
+    {
+        return S_OK;
+    }
+
     // If we just inherited the cursor, we're going to get an InvalidateCursor
     //      for both where the old cursor was, and where the new cursor is
     //      (the inherited location). (See Cursor.cpp:Cursor::SetPosition)
@@ -91,12 +116,81 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateAll() noexcept
 try
 {
+    if (_passingThrough)
+    {
+        return S_OK;
+    }
+
     _trace.TraceInvalidateAll(_lastViewport.ToOrigin().ToInclusive());
     _invalidMap.set_all();
     return S_OK;
 }
 CATCH_RETURN();
 
+// Routine Description:
+// - Notifies us that the console is about to copy a rectangle of the viewport
+//      to another position on it. If we're allowed to use DECCRA, the terminal
+//      can make the same copy at the start of the next frame, and the target
+//      doesn't need to be painted. That only works while the terminal still
+//      has what's in the source: none of it may be waiting to be painted, and
+//      nothing may have been scrolled or copied yet this frame.
+// - Until EndRectangleCopy, invalidations of the target are ignored.
+// Arguments:
+// - source - The rectangle to copy, in buffer coordinates.
+// - target - The position its top left is copied to, in buffer coordinates.
+// Return Value:
+// - true if the terminal is going to make the copy. Otherwise the target gets
+//      invalidated like it always did.
+bool VtEngine::BeginRectangleCopy(const Viewport& source, const COORD target) noexcept
+try
+{
+    if (!_rectangularCopy ||
+        _passingThrough ||
+        _midPassthroughSequence ||
+        _firstPaint ||
+        _pendingCopySource.has_value() ||
+        _scrollDelta != til::point{ 0, 0 } ||
+        (source.Left() == target.X && source.Top() == target.Y))
+    {
+        return false;
+    }
+
+    const auto targetRect = Viewport::FromDimensions(target, source.Dimensions());
+    if (!_lastViewport.IsInBounds(source) || !_lastViewport.IsInBounds(targetRect))
+    {
+        return false;
+    }
+
+    const auto sourceInView = _lastViewport.ConvertToOrigin(source);
+    const til::rectangle sourceRect{ sourceInView.ToInclusive() };
+    for (const auto& run : _invalidMap.runs())
+    {
+        if (!(run & sourceRect).empty())
+        {
+            return false;
+        }
+    }
+
+    _pendingCopySource = sourceInView;
+    _pendingCopyTarget = target;
+    _lastViewport.ConvertToOrigin(&_pendingCopyTarget);
+    _copyingRectangle = true;
+    return true;
+}
+CATCH_LOG_RETURN_FALSE()
+
+// Routine Description:
+// - Notifies us that the console made the copy that BeginRectangleCopy
+//      accepted, so invalidations of the target count again.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::EndRectangleCopy() noexcept
+{
+    _copyingRectangle = false;
+}
+
 // Method Description:
 // - Notifies us that we're about to circle the buffer, giving us a chance to
 //      force a repaint before the buffer contents are lost. The VT renderer
@@ -108,7 +202,9 @@ CATCH_RETURN();
 [[nodiscard]] HRESULT VtEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
 {
     // If we're in the middle of a resize request, don't try to immediately start a frame.
-    if (_inResizeRequest)
+    // The same goes for client VT that's passed through: the terminal scrolls
+    // along with it by itself.
+    if (_inResizeRequest || _passingThrough)
     {
         *pForcePaint = false;
     }
@@ -28,6 +28,7 @@ using namespace Microsoft::Console::Types;
     // If there's nothing to do, quick return
     bool somethingToDo = _invalidMap.any() ||
                          _scrollDelta != til::point{ 0, 0 } ||
+                         _pendingCopySource.has_value() ||
                          _cursorMoved ||
                          _titleChanged;
 
@@ -450,6 +450,21 @@ HRESULT VtEngine::RequestCursor() noexcept
     return S_OK;
 }
 
+// Method Description:
+// - sends a sequence to ask the end terminal to wrap pastes in bracketed
+//      paste markers, or to stop. Flushes the buffer as well, so that the
+//      terminal knows before the next paste.
+// Arguments:
+// - enabled: true to ask for the markers.
+// Return Value:
+// - S_OK if we succeeded, else an appropriate HRESULT for failing to allocate or write.
+HRESULT VtEngine::RequestBracketedPasteMode(const bool enabled) noexcept
+{
+    RETURN_IF_FAILED(_SetBracketedPasteMode(enabled));
+    RETURN_IF_FAILED(_Flush());
+    return S_OK;
+}
+
 // Method Description:
 // - Tell the vt renderer to begin a resize operation. During a resize
 //   operation, the vt renderer should _not_ request to be repainted during a
@@ -493,3 +508,78 @@ void VtEngine::SetResizeQuirk(const bool resizeQuirk)
 {
     _resizeQuirk = resizeQuirk;
 }
+
+// Method Description:
+// - Configure the renderer to let the terminal copy rectangles of the viewport
+//   that the console copied, with DECCRA, instead of repainting where they
+//   went. Only terminals that support the rectangular area operations can be
+//   sent those, so this is opt-in.
+// Arguments:
+// - rectangularCopy - true iff we were started with the `--rectangularCopy` flag enabled.
+// Return Value:
+// - <none>
+void VtEngine::SetRectangularCopy(const bool rectangularCopy)
+{
+    _rectangularCopy = rectangularCopy;
+}
+
+// Method Description:
+// - Called before the console parses VT that a client application wrote, and
+//   that's going to be written to the terminal as it is. Until EndPassthrough,
+//   whatever the console does to its buffer in response isn't invalidated,
+//   since the terminal is going to do the same thing by itself.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void VtEngine::BeginPassthrough() noexcept
+{
+    _passingThrough = true;
+}
+
+// Method Description:
+// - Writes the client's VT to the terminal, and stops ignoring invalidations.
+//   We don't know what the client did to the terminal's rendition, or whether
+//   it left the cursor in the delayed wrap state, so the rendition is reset
+//   and the next frame positions the cursor explicitly.
+// - If the client's VT stopped in the middle of a sequence, the rest of it is
+//   still to come, and anything we wrote now would end up inside it. Until a
+//   later write finishes it, the rendition isn't reset, and we don't paint.
+// Arguments:
+// - str: the VT that the client wrote.
+// - cursorVisible: whether the client left the cursor visible.
+// - inGround: whether the client's VT ended outside of any sequence.
+// Return Value:
+// - S_OK or suitable HRESULT error from either conversion or writing pipe.
+[[nodiscard]] HRESULT VtEngine::EndPassthrough(const std::wstring_view str, const bool /*cursorVisible*/, const bool inGround) noexcept
+{
+    _passingThrough = false;
+    _midPassthroughSequence = !inGround;
+
+    RETURN_IF_FAILED(_WriteTerminalUtf8(str));
+
+    _lastText = INVALID_COORDS;
+    _wrappedRow = std::nullopt;
+    _delayedEolWrap = false;
+    if (inGround)
+    {
+        RETURN_IF_FAILED(_ResetGraphicsRendition());
+    }
+
+    return _Flush();
+}
+
+// Method Description:
+// - Resets the terminal's rendition to the default, so that the next
+//   UpdateDrawingBrushes only needs to emit what differs from that.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK or suitable HRESULT error from writing pipe.
+[[nodiscard]] HRESULT VtEngine::_ResetGraphicsRendition() noexcept
+{
+    _LastFG = _colorProvider.GetDefaultForeground();
+    _LastBG = _colorProvider.GetDefaultBackground();
+    _lastWasBold = false;
+    return _SetGraphicsDefault();
+}
@@ -96,6 +96,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT SuppressResizeRepaint() noexcept;
 
         [[nodiscard]] HRESULT RequestCursor() noexcept;
+        [[nodiscard]] HRESULT RequestBracketedPasteMode(const bool enabled) noexcept;
         [[nodiscard]] HRESULT InheritCursor(const COORD coordCursor) noexcept;
 
         [[nodiscard]] HRESULT WriteTerminalUtf8(const std::string_view str) noexcept;
@@ -107,6 +108,12 @@ namespace Microsoft::Console::Render
         void EndResizeRequest();
 
         void SetResizeQuirk(const bool resizeQuirk);
+        void SetRectangularCopy(const bool rectangularCopy);
+        bool BeginRectangleCopy(const Microsoft::Console::Types::Viewport& source, const COORD target) noexcept;
+        void EndRectangleCopy() noexcept;
+
+        void BeginPassthrough() noexcept;
+        [[nodiscard]] virtual HRESULT EndPassthrough(const std::wstring_view str, const bool cursorVisible, const bool inGround) noexcept;
 
     protected:
         wil::unique_hfile _hFile;
@@ -155,6 +162,16 @@ namespace Microsoft::Console::Render
 
         bool _resizeQuirk{ false };
 
+        bool _rectangularCopy{ false };
+        // A rectangle of the viewport that the console copied, and that the
+        // terminal is going to copy by itself at the start of the next frame.
+        std::optional<Microsoft::Console::Types::Viewport> _pendingCopySource{ std::nullopt };
+        COORD _pendingCopyTarget{ 0, 0 };
+        bool _copyingRectangle{ false };
+
+        bool _passingThrough{ false };
+        bool _midPassthroughSequence{ false };
+
         [[nodiscard]] HRESULT _Write(std::string_view const str) noexcept;
         [[nodiscard]] HRESULT _WriteFormattedString(const std::string* const pFormat, ...) noexcept;
         [[nodiscard]] HRESULT _Flush() noexcept;
@@ -175,6 +192,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _CursorPosition(const COORD coord) noexcept;
         [[nodiscard]] HRESULT _CursorHome() noexcept;
         [[nodiscard]] HRESULT _ClearScreen() noexcept;
+        [[nodiscard]] HRESULT _CopyRectangularArea(const Microsoft::Console::Types::Viewport& source, const COORD target) noexcept;
         [[nodiscard]] HRESULT _ChangeTitle(const std::string& title) noexcept;
         [[nodiscard]] HRESULT _SetGraphicsRendition16Color(const WORD wAttr,
                                                            const bool fIsForeground) noexcept;
@@ -185,6 +203,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _SetGraphicsBoldness(const bool isBold) noexcept;
 
         [[nodiscard]] HRESULT _SetGraphicsDefault() noexcept;
+        [[nodiscard]] virtual HRESULT _ResetGraphicsRendition() noexcept;
 
         [[nodiscard]] HRESULT _ResizeWindow(const short sWidth, const short sHeight) noexcept;
 
@@ -204,6 +223,7 @@ namespace Microsoft::Console::Render
         [[nodiscard]] HRESULT _EndCrossedOut() noexcept;
 
         [[nodiscard]] HRESULT _RequestCursor() noexcept;
+        [[nodiscard]] HRESULT _SetBracketedPasteMode(const bool enabled) noexcept;
 
         [[nodiscard]] virtual HRESULT _MoveCursor(const COORD coord) noexcept = 0;
         [[nodiscard]] HRESULT _RgbUpdateDrawingBrushes(const COLORREF colorForeground,
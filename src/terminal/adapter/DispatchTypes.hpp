@@ -94,7 +94,9 @@ namespace Microsoft::Console::VirtualTerminal::DispatchTypes
         UTF8_EXTENDED_MODE = 1005,
         SGR_EXTENDED_MODE = 1006,
         ALTERNATE_SCROLL = 1007,
-        ASB_AlternateScreenBuffer = 1049
+        ASB_AlternateScreenBuffer = 1049,
+        BRACKETED_PASTE_MODE = 2004,
+        SYNCHRONIZED_OUTPUT = 2026
     };
 
     enum VTCharacterSets : wchar_t
@@ -134,6 +136,17 @@ namespace Microsoft::Console::VirtualTerminal::DispatchTypes
         DependsOnMode
     };
 
+    // The area of a rectangular area operation (DECCRA, DECFRA, DECERA,
+    // DECSERA) in 1-based, inclusive page coordinates. A bottom or right of 0
+    // stands for the last line or column of the page.
+    struct RectangularArea
+    {
+        size_t top;
+        size_t left;
+        size_t bottom;
+        size_t right;
+    };
+
     constexpr short s_sDECCOLMSetColumns = 132;
     constexpr short s_sDECCOLMResetColumns = 80;
 
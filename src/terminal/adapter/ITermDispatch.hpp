@@ -76,6 +76,8 @@ public:
     virtual bool EnableButtonEventMouseMode(const bool enabled) = 0; // ?1002
     virtual bool EnableAnyEventMouseMode(const bool enabled) = 0; // ?1003
     virtual bool EnableAlternateScroll(const bool enabled) = 0; // ?1007
+    virtual bool EnableBracketedPasteMode(const bool enabled) = 0; // ?2004
+    virtual bool EnableSynchronizedOutput(const bool enabled) = 0; // ?2026
     virtual bool SetColorTableEntry(const size_t tableIndex, const DWORD color) = 0; // OSCColorTable
     virtual bool SetDefaultForeground(const DWORD color) = 0; // OSCDefaultForeground
     virtual bool SetDefaultBackground(const DWORD color) = 0; // OSCDefaultBackground
@@ -84,6 +86,14 @@ public:
     virtual bool EraseInLine(const DispatchTypes::EraseType eraseType) = 0; // EL
     virtual bool EraseCharacters(const size_t numChars) = 0; // ECH
 
+    virtual bool CopyRectangularArea(const DispatchTypes::RectangularArea source,
+                                     const size_t targetTop,
+                                     const size_t targetLeft) = 0; // DECCRA
+    virtual bool FillRectangularArea(const wchar_t fillChar,
+                                     const DispatchTypes::RectangularArea area) = 0; // DECFRA
+    virtual bool EraseRectangularArea(const DispatchTypes::RectangularArea area) = 0; // DECERA
+    virtual bool SelectiveEraseRectangularArea(const DispatchTypes::RectangularArea area) = 0; // DECSERA
+
     virtual bool SetGraphicsRendition(const std::basic_string_view<DispatchTypes::GraphicsOptions> options) = 0; // SGR
 
     virtual bool SetPrivateModes(const std::basic_string_view<DispatchTypes::PrivateModeParams> params) = 0; // DECSET
@@ -53,6 +53,8 @@ bool InteractDispatch::WriteCtrlC()
 // Method Description:
 // - Writes a string of input to the host. The string is converted to keystrokes
 //      that will faithfully represent the input by CharToKeyEvents.
+//  All of the keystrokes are written to the input buffer at once, as records,
+//      so that long strings (like pastes) don't need an allocation per key.
 // Arguments:
 // - string : a string to write to the console.
 // Return Value:
@@ -68,18 +70,44 @@ bool InteractDispatch::WriteString(const std::wstring_view string)
     bool success = _pConApi->GetConsoleOutputCP(codepage);
     if (success)
     {
-        std::deque<std::unique_ptr<IInputEvent>> keyEvents;
+        std::vector<INPUT_RECORD> records;
+        records.reserve(string.size() * 2);
+
+        // Most strings only use a handful of distinct ASCII characters, so
+        //      remember where the keystrokes for each of them were put the
+        //      first time (as offset and count), and copy those afterwards.
+        std::array<std::pair<size_t, size_t>, 128> asciiRecords{};
 
         for (const auto& wch : string)
         {
-            std::deque<std::unique_ptr<KeyEvent>> convertedEvents = CharToKeyEvents(wch, codepage);
+            if (wch < asciiRecords.size() && asciiRecords[wch].second != 0)
+            {
+                const auto [offset, count] = asciiRecords[wch];
+                // Grow first, so that the records we copy from stay put.
+                if (records.capacity() < records.size() + count)
+                {
+                    records.reserve(std::max(records.capacity() * 2, records.size() + count));
+                }
+                for (size_t i = 0; i < count; ++i)
+                {
+                    records.push_back(records[offset + i]);
+                }
+                continue;
+            }
 
-            std::move(convertedEvents.begin(),
-                      convertedEvents.end(),
-                      std::back_inserter(keyEvents));
+            const auto convertedEvents = CharToKeyEvents(wch, codepage);
+            if (wch < asciiRecords.size())
+            {
+                asciiRecords[wch] = { records.size(), convertedEvents.size() };
+            }
+            for (const auto& keyEvent : convertedEvents)
+            {
+                records.push_back(keyEvent->ToInputRecord());
+            }
         }
 
-        success = WriteInput(keyEvents);
+        size_t written = 0;
+        success = _pConApi->PrivateWriteConsoleInputW(records, written);
     }
     return success;
 }
@@ -559,6 +559,172 @@ bool AdaptDispatch::EraseCharacters(const size_t numChars)
     return success;
 }
 
+// Routine Description:
+// - Gets the page that the rectangular area operations work in, as an
+//   inclusive rectangle in the buffer. That's the viewport, or the area between
+//   the margins when the origin mode is relative.
+// Arguments:
+// - csbiex - The screen buffer info of the active buffer.
+// Return Value:
+// - The page.
+SMALL_RECT AdaptDispatch::_GetRectangularAreaPage(const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex) const noexcept
+{
+    // srWindow is exclusive so we need to subtract 1 from the bottom.
+    SMALL_RECT page = { 0, csbiex.srWindow.Top, gsl::narrow_cast<SHORT>(csbiex.dwSize.X - 1), gsl::narrow_cast<SHORT>(csbiex.srWindow.Bottom - 1) };
+
+    const bool marginsSet = _scrollMargins.Top < _scrollMargins.Bottom;
+    if (_isOriginModeRelative && marginsSet)
+    {
+        page.Top = gsl::narrow_cast<SHORT>(csbiex.srWindow.Top + _scrollMargins.Top);
+        page.Bottom = gsl::narrow_cast<SHORT>(csbiex.srWindow.Top + _scrollMargins.Bottom);
+    }
+    return page;
+}
+
+// Routine Description:
+// - Converts the area of a rectangular area operation into an inclusive
+//   rectangle in the buffer. Coordinates past the edges of the page are
+//   treated as its edges.
+// Arguments:
+// - csbiex - The screen buffer info of the active buffer.
+// - area - The area, in page coordinates.
+// - rect - Receives the rectangle in the buffer.
+// Return Value:
+// - True if the area contains any cells. False if its top is below its
+//   bottom, or its left is right of its right.
+bool AdaptDispatch::_GetRectangularArea(const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex,
+                                        const DispatchTypes::RectangularArea area,
+                                        SMALL_RECT& rect) const noexcept
+{
+    const auto page = _GetRectangularAreaPage(csbiex);
+
+    // A position of 0 is the last line or column of the page.
+    const auto toPage = [](const size_t position, const SHORT first, const SHORT last) noexcept {
+        const auto count = gsl::narrow_cast<size_t>(last - first) + 1;
+        const auto clamped = position == 0 ? count : std::min(position, count);
+        return gsl::narrow_cast<SHORT>(first + clamped - 1);
+    };
+
+    rect.Top = toPage(std::max<size_t>(area.top, 1), page.Top, page.Bottom);
+    rect.Left = toPage(std::max<size_t>(area.left, 1), page.Left, page.Right);
+    rect.Bottom = toPage(area.bottom, page.Top, page.Bottom);
+    rect.Right = toPage(area.right, page.Left, page.Right);
+    return rect.Top <= rect.Bottom && rect.Left <= rect.Right;
+}
+
+// Routine Description:
+// - DECCRA - Copies a rectangular area of the page to another position on it.
+//   The parts of the copy that wouldn't fit on the page are cut off.
+// Arguments:
+// - source - The area to copy.
+// - targetTop - The line to copy the top of the area to.
+// - targetLeft - The column to copy the left of the area to.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::CopyRectangularArea(const DispatchTypes::RectangularArea source,
+                                        const size_t targetTop,
+                                        const size_t targetLeft)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    // Make sure to reset the viewport (with MoveToBottom )to where it was
+    //      before the user scrolled the console output
+    bool success = _pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+
+    SMALL_RECT sourceRect = { 0 };
+    if (success && _GetRectangularArea(csbiex, source, sourceRect))
+    {
+        const auto top = std::max<size_t>(targetTop, 1);
+        const auto left = std::max<size_t>(targetLeft, 1);
+        const auto height = gsl::narrow_cast<size_t>(sourceRect.Bottom - sourceRect.Top);
+        const auto width = gsl::narrow_cast<size_t>(sourceRect.Right - sourceRect.Left);
+
+        SMALL_RECT targetRect = { 0 };
+        if (_GetRectangularArea(csbiex, { top, left, top + height, left + width }, targetRect))
+        {
+            sourceRect.Bottom = gsl::narrow_cast<SHORT>(sourceRect.Top + targetRect.Bottom - targetRect.Top);
+            sourceRect.Right = gsl::narrow_cast<SHORT>(sourceRect.Left + targetRect.Right - targetRect.Left);
+            success = _pConApi->PrivateCopyRectangle(sourceRect, { targetRect.Left, targetRect.Top });
+        }
+    }
+
+    return success;
+}
+
+// Routine Description:
+// - Fills a rectangular area of the page with the given character.
+// Arguments:
+// - area - The area to fill.
+// - fillChar - The character to fill the area with.
+// - fillAttrs - The attributes to give the cells, or empty to keep theirs.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::_FillRectangularAreaHelper(const DispatchTypes::RectangularArea area,
+                                               const wchar_t fillChar,
+                                               const std::optional<TextAttribute> fillAttrs) const
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX csbiex = { 0 };
+    csbiex.cbSize = sizeof(CONSOLE_SCREEN_BUFFER_INFOEX);
+    // Make sure to reset the viewport (with MoveToBottom )to where it was
+    //      before the user scrolled the console output
+    bool success = _pConApi->MoveToBottom() && _pConApi->GetConsoleScreenBufferInfoEx(csbiex);
+
+    SMALL_RECT rect = { 0 };
+    if (success && _GetRectangularArea(csbiex, area, rect))
+    {
+        success = _pConApi->PrivateFillRectangle(rect, fillChar, fillAttrs);
+    }
+
+    return success;
+}
+
+// Routine Description:
+// - DECFRA - Fills a rectangular area of the page with the given character,
+//   in the currently selected rendition.
+// Arguments:
+// - fillChar - The character to fill the area with.
+// - area - The area to fill.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::FillRectangularArea(const wchar_t fillChar,
+                                        const DispatchTypes::RectangularArea area)
+{
+    TextAttribute attrs;
+    return _pConApi->PrivateGetTextAttributes(attrs) &&
+           _FillRectangularAreaHelper(area, fillChar, attrs);
+}
+
+// Routine Description:
+// - DECERA - Erases a rectangular area of the page, by filling it with spaces
+//   in the standard erase attributes.
+// Arguments:
+// - area - The area to erase.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::EraseRectangularArea(const DispatchTypes::RectangularArea area)
+{
+    TextAttribute attrs;
+    if (!_pConApi->PrivateGetTextAttributes(attrs))
+    {
+        return false;
+    }
+    attrs.SetStandardErase();
+    return _FillRectangularAreaHelper(area, L' ', attrs);
+}
+
+// Routine Description:
+// - DECSERA - Erases the characters in a rectangular area of the page that
+//   aren't protected, leaving their attributes alone. We don't support
+//   protecting characters (DECSCA), so that's all of them.
+// Arguments:
+// - area - The area to erase.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool AdaptDispatch::SelectiveEraseRectangularArea(const DispatchTypes::RectangularArea area)
+{
+    return _FillRectangularAreaHelper(area, L' ', std::nullopt);
+}
+
 // Routine Description:
 // - ED - Erases a portion of the current viewable area (viewport) of the console.
 // Arguments:
@@ -979,6 +1145,12 @@ bool AdaptDispatch::_PrivateModeParamsHelper(const DispatchTypes::PrivateModePar
     case DispatchTypes::PrivateModeParams::ASB_AlternateScreenBuffer:
         success = enable ? UseAlternateScreenBuffer() : UseMainScreenBuffer();
         break;
+    case DispatchTypes::PrivateModeParams::BRACKETED_PASTE_MODE:
+        success = EnableBracketedPasteMode(enable);
+        break;
+    case DispatchTypes::PrivateModeParams::SYNCHRONIZED_OUTPUT:
+        success = EnableSynchronizedOutput(enable);
+        break;
     default:
         // If no functions to call, overall dispatch was a failure.
         success = false;
@@ -1980,6 +2152,33 @@ bool AdaptDispatch::EnableAlternateScroll(const bool enabled)
     return success;
 }
 
+//Routine Description:
+// Enable Bracketed Paste Mode - The console doesn't wrap pastes itself. As a
+//      conpty, failing passes the mode through to the terminal, which does.
+//Arguments:
+// - enabled - true to enable, false to disable.
+// Return value:
+// False, since the console doesn't handle it.
+bool AdaptDispatch::EnableBracketedPasteMode(const bool /*enabled*/)
+{
+    return false;
+}
+
+//Routine Description:
+// Enable Synchronized Output - While enabled, the renderer holds back its
+//      frames, so that an application can redraw the screen with as many
+//      sequences as it likes without anything being painted halfway through.
+//      Disabling it presents everything that changed in the meantime as a
+//      single frame.
+//Arguments:
+// - enabled - true to begin a synchronized update, false to end it.
+// Return value:
+// True if handled successfully. False otherwise.
+bool AdaptDispatch::EnableSynchronizedOutput(const bool enabled)
+{
+    return _pConApi->PrivateEnableSynchronizedOutput(enabled);
+}
+
 //Routine Description:
 // Set Cursor Style - Changes the cursor's style to match the given Dispatch
 //      cursor style. Unix styles are a combination of the shape and the blinking state.
@@ -53,6 +53,13 @@ namespace Microsoft::Console::VirtualTerminal
         bool EraseInDisplay(const DispatchTypes::EraseType eraseType) override; // ED
         bool EraseInLine(const DispatchTypes::EraseType eraseType) override; // EL
         bool EraseCharacters(const size_t numChars) override; // ECH
+        bool CopyRectangularArea(const DispatchTypes::RectangularArea source,
+                                 const size_t targetTop,
+                                 const size_t targetLeft) override; // DECCRA
+        bool FillRectangularArea(const wchar_t fillChar,
+                                 const DispatchTypes::RectangularArea area) override; // DECFRA
+        bool EraseRectangularArea(const DispatchTypes::RectangularArea area) override; // DECERA
+        bool SelectiveEraseRectangularArea(const DispatchTypes::RectangularArea area) override; // DECSERA
         bool InsertCharacter(const size_t count) override; // ICH
         bool DeleteCharacter(const size_t count) override; // DCH
         bool SetGraphicsRendition(const std::basic_string_view<DispatchTypes::GraphicsOptions> options) override; // SGR
@@ -95,6 +102,8 @@ namespace Microsoft::Console::VirtualTerminal
         bool EnableButtonEventMouseMode(const bool enabled) override; // ?1002
         bool EnableAnyEventMouseMode(const bool enabled) override; // ?1003
         bool EnableAlternateScroll(const bool enabled) override; // ?1007
+        bool EnableBracketedPasteMode(const bool enabled) override; // ?2004
+        bool EnableSynchronizedOutput(const bool enabled) override; // ?2026
         bool SetCursorStyle(const DispatchTypes::CursorStyle cursorStyle) override; // DECSCUSR
         bool SetCursorColor(const COLORREF cursorColor) override;
 
@@ -139,6 +148,13 @@ namespace Microsoft::Console::VirtualTerminal
         bool _EraseScrollback();
         bool _EraseAll();
         bool _InsertDeleteHelper(const size_t count, const bool isInsert) const;
+        SMALL_RECT _GetRectangularAreaPage(const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex) const noexcept;
+        bool _GetRectangularArea(const CONSOLE_SCREEN_BUFFER_INFOEX& csbiex,
+                                 const DispatchTypes::RectangularArea area,
+                                 SMALL_RECT& rect) const noexcept;
+        bool _FillRectangularAreaHelper(const DispatchTypes::RectangularArea area,
+                                        const wchar_t fillChar,
+                                        const std::optional<TextAttribute> fillAttrs) const;
         bool _ScrollMovement(const ScrollDirection dir, const size_t distance) const;
         static void s_DisableAllColors(WORD& attr, const bool isForeground) noexcept;
         static void s_ApplyColors(WORD& attr, const WORD applyThis, const bool isForeground) noexcept;
@@ -55,6 +55,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         virtual bool PrivateWriteConsoleInputW(std::deque<std::unique_ptr<IInputEvent>>& events,
                                                size_t& eventsWritten) = 0;
+        virtual bool PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
+                                               size_t& eventsWritten) = 0;
         virtual bool SetConsoleWindowInfo(const bool absolute,
                                           const SMALL_RECT& window) = 0;
         virtual bool PrivateSetCursorKeysMode(const bool applicationMode) = 0;
@@ -81,6 +83,7 @@ namespace Microsoft::Console::VirtualTerminal
         virtual bool PrivateEnableButtonEventMouseMode(const bool enabled) = 0;
         virtual bool PrivateEnableAnyEventMouseMode(const bool enabled) = 0;
         virtual bool PrivateEnableAlternateScroll(const bool enabled) = 0;
+        virtual bool PrivateEnableSynchronizedOutput(const bool enabled) = 0;
         virtual bool PrivateEraseAll() = 0;
         virtual bool SetCursorStyle(const CursorType style) = 0;
         virtual bool SetCursorColor(const COLORREF color) = 0;
@@ -113,5 +116,11 @@ namespace Microsoft::Console::VirtualTerminal
                                          const std::optional<SMALL_RECT> clipRect,
                                          const COORD destinationOrigin,
                                          const bool standardFillAttrs) = 0;
+
+        virtual bool PrivateCopyRectangle(const SMALL_RECT source,
+                                          const COORD target) = 0;
+        virtual bool PrivateFillRectangle(const SMALL_RECT rect,
+                                          const wchar_t fillChar,
+                                          const std::optional<TextAttribute> fillAttrs) = 0;
     };
 }
@@ -70,6 +70,8 @@ public:
     bool EnableButtonEventMouseMode(const bool /*enabled*/) noexcept override { return false; } // ?1002
     bool EnableAnyEventMouseMode(const bool /*enabled*/) noexcept override { return false; } // ?1003
     bool EnableAlternateScroll(const bool /*enabled*/) noexcept override { return false; } // ?1007
+    bool EnableBracketedPasteMode(const bool /*enabled*/) noexcept override { return false; } // ?2004
+    bool EnableSynchronizedOutput(const bool /*enabled*/) noexcept override { return false; } // ?2026
     bool SetColorTableEntry(const size_t /*tableIndex*/, const DWORD /*color*/) noexcept override { return false; } // OSCColorTable
     bool SetDefaultForeground(const DWORD /*color*/) noexcept override { return false; } // OSCDefaultForeground
     bool SetDefaultBackground(const DWORD /*color*/) noexcept override { return false; } // OSCDefaultBackground
@@ -78,6 +80,14 @@ public:
     bool EraseInLine(const DispatchTypes::EraseType /* eraseType*/) noexcept override { return false; } // EL
     bool EraseCharacters(const size_t /*numChars*/) noexcept override { return false; } // ECH
 
+    bool CopyRectangularArea(const DispatchTypes::RectangularArea /*source*/,
+                             const size_t /*targetTop*/,
+                             const size_t /*targetLeft*/) noexcept override { return false; } // DECCRA
+    bool FillRectangularArea(const wchar_t /*fillChar*/,
+                             const DispatchTypes::RectangularArea /*area*/) noexcept override { return false; } // DECFRA
+    bool EraseRectangularArea(const DispatchTypes::RectangularArea /*area*/) noexcept override { return false; } // DECERA
+    bool SelectiveEraseRectangularArea(const DispatchTypes::RectangularArea /*area*/) noexcept override { return false; } // DECSERA
+
     bool SetGraphicsRendition(const std::basic_string_view<DispatchTypes::GraphicsOptions> /*options*/) noexcept override { return false; } // SGR
 
     bool SetPrivateModes(const std::basic_string_view<DispatchTypes::PrivateModeParams> /*params*/) noexcept override { return false; } // DECSET
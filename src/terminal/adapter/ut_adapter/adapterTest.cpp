@@ -344,6 +344,23 @@ public:
         return _privateWriteConsoleInputWResult;
     }
 
+    bool PrivateWriteConsoleInputW(const gsl::span<const INPUT_RECORD> records,
+                                   size_t& eventsWritten) override
+    {
+        Log::Comment(L"PrivateWriteConsoleInputW MOCK called...");
+
+        if (_privateWriteConsoleInputWResult)
+        {
+            // convert the records into input events in local storage so we can test against them
+            Log::Comment(NoThrowString().Format(L"Storing %zu input records locally...", records.size()));
+
+            _events = IInputEvent::Create(records);
+            eventsWritten = _events.size();
+        }
+
+        return _privateWriteConsoleInputWResult;
+    }
+
     bool PrivatePrependConsoleInput(std::deque<std::unique_ptr<IInputEvent>>& events,
                                     size_t& eventsWritten) override
     {
@@ -505,6 +522,16 @@ public:
         return _privateEnableAlternateScrollResult;
     }
 
+    bool PrivateEnableSynchronizedOutput(const bool enabled) override
+    {
+        Log::Comment(L"PrivateEnableSynchronizedOutput MOCK called...");
+        if (_privateEnableSynchronizedOutputResult)
+        {
+            VERIFY_ARE_EQUAL(_expectedSynchronizedOutputEnabled, enabled);
+        }
+        return _privateEnableSynchronizedOutputResult;
+    }
+
     bool PrivateEraseAll() override
     {
         Log::Comment(L"PrivateEraseAll MOCK called...");
@@ -667,6 +694,36 @@ public:
         return TRUE;
     }
 
+    bool PrivateCopyRectangle(const SMALL_RECT source,
+                              const COORD target) override
+    {
+        Log::Comment(L"PrivateCopyRectangle MOCK called...");
+
+        if (_privateCopyRectangleResult)
+        {
+            VERIFY_ARE_EQUAL(_expectedCopyRectangleSource, source);
+            VERIFY_ARE_EQUAL(_expectedCopyRectangleTarget, target);
+        }
+
+        return _privateCopyRectangleResult;
+    }
+
+    bool PrivateFillRectangle(const SMALL_RECT rect,
+                              const wchar_t fillChar,
+                              const std::optional<TextAttribute> fillAttrs) override
+    {
+        Log::Comment(L"PrivateFillRectangle MOCK called...");
+
+        if (_privateFillRectangleResult)
+        {
+            VERIFY_ARE_EQUAL(_expectedFillRectangle, rect);
+            VERIFY_ARE_EQUAL(_expectedFillRectangleChar, fillChar);
+            VERIFY_ARE_EQUAL(_expectedFillRectangleKeepsAttrs, !fillAttrs.has_value());
+        }
+
+        return _privateFillRectangleResult;
+    }
+
     void PrepData()
     {
         PrepData(CursorDirection::UP); // if called like this, the cursor direction doesn't matter.
@@ -889,6 +946,8 @@ public:
     bool _privateEnableButtonEventMouseModeResult = false;
     bool _privateEnableAnyEventMouseModeResult = false;
     bool _privateEnableAlternateScrollResult = false;
+    bool _privateEnableSynchronizedOutputResult = false;
+    bool _expectedSynchronizedOutputEnabled = false;
     bool _setConsoleXtermTextAttributeResult = false;
     bool _setConsoleRGBTextAttributeResult = false;
     bool _privateSetLegacyAttributesResult = false;
@@ -911,6 +970,15 @@ public:
     bool _privateSetDefaultBackgroundResult = false;
     COLORREF _expectedDefaultBackgroundColorValue = INVALID_COLOR;
 
+    bool _privateCopyRectangleResult = false;
+    SMALL_RECT _expectedCopyRectangleSource = { 0 };
+    COORD _expectedCopyRectangleTarget = { 0 };
+
+    bool _privateFillRectangleResult = false;
+    SMALL_RECT _expectedFillRectangle = { 0 };
+    wchar_t _expectedFillRectangleChar = L'\0';
+    bool _expectedFillRectangleKeepsAttrs = false;
+
 private:
     HANDLE _hCon;
 };
@@ -1976,6 +2044,48 @@ public:
         VERIFY_IS_FALSE(_pDispatch.get()->SetTopBottomScrollingMargins(srTestMargins.Top, srTestMargins.Bottom));
     }
 
+    TEST_METHOD(RectangularAreaTest)
+    {
+        Log::Comment(L"Starting test...");
+
+        // The viewport covers rows 20 to 48 of a buffer that's 100 columns wide.
+        _testGetSet->PrepData();
+
+        Log::Comment(L"Test 1: Copy an area to another position on the page.");
+        _testGetSet->_privateCopyRectangleResult = true;
+        _testGetSet->_expectedCopyRectangleSource = { 2, 21, 5, 23 };
+        _testGetSet->_expectedCopyRectangleTarget = { 19, 29 };
+        VERIFY_IS_TRUE(_pDispatch->CopyRectangularArea({ 2, 3, 4, 6 }, 10, 20));
+
+        Log::Comment(L"Test 2: The part of a copy that doesn't fit on the page is cut off.");
+        _testGetSet->_expectedCopyRectangleSource = { 0, 20, 1, 21 };
+        _testGetSet->_expectedCopyRectangleTarget = { 98, 47 };
+        VERIFY_IS_TRUE(_pDispatch->CopyRectangularArea({ 1, 1, 0, 0 }, 28, 99));
+
+        Log::Comment(L"Test 3: Fill an area in the current rendition.");
+        _testGetSet->_privateFillRectangleResult = true;
+        _testGetSet->_expectedFillRectangle = { 4, 24, 9, 24 };
+        _testGetSet->_expectedFillRectangleChar = L'X';
+        _testGetSet->_expectedFillRectangleKeepsAttrs = false;
+        VERIFY_IS_TRUE(_pDispatch->FillRectangularArea(L'X', { 5, 5, 5, 10 }));
+
+        Log::Comment(L"Test 4: Erasing defaults to the whole page.");
+        _testGetSet->_expectedFillRectangle = { 0, 20, 99, 48 };
+        _testGetSet->_expectedFillRectangleChar = L' ';
+        VERIFY_IS_TRUE(_pDispatch->EraseRectangularArea({ 1, 1, 0, 0 }));
+
+        Log::Comment(L"Test 5: A selective erase keeps the attributes, and is clamped to the page.");
+        _testGetSet->_expectedFillRectangle = { 49, 40, 99, 48 };
+        _testGetSet->_expectedFillRectangleKeepsAttrs = true;
+        VERIFY_IS_TRUE(_pDispatch->SelectiveEraseRectangularArea({ 21, 50, 500, 500 }));
+
+        Log::Comment(L"Test 6: An area with its top below its bottom does nothing.");
+        _testGetSet->_privateCopyRectangleResult = false;
+        _testGetSet->_privateFillRectangleResult = false;
+        VERIFY_IS_TRUE(_pDispatch->EraseRectangularArea({ 10, 1, 5, 0 }));
+        VERIFY_IS_TRUE(_pDispatch->CopyRectangularArea({ 1, 10, 0, 5 }, 1, 1));
+    }
+
     TEST_METHOD(LineFeedTest)
     {
         Log::Comment(L"Starting test...");
@@ -14,6 +14,54 @@ Abstract:
 #pragma once
 namespace Microsoft::Console::VirtualTerminal
 {
+    // DEC terminals accept at least 16 parameters in a control sequence, and
+    // xterm accepts 30. The state machine keeps up to 32 values, counting both
+    // the parameters and their sub-parameters. Any that follow are dropped, and
+    // the sequence is dispatched with the ones that fit. Engines can rely on
+    // never getting more than this many values in total.
+    constexpr size_t MAX_PARAMETER_COUNT = 32;
+
+    // The sub-parameters of a control sequence, which follow one of its
+    //  parameters after a colon. For example "\x1b[38:2::255:0:0m" has the
+    //  single parameter 38, with the sub-parameters 2, 0, 255, 0 and 0.
+    // This only refers to storage owned by the state machine, so like the other
+    //  arguments of a dispatch, it isn't valid after the dispatch returns.
+    class VTSubParameters
+    {
+    public:
+        constexpr VTSubParameters() noexcept = default;
+
+        constexpr VTSubParameters(const std::basic_string_view<size_t> values,
+                                  const std::basic_string_view<BYTE> ends) noexcept :
+            _values{ values },
+            _ends{ ends }
+        {
+        }
+
+        // Returns true if none of the parameters has any sub-parameters.
+        constexpr bool empty() const noexcept
+        {
+            return _values.empty();
+        }
+
+        // Returns the sub-parameters of the parameter at the given index.
+        constexpr std::basic_string_view<size_t> at(const size_t parameterIndex) const noexcept
+        {
+            if (parameterIndex >= _ends.size())
+            {
+                return {};
+            }
+            const size_t begin = parameterIndex > 0 ? _ends[parameterIndex - 1] : 0;
+            return _values.substr(begin, _ends[parameterIndex] - begin);
+        }
+
+    private:
+        std::basic_string_view<size_t> _values;
+        // For each parameter, where its sub-parameters end within _values.
+        //  They begin where those of the previous parameter end.
+        std::basic_string_view<BYTE> _ends;
+    };
+
     class IStateMachineEngine
     {
     public:
@@ -34,7 +82,8 @@ namespace Microsoft::Console::VirtualTerminal
                                        const std::basic_string_view<wchar_t> intermediates) = 0;
         virtual bool ActionCsiDispatch(const wchar_t wch,
                                        const std::basic_string_view<wchar_t> intermediates,
-                                       const std::basic_string_view<size_t> parameters) = 0;
+                                       const std::basic_string_view<size_t> parameters,
+                                       const VTSubParameters subParameters) = 0;
 
         virtual bool ActionClear() = 0;
 
@@ -47,6 +96,20 @@ namespace Microsoft::Console::VirtualTerminal
         virtual bool ActionSs3Dispatch(const wchar_t wch,
                                        const std::basic_string_view<size_t> parameters) = 0;
 
+        // A device control string is handed over in three steps, so that its
+        //  payload can be consumed as it arrives instead of being collected first.
+        //  ActionDcsHook is called with the header of the string. If it returns
+        //  true, the payload follows in any number of ActionDcsPut calls, which
+        //  only see the storage they're given for the duration of the call. Then
+        //  ActionDcsUnhook tells whether the string was terminated, or aborted by
+        //  a CAN, SUB or another escape sequence. If the hook returns false, the
+        //  payload is dropped, and neither of the other two are called.
+        virtual bool ActionDcsHook(const wchar_t wch,
+                                   const std::basic_string_view<wchar_t> intermediates,
+                                   const std::basic_string_view<size_t> parameters) = 0;
+        virtual bool ActionDcsPut(const std::wstring_view string) = 0;
+        virtual bool ActionDcsUnhook(const bool aborted) = 0;
+
         virtual bool FlushAtEndOfString() const = 0;
         virtual bool DispatchControlCharsFromEscape() const = 0;
         virtual bool DispatchIntermediatesFromEscape() const = 0;
@@ -119,6 +119,9 @@ bool InputStateMachineEngine::ActionExecute(const wchar_t wch)
 // - True if successfully generated and written. False otherwise.
 bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool writeAlt)
 {
+    const bool afterCarriageReturn = _pasteAfterCarriageReturn;
+    _pasteAfterCarriageReturn = false;
+
     bool success = false;
     if (wch == UNICODE_ETX && !writeAlt)
     {
@@ -147,6 +150,18 @@ bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool
             writeCtrl = false;
             success = _GenerateKeyFromChar(wch, vkey, modifierState);
             modifierState = 0;
+            _pasteAfterCarriageReturn = !writeAlt && _IsInBracketedPaste();
+            break;
+        case L'\n':
+            if (afterCarriageReturn && !writeAlt && _IsInBracketedPaste())
+            {
+                // A pasted CRLF is a single line break, which the CR already
+                //      entered. Conhost's own paste drops the LF the same way,
+                //      see Clipboard::TextToKeyEvents. Any other pasted LF
+                //      is Ctrl+Enter, just like it is there.
+                return true;
+            }
+            success = _GenerateKeyFromChar(actualChar, vkey, modifierState);
             break;
         case L'\x1b':
             // Translate escape as the ESC key, NOT C-[.
@@ -197,6 +212,33 @@ bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool
     return success;
 }
 
+// Routine Description:
+// - Checks whether the input is part of a bracketed paste, and notes that
+//      more of the paste arrived if so.
+// - If nothing arrived for longer than BracketedPasteTimeout, the terminal
+//      is done sending the paste, and its end marker was lost on the way.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if we're between the markers of a paste.
+bool InputStateMachineEngine::_IsInBracketedPaste() noexcept
+{
+    if (!_inBracketedPaste)
+    {
+        return false;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _lastPasteInput > BracketedPasteTimeout)
+    {
+        _inBracketedPaste = false;
+        return false;
+    }
+
+    _lastPasteInput = now;
+    return true;
+}
+
 // Routine Description:
 // - Triggers the Execute action to indicate that the listener should
 //      immediately respond to a C0 control character.
@@ -212,6 +254,7 @@ bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 {
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
+        _inBracketedPaste = false;
         return _pfnFlushToInputQueue();
     }
 
@@ -227,6 +270,9 @@ bool InputStateMachineEngine::ActionExecuteFromEscape(const wchar_t wch)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPrint(const wchar_t wch)
 {
+    _pasteAfterCarriageReturn = false;
+    _IsInBracketedPaste();
+
     short vkey = 0;
     DWORD modifierState = 0;
     bool success = _GenerateKeyFromChar(wch, vkey, modifierState);
@@ -250,6 +296,10 @@ bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
     {
         return true;
     }
+
+    _pasteAfterCarriageReturn = false;
+    _IsInBracketedPaste();
+
     return _pDispatch->WriteString(string);
 }
 
@@ -298,6 +348,9 @@ bool InputStateMachineEngine::ActionPassThroughString(const std::wstring_view st
 bool InputStateMachineEngine::ActionEscDispatch(const wchar_t wch,
                                                 const std::basic_string_view<wchar_t> /*intermediates*/)
 {
+    // No key sequence is part of a paste.
+    _inBracketedPaste = false;
+
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -335,17 +388,26 @@ bool InputStateMachineEngine::ActionEscDispatch(const wchar_t wch,
 // - wch - Character to dispatch.
 // - intermediates - Intermediate characters in the sequence
 // - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - unused, no input sequence has any.
 // Return Value:
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
                                                 const std::basic_string_view<wchar_t> intermediates,
-                                                const std::basic_string_view<size_t> parameters)
+                                                const std::basic_string_view<size_t> parameters,
+                                                const VTSubParameters /*subParameters*/)
 {
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
+        // Clients in VT input mode get the paste markers as they are, and
+        //      handle pastes themselves. That ends any paste that began
+        //      before the client switched its input mode.
+        _inBracketedPaste = false;
         return _pfnFlushToInputQueue();
     }
 
+    // No key sequence is part of a paste. Only its markers set this again.
+    _inBracketedPaste = false;
+
     DWORD modifierState = 0;
     short vkey = 0;
     unsigned int function = 0;
@@ -382,6 +444,18 @@ bool InputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
     switch (static_cast<CsiActionCodes>(wch))
     {
     case CsiActionCodes::Generic:
+        // A terminal in bracketed paste mode wraps pastes in these two. They
+        //      aren't keys, we only need to know whether we're in a paste.
+        //      See VtIo::SetBracketedPasteMode for who asks for them.
+        if (parameters.size() == 1 &&
+            (til::at(parameters, 0) == static_cast<size_t>(GenericKeyIdentifiers::BracketedPasteStart) ||
+             til::at(parameters, 0) == static_cast<size_t>(GenericKeyIdentifiers::BracketedPasteEnd)))
+        {
+            _inBracketedPaste = til::at(parameters, 0) == static_cast<size_t>(GenericKeyIdentifiers::BracketedPasteStart);
+            _pasteAfterCarriageReturn = false;
+            _lastPasteInput = std::chrono::steady_clock::now();
+            return true;
+        }
         modifierState = _GetGenericKeysModifierState(parameters);
         success = _GetGenericVkey(parameters, vkey);
         break;
@@ -477,6 +551,9 @@ bool InputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
 bool InputStateMachineEngine::ActionSs3Dispatch(const wchar_t wch,
                                                 const std::basic_string_view<size_t> /*parameters*/)
 {
+    // No key sequence is part of a paste.
+    _inBracketedPaste = false;
+
     if (_pDispatch->IsVtInputEnabled() && _pfnFlushToInputQueue)
     {
         return _pfnFlushToInputQueue();
@@ -537,6 +614,46 @@ bool InputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
     return false;
 }
 
+// Method Description:
+// - Triggers the DcsHook action to indicate that the listener should handle a
+//      device control string.
+// Arguments:
+// - wch - Character to dispatch.
+// - intermediates - Intermediate characters in the sequence
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// Return Value:
+// - true if we want the payload of the string.
+bool InputStateMachineEngine::ActionDcsHook(const wchar_t /*wch*/,
+                                            const std::basic_string_view<wchar_t> /*intermediates*/,
+                                            const std::basic_string_view<size_t> /*parameters*/) noexcept
+{
+    // The input engine doesn't handle any device control strings.
+    return false;
+}
+
+// Method Description:
+// - Receives a piece of the payload of a device control string. Never called,
+//      since we don't hook any strings.
+// Arguments:
+// - string - the piece of the payload.
+// Return Value:
+// - true if we handled the payload.
+bool InputStateMachineEngine::ActionDcsPut(const std::wstring_view /*string*/) noexcept
+{
+    return false;
+}
+
+// Method Description:
+// - Ends a device control string. Never called, since we don't hook any strings.
+// Arguments:
+// - aborted - true if the string was cut short instead of being terminated.
+// Return Value:
+// - true if we handled the end of the string.
+bool InputStateMachineEngine::ActionDcsUnhook(const bool /*aborted*/) noexcept
+{
+    return false;
+}
+
 // Method Description:
 // - Writes a sequence of keypresses to the buffer based on the wch,
 //      vkey and modifiers passed in. Will create both the appropriate key downs
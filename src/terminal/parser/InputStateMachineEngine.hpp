@@ -112,6 +112,8 @@ namespace Microsoft::Console::VirtualTerminal
         F10 = 21,
         F11 = 23,
         F12 = 24,
+        BracketedPasteStart = 200,
+        BracketedPasteEnd = 201,
     };
 
     enum class Ss3ActionCodes : wchar_t
@@ -151,7 +153,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionCsiDispatch(const wchar_t wch,
                                const std::basic_string_view<wchar_t> intermediates,
-                               const std::basic_string_view<size_t> parameters) override;
+                               const std::basic_string_view<size_t> parameters,
+                               const VTSubParameters subParameters) override;
 
         bool ActionClear() noexcept override;
 
@@ -164,6 +167,14 @@ namespace Microsoft::Console::VirtualTerminal
         bool ActionSs3Dispatch(const wchar_t wch,
                                const std::basic_string_view<size_t> parameters) override;
 
+        bool ActionDcsHook(const wchar_t wch,
+                           const std::basic_string_view<wchar_t> intermediates,
+                           const std::basic_string_view<size_t> parameters) noexcept override;
+
+        bool ActionDcsPut(const std::wstring_view string) noexcept override;
+
+        bool ActionDcsUnhook(const bool aborted) noexcept override;
+
         bool FlushAtEndOfString() const noexcept override;
         bool DispatchControlCharsFromEscape() const noexcept override;
         bool DispatchIntermediatesFromEscape() const noexcept override;
@@ -176,6 +187,15 @@ namespace Microsoft::Console::VirtualTerminal
         bool _lookingForDSR;
         DWORD _mouseButtonState = 0;
 
+        // Between the markers of a bracketed paste, a line feed right after
+        //      a carriage return is dropped, like conhost's own paste does.
+        //      A terminal sends a paste all at once, so if no more of it
+        //      arrived for this long, the end marker was lost.
+        static constexpr std::chrono::milliseconds BracketedPasteTimeout{ 1000 };
+        bool _inBracketedPaste = false;
+        bool _pasteAfterCarriageReturn = false;
+        std::chrono::steady_clock::time_point _lastPasteInput{};
+
         DWORD _GetCursorKeysModifierState(const std::basic_string_view<size_t> parameters, const CsiActionCodes actionCode) noexcept;
         DWORD _GetGenericKeysModifierState(const std::basic_string_view<size_t> parameters) noexcept;
         DWORD _GetSGRMouseModifierState(const std::basic_string_view<size_t> parameters) noexcept;
@@ -221,6 +241,7 @@ namespace Microsoft::Console::VirtualTerminal
                                size_t& column) const noexcept;
 
         bool _DoControlCharacter(const wchar_t wch, const bool writeAlt);
+        bool _IsInBracketedPaste() noexcept;
 
 #ifdef UNIT_TESTING
         friend class InputEngineTest;
@@ -15,7 +15,8 @@ OutputStateMachineEngine::OutputStateMachineEngine(std::unique_ptr<ITermDispatch
     _dispatch(std::move(pDispatch)),
     _pfnFlushToTerminal(nullptr),
     _pTtyConnection(nullptr),
-    _lastPrintedChar(AsciiChars::NUL)
+    _lastPrintedChar(AsciiChars::NUL),
+    _dcsPassingThrough(false)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, _dispatch.get());
 }
@@ -178,102 +179,95 @@ bool OutputStateMachineEngine::ActionPassThroughString(const std::wstring_view s
 bool OutputStateMachineEngine::ActionEscDispatch(const wchar_t wch,
                                                  const std::basic_string_view<wchar_t> intermediates)
 {
-    bool success = false;
+    const auto handler = _GetEscHandler(wch, intermediates);
+    bool success = handler != nullptr && (this->*handler)(wch);
 
-    // no intermediates.
-    if (intermediates.empty())
+    // If we were unable to process the string, and there's a TTY attached to us,
+    //      trigger the state machine to flush the string to the terminal.
+    if (_pfnFlushToTerminal != nullptr && !success)
     {
-        switch (wch)
-        {
-        case VTActionCodes::DECSC_CursorSave:
-            success = _dispatch->CursorSaveState();
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSC);
-            break;
-        case VTActionCodes::DECRC_CursorRestore:
-            success = _dispatch->CursorRestoreState();
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECRC);
-            break;
-        case VTActionCodes::DECKPAM_KeypadApplicationMode:
-            success = _dispatch->SetKeypadMode(true);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECKPAM);
-            break;
-        case VTActionCodes::DECKPNM_KeypadNumericMode:
-            success = _dispatch->SetKeypadMode(false);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECKPNM);
-            break;
-        case VTActionCodes::NEL_NextLine:
-            success = _dispatch->LineFeed(DispatchTypes::LineFeedType::WithReturn);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::NEL);
-            break;
-        case VTActionCodes::IND_Index:
-            success = _dispatch->LineFeed(DispatchTypes::LineFeedType::WithoutReturn);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::IND);
-            break;
-        case VTActionCodes::RI_ReverseLineFeed:
-            success = _dispatch->ReverseLineFeed();
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::RI);
-            break;
-        case VTActionCodes::HTS_HorizontalTabSet:
-            success = _dispatch->HorizontalTabSet();
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::HTS);
-            break;
-        case VTActionCodes::RIS_ResetToInitialState:
-            success = _dispatch->HardReset();
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::RIS);
-            break;
-        default:
-            // If no functions to call, overall dispatch was a failure.
-            success = false;
-            break;
-        }
+        success = _pfnFlushToTerminal();
     }
-    else if (intermediates.size() == 1)
+
+    _ClearLastChar();
+
+    return success;
+}
+
+// Routine Description:
+// - Triggers the CsiDispatch action to indicate that the listener should handle
+//      a control sequence. These sequences perform various API-type commands
+//      that can include many parameters.
+// Arguments:
+// - wch - Character to dispatch.
+// - intermediates - Intermediate characters in the sequence
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - true iff we successfully dispatched the sequence.
+bool OutputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
+                                                 const std::basic_string_view<wchar_t> intermediates,
+                                                 std::basic_string_view<size_t> parameters,
+                                                 const VTSubParameters subParameters)
+{
+    // The state machine only dispatches sub-parameters for SGR.
+    const auto handler = _GetCsiHandler(wch, intermediates);
+    bool success = handler != nullptr && (this->*handler)(parameters, subParameters);
+
+    // If we were unable to process the string, and there's a TTY attached to us,
+    //      trigger the state machine to flush the string to the terminal.
+    if (_pfnFlushToTerminal != nullptr && !success)
     {
-        const auto value = til::at(intermediates, 0);
-        DesignateCharsetTypes designateType = DefaultDesignateCharsetType;
-        success = _GetDesignateType(value, designateType);
-        if (success)
-        {
-            switch (designateType)
-            {
-            case DesignateCharsetTypes::G0:
-                success = _dispatch->DesignateCharset(wch);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DesignateG0);
-                break;
-            case DesignateCharsetTypes::G1:
-                success = false;
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DesignateG1);
-                break;
-            case DesignateCharsetTypes::G2:
-                success = false;
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DesignateG2);
-                break;
-            case DesignateCharsetTypes::G3:
-                success = false;
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DesignateG3);
-                break;
-            default:
-                // If no functions to call, overall dispatch was a failure.
-                success = false;
-                break;
-            }
-        }
-        else if (value == L'#')
-        {
-            switch (wch)
-            {
-            case VTActionCodes::DECALN_ScreenAlignmentPattern:
-                success = _dispatch->ScreenAlignmentPattern();
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DECALN);
-                break;
-            default:
-                // If no functions to call, overall dispatch was a failure.
-                success = false;
-                break;
-            }
-        }
+        success = _pfnFlushToTerminal();
     }
 
+    _ClearLastChar();
+
+    return success;
+}
+
+// Routine Description:
+// - Triggers the Clear action to indicate that the state machine should erase
+//      all internal state.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+bool OutputStateMachineEngine::ActionClear() noexcept
+{
+    // do nothing.
+    return true;
+}
+
+// Routine Description:
+// - Triggers the Ignore action to indicate that the state machine should eat
+//      this character and say nothing.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+bool OutputStateMachineEngine::ActionIgnore() noexcept
+{
+    // do nothing.
+    return true;
+}
+
+// Routine Description:
+// - Triggers the OscDispatch action to indicate that the listener should handle a control sequence.
+//   These sequences perform various API-type commands that can include many parameters.
+// Arguments:
+// - wch - Character to dispatch. This will be a BEL or ST char.
+// - parameter - identifier of the OSC action to perform
+// - string - OSC string we've collected. NOT null terminated.
+// Return Value:
+// - true if we handled the dispatch.
+bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
+                                                 const size_t parameter,
+                                                 const std::wstring_view string)
+{
+    const auto handler = _GetOscHandler(parameter);
+    bool success = handler != nullptr && (this->*handler)(string);
+
     // If we were unable to process the string, and there's a TTY attached to us,
     //      trigger the state machine to flush the string to the terminal.
     if (_pfnFlushToTerminal != nullptr && !success)
@@ -287,548 +281,817 @@ bool OutputStateMachineEngine::ActionEscDispatch(const wchar_t wch,
 }
 
 // Routine Description:
-// - Triggers the CsiDispatch action to indicate that the listener should handle
+// - Triggers the Ss3Dispatch action to indicate that the listener should handle
 //      a control sequence. These sequences perform various API-type commands
 //      that can include many parameters.
 // Arguments:
 // - wch - Character to dispatch.
-// - intermediates - Intermediate characters in the sequence
 // - parameters - set of numeric parameters collected while parsing the sequence.
 // Return Value:
 // - true iff we successfully dispatched the sequence.
-bool OutputStateMachineEngine::ActionCsiDispatch(const wchar_t wch,
-                                                 const std::basic_string_view<wchar_t> intermediates,
-                                                 std::basic_string_view<size_t> parameters)
+bool OutputStateMachineEngine::ActionSs3Dispatch(const wchar_t /*wch*/,
+                                                 const std::basic_string_view<size_t> /*parameters*/) noexcept
+{
+    // The output engine doesn't handle any SS3 sequences.
+    _ClearLastChar();
+    return false;
+}
+
+// Routine Description:
+// - Triggers the DcsHook action to indicate that the listener should handle a
+//      device control string. Its payload follows in ActionDcsPut.
+// Arguments:
+// - wch - Character to dispatch.
+// - intermediates - Intermediate characters in the sequence
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// Return Value:
+// - true iff we want the payload of the string.
+bool OutputStateMachineEngine::ActionDcsHook(const wchar_t /*wch*/,
+                                             const std::basic_string_view<wchar_t> /*intermediates*/,
+                                             const std::basic_string_view<size_t> /*parameters*/)
 {
+    // The output engine doesn't handle any device control strings yet.
     bool success = false;
-    size_t distance = 0;
-    size_t line = 0;
-    size_t column = 0;
-    size_t topMargin = 0;
-    size_t bottomMargin = 0;
-    size_t numTabs = 0;
-    size_t clearType = 0;
-    unsigned int function = 0;
-    DispatchTypes::EraseType eraseType = DispatchTypes::EraseType::ToEnd;
-    std::vector<DispatchTypes::GraphicsOptions> graphicsOptions;
-    DispatchTypes::AnsiStatusType deviceStatusType = static_cast<DispatchTypes::AnsiStatusType>(0); // there is no default status type.
-    size_t repeatCount = 0;
-    // This is all the args after the first arg, and the count of args not including the first one.
-    const auto remainingParams = parameters.size() > 1 ? parameters.substr(1) : std::basic_string_view<size_t>{};
 
+    // If we were unable to process the string, and there's a TTY attached to us,
+    //      trigger the state machine to flush the start of the string to the
+    //      terminal. The payload then follows it there as it arrives.
+    if (_pfnFlushToTerminal != nullptr && !success)
+    {
+        success = _pfnFlushToTerminal();
+        _dcsPassingThrough = success;
+    }
+
+    _ClearLastChar();
+
+    return success;
+}
+
+// Routine Description:
+// - Receives a piece of the payload of the device control string we hooked.
+// Arguments:
+// - string - The piece of the payload.
+// Return Value:
+// - true iff we successfully handled the payload.
+bool OutputStateMachineEngine::ActionDcsPut(const std::wstring_view string)
+{
+    return _dcsPassingThrough && ActionPassThroughString(string);
+}
+
+// Routine Description:
+// - Ends the device control string we hooked.
+// Arguments:
+// - aborted - True if the string was cut short instead of being terminated.
+// Return Value:
+// - true iff we successfully handled the end of the string.
+bool OutputStateMachineEngine::ActionDcsUnhook(const bool aborted)
+{
+    bool success = false;
+    if (_dcsPassingThrough)
+    {
+        // End the string on the terminal the same way it ended here. A CAN
+        //      aborts it there too.
+        _dcsPassingThrough = false;
+        success = ActionPassThroughString(aborted ? L"\x18" : L"\x1b\\");
+    }
+    return success;
+}
+
+// Routine Description:
+// - Handles an escape sequence that has no parameters, by calling the dispatch.
+// Arguments:
+// - wch - The final character of the sequence.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<auto Dispatch, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_EscDispatch(const wchar_t /*wch*/)
+{
+    const bool success = (_dispatch.get()->*Dispatch)();
+    TermTelemetry::Instance().Log(Code);
+    return success;
+}
+
+// Routine Description:
+// - Handles an escape sequence that's one of the values of a dispatch
+//   function's argument, such as DECKPAM and DECKPNM.
+// Arguments:
+// - wch - The final character of the sequence.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<auto Dispatch, auto Argument, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_EscDispatchWith(const wchar_t /*wch*/)
+{
+    const bool success = (_dispatch.get()->*Dispatch)(Argument);
+    TermTelemetry::Instance().Log(Code);
+    return success;
+}
+
+// Routine Description:
+// - Handles SCS, which designates the charset of its final character. Only
+//   G0 is supported.
+// Arguments:
+// - wch - The final character of the sequence.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<OutputStateMachineEngine::DesignateCharsetTypes Type, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_EscDesignateCharset(const wchar_t wch)
+{
+    bool success = false;
+    if constexpr (Type == DesignateCharsetTypes::G0)
+    {
+        success = _dispatch->DesignateCharset(wch);
+    }
+    TermTelemetry::Instance().Log(Code);
+    return success;
+}
+
+// Routine Description:
+// - Handles a control sequence that takes a single count, such as a distance
+//   or a number of tabs.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<auto Parse, auto Dispatch, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_CsiDispatchCount(const std::basic_string_view<size_t> parameters,
+                                                 const VTSubParameters /*subParameters*/)
+{
+    size_t count = 0;
+    bool success = (this->*Parse)(parameters, count);
+    if (success)
+    {
+        success = (_dispatch.get()->*Dispatch)(count);
+        TermTelemetry::Instance().Log(Code);
+    }
+    return success;
+}
+
+// Routine Description:
+// - Handles a control sequence that has no parameters of its own. If there's
+//   a function to verify the parameters, it has to accept them first.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<auto Verify, auto Dispatch, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_CsiDispatch(const std::basic_string_view<size_t> parameters,
+                                            const VTSubParameters /*subParameters*/)
+{
+    bool success = true;
+    if constexpr (Verify != nullptr)
+    {
+        success = (this->*Verify)(parameters);
+    }
+    if (success)
+    {
+        success = (_dispatch.get()->*Dispatch)();
+        TermTelemetry::Instance().Log(Code);
+    }
+    return success;
+}
+
+// Routine Description:
+// - Handles ED and EL.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<auto Dispatch, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_CsiDispatchEraseType(const std::basic_string_view<size_t> parameters,
+                                                     const VTSubParameters /*subParameters*/)
+{
+    DispatchTypes::EraseType eraseType = DefaultEraseType;
+    bool success = _GetEraseOperation(parameters, eraseType);
+    if (success)
+    {
+        success = (_dispatch.get()->*Dispatch)(eraseType);
+        TermTelemetry::Instance().Log(Code);
+    }
+    return success;
+}
+
+// Routine Description:
+// - Handles DECSET and DECRST.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<auto Dispatch, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_CsiDispatchPrivateModes(const std::basic_string_view<size_t> parameters,
+                                                        const VTSubParameters /*subParameters*/)
+{
+    PrivateModeList privateModeParams;
+    bool success = _GetPrivateModeParams(parameters, privateModeParams);
+    if (success)
+    {
+        success = (_dispatch.get()->*Dispatch)({ privateModeParams.data(), privateModeParams.size() });
+        //TODO: MSFT:6367459 Add specific logging for each of the DECSET/DECRST codes
+        TermTelemetry::Instance().Log(Code);
+    }
+    return success;
+}
+
+// Routine Description:
+// - Handles DECERA and DECSERA, which take nothing but the area.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<auto Dispatch, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_CsiDispatchRectangularArea(const std::basic_string_view<size_t> parameters,
+                                                           const VTSubParameters /*subParameters*/)
+{
+    DispatchTypes::RectangularArea area{};
+    bool success = parameters.size() <= 4 && _GetRectangularArea(parameters, area);
+    if (success)
+    {
+        success = (_dispatch.get()->*Dispatch)(area);
+        TermTelemetry::Instance().Log(Code);
+    }
+    return success;
+}
+
+// Routine Description:
+// - Handles OSC 10, 11 and 12, which set one of the colors.
+// Arguments:
+// - string - OSC string we've collected. NOT null terminated.
+// Return Value:
+// - True if handled successfully. False otherwise.
+template<auto Dispatch, TermTelemetry::Codes Code>
+bool OutputStateMachineEngine::_OscSetColor(const std::wstring_view string)
+{
+    DWORD color = 0;
+    bool success = _GetOscSetColor(string, color);
+    if (success)
+    {
+        success = (_dispatch.get()->*Dispatch)(color);
+        TermTelemetry::Instance().Log(Code);
+    }
+    return success;
+}
+
+// Routine Description:
+// - Generates the table of the escape sequences we handle.
+// Return Value:
+// - The handler for each final character after each intermediate. Those of
+//   sequences we don't handle are empty.
+constexpr OutputStateMachineEngine::EscDispatchTable OutputStateMachineEngine::_BuildEscDispatchTable() noexcept
+{
+    using Engine = OutputStateMachineEngine;
+    using Codes = TermTelemetry::Codes;
+
+    struct Sequence
+    {
+        EscPlane plane;
+        wchar_t final;
+        EscHandler handler;
+    };
+
+    constexpr Sequence sequences[] = {
+        { EscPlane::None, VTActionCodes::DECSC_CursorSave, &Engine::_EscDispatch<&ITermDispatch::CursorSaveState, Codes::DECSC> },
+        { EscPlane::None, VTActionCodes::DECRC_CursorRestore, &Engine::_EscDispatch<&ITermDispatch::CursorRestoreState, Codes::DECRC> },
+        { EscPlane::None, VTActionCodes::DECKPAM_KeypadApplicationMode, &Engine::_EscDispatchWith<&ITermDispatch::SetKeypadMode, true, Codes::DECKPAM> },
+        { EscPlane::None, VTActionCodes::DECKPNM_KeypadNumericMode, &Engine::_EscDispatchWith<&ITermDispatch::SetKeypadMode, false, Codes::DECKPNM> },
+        { EscPlane::None, VTActionCodes::NEL_NextLine, &Engine::_EscDispatchWith<&ITermDispatch::LineFeed, DispatchTypes::LineFeedType::WithReturn, Codes::NEL> },
+        { EscPlane::None, VTActionCodes::IND_Index, &Engine::_EscDispatchWith<&ITermDispatch::LineFeed, DispatchTypes::LineFeedType::WithoutReturn, Codes::IND> },
+        { EscPlane::None, VTActionCodes::RI_ReverseLineFeed, &Engine::_EscDispatch<&ITermDispatch::ReverseLineFeed, Codes::RI> },
+        { EscPlane::None, VTActionCodes::HTS_HorizontalTabSet, &Engine::_EscDispatch<&ITermDispatch::HorizontalTabSet, Codes::HTS> },
+        { EscPlane::None, VTActionCodes::RIS_ResetToInitialState, &Engine::_EscDispatch<&ITermDispatch::HardReset, Codes::RIS> },
+        { EscPlane::Hash, VTActionCodes::DECALN_ScreenAlignmentPattern, &Engine::_EscDispatch<&ITermDispatch::ScreenAlignmentPattern, Codes::DECALN> },
+    };
+
+    EscDispatchTable table{};
+    for (const auto& sequence : sequences)
+    {
+        til::at(table, static_cast<size_t>(sequence.plane) * EscFinalCount + sequence.final - EscFinalFirst) = sequence.handler;
+    }
+
+    // The final character of a charset designation is the charset, so every
+    //      one of them goes to the same handler.
+    for (size_t final = 0; final < EscFinalCount; ++final)
+    {
+        til::at(table, static_cast<size_t>(EscPlane::G0) * EscFinalCount + final) = &Engine::_EscDesignateCharset<DesignateCharsetTypes::G0, Codes::DesignateG0>;
+        til::at(table, static_cast<size_t>(EscPlane::G1) * EscFinalCount + final) = &Engine::_EscDesignateCharset<DesignateCharsetTypes::G1, Codes::DesignateG1>;
+        til::at(table, static_cast<size_t>(EscPlane::G2) * EscFinalCount + final) = &Engine::_EscDesignateCharset<DesignateCharsetTypes::G2, Codes::DesignateG2>;
+        til::at(table, static_cast<size_t>(EscPlane::G3) * EscFinalCount + final) = &Engine::_EscDesignateCharset<DesignateCharsetTypes::G3, Codes::DesignateG3>;
+    }
+
+    return table;
+}
+
+// Routine Description:
+// - Generates the table of the control sequences we handle.
+// Return Value:
+// - The handler for each final character after each intermediate. Those of
+//   sequences we don't handle are empty.
+constexpr OutputStateMachineEngine::CsiDispatchTable OutputStateMachineEngine::_BuildCsiDispatchTable() noexcept
+{
+    using Engine = OutputStateMachineEngine;
+    using Codes = TermTelemetry::Codes;
+
+    struct Sequence
+    {
+        CsiPlane plane;
+        wchar_t final;
+        CsiHandler handler;
+    };
+
+    constexpr Sequence sequences[] = {
+        { CsiPlane::None, VTActionCodes::CUU_CursorUp, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::CursorUp, Codes::CUU> },
+        { CsiPlane::None, VTActionCodes::CUD_CursorDown, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::CursorDown, Codes::CUD> },
+        { CsiPlane::None, VTActionCodes::CUF_CursorForward, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::CursorForward, Codes::CUF> },
+        { CsiPlane::None, VTActionCodes::CUB_CursorBackward, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::CursorBackward, Codes::CUB> },
+        { CsiPlane::None, VTActionCodes::CNL_CursorNextLine, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::CursorNextLine, Codes::CNL> },
+        { CsiPlane::None, VTActionCodes::CPL_CursorPrevLine, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::CursorPrevLine, Codes::CPL> },
+        { CsiPlane::None, VTActionCodes::CHA_CursorHorizontalAbsolute, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::CursorHorizontalPositionAbsolute, Codes::CHA> },
+        { CsiPlane::None, VTActionCodes::HPA_HorizontalPositionAbsolute, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::CursorHorizontalPositionAbsolute, Codes::CHA> },
+        { CsiPlane::None, VTActionCodes::VPA_VerticalLinePositionAbsolute, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::VerticalLinePositionAbsolute, Codes::VPA> },
+        { CsiPlane::None, VTActionCodes::HPR_HorizontalPositionRelative, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::HorizontalPositionRelative, Codes::HPR> },
+        { CsiPlane::None, VTActionCodes::VPR_VerticalPositionRelative, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::VerticalPositionRelative, Codes::VPR> },
+        { CsiPlane::None, VTActionCodes::ICH_InsertCharacter, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::InsertCharacter, Codes::ICH> },
+        { CsiPlane::None, VTActionCodes::DCH_DeleteCharacter, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::DeleteCharacter, Codes::DCH> },
+        { CsiPlane::None, VTActionCodes::ECH_EraseCharacters, &Engine::_CsiDispatchCount<&Engine::_GetCursorDistance, &ITermDispatch::EraseCharacters, Codes::ECH> },
+        { CsiPlane::None, VTActionCodes::CUP_CursorPosition, &Engine::_CsiCursorPosition },
+        { CsiPlane::None, VTActionCodes::HVP_HorizontalVerticalPosition, &Engine::_CsiCursorPosition },
+        { CsiPlane::None, VTActionCodes::DECSTBM_SetScrollingRegion, &Engine::_CsiSetScrollingRegion },
+        { CsiPlane::None, VTActionCodes::ED_EraseDisplay, &Engine::_CsiDispatchEraseType<&ITermDispatch::EraseInDisplay, Codes::ED> },
+        { CsiPlane::None, VTActionCodes::EL_EraseLine, &Engine::_CsiDispatchEraseType<&ITermDispatch::EraseInLine, Codes::EL> },
+        { CsiPlane::None, VTActionCodes::SGR_SetGraphicsRendition, &Engine::_CsiSetGraphicsRendition },
+        { CsiPlane::None, VTActionCodes::DSR_DeviceStatusReport, &Engine::_CsiDeviceStatusReport },
+        { CsiPlane::None, VTActionCodes::DA_DeviceAttributes, &Engine::_CsiDispatch<&Engine::_VerifyDeviceAttributesParams, &ITermDispatch::DeviceAttributes, Codes::DA> },
+        { CsiPlane::None, VTActionCodes::SU_ScrollUp, &Engine::_CsiDispatchCount<&Engine::_GetScrollDistance, &ITermDispatch::ScrollUp, Codes::SU> },
+        { CsiPlane::None, VTActionCodes::SD_ScrollDown, &Engine::_CsiDispatchCount<&Engine::_GetScrollDistance, &ITermDispatch::ScrollDown, Codes::SD> },
+        { CsiPlane::None, VTActionCodes::ANSISYSSC_CursorSave, &Engine::_CsiDispatch<&Engine::_VerifyHasNoParameters, &ITermDispatch::CursorSaveState, Codes::ANSISYSSC> },
+        { CsiPlane::None, VTActionCodes::ANSISYSRC_CursorRestore, &Engine::_CsiDispatch<&Engine::_VerifyHasNoParameters, &ITermDispatch::CursorRestoreState, Codes::ANSISYSRC> },
+        { CsiPlane::None, VTActionCodes::IL_InsertLine, &Engine::_CsiDispatchCount<&Engine::_GetScrollDistance, &ITermDispatch::InsertLine, Codes::IL> },
+        { CsiPlane::None, VTActionCodes::DL_DeleteLine, &Engine::_CsiDispatchCount<&Engine::_GetScrollDistance, &ITermDispatch::DeleteLine, Codes::DL> },
+        { CsiPlane::None, VTActionCodes::CHT_CursorForwardTab, &Engine::_CsiDispatchCount<&Engine::_GetTabDistance, &ITermDispatch::ForwardTab, Codes::CHT> },
+        { CsiPlane::None, VTActionCodes::CBT_CursorBackTab, &Engine::_CsiDispatchCount<&Engine::_GetTabDistance, &ITermDispatch::BackwardsTab, Codes::CBT> },
+        { CsiPlane::None, VTActionCodes::TBC_TabClear, &Engine::_CsiDispatchCount<&Engine::_GetTabClearType, &ITermDispatch::TabClear, Codes::TBC> },
+        { CsiPlane::None, VTActionCodes::DTTERM_WindowManipulation, &Engine::_CsiWindowManipulation },
+        { CsiPlane::None, VTActionCodes::REP_RepeatCharacter, &Engine::_CsiRepeatCharacter },
+        { CsiPlane::Question, VTActionCodes::DECSET_PrivateModeSet, &Engine::_CsiDispatchPrivateModes<&ITermDispatch::SetPrivateModes, Codes::DECSET> },
+        { CsiPlane::Question, VTActionCodes::DECRST_PrivateModeReset, &Engine::_CsiDispatchPrivateModes<&ITermDispatch::ResetPrivateModes, Codes::DECRST> },
+        { CsiPlane::Exclamation, VTActionCodes::DECSTR_SoftReset, &Engine::_CsiDispatch<nullptr, &ITermDispatch::SoftReset, Codes::DECSTR> },
+        { CsiPlane::Space, VTActionCodes::DECSCUSR_SetCursorStyle, &Engine::_CsiSetCursorStyle },
+        { CsiPlane::Dollar, VTActionCodes::DECCRA_CopyRectangularArea, &Engine::_CsiCopyRectangularArea },
+        { CsiPlane::Dollar, VTActionCodes::DECFRA_FillRectangularArea, &Engine::_CsiFillRectangularArea },
+        { CsiPlane::Dollar, VTActionCodes::DECERA_EraseRectangularArea, &Engine::_CsiDispatchRectangularArea<&ITermDispatch::EraseRectangularArea, Codes::DECERA> },
+        { CsiPlane::Dollar, VTActionCodes::DECSERA_SelectiveEraseRectangularArea, &Engine::_CsiDispatchRectangularArea<&ITermDispatch::SelectiveEraseRectangularArea, Codes::DECSERA> },
+    };
+
+    CsiDispatchTable table{};
+    for (const auto& sequence : sequences)
+    {
+        til::at(table, static_cast<size_t>(sequence.plane) * CsiFinalCount + sequence.final - CsiFinalFirst) = sequence.handler;
+    }
+
+    return table;
+}
+
+// Routine Description:
+// - Generates the table of the operating system commands we handle.
+// Return Value:
+// - The handler for each OSC number. Those of commands we don't handle are empty.
+constexpr OutputStateMachineEngine::OscDispatchTable OutputStateMachineEngine::_BuildOscDispatchTable() noexcept
+{
+    using Engine = OutputStateMachineEngine;
+    using Codes = TermTelemetry::Codes;
+
+    OscDispatchTable table{};
+    til::at(table, OscActionCodes::SetIconAndWindowTitle) = &Engine::_OscSetWindowTitle;
+    til::at(table, OscActionCodes::SetWindowIcon) = &Engine::_OscSetWindowTitle;
+    til::at(table, OscActionCodes::SetWindowTitle) = &Engine::_OscSetWindowTitle;
+    til::at(table, OscActionCodes::SetColor) = &Engine::_OscSetColorTableEntry;
+    til::at(table, OscActionCodes::SetForegroundColor) = &Engine::_OscSetColor<&ITermDispatch::SetDefaultForeground, Codes::OSCFG>;
+    til::at(table, OscActionCodes::SetBackgroundColor) = &Engine::_OscSetColor<&ITermDispatch::SetDefaultBackground, Codes::OSCBG>;
+    til::at(table, OscActionCodes::SetCursorColor) = &Engine::_OscSetColor<&ITermDispatch::SetCursorColor, Codes::OSCSCC>;
+    til::at(table, OscActionCodes::ResetCursorColor) = &Engine::_OscResetCursorColor;
+    return table;
+}
+
+const OutputStateMachineEngine::EscDispatchTable OutputStateMachineEngine::s_escDispatchTable = OutputStateMachineEngine::_BuildEscDispatchTable();
+const OutputStateMachineEngine::CsiDispatchTable OutputStateMachineEngine::s_csiDispatchTable = OutputStateMachineEngine::_BuildCsiDispatchTable();
+const OutputStateMachineEngine::OscDispatchTable OutputStateMachineEngine::s_oscDispatchTable = OutputStateMachineEngine::_BuildOscDispatchTable();
+
+// Routine Description:
+// - Looks up the handler of an escape sequence.
+// Arguments:
+// - wch - The final character of the sequence.
+// - intermediates - Intermediate characters in the sequence
+// Return Value:
+// - The handler, or nullptr if we don't handle the sequence.
+OutputStateMachineEngine::EscHandler OutputStateMachineEngine::_GetEscHandler(const wchar_t wch,
+                                                                              const std::basic_string_view<wchar_t> intermediates) noexcept
+{
+    auto plane = EscPlane::Count;
     if (intermediates.empty())
     {
-        // fill params
-        switch (wch)
+        plane = EscPlane::None;
+    }
+    else if (intermediates.size() == 1)
+    {
+        switch (til::at(intermediates, 0))
         {
-        case VTActionCodes::CUU_CursorUp:
-        case VTActionCodes::CUD_CursorDown:
-        case VTActionCodes::CUF_CursorForward:
-        case VTActionCodes::CUB_CursorBackward:
-        case VTActionCodes::CNL_CursorNextLine:
-        case VTActionCodes::CPL_CursorPrevLine:
-        case VTActionCodes::CHA_CursorHorizontalAbsolute:
-        case VTActionCodes::HPA_HorizontalPositionAbsolute:
-        case VTActionCodes::VPA_VerticalLinePositionAbsolute:
-        case VTActionCodes::HPR_HorizontalPositionRelative:
-        case VTActionCodes::VPR_VerticalPositionRelative:
-        case VTActionCodes::ICH_InsertCharacter:
-        case VTActionCodes::DCH_DeleteCharacter:
-        case VTActionCodes::ECH_EraseCharacters:
-            success = _GetCursorDistance(parameters, distance);
-            break;
-        case VTActionCodes::HVP_HorizontalVerticalPosition:
-        case VTActionCodes::CUP_CursorPosition:
-            success = _GetXYPosition(parameters, line, column);
-            break;
-        case VTActionCodes::DECSTBM_SetScrollingRegion:
-            success = _GetTopBottomMargins(parameters, topMargin, bottomMargin);
-            break;
-        case VTActionCodes::ED_EraseDisplay:
-        case VTActionCodes::EL_EraseLine:
-            success = _GetEraseOperation(parameters, eraseType);
+        case L'#':
+            plane = EscPlane::Hash;
             break;
-        case VTActionCodes::SGR_SetGraphicsRendition:
-            success = _GetGraphicsOptions(parameters, graphicsOptions);
+        case L'(':
+            plane = EscPlane::G0;
             break;
-        case VTActionCodes::DSR_DeviceStatusReport:
-            success = _GetDeviceStatusOperation(parameters, deviceStatusType);
+        case L')':
+        case L'-':
+            plane = EscPlane::G1;
             break;
-        case VTActionCodes::DA_DeviceAttributes:
-            success = _VerifyDeviceAttributesParams(parameters);
+        case L'*':
+        case L'.':
+            plane = EscPlane::G2;
             break;
-        case VTActionCodes::SU_ScrollUp:
-        case VTActionCodes::SD_ScrollDown:
-            success = _GetScrollDistance(parameters, distance);
-            break;
-        case VTActionCodes::ANSISYSSC_CursorSave:
-        case VTActionCodes::ANSISYSRC_CursorRestore:
-            success = _VerifyHasNoParameters(parameters);
-            break;
-        case VTActionCodes::IL_InsertLine:
-        case VTActionCodes::DL_DeleteLine:
-            success = _GetScrollDistance(parameters, distance);
-            break;
-        case VTActionCodes::CHT_CursorForwardTab:
-        case VTActionCodes::CBT_CursorBackTab:
-            success = _GetTabDistance(parameters, numTabs);
-            break;
-        case VTActionCodes::TBC_TabClear:
-            success = _GetTabClearType(parameters, clearType);
-            break;
-        case VTActionCodes::DTTERM_WindowManipulation:
-            success = _GetWindowManipulationType(parameters, function);
-            break;
-        case VTActionCodes::REP_RepeatCharacter:
-            success = _GetRepeatCount(parameters, repeatCount);
-            break;
-        default:
-            // If no params to fill, param filling was successful.
-            success = true;
+        case L'+':
+        case L'/':
+            plane = EscPlane::G3;
             break;
         }
+    }
 
-        // if param filling successful, try to dispatch
-        if (success)
-        {
-            switch (wch)
-            {
-            case VTActionCodes::CUU_CursorUp:
-                success = _dispatch->CursorUp(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUU);
-                break;
-            case VTActionCodes::CUD_CursorDown:
-                success = _dispatch->CursorDown(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUD);
-                break;
-            case VTActionCodes::CUF_CursorForward:
-                success = _dispatch->CursorForward(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUF);
-                break;
-            case VTActionCodes::CUB_CursorBackward:
-                success = _dispatch->CursorBackward(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUB);
-                break;
-            case VTActionCodes::CNL_CursorNextLine:
-                success = _dispatch->CursorNextLine(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CNL);
-                break;
-            case VTActionCodes::CPL_CursorPrevLine:
-                success = _dispatch->CursorPrevLine(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CPL);
-                break;
-            case VTActionCodes::CHA_CursorHorizontalAbsolute:
-            case VTActionCodes::HPA_HorizontalPositionAbsolute:
-                success = _dispatch->CursorHorizontalPositionAbsolute(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CHA);
-                break;
-            case VTActionCodes::VPA_VerticalLinePositionAbsolute:
-                success = _dispatch->VerticalLinePositionAbsolute(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::VPA);
-                break;
-            case VTActionCodes::HPR_HorizontalPositionRelative:
-                success = _dispatch->HorizontalPositionRelative(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::HPR);
-                break;
-            case VTActionCodes::VPR_VerticalPositionRelative:
-                success = _dispatch->VerticalPositionRelative(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::VPR);
-                break;
-            case VTActionCodes::CUP_CursorPosition:
-            case VTActionCodes::HVP_HorizontalVerticalPosition:
-                success = _dispatch->CursorPosition(line, column);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CUP);
-                break;
-            case VTActionCodes::DECSTBM_SetScrollingRegion:
-                success = _dispatch->SetTopBottomScrollingMargins(topMargin, bottomMargin);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSTBM);
-                break;
-            case VTActionCodes::ICH_InsertCharacter:
-                success = _dispatch->InsertCharacter(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ICH);
-                break;
-            case VTActionCodes::DCH_DeleteCharacter:
-                success = _dispatch->DeleteCharacter(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DCH);
-                break;
-            case VTActionCodes::ED_EraseDisplay:
-                success = _dispatch->EraseInDisplay(eraseType);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ED);
-                break;
-            case VTActionCodes::EL_EraseLine:
-                success = _dispatch->EraseInLine(eraseType);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::EL);
-                break;
-            case VTActionCodes::SGR_SetGraphicsRendition:
-                success = _dispatch->SetGraphicsRendition({ graphicsOptions.data(), graphicsOptions.size() });
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::SGR);
-                break;
-            case VTActionCodes::DSR_DeviceStatusReport:
-                success = _dispatch->DeviceStatusReport(deviceStatusType);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DSR);
-                break;
-            case VTActionCodes::DA_DeviceAttributes:
-                success = _dispatch->DeviceAttributes();
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DA);
-                break;
-            case VTActionCodes::SU_ScrollUp:
-                success = _dispatch->ScrollUp(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::SU);
-                break;
-            case VTActionCodes::SD_ScrollDown:
-                success = _dispatch->ScrollDown(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::SD);
-                break;
-            case VTActionCodes::ANSISYSSC_CursorSave:
-                success = _dispatch->CursorSaveState();
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ANSISYSSC);
-                break;
-            case VTActionCodes::ANSISYSRC_CursorRestore:
-                success = _dispatch->CursorRestoreState();
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ANSISYSRC);
-                break;
-            case VTActionCodes::IL_InsertLine:
-                success = _dispatch->InsertLine(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::IL);
-                break;
-            case VTActionCodes::DL_DeleteLine:
-                success = _dispatch->DeleteLine(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DL);
-                break;
-            case VTActionCodes::CHT_CursorForwardTab:
-                success = _dispatch->ForwardTab(numTabs);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CHT);
-                break;
-            case VTActionCodes::CBT_CursorBackTab:
-                success = _dispatch->BackwardsTab(numTabs);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::CBT);
-                break;
-            case VTActionCodes::TBC_TabClear:
-                success = _dispatch->TabClear(clearType);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::TBC);
-                break;
-            case VTActionCodes::ECH_EraseCharacters:
-                success = _dispatch->EraseCharacters(distance);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::ECH);
-                break;
-            case VTActionCodes::DTTERM_WindowManipulation:
-                success = _dispatch->WindowManipulation(static_cast<DispatchTypes::WindowManipulationType>(function),
-                                                        remainingParams);
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::DTTERM_WM);
-                break;
-            case VTActionCodes::REP_RepeatCharacter:
-                // Handled w/o the dispatch. This function is unique in that way
-                // If this were in the ITerminalDispatch, then each
-                // implementation would effectively be the same, calling only
-                // functions that are already part of the interface.
-                // Print the last graphical character a number of times.
-                if (_lastPrintedChar != AsciiChars::NUL)
-                {
-                    std::wstring wstr(repeatCount, _lastPrintedChar);
-                    _dispatch->PrintString(wstr);
-                }
-                success = true;
-                TermTelemetry::Instance().Log(TermTelemetry::Codes::REP);
-                break;
-            default:
-                // If no functions to call, overall dispatch was a failure.
-                success = false;
-                break;
-            }
-        }
+    if (plane == EscPlane::Count)
+    {
+        return nullptr;
+    }
+
+    const size_t final = wch >= EscFinalFirst && wch <= EscFinalLast ? wch - EscFinalFirst : EscFinalCount - 1;
+    return til::at(s_escDispatchTable, static_cast<size_t>(plane) * EscFinalCount + final);
+}
+
+// Routine Description:
+// - Looks up the handler of a control sequence.
+// Arguments:
+// - wch - The final character of the sequence.
+// - intermediates - Intermediate characters in the sequence
+// Return Value:
+// - The handler, or nullptr if we don't handle the sequence.
+OutputStateMachineEngine::CsiHandler OutputStateMachineEngine::_GetCsiHandler(const wchar_t wch,
+                                                                              const std::basic_string_view<wchar_t> intermediates) noexcept
+{
+    auto plane = CsiPlane::Count;
+    if (intermediates.empty())
+    {
+        plane = CsiPlane::None;
     }
     else if (intermediates.size() == 1)
     {
-        const auto value = til::at(intermediates, 0);
-        switch (value)
+        switch (til::at(intermediates, 0))
         {
         case L'?':
-            success = _IntermediateQuestionMarkDispatch(wch, parameters);
+            plane = CsiPlane::Question;
             break;
         case L'!':
-            success = _IntermediateExclamationDispatch(wch);
+            plane = CsiPlane::Exclamation;
             break;
         case L' ':
-            success = _IntermediateSpaceDispatch(wch, parameters);
+            plane = CsiPlane::Space;
             break;
-        default:
-            // If no functions to call, overall dispatch was a failure.
-            success = false;
+        case L'$':
+            plane = CsiPlane::Dollar;
             break;
         }
     }
-    // If we were unable to process the string, and there's a TTY attached to us,
-    //      trigger the state machine to flush the string to the terminal.
-    if (_pfnFlushToTerminal != nullptr && !success)
+
+    if (plane == CsiPlane::Count || wch < CsiFinalFirst || wch > CsiFinalLast)
+    {
+        return nullptr;
+    }
+
+    return til::at(s_csiDispatchTable, static_cast<size_t>(plane) * CsiFinalCount + wch - CsiFinalFirst);
+}
+
+// Routine Description:
+// - Looks up the handler of an operating system command.
+// Arguments:
+// - parameter - identifier of the OSC action to perform
+// Return Value:
+// - The handler, or nullptr if we don't handle the command.
+OutputStateMachineEngine::OscHandler OutputStateMachineEngine::_GetOscHandler(const size_t parameter) noexcept
+{
+    return parameter < s_oscDispatchTable.size() ? til::at(s_oscDispatchTable, parameter) : nullptr;
+}
+
+// Routine Description:
+// - Handles CUP and HVP.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiCursorPosition(const std::basic_string_view<size_t> parameters,
+                                                  const VTSubParameters /*subParameters*/)
+{
+    size_t line = 0;
+    size_t column = 0;
+    bool success = _GetXYPosition(parameters, line, column);
+    if (success)
     {
-        success = _pfnFlushToTerminal();
+        success = _dispatch->CursorPosition(line, column);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::CUP);
     }
-
-    _ClearLastChar();
-
     return success;
 }
 
 // Routine Description:
-// - Handles actions that have postfix params on an intermediate '?', such as DECTCEM, DECCOLM, ATT610
+// - Handles DECSTBM.
 // Arguments:
-// - wch - Character to dispatch.
 // - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
 // Return Value:
 // - True if handled successfully. False otherwise.
-bool OutputStateMachineEngine::_IntermediateQuestionMarkDispatch(const wchar_t wchAction,
-                                                                 const std::basic_string_view<size_t> parameters)
+bool OutputStateMachineEngine::_CsiSetScrollingRegion(const std::basic_string_view<size_t> parameters,
+                                                      const VTSubParameters /*subParameters*/)
 {
-    bool success = false;
-
-    std::vector<DispatchTypes::PrivateModeParams> privateModeParams;
-    // Ensure that there was the right number of params
-    switch (wchAction)
+    size_t topMargin = 0;
+    size_t bottomMargin = 0;
+    bool success = _GetTopBottomMargins(parameters, topMargin, bottomMargin);
+    if (success)
     {
-    case VTActionCodes::DECSET_PrivateModeSet:
-    case VTActionCodes::DECRST_PrivateModeReset:
-        success = _GetPrivateModeParams(parameters, privateModeParams);
-        break;
-
-    default:
-        // If no params to fill, param filling was successful.
-        success = true;
-        break;
+        success = _dispatch->SetTopBottomScrollingMargins(topMargin, bottomMargin);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSTBM);
     }
+    return success;
+}
+
+// Routine Description:
+// - Handles SGR, the only sequence that takes sub-parameters.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiSetGraphicsRendition(const std::basic_string_view<size_t> parameters,
+                                                        const VTSubParameters subParameters)
+{
+    GraphicsOptionList graphicsOptions;
+    bool success = _GetGraphicsOptions(parameters, subParameters, graphicsOptions);
     if (success)
     {
-        switch (wchAction)
-        {
-        case VTActionCodes::DECSET_PrivateModeSet:
-            success = _dispatch->SetPrivateModes({ privateModeParams.data(), privateModeParams.size() });
-            //TODO: MSFT:6367459 Add specific logging for each of the DECSET/DECRST codes
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSET);
-            break;
-        case VTActionCodes::DECRST_PrivateModeReset:
-            success = _dispatch->ResetPrivateModes({ privateModeParams.data(), privateModeParams.size() });
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECRST);
-            break;
-        default:
-            // If no functions to call, overall dispatch was a failure.
-            success = false;
-            break;
-        }
+        success = _dispatch->SetGraphicsRendition({ graphicsOptions.data(), graphicsOptions.size() });
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::SGR);
     }
     return success;
 }
 
 // Routine Description:
-// - Handles actions that have an intermediate '!', such as DECSTR
+// - Handles DSR.
 // Arguments:
-// - wch - Character to dispatch.
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
 // Return Value:
 // - True if handled successfully. False otherwise.
-bool OutputStateMachineEngine::_IntermediateExclamationDispatch(const wchar_t wchAction)
+bool OutputStateMachineEngine::_CsiDeviceStatusReport(const std::basic_string_view<size_t> parameters,
+                                                      const VTSubParameters /*subParameters*/)
 {
-    bool success = false;
-
-    switch (wchAction)
+    DispatchTypes::AnsiStatusType deviceStatusType = static_cast<DispatchTypes::AnsiStatusType>(0); // there is no default status type.
+    bool success = _GetDeviceStatusOperation(parameters, deviceStatusType);
+    if (success)
     {
-    case VTActionCodes::DECSTR_SoftReset:
-        success = _dispatch->SoftReset();
-        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSTR);
-        break;
-    default:
-        // If no functions to call, overall dispatch was a failure.
-        success = false;
-        break;
+        success = _dispatch->DeviceStatusReport(deviceStatusType);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DSR);
     }
     return success;
 }
 
 // Routine Description:
-// - Handles actions that have an intermediate ' ' (0x20), such as DECSCUSR
+// - Handles the DTTERM window manipulation sequences.
 // Arguments:
-// - wch - Character to dispatch.
 // - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
 // Return Value:
 // - True if handled successfully. False otherwise.
-bool OutputStateMachineEngine::_IntermediateSpaceDispatch(const wchar_t wchAction,
-                                                          const std::basic_string_view<size_t> parameters)
+bool OutputStateMachineEngine::_CsiWindowManipulation(const std::basic_string_view<size_t> parameters,
+                                                      const VTSubParameters /*subParameters*/)
 {
-    bool success = false;
-    DispatchTypes::CursorStyle cursorStyle = DefaultCursorStyle;
-
-    // Parse params
-    switch (wchAction)
+    unsigned int function = 0;
+    bool success = _GetWindowManipulationType(parameters, function);
+    if (success)
     {
-    case VTActionCodes::DECSCUSR_SetCursorStyle:
-        success = _GetCursorStyle(parameters, cursorStyle);
-        break;
-    default:
-        // If no functions to call, overall dispatch was a failure.
-        success = false;
-        break;
+        // This is all the args after the first arg, and the count of args not including the first one.
+        const auto remainingParams = parameters.size() > 1 ? parameters.substr(1) : std::basic_string_view<size_t>{};
+        success = _dispatch->WindowManipulation(static_cast<DispatchTypes::WindowManipulationType>(function),
+                                                remainingParams);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DTTERM_WM);
     }
+    return success;
+}
 
-    // if param filling successful, try to dispatch
+// Routine Description:
+// - Handles REP, which prints the last graphical character a number of times.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiRepeatCharacter(const std::basic_string_view<size_t> parameters,
+                                                   const VTSubParameters /*subParameters*/)
+{
+    size_t repeatCount = 0;
+    bool success = _GetRepeatCount(parameters, repeatCount);
     if (success)
     {
-        switch (wchAction)
+        // Handled w/o the dispatch. This function is unique in that way
+        // If this were in the ITerminalDispatch, then each
+        // implementation would effectively be the same, calling only
+        // functions that are already part of the interface.
+        if (_lastPrintedChar != AsciiChars::NUL)
         {
-        case VTActionCodes::DECSCUSR_SetCursorStyle:
-            success = _dispatch->SetCursorStyle(cursorStyle);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSCUSR);
-            break;
-        default:
-            // If no functions to call, overall dispatch was a failure.
-            success = false;
-            break;
+            std::wstring wstr(repeatCount, _lastPrintedChar);
+            _dispatch->PrintString(wstr);
         }
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::REP);
     }
+    return success;
+}
 
+// Routine Description:
+// - Handles DECSCUSR.
+// Arguments:
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiSetCursorStyle(const std::basic_string_view<size_t> parameters,
+                                                  const VTSubParameters /*subParameters*/)
+{
+    DispatchTypes::CursorStyle cursorStyle = DefaultCursorStyle;
+    bool success = _GetCursorStyle(parameters, cursorStyle);
+    if (success)
+    {
+        success = _dispatch->SetCursorStyle(cursorStyle);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECSCUSR);
+    }
     return success;
 }
 
 // Routine Description:
-// - Triggers the Clear action to indicate that the state machine should erase
-//      all internal state.
+// - Handles DECCRA.
 // Arguments:
-// - <none>
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
 // Return Value:
-// - <none>
-bool OutputStateMachineEngine::ActionClear() noexcept
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiCopyRectangularArea(const std::basic_string_view<size_t> parameters,
+                                                       const VTSubParameters /*subParameters*/)
 {
-    // do nothing.
-    return true;
+    DispatchTypes::RectangularArea area{};
+    size_t targetTop = 0;
+    size_t targetLeft = 0;
+    bool success = _GetCopyRectangularAreaParams(parameters, area, targetTop, targetLeft);
+    if (success)
+    {
+        success = _dispatch->CopyRectangularArea(area, targetTop, targetLeft);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECCRA);
+    }
+    return success;
 }
 
 // Routine Description:
-// - Triggers the Ignore action to indicate that the state machine should eat
-//      this character and say nothing.
+// - Handles DECFRA.
 // Arguments:
-// - <none>
+// - parameters - set of numeric parameters collected while parsing the sequence.
+// - subParameters - the sub-parameters of each of the parameters.
 // Return Value:
-// - <none>
-bool OutputStateMachineEngine::ActionIgnore() noexcept
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_CsiFillRectangularArea(const std::basic_string_view<size_t> parameters,
+                                                       const VTSubParameters /*subParameters*/)
 {
-    // do nothing.
-    return true;
+    DispatchTypes::RectangularArea area{};
+    wchar_t fillChar = L' ';
+    bool success = _GetFillRectangularAreaParams(parameters, fillChar, area);
+    if (success)
+    {
+        success = _dispatch->FillRectangularArea(fillChar, area);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::DECFRA);
+    }
+    return success;
 }
 
 // Routine Description:
-// - Triggers the OscDispatch action to indicate that the listener should handle a control sequence.
-//   These sequences perform various API-type commands that can include many parameters.
+// - Handles OSC 0, 1 and 2, which all set the window title.
 // Arguments:
-// - wch - Character to dispatch. This will be a BEL or ST char.
-// - parameter - identifier of the OSC action to perform
 // - string - OSC string we've collected. NOT null terminated.
 // Return Value:
-// - true if we handled the dispatch.
-bool OutputStateMachineEngine::ActionOscDispatch(const wchar_t /*wch*/,
-                                                 const size_t parameter,
-                                                 const std::wstring_view string)
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_OscSetWindowTitle(const std::wstring_view string)
 {
-    bool success = false;
     std::wstring title;
-    size_t tableIndex = 0;
-    DWORD color = 0;
-
-    switch (parameter)
-    {
-    case OscActionCodes::SetIconAndWindowTitle:
-    case OscActionCodes::SetWindowIcon:
-    case OscActionCodes::SetWindowTitle:
-        success = _GetOscTitle(string, title);
-        break;
-    case OscActionCodes::SetColor:
-        success = _GetOscSetColorTable(string, tableIndex, color);
-        break;
-    case OscActionCodes::SetForegroundColor:
-    case OscActionCodes::SetBackgroundColor:
-    case OscActionCodes::SetCursorColor:
-        success = _GetOscSetColor(string, color);
-        break;
-    case OscActionCodes::ResetCursorColor:
-        // the console uses 0xffffffff as an "invalid color" value
-        color = 0xffffffff;
-        success = true;
-        break;
-    default:
-        // If no functions to call, overall dispatch was a failure.
-        success = false;
-        break;
-    }
+    bool success = _GetOscTitle(string, title);
     if (success)
     {
-        switch (parameter)
-        {
-        case OscActionCodes::SetIconAndWindowTitle:
-        case OscActionCodes::SetWindowIcon:
-        case OscActionCodes::SetWindowTitle:
-            success = _dispatch->SetWindowTitle(title);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCWT);
-            break;
-        case OscActionCodes::SetColor:
-            success = _dispatch->SetColorTableEntry(tableIndex, color);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCCT);
-            break;
-        case OscActionCodes::SetForegroundColor:
-            success = _dispatch->SetDefaultForeground(color);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCFG);
-            break;
-        case OscActionCodes::SetBackgroundColor:
-            success = _dispatch->SetDefaultBackground(color);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCBG);
-            break;
-        case OscActionCodes::SetCursorColor:
-            success = _dispatch->SetCursorColor(color);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCSCC);
-            break;
-        case OscActionCodes::ResetCursorColor:
-            success = _dispatch->SetCursorColor(color);
-            TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCRCC);
-            break;
-        default:
-            // If no functions to call, overall dispatch was a failure.
-            success = false;
-            break;
-        }
+        success = _dispatch->SetWindowTitle(title);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCWT);
     }
+    return success;
+}
 
-    // If we were unable to process the string, and there's a TTY attached to us,
-    //      trigger the state machine to flush the string to the terminal.
-    if (_pfnFlushToTerminal != nullptr && !success)
+// Routine Description:
+// - Handles OSC 4, which sets an entry of the color table.
+// Arguments:
+// - string - OSC string we've collected. NOT null terminated.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_OscSetColorTableEntry(const std::wstring_view string)
+{
+    size_t tableIndex = 0;
+    DWORD color = 0;
+    bool success = _GetOscSetColorTable(string, tableIndex, color);
+    if (success)
     {
-        success = _pfnFlushToTerminal();
+        success = _dispatch->SetColorTableEntry(tableIndex, color);
+        TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCCT);
     }
+    return success;
+}
 
-    _ClearLastChar();
-
+// Routine Description:
+// - Handles OSC 112, which resets the cursor color.
+// Arguments:
+// - string - OSC string we've collected. NOT null terminated.
+// Return Value:
+// - True if handled successfully. False otherwise.
+bool OutputStateMachineEngine::_OscResetCursorColor(const std::wstring_view /*string*/)
+{
+    // the console uses 0xffffffff as an "invalid color" value
+    const bool success = _dispatch->SetCursorColor(0xffffffff);
+    TermTelemetry::Instance().Log(TermTelemetry::Codes::OSCRCC);
     return success;
 }
 
 // Routine Description:
-// - Triggers the Ss3Dispatch action to indicate that the listener should handle
-//      a control sequence. These sequences perform various API-type commands
-//      that can include many parameters.
+// - Appends the graphics options for an SGR parameter that has sub-parameters.
+//   Extended colors like "38:2::255:0:0" or "38:5:196" become the same options
+//   as "38;2;255;0;0" and "38;5;196" do, so the dispatch handles both alike.
 // Arguments:
-// - wch - Character to dispatch.
-// - parameters - set of numeric parameters collected while parsing the sequence.
+// - option - The parameter itself
+// - subParameters - Its sub-parameters, at least one.
+// - options - The list of options to append to
 // Return Value:
-// - true iff we successfully dispatched the sequence.
-bool OutputStateMachineEngine::ActionSs3Dispatch(const wchar_t /*wch*/,
-                                                 const std::basic_string_view<size_t> /*parameters*/) noexcept
+// - <none>
+static void _AppendGraphicsSubOptions(const DispatchTypes::GraphicsOptions option,
+                                      const std::basic_string_view<size_t> subParameters,
+                                      til::some<DispatchTypes::GraphicsOptions, MAX_PARAMETER_COUNT>& options)
 {
-    // The output engine doesn't handle any SS3 sequences.
-    _ClearLastChar();
-    return false;
+    switch (option)
+    {
+    case DispatchTypes::GraphicsOptions::ForegroundExtended:
+    case DispatchTypes::GraphicsOptions::BackgroundExtended:
+    {
+        const auto colorType = static_cast<DispatchTypes::GraphicsOptions>(til::at(subParameters, 0));
+        if (colorType == DispatchTypes::GraphicsOptions::BlinkOrXterm256Index && subParameters.size() >= 2)
+        {
+            options.push_back(option);
+            options.push_back(colorType);
+            options.push_back(static_cast<DispatchTypes::GraphicsOptions>(til::at(subParameters, 1)));
+        }
+        else if (colorType == DispatchTypes::GraphicsOptions::RGBColorOrFaint && subParameters.size() >= 4)
+        {
+            // This is either 38:2:r:g:b, or 38:2:id:r:g:b with the color space
+            //      ID of ITU T.416, which we ignore just like xterm does.
+            const auto rgb = subParameters.substr(subParameters.size() >= 5 ? 2 : 1, 3);
+            options.push_back(option);
+            options.push_back(colorType);
+            for (const auto value : rgb)
+            {
+                options.push_back(static_cast<DispatchTypes::GraphicsOptions>(value));
+            }
+        }
+        // Anything else is a color we don't support, and is skipped. Unlike
+        //      with semicolons, it can't swallow the options that follow.
+        break;
+    }
+    case DispatchTypes::GraphicsOptions::Underline:
+        // "4:0" turns the underline off. We draw every other style as a single underline.
+        options.push_back(til::at(subParameters, 0) == 0 ? DispatchTypes::GraphicsOptions::NoUnderline : option);
+        break;
+    default:
+        // No other option has sub-parameters we support, so they're ignored.
+        options.push_back(option);
+        break;
+    }
 }
 
 // Routine Description:
 // - Retrieves the listed graphics options to be applied in order to the "font style" of the next characters inserted into the buffer.
 // Arguments:
 // - parameters - The parameters to parse
+// - subParameters - The sub-parameters of each of the parameters
 // - options - Space that will be filled with valid options from the GraphicsOptions enum
 // Return Value:
 // - True if we successfully retrieved an array of valid graphics options from the parameters we've stored. False otherwise.
 bool OutputStateMachineEngine::_GetGraphicsOptions(const std::basic_string_view<size_t> parameters,
-                                                   std::vector<DispatchTypes::GraphicsOptions>& options) const
+                                                   const VTSubParameters subParameters,
+                                                   GraphicsOptionList& options) const
 {
     bool success = false;
 
@@ -839,9 +1102,18 @@ bool OutputStateMachineEngine::_GetGraphicsOptions(const std::basic_string_view<
     }
     else
     {
-        for (const auto& p : parameters)
+        for (size_t i = 0; i < parameters.size(); i++)
         {
-            options.push_back((DispatchTypes::GraphicsOptions)p);
+            const auto option = static_cast<DispatchTypes::GraphicsOptions>(til::at(parameters, i));
+            const auto subOptions = subParameters.at(i);
+            if (subOptions.empty())
+            {
+                options.push_back(option);
+            }
+            else
+            {
+                _AppendGraphicsSubOptions(option, subOptions, options);
+            }
         }
         success = true;
     }
@@ -1131,7 +1403,7 @@ bool OutputStateMachineEngine::_GetDeviceStatusOperation(const std::basic_string
 // Return Value:
 // - True if we successfully retrieved an array of private mode params from the parameters we've stored. False otherwise.
 bool OutputStateMachineEngine::_GetPrivateModeParams(const std::basic_string_view<size_t> parameters,
-                                                     std::vector<DispatchTypes::PrivateModeParams>& privateModes) const
+                                                     PrivateModeList& privateModes) const
 {
     bool success = false;
     // Can't just set nothing at all
@@ -1258,45 +1530,6 @@ bool OutputStateMachineEngine::_GetTabClearType(const std::basic_string_view<siz
     return success;
 }
 
-// Routine Description:
-// - Retrieves a designate charset type from the intermediate we've stored. False otherwise.
-// Arguments:
-// - intermediate - Intermediate character in the sequence
-// - designateType - Receives the designate type.
-// Return Value:
-// - True if we successfully pulled the designate type from the intermediate we've stored. False otherwise.
-bool OutputStateMachineEngine::_GetDesignateType(const wchar_t intermediate,
-                                                 DesignateCharsetTypes& designateType) const noexcept
-{
-    bool success = false;
-    designateType = DefaultDesignateCharsetType;
-
-    switch (intermediate)
-    {
-    case '(':
-        designateType = DesignateCharsetTypes::G0;
-        success = true;
-        break;
-    case ')':
-    case '-':
-        designateType = DesignateCharsetTypes::G1;
-        success = true;
-        break;
-    case '*':
-    case '.':
-        designateType = DesignateCharsetTypes::G2;
-        success = true;
-        break;
-    case '+':
-    case '/':
-        designateType = DesignateCharsetTypes::G3;
-        success = true;
-        break;
-    }
-
-    return success;
-}
-
 // Routine Description:
 // - Returns true if the engine should dispatch on the last character of a string
 //      always, even if the sequence hasn't normally dispatched.
@@ -1727,6 +1960,90 @@ bool OutputStateMachineEngine::_GetRepeatCount(std::basic_string_view<size_t> pa
     return success;
 }
 
+// Routine Description:
+// - Retrieves the area of a rectangular area operation from its first four
+//   parameters: top, left, bottom and right. Missing or 0 values for the top
+//   and left default to 1, and for the bottom and right to 0, which is the
+//   last line or column of the page.
+// Arguments:
+// - parameters - The parameters to parse
+// - area - Receives the area
+// Return Value:
+// - True if we successfully pulled the area from the parameters.
+//   False otherwise.
+bool OutputStateMachineEngine::_GetRectangularArea(const std::basic_string_view<size_t> parameters,
+                                                   DispatchTypes::RectangularArea& area) const noexcept
+{
+    const auto get = [&](const size_t index) noexcept {
+        return index < parameters.size() ? til::at(parameters, index) : 0;
+    };
+
+    area.top = std::max<size_t>(get(0), 1);
+    area.left = std::max<size_t>(get(1), 1);
+    area.bottom = get(2);
+    area.right = get(3);
+    return true;
+}
+
+// Routine Description:
+// - Retrieves the parameters of DECCRA: the source area, its page, and the
+//   top, left and page of the target. We only have the one page, so the
+//   pages are ignored.
+// Arguments:
+// - parameters - The parameters to parse
+// - source - Receives the area to copy
+// - targetTop - Receives the line to copy the area to, 1 if omitted
+// - targetLeft - Receives the column to copy the area to, 1 if omitted
+// Return Value:
+// - True if we successfully pulled the values from the parameters.
+//   False otherwise.
+bool OutputStateMachineEngine::_GetCopyRectangularAreaParams(const std::basic_string_view<size_t> parameters,
+                                                             DispatchTypes::RectangularArea& source,
+                                                             size_t& targetTop,
+                                                             size_t& targetLeft) const noexcept
+{
+    bool success = false;
+
+    if (parameters.size() <= 8)
+    {
+        success = _GetRectangularArea(parameters, source);
+        targetTop = parameters.size() > 5 ? std::max<size_t>(til::at(parameters, 5), 1) : 1;
+        targetLeft = parameters.size() > 6 ? std::max<size_t>(til::at(parameters, 6), 1) : 1;
+    }
+
+    return success;
+}
+
+// Routine Description:
+// - Retrieves the parameters of DECFRA: the character to fill with, followed
+//   by the area. Only printable characters from ASCII and the upper half of
+//   Latin-1 can be used.
+// Arguments:
+// - parameters - The parameters to parse
+// - fillChar - Receives the character to fill the area with
+// - area - Receives the area to fill
+// Return Value:
+// - True if we successfully pulled the values from the parameters.
+//   False otherwise.
+bool OutputStateMachineEngine::_GetFillRectangularAreaParams(const std::basic_string_view<size_t> parameters,
+                                                             wchar_t& fillChar,
+                                                             DispatchTypes::RectangularArea& area) const noexcept
+{
+    bool success = false;
+
+    if (!parameters.empty() && parameters.size() <= 5)
+    {
+        const auto ch = til::at(parameters, 0);
+        if ((ch >= 32 && ch <= 126) || (ch >= 160 && ch <= 255))
+        {
+            fillChar = gsl::narrow_cast<wchar_t>(ch);
+            success = _GetRectangularArea(parameters.substr(1), area);
+        }
+    }
+
+    return success;
+}
+
 // Method Description:
 // - Clears our last stored character. The last stored character is the last
 //      graphical character we printed, which is reset if any other action is
@@ -10,6 +10,7 @@ Abstract:
 */
 #pragma once
 
+#include <array>
 #include <functional>
 
 #include "../adapter/termDispatch.hpp"
@@ -38,7 +39,8 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool ActionCsiDispatch(const wchar_t wch,
                                const std::basic_string_view<wchar_t> intermediates,
-                               const std::basic_string_view<size_t> parameters) override;
+                               const std::basic_string_view<size_t> parameters,
+                               const VTSubParameters subParameters) override;
 
         bool ActionClear() noexcept override;
 
@@ -51,6 +53,14 @@ namespace Microsoft::Console::VirtualTerminal
         bool ActionSs3Dispatch(const wchar_t wch,
                                const std::basic_string_view<size_t> parameters) noexcept override;
 
+        bool ActionDcsHook(const wchar_t wch,
+                           const std::basic_string_view<wchar_t> intermediates,
+                           const std::basic_string_view<size_t> parameters) override;
+
+        bool ActionDcsPut(const std::wstring_view string) override;
+
+        bool ActionDcsUnhook(const bool aborted) override;
+
         bool FlushAtEndOfString() const noexcept override;
         bool DispatchControlCharsFromEscape() const noexcept override;
         bool DispatchIntermediatesFromEscape() const noexcept override;
@@ -66,12 +76,7 @@ namespace Microsoft::Console::VirtualTerminal
         Microsoft::Console::ITerminalOutputConnection* _pTtyConnection;
         std::function<bool()> _pfnFlushToTerminal;
         wchar_t _lastPrintedChar;
-
-        bool _IntermediateQuestionMarkDispatch(const wchar_t wchAction,
-                                               const std::basic_string_view<size_t> parameters);
-        bool _IntermediateExclamationDispatch(const wchar_t wch);
-        bool _IntermediateSpaceDispatch(const wchar_t wchAction,
-                                        const std::basic_string_view<size_t> parameters);
+        bool _dcsPassingThrough;
 
         enum VTActionCodes : wchar_t
         {
@@ -123,7 +128,12 @@ namespace Microsoft::Console::VirtualTerminal
             DECSCUSR_SetCursorStyle = L'q', // I believe we'll only ever implement DECSCUSR
             DTTERM_WindowManipulation = L't',
             REP_RepeatCharacter = L'b',
-            DECALN_ScreenAlignmentPattern = L'8'
+            DECALN_ScreenAlignmentPattern = L'8',
+            // The rectangular area operations all have a '$' intermediate.
+            DECCRA_CopyRectangularArea = L'v',
+            DECFRA_FillRectangularArea = L'x',
+            DECERA_EraseRectangularArea = L'z',
+            DECSERA_SelectiveEraseRectangularArea = L'{'
         };
 
         enum OscActionCodes : unsigned int
@@ -149,9 +159,118 @@ namespace Microsoft::Console::VirtualTerminal
             G3
         };
 
+        // Every sequence we handle has a handler of its own, that parses its
+        // parameters and calls the dispatch. They're found through tables that
+        // have a slot for each final character that can follow each of the
+        // intermediates we know, so finding one takes a single lookup however
+        // many sequences there are. The tables are generated at compile time
+        // from the lists of sequences in the .cpp.
+        using EscHandler = bool (OutputStateMachineEngine::*)(const wchar_t wch);
+        using CsiHandler = bool (OutputStateMachineEngine::*)(const std::basic_string_view<size_t> parameters,
+                                                              const VTSubParameters subParameters);
+        using OscHandler = bool (OutputStateMachineEngine::*)(const std::wstring_view string);
+
+        enum class EscPlane : size_t
+        {
+            None,
+            Hash,
+            G0,
+            G1,
+            G2,
+            G3,
+            Count
+        };
+        static constexpr wchar_t EscFinalFirst = L'0';
+        static constexpr wchar_t EscFinalLast = L'~';
+        // A charset designation takes any final character at all, so there's
+        //      one more slot that all the other characters share.
+        static constexpr size_t EscFinalCount = EscFinalLast - EscFinalFirst + 2;
+        using EscDispatchTable = std::array<EscHandler, static_cast<size_t>(EscPlane::Count) * EscFinalCount>;
+
+        enum class CsiPlane : size_t
+        {
+            None,
+            Question,
+            Exclamation,
+            Space,
+            Dollar,
+            Count
+        };
+        static constexpr wchar_t CsiFinalFirst = L'@';
+        static constexpr wchar_t CsiFinalLast = L'~';
+        static constexpr size_t CsiFinalCount = CsiFinalLast - CsiFinalFirst + 1;
+        using CsiDispatchTable = std::array<CsiHandler, static_cast<size_t>(CsiPlane::Count) * CsiFinalCount>;
+
+        using OscDispatchTable = std::array<OscHandler, OscActionCodes::ResetCursorColor + 1>;
+
+        static const EscDispatchTable s_escDispatchTable;
+        static const CsiDispatchTable s_csiDispatchTable;
+        static const OscDispatchTable s_oscDispatchTable;
+
+        static constexpr EscDispatchTable _BuildEscDispatchTable() noexcept;
+        static constexpr CsiDispatchTable _BuildCsiDispatchTable() noexcept;
+        static constexpr OscDispatchTable _BuildOscDispatchTable() noexcept;
+
+        static EscHandler _GetEscHandler(const wchar_t wch,
+                                         const std::basic_string_view<wchar_t> intermediates) noexcept;
+        static CsiHandler _GetCsiHandler(const wchar_t wch,
+                                         const std::basic_string_view<wchar_t> intermediates) noexcept;
+        static OscHandler _GetOscHandler(const size_t parameter) noexcept;
+
+        template<auto Dispatch, TermTelemetry::Codes Code>
+        bool _EscDispatch(const wchar_t wch);
+        template<auto Dispatch, auto Argument, TermTelemetry::Codes Code>
+        bool _EscDispatchWith(const wchar_t wch);
+        template<DesignateCharsetTypes Type, TermTelemetry::Codes Code>
+        bool _EscDesignateCharset(const wchar_t wch);
+
+        template<auto Parse, auto Dispatch, TermTelemetry::Codes Code>
+        bool _CsiDispatchCount(const std::basic_string_view<size_t> parameters,
+                               const VTSubParameters subParameters);
+        template<auto Verify, auto Dispatch, TermTelemetry::Codes Code>
+        bool _CsiDispatch(const std::basic_string_view<size_t> parameters,
+                          const VTSubParameters subParameters);
+        template<auto Dispatch, TermTelemetry::Codes Code>
+        bool _CsiDispatchEraseType(const std::basic_string_view<size_t> parameters,
+                                   const VTSubParameters subParameters);
+        template<auto Dispatch, TermTelemetry::Codes Code>
+        bool _CsiDispatchPrivateModes(const std::basic_string_view<size_t> parameters,
+                                      const VTSubParameters subParameters);
+        template<auto Dispatch, TermTelemetry::Codes Code>
+        bool _CsiDispatchRectangularArea(const std::basic_string_view<size_t> parameters,
+                                         const VTSubParameters subParameters);
+        bool _CsiCursorPosition(const std::basic_string_view<size_t> parameters,
+                                const VTSubParameters subParameters);
+        bool _CsiSetScrollingRegion(const std::basic_string_view<size_t> parameters,
+                                    const VTSubParameters subParameters);
+        bool _CsiSetGraphicsRendition(const std::basic_string_view<size_t> parameters,
+                                      const VTSubParameters subParameters);
+        bool _CsiDeviceStatusReport(const std::basic_string_view<size_t> parameters,
+                                    const VTSubParameters subParameters);
+        bool _CsiWindowManipulation(const std::basic_string_view<size_t> parameters,
+                                    const VTSubParameters subParameters);
+        bool _CsiRepeatCharacter(const std::basic_string_view<size_t> parameters,
+                                 const VTSubParameters subParameters);
+        bool _CsiSetCursorStyle(const std::basic_string_view<size_t> parameters,
+                                const VTSubParameters subParameters);
+        bool _CsiCopyRectangularArea(const std::basic_string_view<size_t> parameters,
+                                     const VTSubParameters subParameters);
+        bool _CsiFillRectangularArea(const std::basic_string_view<size_t> parameters,
+                                     const VTSubParameters subParameters);
+
+        bool _OscSetWindowTitle(const std::wstring_view string);
+        bool _OscSetColorTableEntry(const std::wstring_view string);
+        template<auto Dispatch, TermTelemetry::Codes Code>
+        bool _OscSetColor(const std::wstring_view string);
+        bool _OscResetCursorColor(const std::wstring_view string);
+
+        // Each option comes from a parameter or sub-parameter of its own, so this always has room for all of them.
+        using GraphicsOptionList = til::some<DispatchTypes::GraphicsOptions, MAX_PARAMETER_COUNT>;
+
         static constexpr DispatchTypes::GraphicsOptions DefaultGraphicsOption = DispatchTypes::GraphicsOptions::Off;
         bool _GetGraphicsOptions(const std::basic_string_view<size_t> parameters,
-                                 std::vector<DispatchTypes::GraphicsOptions>& options) const;
+                                 const VTSubParameters subParameters,
+                                 GraphicsOptionList& options) const;
 
         static constexpr DispatchTypes::EraseType DefaultEraseType = DispatchTypes::EraseType::ToEnd;
         bool _GetEraseOperation(const std::basic_string_view<size_t> parameters,
@@ -182,8 +301,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _VerifyDeviceAttributesParams(const std::basic_string_view<size_t> parameters) const noexcept;
 
+        using PrivateModeList = til::some<DispatchTypes::PrivateModeParams, MAX_PARAMETER_COUNT>;
         bool _GetPrivateModeParams(const std::basic_string_view<size_t> parameters,
-                                   std::vector<DispatchTypes::PrivateModeParams>& privateModes) const;
+                                   PrivateModeList& privateModes) const;
 
         static constexpr size_t DefaultTopMargin = 0;
         static constexpr size_t DefaultBottomMargin = 0;
@@ -202,10 +322,6 @@ namespace Microsoft::Console::VirtualTerminal
         bool _GetTabClearType(const std::basic_string_view<size_t> parameters,
                               size_t& clearType) const noexcept;
 
-        static constexpr DesignateCharsetTypes DefaultDesignateCharsetType = DesignateCharsetTypes::G0;
-        bool _GetDesignateType(const wchar_t intermediate,
-                               DesignateCharsetTypes& designateType) const noexcept;
-
         static constexpr DispatchTypes::WindowManipulationType DefaultWindowManipulationType = DispatchTypes::WindowManipulationType::Invalid;
         bool _GetWindowManipulationType(const std::basic_string_view<size_t> parameters,
                                         unsigned int& function) const noexcept;
@@ -230,6 +346,18 @@ namespace Microsoft::Console::VirtualTerminal
         bool _GetRepeatCount(const std::basic_string_view<size_t> parameters,
                              size_t& repeatCount) const noexcept;
 
+        bool _GetRectangularArea(const std::basic_string_view<size_t> parameters,
+                                 DispatchTypes::RectangularArea& area) const noexcept;
+
+        bool _GetCopyRectangularAreaParams(const std::basic_string_view<size_t> parameters,
+                                           DispatchTypes::RectangularArea& source,
+                                           size_t& targetTop,
+                                           size_t& targetLeft) const noexcept;
+
+        bool _GetFillRectangularAreaParams(const std::basic_string_view<size_t> parameters,
+                                           wchar_t& fillChar,
+                                           DispatchTypes::RectangularArea& area) const noexcept;
+
         void _ClearLastChar() noexcept;
     };
 }
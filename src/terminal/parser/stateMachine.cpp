@@ -9,15 +9,30 @@
 
 using namespace Microsoft::Console::VirtualTerminal;
 
+// A very long sequence can leave a buffer of several megabytes behind. Once
+// it's done, buffers bigger than this are freed again.
+static constexpr size_t RetainedSequenceCapacity = 4096;
+
 //Takes ownership of the pEngine.
 StateMachine::StateMachine(std::unique_ptr<IStateMachineEngine> engine) :
     _engine(std::move(engine)),
     _state(VTStates::Ground),
     _trace(Microsoft::Console::VirtualTerminal::ParserTracing()),
     _intermediates{},
+    _intermediateCount{ 0 },
+    _intermediatesOverflowed{ false },
     _parameters{},
+    _parameterCount{ 0 },
+    _subParameters{},
+    _subParameterCount{ 0 },
+    _subParameterEnds{},
+    _parametersOverflowed{ false },
     _oscString{},
-    _cachedSequence{ std::nullopt },
+    _oscStringOverflowed{ false },
+    _dcsHooked{ false },
+    _cachedSequence{},
+    _cachedSequenceOverflowed{ false },
+    _maxSequenceLength{ DEFAULT_MAX_SEQUENCE_LENGTH },
     _processingIndividually(false)
 {
     _ActionClear();
@@ -148,6 +163,18 @@ static constexpr bool _isCsiDelimiter(const wchar_t wch) noexcept
     return wch == L';'; // 0x3B
 }
 
+// Routine Description:
+// - Determines if a character is a delimiter between a parameter of a "control sequence" and its sub-parameters,
+//   or between two sub-parameters, as in the "38:2:255:0:0" of an SGR.
+// Arguments:
+// - wch - Character to check.
+// Return Value:
+// - True if it is. False if it isn't.
+static constexpr bool _isSubParameterDelimiter(const wchar_t wch) noexcept
+{
+    return wch == L':'; // 0x3A
+}
+
 // Routine Description:
 // - Determines if a character is a valid parameter value
 //   Parameters must be numerical digits.
@@ -174,6 +201,7 @@ static constexpr bool _isCsiPrivateMarker(const wchar_t wch) noexcept
 
 // Routine Description:
 // - Determines if a character is invalid in a control sequence
+//   Within the parameters of a CSI, this is a sub-parameter delimiter instead.
 // Arguments:
 // - wch - Character to check.
 // Return Value:
@@ -271,16 +299,80 @@ static constexpr bool _isOscTerminator(const wchar_t wch) noexcept
     return wch == L'\x7' || wch == L'\x9C'; // Bell character or C1 terminator
 }
 
+// Routine Description:
+// - Determines if a character is a C1 DCS (Device Control String)
+//   This is a single-character way to start a device control string, as opposed to "ESC P".
+//   See _isC1Csi for why a \x0090 can only mean the C1 control by the time we get here.
+// Arguments:
+// - wch - Character to check.
+// Return Value:
+// - True if it is. False if it isn't.
+static constexpr bool _isC1Dcs(const wchar_t wch) noexcept
+{
+    return wch == L'\x90';
+}
+
+// Routine Description:
+// - Determines if a character is "device control string" beginning indicator.
+//   This immediately follows an escape and signifies a varying length control string.
+// Arguments:
+// - wch - Character to check.
+// Return Value:
+// - True if it is. False if it isn't.
+static constexpr bool _isDcsIndicator(const wchar_t wch) noexcept
+{
+    return wch == L'P'; // 0x50
+}
+
+// Routine Description:
+// - Determines if a character is the C1 string terminator, which ends a "device control string".
+// Arguments:
+// - wch - Character to check.
+// Return Value:
+// - True if it is. False if it isn't.
+static constexpr bool _isDcsTerminator(const wchar_t wch) noexcept
+{
+    return wch == L'\x9C';
+}
+
+// Routine Description:
+// - Determines if a character completes the "ESC \" that terminates a "device control string".
+// Arguments:
+// - wch - Character to check.
+// Return Value:
+// - True if it is. False if it isn't.
+static constexpr bool _isStringTerminatorIndicator(const wchar_t wch) noexcept
+{
+    return wch == L'\\'; // 0x5C
+}
+
+// Routine Description:
+// - Determines if a character belongs to the payload of a "device control string".
+//   Everything does, apart from the characters that end or abort the string,
+//   and Delete, which is ignored.
+// Arguments:
+// - wch - Character to check.
+// Return Value:
+// - True if it is. False if it isn't.
+static constexpr bool _isDcsPassThroughValue(const wchar_t wch) noexcept
+{
+    return wch != AsciiChars::CAN &&
+           wch != AsciiChars::SUB &&
+           !_isEscape(wch) &&
+           !_isDelete(wch) &&
+           !_isDcsTerminator(wch);
+}
+
 // Routine Description:
 // - Determines if a character indicates an action that should be taken in the ground state -
-//     These are C0 characters and the C1 [single-character] CSI.
+//     These are C0 characters and the C1 [single-character] CSI and DCS.
 // Arguments:
 // - wch - Character to check.
 // Return Value:
 // - True if it is. False if it isn't.
 static constexpr bool _isActionableFromGround(const wchar_t wch) noexcept
 {
-    return (wch <= AsciiChars::US) || _isC1Csi(wch) || _isDelete(wch);
+    return (wch <= AsciiChars::US) || _isC1Csi(wch) || _isC1Dcs(wch) || _isDelete(wch);
 }
 
 #pragma warning(pop)
@@ -334,7 +426,8 @@ void StateMachine::_ActionEscDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"EscDispatch");
 
-    const bool success = _engine->ActionEscDispatch(wch, { _intermediates.data(), _intermediates.size() });
+    const bool success = !_intermediatesOverflowed &&
+                         _engine->ActionEscDispatch(wch, { _intermediates.data(), _intermediateCount });
 
     // Trace the result.
     _trace.DispatchSequenceTrace(success);
@@ -349,17 +442,30 @@ void StateMachine::_ActionEscDispatch(const wchar_t wch)
 // Routine Description:
 // - Triggers the CsiDispatch action to indicate that the listener should handle a control sequence.
 //   These sequences perform various API-type commands that can include many parameters.
+// - Only SGR takes sub-parameters. Any other sequence that has them is ignored,
+//   just like one with invalid characters in its parameters (CsiIgnore).
 // Arguments:
 // - wch - Character to dispatch.
 // Return Value:
 // - <none>
 void StateMachine::_ActionCsiDispatch(const wchar_t wch)
 {
+    if (_subParameterCount != 0 && (wch != L'm' || _intermediateCount != 0))
+    {
+        _ActionIgnore();
+        return;
+    }
+
     _trace.TraceOnAction(L"CsiDispatch");
 
-    const bool success = _engine->ActionCsiDispatch(wch,
-                                                    { _intermediates.data(), _intermediates.size() },
-                                                    { _parameters.data(), _parameters.size() });
+    const VTSubParameters subParameters{ { _subParameters.data(), _subParameterCount },
+                                         { _subParameterEnds.data(), _parameterCount } };
+
+    const bool success = !_intermediatesOverflowed &&
+                         _engine->ActionCsiDispatch(wch,
+                                                    { _intermediates.data(), _intermediateCount },
+                                                    { _parameters.data(), _parameterCount },
+                                                    subParameters);
 
     // Trace the result.
     _trace.DispatchSequenceTrace(success);
@@ -382,7 +488,14 @@ void StateMachine::_ActionCollect(const wchar_t wch)
     _trace.TraceOnAction(L"Collect");
 
     // store collect data
-    _intermediates.push_back(wch);
+    if (_intermediateCount < _intermediates.size())
+    {
+        til::at(_intermediates, _intermediateCount++) = wch;
+    }
+    else
+    {
+        _intermediatesOverflowed = true;
+    }
 }
 
 // Routine Description:
@@ -397,9 +510,9 @@ void StateMachine::_ActionParam(const wchar_t wch)
     _trace.TraceOnAction(L"Param");
 
     // If we have no parameters and we're about to add one, get the 0 value ready here.
-    if (_parameters.empty())
+    if (_parameterCount == 0)
     {
-        _parameters.push_back(0);
+        _PushParameter();
     }
 
     // On a delimiter, increase the number of params we've seen.
@@ -408,12 +521,42 @@ void StateMachine::_ActionParam(const wchar_t wch)
     if (wch == L';')
     {
         // Move to next param.
-        _parameters.push_back(0);
+        _PushParameter();
     }
-    else
+    else if (!_parametersOverflowed)
     {
         // Accumulate the character given into the last (current) parameter
-        _AccumulateTo(wch, _parameters.back());
+        _AccumulateTo(wch, til::at(_parameters, _parameterCount - 1));
+    }
+}
+
+// Routine Description:
+// - Triggers the SubParam action to indicate that the state machine should store this character as a part of a
+//   sub-parameter of the current parameter of a control sequence.
+// Arguments:
+// - wch - Character to dispatch.
+// Return Value:
+// - <none>
+void StateMachine::_ActionSubParam(const wchar_t wch) noexcept
+{
+    _trace.TraceOnAction(L"SubParam");
+
+    // Sub-parameters always belong to a parameter, even an empty one -
+    //      eg "\x1b[:3m" is a "0" param with a "3" sub-param
+    if (_parameterCount == 0)
+    {
+        _PushParameter();
+    }
+
+    if (wch == L':')
+    {
+        // Move to the next sub-param of the current param.
+        _PushSubParameter();
+    }
+    else if (!_parametersOverflowed)
+    {
+        // Accumulate the character given into the last (current) sub-parameter
+        _AccumulateTo(wch, til::at(_subParameters, _subParameterCount - 1));
     }
 }
 
@@ -428,11 +571,15 @@ void StateMachine::_ActionClear()
     _trace.TraceOnAction(L"Clear");
 
     // clear all internal stored state.
-    _intermediates.clear();
+    _intermediateCount = 0;
+    _intermediatesOverflowed = false;
 
-    _parameters.clear();
+    _parameterCount = 0;
+    _subParameterCount = 0;
+    _parametersOverflowed = false;
 
-    _oscString.clear();
+    _ClearSequenceBuffer(_oscString);
+    _oscStringOverflowed = false;
     _oscParameter = 0;
 
     _engine->ActionClear();
@@ -473,7 +620,16 @@ void StateMachine::_ActionOscPut(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscPut");
 
-    _oscString.push_back(wch);
+    // Once the string doesn't fit anymore, the rest of it goes nowhere, and
+    // the sequence won't be dispatched.
+    if (_oscString.size() < _maxSequenceLength)
+    {
+        _oscString.push_back(wch);
+    }
+    else
+    {
+        _oscStringOverflowed = true;
+    }
 }
 
 // Routine Description:
@@ -487,7 +643,8 @@ void StateMachine::_ActionOscDispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"OscDispatch");
 
-    const bool success = _engine->ActionOscDispatch(wch, _oscParameter, _oscString);
+    const bool success = !_oscStringOverflowed &&
+                         _engine->ActionOscDispatch(wch, _oscParameter, _oscString);
 
     // Trace the result.
     _trace.DispatchSequenceTrace(success);
@@ -510,7 +667,7 @@ void StateMachine::_ActionSs3Dispatch(const wchar_t wch)
 {
     _trace.TraceOnAction(L"Ss3Dispatch");
 
-    const bool success = _engine->ActionSs3Dispatch(wch, { _parameters.data(), _parameters.size() });
+    const bool success = _engine->ActionSs3Dispatch(wch, { _parameters.data(), _parameterCount });
 
     // Trace the result.
     _trace.DispatchSequenceTrace(success);
@@ -522,6 +679,71 @@ void StateMachine::_ActionSs3Dispatch(const wchar_t wch)
     }
 }
 
+// Routine Description:
+// - Triggers the DcsHook action to indicate that the listener should handle a device control string.
+//   Its payload follows in DcsPut actions, which end with a DcsUnhook action.
+// Arguments:
+// - wch - Character to dispatch.
+// Return Value:
+// - <none>
+void StateMachine::_ActionDcsHook(const wchar_t wch)
+{
+    _trace.TraceOnAction(L"DcsHook");
+
+    _dcsHooked = !_intermediatesOverflowed &&
+                 _engine->ActionDcsHook(wch,
+                                        { _intermediates.data(), _intermediateCount },
+                                        { _parameters.data(), _parameterCount });
+
+    // Trace the result.
+    _trace.DispatchSequenceTrace(_dcsHooked);
+
+    if (!_dcsHooked)
+    {
+        // Suppress it and log telemetry on failed cases
+        TermTelemetry::Instance().LogFailed(wch);
+    }
+
+    // From here on, the payload goes straight to the engine. There's nothing
+    //   left of the string that we'd need to keep to pass it through later.
+    _ClearSequenceBuffer(_cachedSequence);
+}
+
+// Routine Description:
+// - Passes a piece of the payload of a device control string to the listener.
+//   If the listener didn't want the string, it's dropped instead.
+// Arguments:
+// - string - The piece of the payload.
+// Return Value:
+// - <none>
+void StateMachine::_ActionDcsPut(const std::wstring_view string)
+{
+    _trace.TraceOnAction(L"DcsPut");
+
+    if (_dcsHooked)
+    {
+        _engine->ActionDcsPut(string);
+    }
+}
+
+// Routine Description:
+// - Triggers the DcsUnhook action to indicate that the current device control string has ended.
+//   Does nothing unless the listener took the string on in the DcsHook action.
+// Arguments:
+// - aborted - True if the string was cut short instead of being terminated.
+// Return Value:
+// - <none>
+void StateMachine::_ActionDcsUnhook(const bool aborted)
+{
+    if (_dcsHooked)
+    {
+        _trace.TraceOnAction(L"DcsUnhook");
+
+        _dcsHooked = false;
+        _engine->ActionDcsUnhook(aborted);
+    }
+}
+
 // Routine Description:
 // - Moves the state machine into the Ground state.
 //   This state is entered:
@@ -534,7 +756,9 @@ void StateMachine::_ActionSs3Dispatch(const wchar_t wch)
 void StateMachine::_EnterGround() noexcept
 {
     _state = VTStates::Ground;
-    _cachedSequence.reset(); // entering ground means we've completed the pending sequence
+    // entering ground means we've completed the pending sequence
+    _ClearSequenceBuffer(_cachedSequence);
+    _cachedSequenceOverflowed = false;
     _trace.TraceStateChange(L"Ground");
 }
 
@@ -548,6 +772,9 @@ void StateMachine::_EnterGround() noexcept
 // - <none>
 void StateMachine::_EnterEscape()
 {
+    // An escape sequence aborts any device control string that came before it.
+    _ActionDcsUnhook(true);
+
     _state = VTStates::Escape;
     _trace.TraceStateChange(L"Escape");
     _ActionClear();
@@ -597,6 +824,20 @@ void StateMachine::_EnterCsiParam() noexcept
     _trace.TraceStateChange(L"CsiParam");
 }
 
+// Routine Description:
+// - Moves the state machine into the CsiSubParam state.
+//   This state is entered:
+//   1. When a sub-parameter delimiter is detected while collecting parameter data (from CsiEntry or CsiParam)
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_EnterCsiSubParam() noexcept
+{
+    _state = VTStates::CsiSubParam;
+    _trace.TraceStateChange(L"CsiSubParam");
+}
+
 // Routine Description:
 // - Moves the state machine into the CsiIgnore state.
 //   This state is entered:
@@ -699,6 +940,95 @@ void StateMachine::_EnterSs3Param() noexcept
     _trace.TraceStateChange(L"Ss3Param");
 }
 
+// Routine Description:
+// - Moves the state machine into the DcsEntry state.
+//   This state is entered:
+//   1. When the DcsIndicator character is seen after an Escape entry (only from the Escape state)
+//   2. When the C1 DCS character is seen in the Ground state
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_EnterDcsEntry()
+{
+    _state = VTStates::DcsEntry;
+    _trace.TraceStateChange(L"DcsEntry");
+    _ActionClear();
+}
+
+// Routine Description:
+// - Moves the state machine into the DcsParam state.
+//   This state is entered:
+//   1. When valid parameter characters are detected on entering a DCS (from DcsEntry state)
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_EnterDcsParam() noexcept
+{
+    _state = VTStates::DcsParam;
+    _trace.TraceStateChange(L"DcsParam");
+}
+
+// Routine Description:
+// - Moves the state machine into the DcsIgnore state.
+//   This state is entered:
+//   1. When an invalid character is detected in the header of a DCS
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_EnterDcsIgnore() noexcept
+{
+    _state = VTStates::DcsIgnore;
+    _trace.TraceStateChange(L"DcsIgnore");
+}
+
+// Routine Description:
+// - Moves the state machine into the DcsIntermediate state.
+//   This state is entered:
+//   1. When an intermediate character is seen immediately after entering a DCS (from DcsEntry)
+//   2. When an intermediate character is seen while collecting parameter data (from DcsParam)
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_EnterDcsIntermediate() noexcept
+{
+    _state = VTStates::DcsIntermediate;
+    _trace.TraceStateChange(L"DcsIntermediate");
+}
+
+// Routine Description:
+// - Moves the state machine into the DcsPassThrough state.
+//   This state is entered:
+//   1. When the final character of the header of a DCS has been dispatched
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_EnterDcsPassThrough() noexcept
+{
+    _state = VTStates::DcsPassThrough;
+    _trace.TraceStateChange(L"DcsPassThrough");
+}
+
+// Routine Description:
+// - Moves the state machine into the DcsTermination state.
+//   This state is entered:
+//   1. When an ESC is seen in the payload of a DCS, or while it's being
+//      ignored. This escape will normally be followed by a '\', as to encode
+//      a 0x9C as a 7-bit ASCII char stream.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_EnterDcsTermination() noexcept
+{
+    _state = VTStates::DcsTermination;
+    _trace.TraceStateChange(L"DcsTermination");
+}
+
 // Routine Description:
 // - Processes a character event into an Action that occurs while in the Ground state.
 //   Events in this state will:
@@ -720,6 +1050,10 @@ void StateMachine::_EventGround(const wchar_t wch)
     {
         _EnterCsiEntry();
     }
+    else if (_isC1Dcs(wch))
+    {
+        _EnterDcsEntry();
+    }
     else
     {
         _ActionPrint(wch);
@@ -782,6 +1116,10 @@ void StateMachine::_EventEscape(const wchar_t wch)
     {
         _EnterSs3Entry();
     }
+    else if (_isDcsIndicator(wch))
+    {
+        _EnterDcsEntry();
+    }
     else
     {
         _ActionEscDispatch(wch);
@@ -828,8 +1166,8 @@ void StateMachine::_EventEscapeIntermediate(const wchar_t wch)
 //   1. Execute C0 control characters
 //   2. Ignore Delete characters
 //   3. Collect Intermediate characters
-//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
-//   5. Store parameter data
+//   4. Store parameter data
+//   5. Store sub-parameter data (CsiSubParam)
 //   6. Collect Control Sequence Private markers
 //   7. Dispatch a control sequence with parameters for action
 // Arguments:
@@ -852,9 +1190,10 @@ void StateMachine::_EventCsiEntry(const wchar_t wch)
         _ActionCollect(wch);
         _EnterCsiIntermediate();
     }
-    else if (_isCsiInvalid(wch))
+    else if (_isSubParameterDelimiter(wch))
     {
-        _EnterCsiIgnore();
+        _ActionSubParam(wch);
+        _EnterCsiSubParam();
     }
     else if (_isCsiParamValue(wch) || _isCsiDelimiter(wch))
     {
@@ -956,7 +1295,8 @@ void StateMachine::_EventCsiIgnore(const wchar_t wch)
 //   3. Collect Intermediate characters
 //   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
 //   5. Store parameter data
-//   6. Dispatch a control sequence with parameters for action
+//   6. Store sub-parameter data (CsiSubParam)
+//   7. Dispatch a control sequence with parameters for action
 // Arguments:
 // - wch - Character that triggered the event
 // Return Value:
@@ -976,12 +1316,67 @@ void StateMachine::_EventCsiParam(const wchar_t wch)
     {
         _ActionParam(wch);
     }
+    else if (_isSubParameterDelimiter(wch))
+    {
+        _ActionSubParam(wch);
+        _EnterCsiSubParam();
+    }
     else if (_isIntermediate(wch))
     {
         _ActionCollect(wch);
         _EnterCsiIntermediate();
     }
-    else if (_isCsiInvalid(wch) || _isCsiPrivateMarker(wch))
+    else if (_isCsiPrivateMarker(wch))
+    {
+        _EnterCsiIgnore();
+    }
+    else
+    {
+        _ActionCsiDispatch(wch);
+        _EnterGround();
+    }
+}
+
+// Routine Description:
+// - Processes a character event into an Action that occurs while in the CsiSubParam state.
+//   Events in this state will:
+//   1. Execute C0 control characters
+//   2. Ignore Delete characters
+//   3. Collect Intermediate characters
+//   4. Begin to ignore all remaining parameters when an invalid character is detected (CsiIgnore)
+//   5. Store sub-parameter data
+//   6. Move on to the next parameter (CsiParam)
+//   7. Dispatch a control sequence with parameters for action
+// Arguments:
+// - wch - Character that triggered the event
+// Return Value:
+// - <none>
+void StateMachine::_EventCsiSubParam(const wchar_t wch)
+{
+    _trace.TraceOnEvent(L"CsiSubParam");
+    if (_isC0Code(wch))
+    {
+        _ActionExecute(wch);
+    }
+    else if (_isDelete(wch))
+    {
+        _ActionIgnore();
+    }
+    else if (_isCsiParamValue(wch) || _isSubParameterDelimiter(wch))
+    {
+        _ActionSubParam(wch);
+    }
+    else if (_isCsiDelimiter(wch))
+    {
+        _ActionParam(wch);
+        _EnterCsiParam();
+    }
+    else if (_isIntermediate(wch))
+    {
+        _ActionCollect(wch);
+        _EnterCsiIntermediate();
+    }
+    else if (_isCsiPrivateMarker(wch))
     {
         _EnterCsiIgnore();
     }
@@ -1156,6 +1551,215 @@ void StateMachine::_EventSs3Param(const wchar_t wch)
     }
 }
 
+// Routine Description:
+// - Processes a character event into an Action that occurs while in the DcsEntry state.
+//   Events in this state will:
+//   1. Ignore C0 control characters
+//   2. Ignore Delete characters
+//   3. Collect Intermediate characters
+//   4. Begin to ignore the whole string when an invalid character is detected (DcsIgnore)
+//   5. Store parameter data
+//   6. Collect private markers
+//   7. Hook the string, and pass its payload on to the listener (DcsPassThrough)
+//  The header of a DCS is structurally the same as a CSI sequence, so it's
+//      safe to reuse CSI's functions for determining if a character is a
+//      parameter, delimiter, or private marker.
+// Arguments:
+// - wch - Character that triggered the event
+// Return Value:
+// - <none>
+void StateMachine::_EventDcsEntry(const wchar_t wch)
+{
+    _trace.TraceOnEvent(L"DcsEntry");
+    if (_isC0Code(wch) || _isDelete(wch))
+    {
+        _ActionIgnore();
+    }
+    else if (_isIntermediate(wch))
+    {
+        _ActionCollect(wch);
+        _EnterDcsIntermediate();
+    }
+    else if (_isSubParameterDelimiter(wch))
+    {
+        _EnterDcsIgnore();
+    }
+    else if (_isCsiParamValue(wch) || _isCsiDelimiter(wch))
+    {
+        _ActionParam(wch);
+        _EnterDcsParam();
+    }
+    else if (_isCsiPrivateMarker(wch))
+    {
+        _ActionCollect(wch);
+        _EnterDcsParam();
+    }
+    else
+    {
+        _ActionDcsHook(wch);
+        _EnterDcsPassThrough();
+    }
+}
+
+// Routine Description:
+// - Processes a character event into an Action that occurs while in the DcsParam state.
+//   Events in this state will:
+//   1. Ignore C0 control characters
+//   2. Ignore Delete characters
+//   3. Collect DCS parameter data
+//   4. Begin to ignore the whole string when an invalid character is detected (DcsIgnore)
+//   5. Collect Intermediate characters
+//   6. Hook the string, and pass its payload on to the listener (DcsPassThrough)
+// Arguments:
+// - wch - Character that triggered the event
+// Return Value:
+// - <none>
+void StateMachine::_EventDcsParam(const wchar_t wch)
+{
+    _trace.TraceOnEvent(L"DcsParam");
+    if (_isC0Code(wch) || _isDelete(wch))
+    {
+        _ActionIgnore();
+    }
+    else if (_isCsiParamValue(wch) || _isCsiDelimiter(wch))
+    {
+        _ActionParam(wch);
+    }
+    else if (_isSubParameterDelimiter(wch) || _isCsiPrivateMarker(wch))
+    {
+        _EnterDcsIgnore();
+    }
+    else if (_isIntermediate(wch))
+    {
+        _ActionCollect(wch);
+        _EnterDcsIntermediate();
+    }
+    else
+    {
+        _ActionDcsHook(wch);
+        _EnterDcsPassThrough();
+    }
+}
+
+// Routine Description:
+// - Processes a character event into an Action that occurs while in the DcsIntermediate state.
+//   Events in this state will:
+//   1. Ignore C0 control characters
+//   2. Ignore Delete characters
+//   3. Collect Intermediate characters
+//   4. Begin to ignore the whole string when an invalid character is detected (DcsIgnore)
+//   5. Hook the string, and pass its payload on to the listener (DcsPassThrough)
+// Arguments:
+// - wch - Character that triggered the event
+// Return Value:
+// - <none>
+void StateMachine::_EventDcsIntermediate(const wchar_t wch)
+{
+    _trace.TraceOnEvent(L"DcsIntermediate");
+    if (_isC0Code(wch) || _isDelete(wch))
+    {
+        _ActionIgnore();
+    }
+    else if (_isIntermediate(wch))
+    {
+        _ActionCollect(wch);
+    }
+    else if (_isCsiParamValue(wch) || _isSubParameterDelimiter(wch) || _isCsiDelimiter(wch) || _isCsiPrivateMarker(wch))
+    {
+        _EnterDcsIgnore();
+    }
+    else
+    {
+        _ActionDcsHook(wch);
+        _EnterDcsPassThrough();
+    }
+}
+
+// Routine Description:
+// - Processes a character event into an Action that occurs while in the DcsIgnore state.
+//   Events in this state will:
+//   1. Return to the Ground state on a string terminator
+//   2. Wait for the second character of a 7-bit string terminator on an ESC (DcsTermination)
+//   3. Ignore everything else
+// Arguments:
+// - wch - Character that triggered the event
+// Return Value:
+// - <none>
+void StateMachine::_EventDcsIgnore(const wchar_t wch) noexcept
+{
+    _trace.TraceOnEvent(L"DcsIgnore");
+    if (_isDcsTerminator(wch))
+    {
+        _EnterGround();
+    }
+    else if (_isEscape(wch))
+    {
+        _EnterDcsTermination();
+    }
+    else
+    {
+        _ActionIgnore();
+    }
+}
+
+// Routine Description:
+// - Processes a character event into an Action that occurs while in the DcsPassThrough state.
+//   Events in this state will:
+//   1. Unhook the string on a string terminator
+//   2. Wait for the second character of a 7-bit string terminator on an ESC (DcsTermination)
+//   3. Ignore Delete characters
+//   4. Pass everything else on to the listener as part of the payload
+// Arguments:
+// - wch - Character that triggered the event
+// Return Value:
+// - <none>
+void StateMachine::_EventDcsPassThrough(const wchar_t wch)
+{
+    _trace.TraceOnEvent(L"DcsPassThrough");
+    if (_isDcsTerminator(wch))
+    {
+        _ActionDcsUnhook(false);
+        _EnterGround();
+    }
+    else if (_isEscape(wch))
+    {
+        _EnterDcsTermination();
+    }
+    else if (_isDelete(wch))
+    {
+        _ActionIgnore();
+    }
+    else
+    {
+        _ActionDcsPut({ &wch, 1 });
+    }
+}
+
+// Routine Description:
+// - Handle the two-character termination of a DCS.
+//   Events in this state will:
+//   1. Unhook the string on a '\', which completes the string terminator
+//   2. Otherwise, abort the string, and treat the ESC as the start of a new
+//      escape sequence, which this character is a part of.
+// Arguments:
+// - wch - Character that triggered the event
+// Return Value:
+// - <none>
+void StateMachine::_EventDcsTermination(const wchar_t wch)
+{
+    _trace.TraceOnEvent(L"DcsTermination");
+    if (_isStringTerminatorIndicator(wch))
+    {
+        _ActionDcsUnhook(false);
+        _EnterGround();
+    }
+    else
+    {
+        _EnterEscape();
+        _EventEscape(wch);
+    }
+}
+
 // Routine Description:
 // - Entry to the state machine. Takes characters one by one and processes them according to the state machine rules.
 // Arguments:
@@ -1175,13 +1779,17 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
     // these from any state.
     if (isFromAnywhereChar && !(_state == VTStates::Escape && _engine->DispatchControlCharsFromEscape()))
     {
+        _ActionDcsUnhook(true);
         _ActionExecute(wch);
         _EnterGround();
     }
-    else if (_isEscape(wch) && _state != VTStates::OscString)
+    else if (_isEscape(wch) &&
+             _state != VTStates::OscString &&
+             _state != VTStates::DcsPassThrough &&
+             _state != VTStates::DcsIgnore)
     {
-        // Don't go to escape from the OSC string state - ESC can be used to
-        //      terminate OSC strings.
+        // Don't go to escape from the OSC string state or the DCS payload -
+        //      ESC can be used to terminate those strings.
         _EnterEscape();
     }
     else
@@ -1203,6 +1811,8 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
             return _EventCsiIgnore(wch);
         case VTStates::CsiParam:
             return _EventCsiParam(wch);
+        case VTStates::CsiSubParam:
+            return _EventCsiSubParam(wch);
         case VTStates::OscParam:
             return _EventOscParam(wch);
         case VTStates::OscString:
@@ -1213,6 +1823,18 @@ void StateMachine::ProcessCharacter(const wchar_t wch)
             return _EventSs3Entry(wch);
         case VTStates::Ss3Param:
             return _EventSs3Param(wch);
+        case VTStates::DcsEntry:
+            return _EventDcsEntry(wch);
+        case VTStates::DcsParam:
+            return _EventDcsParam(wch);
+        case VTStates::DcsIntermediate:
+            return _EventDcsIntermediate(wch);
+        case VTStates::DcsIgnore:
+            return _EventDcsIgnore(wch);
+        case VTStates::DcsPassThrough:
+            return _EventDcsPassThrough(wch);
+        case VTStates::DcsTermination:
+            return _EventDcsTermination(wch);
         default:
             return;
         }
@@ -1235,13 +1857,19 @@ bool StateMachine::FlushToTerminal()
 {
     bool success{ true };
 
-    if (success && _cachedSequence.has_value())
+    if (_cachedSequenceOverflowed)
+    {
+        // The start of this sequence was too long to keep, so there's nothing
+        // sensible left that we could pass through. Drop all of it.
+        success = false;
+    }
+    else if (!_cachedSequence.empty())
     {
         // Flush the partial sequence to the terminal before we flush the rest of it.
         // We always want to clear the sequence, even if we failed, so we don't accumulate bad state
         // and dump it out elsewhere later.
-        success = _engine->ActionPassThroughString(*_cachedSequence);
-        _cachedSequence.reset();
+        success = _engine->ActionPassThroughString(_cachedSequence);
+        _cachedSequence.clear();
     }
 
     if (success)
@@ -1256,6 +1884,36 @@ bool StateMachine::FlushToTerminal()
     return success;
 }
 
+// Method Description:
+// - Returns true if the state machine isn't in the middle of a sequence, so
+//   that whatever follows the characters processed so far starts a new one.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if we're in the ground state.
+bool StateMachine::IsInGroundState() const noexcept
+{
+    return _state == VTStates::Ground;
+}
+
+// Method Description:
+// - Returns the sequence that's being dispatched, as a view into the string
+//   that ProcessString was given. Only valid while the engine handles the
+//   dispatch. If part of the sequence arrived in an earlier string, only the
+//   rest of it is in this one, so there's nothing sensible we can return.
+// Arguments:
+// - <none>
+// Return Value:
+// - The characters of the sequence, or an empty view.
+std::wstring_view StateMachine::GetDispatchingSequence() const noexcept
+{
+    if (!_processingIndividually || !_cachedSequence.empty() || _cachedSequenceOverflowed)
+    {
+        return {};
+    }
+    return _run;
+}
+
 // Routine Description:
 // - Helper for entry to the state machine. Will take an array of characters
 //     and print as many as it can without encountering a character indicating
@@ -1279,6 +1937,23 @@ void StateMachine::ProcessString(const std::wstring_view string)
 
         if (_processingIndividually)
         {
+            if (_state == VTStates::DcsPassThrough)
+            {
+                // The payload of a DCS can be megabytes long, so rather than
+                //   a character at a time, pass it on in runs, up to the next
+                //   character that ends the string or needs to be ignored.
+                const auto payload = string.substr(current);
+                const auto end = std::find_if_not(payload.cbegin(), payload.cend(), _isDcsPassThroughValue);
+                const auto length = static_cast<size_t>(end - payload.cbegin());
+                if (length > 0)
+                {
+                    _ActionDcsPut(payload.substr(0, length));
+                    current += length;
+                    start = current;
+                    continue;
+                }
+            }
+
             // If we're processing characters individually, send it to the state machine.
             ProcessCharacter(string.at(current));
             ++current;
@@ -1287,6 +1962,13 @@ void StateMachine::ProcessString(const std::wstring_view string)
                 _processingIndividually = false;
                 start = current;
             }
+            else if (_state == VTStates::DcsPassThrough)
+            {
+                // The start of the DCS has been dealt with when it was hooked,
+                //   and its payload goes straight to the engine, so none of it
+                //   is part of a sequence that might have to be flushed later.
+                start = current;
+            }
         }
         else
         {
@@ -1326,6 +2008,16 @@ void StateMachine::ProcessString(const std::wstring_view string)
         _engine->ActionPrintString(_run);
         _trace.DispatchPrintRunTrace(_run);
     }
+    else if (_processingIndividually && _run.empty())
+    {
+        // This only happens in the payload of a DCS, all of which has been
+        //   passed on already. An engine that expects every string to be
+        //   complete is done with it now, everyone else waits for the rest.
+        if (_engine->FlushAtEndOfString())
+        {
+            ResetState();
+        }
+    }
     else if (_processingIndividually)
     {
         // One of the "weird things" in VT input is the case of something like
@@ -1372,6 +2064,7 @@ void StateMachine::ProcessString(const std::wstring_view string)
             case VTStates::CsiIntermediate:
             case VTStates::CsiIgnore:
             case VTStates::CsiParam:
+            case VTStates::CsiSubParam:
                 _ActionCsiDispatch(*wchIter);
                 break;
             case VTStates::OscParam:
@@ -1383,6 +2076,16 @@ void StateMachine::ProcessString(const std::wstring_view string)
             case VTStates::Ss3Param:
                 _ActionSs3Dispatch(*wchIter);
                 break;
+            case VTStates::DcsEntry:
+            case VTStates::DcsParam:
+            case VTStates::DcsIntermediate:
+            case VTStates::DcsIgnore:
+            case VTStates::DcsPassThrough:
+            case VTStates::DcsTermination:
+                // A device control string can't be dispatched before it's
+                //   complete, so an unfinished one is dropped.
+                _ActionDcsUnhook(true);
+                break;
             }
             // microsoft/terminal#2746: Make sure to return to the ground state
             // after dispatching the characters
@@ -1392,8 +2095,18 @@ void StateMachine::ProcessString(const std::wstring_view string)
         {
             // If the engine doesn't require flushing at the end of the string, we
             // want to cache the partial sequence in case we have to flush the whole
-            // thing to the terminal later.
-            _cachedSequence = _cachedSequence.value_or(std::wstring{}) + std::wstring{ _run };
+            // thing to the terminal later. It's appended in place, so that a long
+            // sequence that trickles in a few characters at a time still only
+            // takes linear time.
+            if (_cachedSequenceOverflowed || _cachedSequence.size() + _run.size() > _maxSequenceLength)
+            {
+                _ClearSequenceBuffer(_cachedSequence);
+                _cachedSequenceOverflowed = true;
+            }
+            else
+            {
+                _cachedSequence.append(_run);
+            }
         }
     }
 }
@@ -1408,9 +2121,49 @@ void StateMachine::ProcessString(const std::wstring_view string)
 // - <none>
 void StateMachine::ResetState() noexcept
 {
+    // Let the engine know if this cuts a device control string short.
+    try
+    {
+        _ActionDcsUnhook(true);
+    }
+    CATCH_LOG();
+
     _EnterGround();
 }
 
+// Routine Description:
+// - Sets how many characters of a single sequence we keep around at most,
+//   either for its OSC string or to pass it through later. Longer sequences
+//   are dropped.
+// Arguments:
+// - length - The maximum number of characters.
+// Return Value:
+// - <none>
+void StateMachine::SetMaxSequenceLength(const size_t length) noexcept
+{
+    _maxSequenceLength = length;
+}
+
+// Routine Description:
+// - Empties one of the buffers that the current sequence is kept in. It keeps
+//   its memory for the next sequence, unless a very long one left it unusually
+//   large.
+// Arguments:
+// - buffer - The buffer to empty.
+// Return Value:
+// - <none>
+void StateMachine::_ClearSequenceBuffer(std::wstring& buffer) noexcept
+{
+    if (buffer.capacity() > RetainedSequenceCapacity)
+    {
+        std::wstring{}.swap(buffer);
+    }
+    else
+    {
+        buffer.clear();
+    }
+}
+
 // Routine Description:
 // - Takes the given printable character and accumulates it as the new ones digit
 //   into the given size_t. All existing value is moved up by 10.
@@ -1434,3 +2187,44 @@ void StateMachine::_AccumulateTo(const wchar_t wch, size_t& value) noexcept
         value = MAX_PARAMETER_VALUE;
     }
 }
+
+// Routine Description:
+// - Starts a new parameter with the value 0, with no sub-parameters yet.
+// - If there's no room for any more values, sets _parametersOverflowed instead.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_PushParameter() noexcept
+{
+    if (_parameterCount + _subParameterCount >= MAX_PARAMETER_COUNT)
+    {
+        _parametersOverflowed = true;
+        return;
+    }
+
+    // The sub-parameters of this parameter will start after all those we have so far.
+    til::at(_subParameterEnds, _parameterCount) = static_cast<BYTE>(_subParameterCount);
+    til::at(_parameters, _parameterCount) = 0;
+    ++_parameterCount;
+}
+
+// Routine Description:
+// - Starts a new sub-parameter of the last parameter, with the value 0.
+// - If there's no room for any more values, sets _parametersOverflowed instead.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void StateMachine::_PushSubParameter() noexcept
+{
+    if (_parameterCount + _subParameterCount >= MAX_PARAMETER_COUNT)
+    {
+        _parametersOverflowed = true;
+        return;
+    }
+
+    til::at(_subParameters, _subParameterCount) = 0;
+    ++_subParameterCount;
+    til::at(_subParameterEnds, _parameterCount - 1)++;
+}
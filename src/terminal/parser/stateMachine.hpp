@@ -17,6 +17,7 @@ Abstract:
 #include "IStateMachineEngine.hpp"
 #include "telemetry.hpp"
 #include "tracing.hpp"
+#include <array>
 #include <memory>
 
 namespace Microsoft::Console::VirtualTerminal
@@ -27,6 +28,16 @@ namespace Microsoft::Console::VirtualTerminal
     // but for now 32767 is the safest limit for our existing code base.
     constexpr size_t MAX_PARAMETER_VALUE = 32767;
 
+    // No sequence we know of uses more than two intermediates. A sequence
+    // with more than this many isn't dispatched at all.
+    constexpr size_t MAX_INTERMEDIATE_COUNT = 4;
+
+    // A sequence is dropped when the characters we'd have to keep around for
+    // it grow past this, either its OSC string or what's cached of it in case
+    // it has to be passed through. The parser still follows it up to its end,
+    // so that it picks up again right after it.
+    constexpr size_t DEFAULT_MAX_SEQUENCE_LENGTH = 4 * 1024 * 1024;
+
     class StateMachine final
     {
 #ifdef UNIT_TESTING
@@ -41,9 +52,13 @@ namespace Microsoft::Console::VirtualTerminal
         void ProcessString(const std::wstring_view string);
 
         void ResetState() noexcept;
+        void SetMaxSequenceLength(const size_t length) noexcept;
 
         bool FlushToTerminal();
 
+        bool IsInGroundState() const noexcept;
+        std::wstring_view GetDispatchingSequence() const noexcept;
+
         const IStateMachineEngine& Engine() const noexcept;
         IStateMachineEngine& Engine() noexcept;
 
@@ -54,11 +69,15 @@ namespace Microsoft::Console::VirtualTerminal
         void _ActionEscDispatch(const wchar_t wch);
         void _ActionCollect(const wchar_t wch);
         void _ActionParam(const wchar_t wch);
+        void _ActionSubParam(const wchar_t wch) noexcept;
         void _ActionCsiDispatch(const wchar_t wch);
         void _ActionOscParam(const wchar_t wch) noexcept;
         void _ActionOscPut(const wchar_t wch);
         void _ActionOscDispatch(const wchar_t wch);
         void _ActionSs3Dispatch(const wchar_t wch);
+        void _ActionDcsHook(const wchar_t wch);
+        void _ActionDcsPut(const std::wstring_view string);
+        void _ActionDcsUnhook(const bool aborted);
 
         void _ActionClear();
         void _ActionIgnore() noexcept;
@@ -68,6 +87,7 @@ namespace Microsoft::Console::VirtualTerminal
         void _EnterEscapeIntermediate() noexcept;
         void _EnterCsiEntry();
         void _EnterCsiParam() noexcept;
+        void _EnterCsiSubParam() noexcept;
         void _EnterCsiIgnore() noexcept;
         void _EnterCsiIntermediate() noexcept;
         void _EnterOscParam() noexcept;
@@ -75,6 +95,12 @@ namespace Microsoft::Console::VirtualTerminal
         void _EnterOscTermination() noexcept;
         void _EnterSs3Entry();
         void _EnterSs3Param() noexcept;
+        void _EnterDcsEntry();
+        void _EnterDcsParam() noexcept;
+        void _EnterDcsIgnore() noexcept;
+        void _EnterDcsIntermediate() noexcept;
+        void _EnterDcsPassThrough() noexcept;
+        void _EnterDcsTermination() noexcept;
 
         void _EventGround(const wchar_t wch);
         void _EventEscape(const wchar_t wch);
@@ -83,13 +109,23 @@ namespace Microsoft::Console::VirtualTerminal
         void _EventCsiIntermediate(const wchar_t wch);
         void _EventCsiIgnore(const wchar_t wch);
         void _EventCsiParam(const wchar_t wch);
+        void _EventCsiSubParam(const wchar_t wch);
         void _EventOscParam(const wchar_t wch) noexcept;
         void _EventOscString(const wchar_t wch);
         void _EventOscTermination(const wchar_t wch);
         void _EventSs3Entry(const wchar_t wch);
         void _EventSs3Param(const wchar_t wch);
+        void _EventDcsEntry(const wchar_t wch);
+        void _EventDcsParam(const wchar_t wch);
+        void _EventDcsIntermediate(const wchar_t wch);
+        void _EventDcsIgnore(const wchar_t wch) noexcept;
+        void _EventDcsPassThrough(const wchar_t wch);
+        void _EventDcsTermination(const wchar_t wch);
 
         void _AccumulateTo(const wchar_t wch, size_t& value) noexcept;
+        void _PushParameter() noexcept;
+        void _PushSubParameter() noexcept;
+        static void _ClearSequenceBuffer(std::wstring& buffer) noexcept;
 
         enum class VTStates
         {
@@ -100,11 +136,18 @@ namespace Microsoft::Console::VirtualTerminal
             CsiIntermediate,
             CsiIgnore,
             CsiParam,
+            CsiSubParam,
             OscParam,
             OscString,
             OscTermination,
             Ss3Entry,
-            Ss3Param
+            Ss3Param,
+            DcsEntry,
+            DcsParam,
+            DcsIntermediate,
+            DcsIgnore,
+            DcsPassThrough,
+            DcsTermination
         };
 
         Microsoft::Console::VirtualTerminal::ParserTracing _trace;
@@ -115,13 +158,34 @@ namespace Microsoft::Console::VirtualTerminal
 
         std::wstring_view _run;
 
-        std::vector<wchar_t> _intermediates;
-        std::vector<size_t> _parameters;
-
+        // These are fixed in size, so that parsing a sequence never allocates.
+        std::array<wchar_t, MAX_INTERMEDIATE_COUNT> _intermediates;
+        size_t _intermediateCount;
+        bool _intermediatesOverflowed;
+
+        std::array<size_t, MAX_PARAMETER_COUNT> _parameters;
+        size_t _parameterCount;
+        std::array<size_t, MAX_PARAMETER_COUNT> _subParameters;
+        size_t _subParameterCount;
+        std::array<BYTE, MAX_PARAMETER_COUNT> _subParameterEnds;
+        // Set once a value didn't fit. The digits of values that don't fit go nowhere.
+        bool _parametersOverflowed;
+
+        // The buffers below are cleared between sequences, but keep their
+        //   memory for the next one, so that they rarely need to grow.
         std::wstring _oscString;
         size_t _oscParameter;
+        bool _oscStringOverflowed;
+
+        // Set while the engine takes the payload of the current DCS.
+        bool _dcsHooked;
+
+        // The part of the current sequence that came in with earlier calls to
+        //   ProcessString, in case it has to be passed through after all.
+        std::wstring _cachedSequence;
+        bool _cachedSequenceOverflowed;
 
-        std::optional<std::wstring> _cachedSequence;
+        size_t _maxSequenceLength;
 
         // This is tracked per state machine instance so that separate calls to Process*
         //   can start and finish a sequence.
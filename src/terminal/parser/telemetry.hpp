@@ -89,6 +89,10 @@ namespace Microsoft::Console::VirtualTerminal
             OSCFG,
             OSCBG,
             DECALN,
+            DECCRA,
+            DECFRA,
+            DECERA,
+            DECSERA,
             // Only use this last enum as a count of the number of codes.
             NUMBER_OF_CODES
         };
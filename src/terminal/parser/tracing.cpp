@@ -6,6 +6,8 @@
 
 using namespace Microsoft::Console::VirtualTerminal;
 
+#ifdef PARSER_TRACING_ENABLED
+
 #pragma warning(push)
 #pragma warning(disable : 26494) // _Tlgdata uninitialized from TraceLoggingWrite
 #pragma warning(disable : 26477) // Use nullptr instead of NULL or 0 from TraceLoggingWrite
@@ -130,3 +132,5 @@ void ParserTracing::DispatchPrintRunTrace(const std::wstring_view string) const
 }
 
 #pragma warning(pop)
+
+#endif
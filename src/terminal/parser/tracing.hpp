@@ -16,11 +16,23 @@ Abstract:
 
 #include "telemetry.hpp"
 
+// The state machine traces every character, event, action and state change.
+// Even with no trace session listening, each of those costs a call and an
+// enabled check, on every character of output. So the tracing is only compiled
+// into debug builds, and builds that define PARSER_TRACING. Everywhere else the
+// methods below are empty, and the calls to them compile away.
+#if DBG || defined(PARSER_TRACING)
+#define PARSER_TRACING_ENABLED
+#endif
+
 namespace Microsoft::Console::VirtualTerminal
 {
     class ParserTracing sealed
     {
     public:
+#ifdef PARSER_TRACING_ENABLED
+        static constexpr bool IsEnabled = true;
+
         ParserTracing() noexcept;
 
         void TraceStateChange(const std::wstring_view name) const noexcept;
@@ -37,5 +49,22 @@ namespace Microsoft::Console::VirtualTerminal
 
     private:
         std::wstring _sequenceTrace;
+#else
+        static constexpr bool IsEnabled = false;
+
+        constexpr ParserTracing() noexcept = default;
+
+        void TraceStateChange(const std::wstring_view /*name*/) const noexcept {}
+        void TraceOnAction(const std::wstring_view /*name*/) const noexcept {}
+        void TraceOnExecute(const wchar_t /*wch*/) const noexcept {}
+        void TraceOnExecuteFromEscape(const wchar_t /*wch*/) const noexcept {}
+        void TraceOnEvent(const std::wstring_view /*name*/) const noexcept {}
+        void TraceCharInput(const wchar_t /*wch*/) noexcept {}
+
+        void AddSequenceTrace(const wchar_t /*wch*/) noexcept {}
+        void DispatchSequenceTrace(const bool /*fSuccess*/) noexcept {}
+        void ClearSequenceTrace() noexcept {}
+        void DispatchPrintRunTrace(const std::wstring_view /*string*/) const noexcept {}
+#endif
     };
 }
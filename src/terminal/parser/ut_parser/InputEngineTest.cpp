@@ -257,6 +257,7 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
     TEST_METHOD(AltCtrlDTest);
     TEST_METHOD(AltIntermediateTest);
     TEST_METHOD(AltBackspaceEnterTest);
+    TEST_METHOD(BracketedPasteTest);
     TEST_METHOD(SGRMouseTest_ButtonClick);
     TEST_METHOD(SGRMouseTest_Modifiers);
     TEST_METHOD(SGRMouseTest_Movement);
@@ -1014,6 +1015,76 @@ void InputEngineTest::AltBackspaceEnterTest()
     VerifyExpectedInputDrained();
 }
 
+void InputEngineTest::BracketedPasteTest()
+{
+    auto pfn = std::bind(&TestState::TestInputCallback, &testState, std::placeholders::_1);
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    auto _stateMachine = std::make_unique<StateMachine>(std::move(inputEngine));
+    VERIFY_IS_NOT_NULL(_stateMachine);
+    testState._stateMachine = _stateMachine.get();
+
+    Log::Comment(L"The paste markers aren't keys, they shouldn't write any input.");
+    _stateMachine->ProcessString(L"\x1b[200~");
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::Ground, _stateMachine->_state);
+
+    INPUT_RECORD inputRec;
+    inputRec.EventType = KEY_EVENT;
+    inputRec.Event.KeyEvent.bKeyDown = TRUE;
+    inputRec.Event.KeyEvent.dwControlKeyState = 0;
+    inputRec.Event.KeyEvent.wRepeatCount = 1;
+    inputRec.Event.KeyEvent.wVirtualKeyCode = 'A';
+    inputRec.Event.KeyEvent.wVirtualScanCode = static_cast<WORD>(MapVirtualKeyW('A', MAPVK_VK_TO_VSC));
+    inputRec.Event.KeyEvent.uChar.UnicodeChar = L'a';
+    testState.vExpectedInput.push_back(inputRec);
+    _stateMachine->ProcessString(L"a");
+
+    INPUT_RECORD enter = inputRec;
+    enter.Event.KeyEvent.wVirtualKeyCode = VK_RETURN;
+    enter.Event.KeyEvent.wVirtualScanCode = static_cast<WORD>(MapVirtualKeyW(VK_RETURN, MAPVK_VK_TO_VSC));
+    enter.Event.KeyEvent.uChar.UnicodeChar = L'\r';
+
+    INPUT_RECORD lineFeed = enter;
+    lineFeed.Event.KeyEvent.uChar.UnicodeChar = L'\n';
+    lineFeed.Event.KeyEvent.dwControlKeyState = LEFT_CTRL_PRESSED;
+
+    Log::Comment(L"A pasted CRLF is a single Enter, like in conhost's own paste.");
+    testState.vExpectedInput.push_back(enter);
+    _stateMachine->ProcessString(L"\r");
+    _stateMachine->ProcessString(L"\n");
+    VerifyExpectedInputDrained();
+
+    Log::Comment(L"A lone pasted LF is a Ctrl+Enter, which cooked reads keep as text.");
+    testState.vExpectedInput.push_back(inputRec);
+    _stateMachine->ProcessString(L"a");
+    testState.vExpectedInput.push_back(lineFeed);
+    _stateMachine->ProcessString(L"\n");
+
+    _stateMachine->ProcessString(L"\x1b[201~");
+    VERIFY_ARE_EQUAL(StateMachine::VTStates::Ground, _stateMachine->_state);
+
+    Log::Comment(L"Once the paste is over, the LF of a CRLF is a key of its own again.");
+    testState.vExpectedInput.push_back(enter);
+    _stateMachine->ProcessString(L"\r");
+    testState.vExpectedInput.push_back(lineFeed);
+    _stateMachine->ProcessString(L"\n");
+
+    Log::Comment(L"A key sequence ends a paste whose end marker got lost.");
+    _stateMachine->ProcessString(L"\x1b[200~");
+    INPUT_RECORD up = inputRec;
+    up.Event.KeyEvent.wVirtualKeyCode = VK_UP;
+    up.Event.KeyEvent.wVirtualScanCode = static_cast<WORD>(MapVirtualKeyW(VK_UP, MAPVK_VK_TO_VSC));
+    up.Event.KeyEvent.uChar.UnicodeChar = L'\0';
+    testState.vExpectedInput.push_back(up);
+    _stateMachine->ProcessString(L"\x1b[A");
+    testState.vExpectedInput.push_back(enter);
+    _stateMachine->ProcessString(L"\r");
+    testState.vExpectedInput.push_back(lineFeed);
+    _stateMachine->ProcessString(L"\n");
+
+    VerifyExpectedInputDrained();
+}
+
 // Method Description:
 // - Writes an SGR VT sequence based on the necessary parameters
 // Arguments:
@@ -10,6 +10,8 @@
 
 #include "ascii.hpp"
 
+#include <chrono>
+
 using namespace Microsoft::Console::VirtualTerminal;
 
 using namespace WEX::Common;
@@ -307,7 +309,7 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
             mach.ProcessCharacter((wchar_t)(L'1' + i));
             VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
         }
-        VERIFY_ARE_EQUAL(mach._parameters.back(), 12345u);
+        VERIFY_ARE_EQUAL(til::at(mach._parameters, mach._parameterCount - 1), 12345u);
         mach.ProcessCharacter(L'J');
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
@@ -323,7 +325,9 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Escape);
         mach.ProcessCharacter(L'[');
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiEntry);
-        mach.ProcessCharacter(L':');
+        mach.ProcessCharacter(L'4');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
+        mach.ProcessCharacter(L'?');
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiIgnore);
         mach.ProcessCharacter(L'3');
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiIgnore);
@@ -338,7 +342,7 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
         mach.ProcessCharacter(L';');
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
-        mach.ProcessCharacter(L':');
+        mach.ProcessCharacter(L'>');
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiIgnore);
         mach.ProcessCharacter(L'8');
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiIgnore);
@@ -361,6 +365,102 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
 
+    TEST_METHOD(TestCsiSubParam)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+        mach.ProcessCharacter(AsciiChars::ESC);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Escape);
+        mach.ProcessCharacter(L'[');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiEntry);
+        mach.ProcessCharacter(L'3');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
+        mach.ProcessCharacter(L'8');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
+        mach.ProcessCharacter(L':');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiSubParam);
+        mach.ProcessCharacter(L'2');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiSubParam);
+        mach.ProcessCharacter(L':');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiSubParam);
+        mach.ProcessCharacter(L':');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiSubParam);
+        mach.ProcessCharacter(L'1');
+        mach.ProcessCharacter(L'0');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiSubParam);
+        mach.ProcessCharacter(L';');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
+        mach.ProcessCharacter(L'1');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
+        mach.ProcessCharacter(L';');
+        mach.ProcessCharacter(L':');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiSubParam);
+        mach.ProcessCharacter(L'5');
+
+        VERIFY_ARE_EQUAL(3u, mach._parameterCount);
+        VERIFY_ARE_EQUAL(38u, til::at(mach._parameters, 0));
+        VERIFY_ARE_EQUAL(1u, til::at(mach._parameters, 1));
+        VERIFY_ARE_EQUAL(0u, til::at(mach._parameters, 2));
+        VERIFY_ARE_EQUAL(4u, mach._subParameterCount);
+        VERIFY_ARE_EQUAL(2u, til::at(mach._subParameters, 0));
+        VERIFY_ARE_EQUAL(0u, til::at(mach._subParameters, 1));
+        VERIFY_ARE_EQUAL(10u, til::at(mach._subParameters, 2));
+        VERIFY_ARE_EQUAL(5u, til::at(mach._subParameters, 3));
+
+        mach.ProcessCharacter(L'm');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+
+        Log::Comment(L"A sub-parameter can start the parameters, too.");
+        mach.ProcessCharacter(AsciiChars::ESC);
+        mach.ProcessCharacter(L'[');
+        mach.ProcessCharacter(L':');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiSubParam);
+        VERIFY_ARE_EQUAL(1u, mach._parameterCount);
+        VERIFY_ARE_EQUAL(1u, mach._subParameterCount);
+        mach.ProcessCharacter(L'?');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiIgnore);
+        mach.ProcessCharacter(L'm');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+    }
+
+    TEST_METHOD(TestCsiMaxParamCount)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"Values beyond the limit are dropped, including their digits.");
+        mach.ProcessCharacter(AsciiChars::ESC);
+        mach.ProcessCharacter(L'[');
+        for (size_t i = 0; i < MAX_PARAMETER_COUNT + 8; i++)
+        {
+            mach.ProcessCharacter(L'1');
+            mach.ProcessCharacter(i % 2 ? L';' : L':');
+        }
+        mach.ProcessCharacter(L'7');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiParam);
+        VERIFY_IS_TRUE(mach._parametersOverflowed);
+        VERIFY_ARE_EQUAL(MAX_PARAMETER_COUNT, mach._parameterCount + mach._subParameterCount);
+        for (size_t i = 0; i < mach._parameterCount; i++)
+        {
+            VERIFY_ARE_EQUAL(1u, til::at(mach._parameters, i));
+        }
+        mach.ProcessCharacter(L'm');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+
+        Log::Comment(L"The next sequence starts over.");
+        mach.ProcessString(L"\x1b[12;34");
+        VERIFY_IS_FALSE(mach._parametersOverflowed);
+        VERIFY_ARE_EQUAL(2u, mach._parameterCount);
+        VERIFY_ARE_EQUAL(0u, mach._subParameterCount);
+        VERIFY_ARE_EQUAL(34u, til::at(mach._parameters, 1));
+        mach.ProcessCharacter(L'H');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+    }
+
     TEST_METHOD(TestOscStringSimple)
     {
         auto dispatch = std::make_unique<DummyDispatch>();
@@ -452,6 +552,170 @@ class Microsoft::Console::VirtualTerminal::OutputEngineTest final
         VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
     }
 
+    TEST_METHOD(TestOscStringOverflow)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+        mach.SetMaxSequenceLength(16);
+
+        mach.ProcessString(L"\x1b]0;");
+        for (int i = 0; i < 20; i++)
+        {
+            mach.ProcessCharacter(L's');
+            VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::OscString);
+        }
+        VERIFY_ARE_EQUAL(mach._oscString.size(), 16u);
+        VERIFY_IS_TRUE(mach._oscStringOverflowed);
+
+        Log::Comment(L"The sequence ends as usual, and the next one starts over.");
+        mach.ProcessCharacter(AsciiChars::BEL);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+        mach.ProcessString(L"\x1b]0;s");
+        VERIFY_ARE_EQUAL(mach._oscString.size(), 1u);
+        VERIFY_IS_FALSE(mach._oscStringOverflowed);
+    }
+
+    TEST_METHOD(TestLongOscStringOneCharacterAtATime)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"Feeds a 1MB OSC string one write at a time. Each write caches "
+                     L"the character in case the sequence needs to be passed through, "
+                     L"which must append to the cache instead of copying what's in it.");
+        constexpr size_t length = 1024 * 1024;
+        const std::wstring_view character{ L"s" };
+
+        mach.ProcessString(L"\x1b]0;");
+
+        size_t reallocations = 0;
+        auto cache = mach._cachedSequence.data();
+        for (size_t i = 0; i < length; i++)
+        {
+            mach.ProcessString(character);
+            if (mach._cachedSequence.data() != cache)
+            {
+                cache = mach._cachedSequence.data();
+                reallocations++;
+            }
+        }
+
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::OscString);
+        VERIFY_ARE_EQUAL(mach._oscString.size(), length);
+        VERIFY_ARE_EQUAL(mach._cachedSequence.size(), length + 4);
+
+        // Appending grows the cache geometrically, so it moves a few dozen
+        // times at most. Copying it on every write would move it every time.
+        Log::Comment(NoThrowString().Format(L"The cache moved %zu times", reallocations));
+        VERIFY_IS_LESS_THAN(reallocations, size_t{ 64 });
+
+        mach.ProcessString(L"\x07");
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+        VERIFY_IS_TRUE(mach._cachedSequence.empty());
+    }
+
+    TEST_METHOD(TestDcsString)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+        mach.ProcessCharacter(AsciiChars::ESC);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Escape);
+        mach.ProcessCharacter(L'P');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsEntry);
+        mach.ProcessCharacter(L'1');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsParam);
+        mach.ProcessCharacter(L';');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsParam);
+        mach.ProcessCharacter(L'2');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsParam);
+        mach.ProcessCharacter(L'$');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsIntermediate);
+        mach.ProcessCharacter(L'q');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsPassThrough);
+        mach.ProcessCharacter(L's');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsPassThrough);
+        mach.ProcessCharacter(AsciiChars::LF);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsPassThrough);
+        mach.ProcessCharacter(AsciiChars::BEL);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsPassThrough);
+        mach.ProcessCharacter(AsciiChars::ESC);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsTermination);
+        mach.ProcessCharacter(L'\\');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+
+        Log::Comment(L"A C1 DCS, terminated by a C1 ST.");
+        mach.ProcessCharacter(L'\x90');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsEntry);
+        mach.ProcessCharacter(L'q');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsPassThrough);
+        mach.ProcessCharacter(L's');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsPassThrough);
+        mach.ProcessCharacter(L'\x9c');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+    }
+
+    TEST_METHOD(TestDcsIgnore)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+        mach.ProcessCharacter(AsciiChars::ESC);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Escape);
+        mach.ProcessCharacter(L'P');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsEntry);
+        mach.ProcessCharacter(L'1');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsParam);
+        mach.ProcessCharacter(L':');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsIgnore);
+        mach.ProcessCharacter(L'q');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsIgnore);
+        mach.ProcessCharacter(AsciiChars::ESC);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsTermination);
+        mach.ProcessCharacter(L'\\');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+
+        mach.ProcessCharacter(AsciiChars::ESC);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Escape);
+        mach.ProcessCharacter(L'P');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsEntry);
+        mach.ProcessCharacter(L'$');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsIntermediate);
+        mach.ProcessCharacter(L'1');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsIgnore);
+        mach.ProcessCharacter(L'\x9c');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+    }
+
+    TEST_METHOD(TestDcsAborted)
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"A CAN aborts the string.");
+        mach.ProcessString(L"\x1bPqs");
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsPassThrough);
+        mach.ProcessCharacter(AsciiChars::CAN);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+
+        Log::Comment(L"An ESC that doesn't start a string terminator aborts the string, and starts a new sequence.");
+        mach.ProcessString(L"\x1bPqs");
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsPassThrough);
+        mach.ProcessCharacter(AsciiChars::ESC);
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::DcsTermination);
+        mach.ProcessCharacter(L'[');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::CsiEntry);
+        mach.ProcessCharacter(L'm');
+        VERIFY_ARE_EQUAL(mach._state, StateMachine::VTStates::Ground);
+    }
+
     TEST_METHOD(NormalTestOscParam)
     {
         auto dispatch = std::make_unique<DummyDispatch>();
@@ -689,6 +953,11 @@ public:
         _numTabs{ 0 },
         _isDECCOLMAllowed{ false },
         _windowWidth{ 80 },
+        _rectangularOperation{ 0 },
+        _rectangularArea{},
+        _targetTop{ 0 },
+        _targetLeft{ 0 },
+        _fillChar{ 0 },
         _options{ s_cMaxOptions, static_cast<DispatchTypes::GraphicsOptions>(s_uiGraphicsCleared) } // fill with cleared option
     {
     }
@@ -990,6 +1259,48 @@ public:
         return true;
     }
 
+    bool CopyRectangularArea(const DispatchTypes::RectangularArea source,
+                             const size_t targetTop,
+                             const size_t targetLeft) noexcept override
+    {
+        _rectangularOperation = L'v';
+        _rectangularArea = source;
+        _targetTop = targetTop;
+        _targetLeft = targetLeft;
+        return true;
+    }
+
+    bool FillRectangularArea(const wchar_t fillChar,
+                             const DispatchTypes::RectangularArea area) noexcept override
+    {
+        _rectangularOperation = L'x';
+        _rectangularArea = area;
+        _fillChar = fillChar;
+        return true;
+    }
+
+    bool EraseRectangularArea(const DispatchTypes::RectangularArea area) noexcept override
+    {
+        _rectangularOperation = L'z';
+        _rectangularArea = area;
+        return true;
+    }
+
+    bool SelectiveEraseRectangularArea(const DispatchTypes::RectangularArea area) noexcept override
+    {
+        _rectangularOperation = L'{';
+        _rectangularArea = area;
+        return true;
+    }
+
+    void VerifyRectangularArea(const size_t top, const size_t left, const size_t bottom, const size_t right)
+    {
+        VERIFY_ARE_EQUAL(top, _rectangularArea.top);
+        VERIFY_ARE_EQUAL(left, _rectangularArea.left);
+        VERIFY_ARE_EQUAL(bottom, _rectangularArea.bottom);
+        VERIFY_ARE_EQUAL(right, _rectangularArea.right);
+    }
+
     size_t _cursorDistance;
     size_t _line;
     size_t _column;
@@ -1030,6 +1341,11 @@ public:
     size_t _numTabs;
     bool _isDECCOLMAllowed;
     size_t _windowWidth;
+    wchar_t _rectangularOperation;
+    DispatchTypes::RectangularArea _rectangularArea;
+    size_t _targetTop;
+    size_t _targetLeft;
+    wchar_t _fillChar;
 
     static const size_t s_cMaxOptions = 16;
     static const size_t s_uiGraphicsCleared = UINT_MAX;
@@ -1727,6 +2043,272 @@ class StateMachineExternalTest final
         VerifyDispatchTypes({ rgExpected, 3 }, *pDispatch);
 
         pDispatch->ClearState();
+
+        Log::Comment(L"Test 6.a: Test an RGB color with sub-parameters, including the color space ID");
+
+        sequence = L"\x1b[38:2::255:128:0;1m";
+        mach.ProcessString(sequence);
+        VERIFY_IS_TRUE(pDispatch->_setGraphics);
+
+        rgExpected[0] = DispatchTypes::GraphicsOptions::ForegroundExtended;
+        rgExpected[1] = DispatchTypes::GraphicsOptions::RGBColorOrFaint;
+        rgExpected[2] = static_cast<DispatchTypes::GraphicsOptions>(255);
+        rgExpected[3] = static_cast<DispatchTypes::GraphicsOptions>(128);
+        rgExpected[4] = static_cast<DispatchTypes::GraphicsOptions>(0);
+        rgExpected[5] = DispatchTypes::GraphicsOptions::BoldBright;
+        VerifyDispatchTypes({ rgExpected, 6 }, *pDispatch);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 6.b: Test an RGB color with sub-parameters, without the color space ID");
+
+        sequence = L"\x1b[48:2:10:20:30m";
+        mach.ProcessString(sequence);
+        VERIFY_IS_TRUE(pDispatch->_setGraphics);
+
+        rgExpected[0] = DispatchTypes::GraphicsOptions::BackgroundExtended;
+        rgExpected[1] = DispatchTypes::GraphicsOptions::RGBColorOrFaint;
+        rgExpected[2] = static_cast<DispatchTypes::GraphicsOptions>(10);
+        rgExpected[3] = static_cast<DispatchTypes::GraphicsOptions>(20);
+        rgExpected[4] = static_cast<DispatchTypes::GraphicsOptions>(30);
+        VerifyDispatchTypes({ rgExpected, 5 }, *pDispatch);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 6.c: Test an indexed color with sub-parameters");
+
+        sequence = L"\x1b[38:5:196;4m";
+        mach.ProcessString(sequence);
+        VERIFY_IS_TRUE(pDispatch->_setGraphics);
+
+        rgExpected[0] = DispatchTypes::GraphicsOptions::ForegroundExtended;
+        rgExpected[1] = DispatchTypes::GraphicsOptions::BlinkOrXterm256Index;
+        rgExpected[2] = static_cast<DispatchTypes::GraphicsOptions>(196);
+        rgExpected[3] = DispatchTypes::GraphicsOptions::Underline;
+        VerifyDispatchTypes({ rgExpected, 4 }, *pDispatch);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 6.d: Test that unsupported sub-parameters don't swallow the options that follow");
+
+        sequence = L"\x1b[38:9:1;38:2:1;4:0;4:3;1:2m";
+        mach.ProcessString(sequence);
+        VERIFY_IS_TRUE(pDispatch->_setGraphics);
+
+        rgExpected[0] = DispatchTypes::GraphicsOptions::NoUnderline;
+        rgExpected[1] = DispatchTypes::GraphicsOptions::Underline;
+        rgExpected[2] = DispatchTypes::GraphicsOptions::BoldBright;
+        VerifyDispatchTypes({ rgExpected, 3 }, *pDispatch);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 6.e: Test that other sequences with sub-parameters aren't dispatched");
+
+        sequence = L"\x1b[3:1H";
+        mach.ProcessString(sequence);
+        VERIFY_IS_FALSE(pDispatch->_cursorPosition);
+
+        sequence = L"\x1b[3;1H";
+        mach.ProcessString(sequence);
+        VERIFY_IS_TRUE(pDispatch->_cursorPosition);
+
+        pDispatch->ClearState();
+    }
+
+    BEGIN_TEST_METHOD(TestCsiDispatchPerformance)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
+    {
+        auto dispatch = std::make_unique<StatefulDispatch>();
+        auto pDispatch = dispatch.get();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"Builds a mix of the control sequences that colorized output uses the most.");
+        std::wstring chunk;
+        constexpr size_t sequencesPerChunk = 1000;
+        for (size_t i = 0; i < sequencesPerChunk / 10; i++)
+        {
+            const auto n = std::to_wstring(i);
+            chunk += L"\x1b[" + n + L";1H";
+            chunk += L"\x1b[1;38;5;" + n + L"m";
+            chunk += L"\x1b[48;2;" + n + L";128;" + n + L"m";
+            chunk += L"\x1b[38:2::" + n + L":64:" + n + L"m";
+            chunk += L"\x1b[0m";
+            chunk += L"\x1b[K";
+            chunk += L"\x1b[?25l";
+            chunk += L"\x1b[?25h";
+            chunk += L"\x1b[" + n + L"C";
+            chunk += L"\x1b[;31;4:3m";
+        }
+
+        constexpr size_t chunkCount = 10000;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < chunkCount; i++)
+        {
+            mach.ProcessString(chunk);
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        VERIFY_IS_TRUE(pDispatch->_setGraphics);
+
+        const auto sequenceCount = sequencesPerChunk * chunkCount;
+        Log::Comment(NoThrowString().Format(L"%zu sequences in %.2fms, %.1fns per sequence",
+                                            sequenceCount,
+                                            elapsed.count(),
+                                            elapsed.count() * 1000000.0 / sequenceCount));
+    }
+
+    BEGIN_TEST_METHOD(TestSessionReplayPerformance)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
+    {
+        auto dispatch = std::make_unique<DummyDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"Builds the output of a vim session: scrolling a file with syntax highlighting, a status line and a command line.");
+        std::wstring vim;
+        for (size_t frame = 0; frame < 100; frame++)
+        {
+            vim += L"\x1b[?25l\x1b[1;23r\x1b[23;1H\r\n\x1b[r";
+            vim += L"\x1b[23;1H\x1b[33m" + std::to_wstring(frame + 23) + L" \x1b[m\x1b[38;5;130mif\x1b[m (\x1b[1;34mcount\x1b[m > 0) { \x1b[32m// keep going\x1b[m\x1b[K";
+            vim += L"\x1b[24;1H\x1b[7m main.cpp [+]\x1b[m\x1b[24;60H" + std::to_wstring(frame) + L",1\x1b[24;75HTop";
+            vim += L"\x1b[" + std::to_wstring(frame % 23 + 1) + L";5H\x1b[?12l\x1b[?25h";
+        }
+
+        Log::Comment(L"Builds the output of an htop session: meters and a process list that gets repainted in place.");
+        std::wstring htop;
+        for (size_t frame = 0; frame < 20; frame++)
+        {
+            htop += L"\x1b[?25l\x1b[H";
+            for (size_t cpu = 0; cpu < 4; cpu++)
+            {
+                htop += L"\x1b[" + std::to_wstring(cpu + 1) + L";3H\x1b[1;36m" + std::to_wstring(cpu) + L"\x1b[m\x1b[1;37m[\x1b[32m||||\x1b[31m||\x1b[30;1m" + std::wstring(frame % 20, L' ') + L"\x1b[37m" + std::to_wstring(frame * 3 % 100) + L"%]\x1b[m";
+            }
+            htop += L"\x1b[6;1H\x1b[30;42m  PID USER      PRI  NI  VIRT   RES   SHR S CPU% MEM%   TIME+  Command\x1b[K\x1b[m";
+            for (size_t row = 0; row < 16; row++)
+            {
+                htop += L"\x1b[" + std::to_wstring(row + 7) + L";1H\x1b[m" + std::to_wstring(1000 + row) + L" \x1b[38;5;245mroot\x1b[m       20   0 \x1b[36m 12.3M\x1b[m  4.1M  3.0M S  0.0  0.1  0:00.42 \x1b[1m/usr/bin/daemon\x1b[m\x1b[K";
+            }
+            htop += L"\x1b[24;1HF1\x1b[30;46mHelp  \x1b[mF2\x1b[30;46mSetup \x1b[mF10\x1b[30;46mQuit\x1b[K\x1b[m";
+        }
+
+        const auto replay = [&](const std::wstring& session, const wchar_t* const name) {
+            constexpr size_t replays = 2000;
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < replays; i++)
+            {
+                mach.ProcessString(session);
+            }
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            const auto characterCount = session.size() * replays;
+            Log::Comment(NoThrowString().Format(L"%s: %zu characters in %.2fms, %.2fns per character",
+                                                name,
+                                                characterCount,
+                                                elapsed.count(),
+                                                elapsed.count() * 1000000.0 / characterCount));
+        };
+        replay(vim, L"vim");
+        replay(htop, L"htop");
+    }
+
+    BEGIN_TEST_METHOD(TestParserTracingPerformance)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
+    {
+        auto dispatch = std::make_unique<StatefulDispatch>();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        // The parser traces each character it sees, so this measures the cost
+        // per character of colorized text. Run it in a build with the tracing
+        // compiled in and in one without, to compare the two.
+        Log::Comment(NoThrowString().Format(L"Parser tracing is %s in this build.",
+                                            ParserTracing::IsEnabled ? L"compiled in" : L"compiled out"));
+
+        std::wstring chunk;
+        for (size_t i = 0; i < 100; i++)
+        {
+            chunk += L"\x1b[3" + std::to_wstring(i % 8) + L"m";
+            chunk += L"The quick brown fox jumps over the lazy dog.\r\n";
+        }
+
+        constexpr size_t chunkCount = 20000;
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < chunkCount; i++)
+        {
+            mach.ProcessString(chunk);
+        }
+        const std::chrono::duration<double, std::milli> stringElapsed = std::chrono::steady_clock::now() - start;
+
+        const auto characterStart = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < chunkCount; i++)
+        {
+            for (const auto wch : chunk)
+            {
+                mach.ProcessCharacter(wch);
+            }
+        }
+        const std::chrono::duration<double, std::milli> characterElapsed = std::chrono::steady_clock::now() - characterStart;
+
+        const auto characterCount = chunk.size() * chunkCount;
+        Log::Comment(NoThrowString().Format(L"ProcessString: %zu characters in %.2fms, %.2fns per character",
+                                            characterCount,
+                                            stringElapsed.count(),
+                                            stringElapsed.count() * 1000000.0 / characterCount));
+        Log::Comment(NoThrowString().Format(L"ProcessCharacter: %zu characters in %.2fms, %.2fns per character",
+                                            characterCount,
+                                            characterElapsed.count(),
+                                            characterElapsed.count() * 1000000.0 / characterCount));
+    }
+
+    TEST_METHOD(TestDispatchByIntermediate)
+    {
+        auto dispatch = std::make_unique<StatefulDispatch>();
+        auto pDispatch = dispatch.get();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"The same final character means a different sequence after each intermediate.");
+        mach.ProcessString(L"\x1b[c");
+        VERIFY_IS_TRUE(pDispatch->_deviceAttributes);
+
+        pDispatch->ClearState();
+
+        mach.ProcessString(L"\x1b[?c");
+        VERIFY_IS_FALSE(pDispatch->_deviceAttributes);
+        mach.ProcessString(L"\x1b[$c");
+        VERIFY_IS_FALSE(pDispatch->_deviceAttributes);
+
+        pDispatch->ClearState();
+
+        mach.ProcessString(L"\x1b[?1h");
+        VERIFY_IS_TRUE(pDispatch->_cursorKeysMode);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Private modes need their intermediate.");
+        mach.ProcessString(L"\x1b[1h");
+        VERIFY_IS_FALSE(pDispatch->_cursorKeysMode);
+        mach.ProcessString(L"\x1b[!1h");
+        VERIFY_IS_FALSE(pDispatch->_cursorKeysMode);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"More than one intermediate isn't anything we handle.");
+        mach.ProcessString(L"\x1b[?$1h");
+        VERIFY_IS_FALSE(pDispatch->_cursorKeysMode);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"The last final character of each table still dispatches.");
+        mach.ProcessString(L"\x1b[;;3;4${");
+        VERIFY_ARE_EQUAL(L'{', pDispatch->_rectangularOperation);
+        pDispatch->VerifyRectangularArea(1, 1, 3, 4);
+
+        pDispatch->ClearState();
     }
 
     TEST_METHOD(TestDeviceStatusReport)
@@ -1804,6 +2386,82 @@ class StateMachineExternalTest final
         pDispatch->ClearState();
     }
 
+    TEST_METHOD(TestRectangularAreaOperations)
+    {
+        auto dispatch = std::make_unique<StatefulDispatch>();
+        auto pDispatch = dispatch.get();
+        auto engine = std::make_unique<OutputStateMachineEngine>(std::move(dispatch));
+        StateMachine mach(std::move(engine));
+
+        Log::Comment(L"Test 1: DECCRA with all parameters. The pages are ignored.");
+        mach.ProcessString(L"\x1b[2;3;4;5;1;6;7;1$v");
+        VERIFY_ARE_EQUAL(L'v', pDispatch->_rectangularOperation);
+        pDispatch->VerifyRectangularArea(2, 3, 4, 5);
+        VERIFY_ARE_EQUAL(6u, pDispatch->_targetTop);
+        VERIFY_ARE_EQUAL(7u, pDispatch->_targetLeft);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 2: DECCRA without parameters. The whole page is copied to the top left.");
+        mach.ProcessString(L"\x1b[$v");
+        VERIFY_ARE_EQUAL(L'v', pDispatch->_rectangularOperation);
+        pDispatch->VerifyRectangularArea(1, 1, 0, 0);
+        VERIFY_ARE_EQUAL(1u, pDispatch->_targetTop);
+        VERIFY_ARE_EQUAL(1u, pDispatch->_targetLeft);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 3: DECCRA with too many parameters. Should fail.");
+        mach.ProcessString(L"\x1b[1;1;1;1;1;1;1;1;1$v");
+        VERIFY_ARE_EQUAL(L'\0', pDispatch->_rectangularOperation);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 4: DECFRA with a printable character.");
+        mach.ProcessString(L"\x1b[65;0;2;;9$x");
+        VERIFY_ARE_EQUAL(L'x', pDispatch->_rectangularOperation);
+        VERIFY_ARE_EQUAL(L'A', pDispatch->_fillChar);
+        pDispatch->VerifyRectangularArea(1, 2, 0, 9);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 5: DECFRA with a character from the upper half of Latin-1.");
+        mach.ProcessString(L"\x1b[233$x");
+        VERIFY_ARE_EQUAL(L'x', pDispatch->_rectangularOperation);
+        VERIFY_ARE_EQUAL(L'\xE9', pDispatch->_fillChar);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 6: DECFRA with a control character, or without one. Should fail.");
+        mach.ProcessString(L"\x1b[7;1;1;2;2$x");
+        VERIFY_ARE_EQUAL(L'\0', pDispatch->_rectangularOperation);
+        mach.ProcessString(L"\x1b[$x");
+        VERIFY_ARE_EQUAL(L'\0', pDispatch->_rectangularOperation);
+        mach.ProcessString(L"\x1b[128$x");
+        VERIFY_ARE_EQUAL(L'\0', pDispatch->_rectangularOperation);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 7: DECERA and DECSERA.");
+        mach.ProcessString(L"\x1b[3;4;5;6$z");
+        VERIFY_ARE_EQUAL(L'z', pDispatch->_rectangularOperation);
+        pDispatch->VerifyRectangularArea(3, 4, 5, 6);
+
+        pDispatch->ClearState();
+
+        mach.ProcessString(L"\x1b[;;5${");
+        VERIFY_ARE_EQUAL(L'{', pDispatch->_rectangularOperation);
+        pDispatch->VerifyRectangularArea(1, 1, 5, 0);
+
+        pDispatch->ClearState();
+
+        Log::Comment(L"Test 8: DECERA with too many parameters. Should fail.");
+        mach.ProcessString(L"\x1b[1;1;1;1;1$z");
+        VERIFY_ARE_EQUAL(L'\0', pDispatch->_rectangularOperation);
+
+        pDispatch->ClearState();
+    }
+
     TEST_METHOD(TestStrings)
     {
         auto dispatch = std::make_unique<StatefulDispatch>();
@@ -7,6 +7,8 @@
 
 #include "stateMachine.hpp"
 
+#include <chrono>
+
 using namespace WEX::Common;
 using namespace WEX::Logging;
 using namespace WEX::TestExecution;
@@ -33,6 +35,10 @@ public:
         printed.clear();
         passedThrough.clear();
         csiParams.reset();
+        dcsParams.reset();
+        dcsPayload.clear();
+        dcsChunks = 0;
+        dcsAborted.reset();
     }
 
     bool ActionExecute(const wchar_t /* wch */) override { return true; };
@@ -72,6 +78,27 @@ public:
     bool ActionSs3Dispatch(const wchar_t /* wch */,
                            const std::basic_string_view<size_t> /* parameters */) override { return true; };
 
+    bool ActionDcsHook(const wchar_t /*wch*/,
+                       const std::basic_string_view<wchar_t> /*intermediates*/,
+                       const std::basic_string_view<size_t> parameters) override
+    {
+        dcsParams.emplace(parameters.cbegin(), parameters.cend());
+        return true;
+    };
+
+    bool ActionDcsPut(const std::wstring_view string) override
+    {
+        dcsPayload += string;
+        dcsChunks++;
+        return true;
+    };
+
+    bool ActionDcsUnhook(const bool aborted) override
+    {
+        dcsAborted = aborted;
+        return true;
+    };
+
     bool FlushAtEndOfString() const override { return false; };
     bool DispatchControlCharsFromEscape() const override { return false; };
     bool DispatchIntermediatesFromEscape() const override { return false; };
@@ -79,7 +106,8 @@ public:
     // ActionCsiDispatch is the only method that's actually implemented.
     bool ActionCsiDispatch(const wchar_t /*wch*/,
                            const std::basic_string_view<wchar_t> /*intermediates*/,
-                           const std::basic_string_view<size_t> parameters) override
+                           const std::basic_string_view<size_t> parameters,
+                           const VTSubParameters /*subParameters*/) override
     {
         // If flush to terminal is registered for a test, then use it.
         if (pfnFlushToTerminal)
@@ -97,6 +125,13 @@ public:
     // This will only be populated if ActionCsiDispatch is called.
     std::optional<std::vector<size_t>> csiParams;
 
+    // These will only be populated if ActionDcsHook, ActionDcsPut and
+    // ActionDcsUnhook are called.
+    std::optional<std::vector<size_t>> dcsParams;
+    std::wstring dcsPayload;
+    size_t dcsChunks{ 0 };
+    std::optional<bool> dcsAborted;
+
     // Flush function for pass-through test.
     std::function<bool()> pfnFlushToTerminal;
 
@@ -127,6 +162,16 @@ class Microsoft::Console::VirtualTerminal::StateMachineTest
     TEST_METHOD(RunStorageBeforeEscape);
     TEST_METHOD(BulkTextPrint);
     TEST_METHOD(PassThroughUnhandledSplitAcrossWrites);
+    TEST_METHOD(PassThroughOverlongSequenceIsDropped);
+    TEST_METHOD(SubParametersOnlyDispatchForSgr);
+
+    TEST_METHOD(DcsPayloadIsStreamed);
+    TEST_METHOD(DcsPayloadSplitAcrossWrites);
+    TEST_METHOD(DcsAbortedByEscapeSequence);
+
+    BEGIN_TEST_METHOD(DcsStreamingThroughput)
+        TEST_METHOD_PROPERTY(L"IsPerfTest", L"true")
+    END_TEST_METHOD()
 };
 
 void StateMachineTest::TwoStateMachinesDoNotInterfereWithEachother()
@@ -244,3 +289,143 @@ void StateMachineTest::PassThroughUnhandledSplitAcrossWrites()
     VERIFY_ARE_EQUAL(L"\x1b]99;foo\x1b\\", engine.passedThrough);
     VERIFY_ARE_EQUAL(L"", engine.printed);
 }
+
+void StateMachineTest::PassThroughOverlongSequenceIsDropped()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+    machine.SetMaxSequenceLength(8);
+
+    // Hook up the passthrough function.
+    engine.pfnFlushToTerminal = std::bind(&StateMachine::FlushToTerminal, &machine);
+
+    // The start of this one is too long to cache, so none of it can be passed through.
+    machine.ProcessString(L"\x1b]99;");
+    machine.ProcessString(L"abcdef");
+    machine.ProcessString(L"\x07");
+    VERIFY_ARE_EQUAL(L"", engine.passedThrough);
+    VERIFY_ARE_EQUAL(L"", engine.printed);
+
+    // The next sequence is passed through as usual again.
+    machine.ProcessString(L"\x1b[?12");
+    machine.ProcessString(L"34h");
+    VERIFY_ARE_EQUAL(L"\x1b[?1234h", engine.passedThrough);
+    VERIFY_ARE_EQUAL(L"", engine.printed);
+}
+
+void StateMachineTest::SubParametersOnlyDispatchForSgr()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    // Hook up the passthrough function.
+    engine.pfnFlushToTerminal = std::bind(&StateMachine::FlushToTerminal, &machine);
+
+    // Other sequences with sub-parameters are ignored, so they aren't passed through either.
+    machine.ProcessString(L"\x1b[3:1H\x1b[?25:1h\x1b[1:2 q");
+    VERIFY_ARE_EQUAL(L"", engine.passedThrough);
+    VERIFY_ARE_EQUAL(L"", engine.printed);
+
+    machine.ProcessString(L"\x1b[38:5:196m");
+    VERIFY_ARE_EQUAL(L"\x1b[38:5:196m", engine.passedThrough);
+    VERIFY_ARE_EQUAL(L"", engine.printed);
+}
+
+void StateMachineTest::DcsPayloadIsStreamed()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    machine.ProcessString(L"\x1bP1;2;3q#0;2;0;0;0#0!10~-\x1b\\after");
+
+    const std::vector<size_t> expectedParams{ 1u, 2u, 3u };
+    VERIFY_ARE_EQUAL(expectedParams, engine.dcsParams);
+    VERIFY_ARE_EQUAL(L"#0;2;0;0;0#0!10~-", engine.dcsPayload);
+    VERIFY_ARE_EQUAL(1u, engine.dcsChunks); // all in one piece, not a character at a time
+    VERIFY_IS_FALSE(engine.dcsAborted.value_or(true));
+    VERIFY_ARE_EQUAL(L"after", engine.printed);
+}
+
+void StateMachineTest::DcsPayloadSplitAcrossWrites()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    machine.ProcessString(L"\x1bP1");
+    VERIFY_IS_FALSE(engine.dcsParams.has_value()); // not hooked yet
+
+    machine.ProcessString(L"2qabc");
+    const std::vector<size_t> expectedParams{ 12u };
+    VERIFY_ARE_EQUAL(expectedParams, engine.dcsParams);
+    VERIFY_ARE_EQUAL(L"abc", engine.dcsPayload); // passed on before the string is complete
+
+    machine.ProcessString(L"def\x1b");
+    VERIFY_ARE_EQUAL(L"abcdef", engine.dcsPayload);
+    VERIFY_IS_FALSE(engine.dcsAborted.has_value());
+
+    machine.ProcessString(L"\\after");
+    VERIFY_ARE_EQUAL(L"abcdef", engine.dcsPayload);
+    VERIFY_IS_FALSE(engine.dcsAborted.value_or(true));
+    VERIFY_ARE_EQUAL(L"after", engine.printed);
+}
+
+void StateMachineTest::DcsAbortedByEscapeSequence()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    machine.ProcessString(L"\x1bPqabc\x1b[1;2Hafter");
+
+    VERIFY_ARE_EQUAL(L"abc", engine.dcsPayload);
+    VERIFY_IS_TRUE(engine.dcsAborted.value_or(false));
+
+    // The escape sequence that aborted the string is processed as usual.
+    const std::vector<size_t> expectedParams{ 1u, 2u };
+    VERIFY_ARE_EQUAL(expectedParams, engine.csiParams);
+    VERIFY_ARE_EQUAL(L"after", engine.printed);
+}
+
+void StateMachineTest::DcsStreamingThroughput()
+{
+    auto enginePtr{ std::make_unique<TestStateMachineEngine>() };
+    // this dance is required because StateMachine presumes to take ownership of its engine.
+    auto& engine{ *enginePtr.get() };
+    StateMachine machine{ std::move(enginePtr) };
+
+    Log::Comment(L"Streams an 8MB DCS payload in 64KB writes, the way a large image would arrive.");
+    constexpr size_t payloadLength = 8 * 1024 * 1024;
+    constexpr size_t writeLength = 64 * 1024;
+    std::wstring write(writeLength, L'~');
+    for (size_t i = 0; i < write.size(); i += 80)
+    {
+        write[i] = L'\n';
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    machine.ProcessString(L"\x1bPq");
+    for (size_t i = 0; i < payloadLength; i += writeLength)
+    {
+        machine.ProcessString(write);
+    }
+    machine.ProcessString(L"\x1b\\");
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    VERIFY_ARE_EQUAL(payloadLength, engine.dcsPayload.size());
+    VERIFY_ARE_EQUAL(payloadLength / writeLength, engine.dcsChunks);
+    VERIFY_IS_FALSE(engine.dcsAborted.value_or(true));
+
+    Log::Comment(NoThrowString().Format(L"%zu characters in %.2fms, %.2f MB/s",
+                                        payloadLength,
+                                        elapsed.count(),
+                                        payloadLength / 1024.0 / 1024.0 / (elapsed.count() / 1000.0)));
+}
@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class SmallVectorTests
+{
+    TEST_CLASS(SmallVectorTests);
+
+    TEST_METHOD(StaysInlineUpToCapacity)
+    {
+        til::small_vector<int, 4> s;
+        VERIFY_IS_TRUE(s.empty());
+        VERIFY_IS_TRUE(s.is_inline());
+
+        for (int i = 0; i < 4; ++i)
+        {
+            s.push_back(i);
+        }
+        VERIFY_ARE_EQUAL(4u, s.size());
+        VERIFY_IS_TRUE(s.is_inline());
+
+        Log::Comment(L"Growing past the inline capacity allocates and keeps the elements.");
+        s.push_back(4);
+        VERIFY_IS_FALSE(s.is_inline());
+        for (int i = 0; i < 5; ++i)
+        {
+            VERIFY_ARE_EQUAL(i, s.at(i));
+        }
+
+        Log::Comment(L"Clearing keeps the allocation.");
+        s.clear();
+        VERIFY_IS_TRUE(s.empty());
+        VERIFY_IS_FALSE(s.is_inline());
+    }
+
+    TEST_METHOD(Equality)
+    {
+        til::small_vector<int, 2> a{ 1, 2 };
+        til::small_vector<int, 2> b{ 1, 2 };
+        VERIFY_IS_TRUE(a == b);
+        VERIFY_IS_FALSE(a != b);
+
+        Log::Comment(L"Where the elements are stored doesn't matter.");
+        til::small_vector<int, 2> c{ 1, 2, 3 };
+        c.pop_back();
+        VERIFY_IS_FALSE(c.is_inline());
+        VERIFY_IS_TRUE(a == c);
+
+        til::small_vector<int, 2> d{ 2, 1 };
+        VERIFY_IS_FALSE(a == d);
+
+        til::small_vector<int, 2> e{ 1 };
+        VERIFY_IS_TRUE(a != e);
+    }
+
+    TEST_METHOD(InsertAndErase)
+    {
+        til::small_vector<int, 4> s{ 1, 5 };
+
+        const std::array<int, 3> middle{ 2, 3, 4 };
+        const auto it = s.insert(s.cbegin() + 1, middle.cbegin(), middle.cend());
+        VERIFY_ARE_EQUAL(2, *it);
+        VERIFY_IS_TRUE((til::small_vector<int, 4>{ 1, 2, 3, 4, 5 } == s));
+
+        s.insert(s.cbegin(), 0);
+        VERIFY_IS_TRUE((til::small_vector<int, 4>{ 0, 1, 2, 3, 4, 5 } == s));
+
+        s.erase(s.cbegin() + 1, s.cbegin() + 4);
+        VERIFY_IS_TRUE((til::small_vector<int, 4>{ 0, 4, 5 } == s));
+
+        s.erase(s.cend() - 1);
+        VERIFY_IS_TRUE((til::small_vector<int, 4>{ 0, 4 } == s));
+    }
+
+    TEST_METHOD(Resize)
+    {
+        til::small_vector<int, 2> s{ 1 };
+        s.resize(3, 7);
+        VERIFY_IS_TRUE((til::small_vector<int, 2>{ 1, 7, 7 } == s));
+
+        s.resize(1);
+        VERIFY_IS_TRUE((til::small_vector<int, 2>{ 1 } == s));
+
+        s.resize(2);
+        VERIFY_IS_TRUE((til::small_vector<int, 2>{ 1, 0 } == s));
+    }
+
+    TEST_METHOD(CopyAndMove)
+    {
+        const til::small_vector<int, 2> small{ 1, 2 };
+        const til::small_vector<int, 2> large{ 1, 2, 3 };
+
+        Log::Comment(L"Copies own their elements.");
+        auto copy = large;
+        copy.at(0) = 9;
+        VERIFY_ARE_EQUAL(1, large.at(0));
+        copy = small;
+        VERIFY_IS_TRUE(small == copy);
+
+        Log::Comment(L"Moving an allocated vector takes its allocation.");
+        auto source = large;
+        const auto data = source.data();
+        til::small_vector<int, 2> moved(std::move(source));
+        VERIFY_ARE_EQUAL(data, moved.data());
+        VERIFY_IS_TRUE(large == moved);
+        VERIFY_IS_TRUE(source.empty());
+        VERIFY_IS_TRUE(source.is_inline());
+
+        Log::Comment(L"Moving an inline vector copies its elements.");
+        auto inlineSource = small;
+        moved = std::move(inlineSource);
+        VERIFY_IS_TRUE(moved.is_inline());
+        VERIFY_IS_TRUE(small == moved);
+        VERIFY_IS_TRUE(inlineSource.empty());
+    }
+
+    TEST_METHOD(OutOfRange)
+    {
+        til::small_vector<int, 2> s{ 1 };
+        VERIFY_THROWS(s.at(1), std::out_of_range);
+
+        s.pop_back();
+        VERIFY_THROWS(s.pop_back(), std::out_of_range);
+    }
+};
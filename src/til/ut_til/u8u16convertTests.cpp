@@ -17,6 +17,7 @@ class Utf8Utf16ConvertTests
     TEST_METHOD(TestU8ToU16Partials);
     TEST_METHOD(TestU16ToU8Partials);
     TEST_METHOD(TestU8ToU16OneByOne);
+    TEST_METHOD(TestU8ToU16AsciiRuns);
 };
 
 void Utf8Utf16ConvertTests::TestU8ToU16()
@@ -191,3 +192,40 @@ void Utf8Utf16ConvertTests::TestU8ToU16OneByOne()
     VERIFY_SUCCEEDED(til::u8u16(u8String1_4, u16Out1, state));
     VERIFY_ARE_EQUAL(u16StringComp1, u16Out1);
 }
+
+void Utf8Utf16ConvertTests::TestU8ToU16AsciiRuns()
+{
+    // ASCII runs of all kinds of lengths, between valid and invalid multi-byte sequences,
+    // so that both the ASCII fast path and MultiByteToWideChar see their share.
+    const std::string asciiRun{ "0123456789abcdefghijklmnopqrstuvwxyz" };
+    std::string u8String{};
+    std::wstring u16StringComp{};
+    for (size_t len = 0; len <= asciiRun.size(); ++len)
+    {
+        u8String.append(asciiRun, 0, len);
+        u16StringComp.append(asciiRun.cbegin(), asciiRun.cbegin() + len);
+
+        u8String.append("\xE2\x82\xAC"); // EURO SIGN (3 bytes)
+        u16StringComp.push_back(gsl::narrow_cast<wchar_t>(0x20ACU));
+
+        if (len % 3 == 0)
+        {
+            u8String.push_back('\xFF'); // never valid in UTF-8
+            u16StringComp.push_back(gsl::narrow_cast<wchar_t>(0xFFFDU)); // REPLACEMENT CHARACTER
+        }
+    }
+
+    std::wstring u16Out{};
+    VERIFY_SUCCEEDED(til::u8u16(u8String, u16Out));
+    VERIFY_ARE_EQUAL(u16StringComp, u16Out);
+
+    // Feeding the same string in pieces of odd sizes must give the same result.
+    til::u8state state{};
+    std::wstring u16Pieces{};
+    for (size_t offset = 0; offset < u8String.size(); offset += 7)
+    {
+        VERIFY_SUCCEEDED(til::u8u16(std::string_view{ u8String }.substr(offset, 7), u16Out, state));
+        u16Pieces.append(u16Out);
+    }
+    VERIFY_ARE_EQUAL(u16StringComp, u16Pieces);
+}
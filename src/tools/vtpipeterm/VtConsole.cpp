@@ -18,10 +18,12 @@
 VtConsole::VtConsole(PipeReadCallback const pfnReadCallback,
                      bool const fHeadless,
                      bool const fUseConpty,
+                     bool const fPassthrough,
                      COORD const initialSize) :
     _pfnReadCallback(pfnReadCallback),
     _fHeadless(fHeadless),
     _fUseConPty(fUseConpty),
+    _fPassthrough(fPassthrough),
     _lastDimensions(initialSize)
 {
     THROW_HR_IF_NULL(E_INVALIDARG, pfnReadCallback);
@@ -128,8 +130,10 @@ void VtConsole::_spawn(const std::wstring& command)
     {
         _createPseudoConsole(command);
     }
-    else if (_fHeadless)
+    else if (_fHeadless && !_fPassthrough)
     {
+        // CreateConPty doesn't know about passthrough mode, so that's
+        // only available when we launch the conhost ourselves.
         _createConptyManually(command);
     }
     else
@@ -227,6 +231,11 @@ void VtConsole::_createConptyViaCommandline(const std::wstring& command)
         cmdline += L" --headless";
     }
 
+    if (_fPassthrough)
+    {
+        cmdline += L" --passthrough";
+    }
+
     // Create some anon pipes so we can pass handles down and into the console.
     // IMPORTANT NOTE:
     // We're creating the pipe here with un-inheritable handles, then marking
@@ -16,6 +16,8 @@
 #include <string>
 #include <sstream>
 #include <assert.h>
+#include <atomic>
+#include <chrono>
 
 #include "VtConsole.hpp"
 
@@ -49,6 +51,14 @@ int lang = TEST_LANG_NONE;
 bool g_headless = false;
 bool g_useConpty = false;
 bool g_useOutfile = false;
+bool g_passthrough = false;
+
+// When measuring, we run the given commandline, and only count how much output
+// came out of conpty until it exits, instead of writing it to the console.
+bool g_measure = false;
+std::wstring g_measureCommand;
+std::atomic<size_t> g_measuredBytes{ 0 };
+std::chrono::steady_clock::time_point g_measureStart;
 std::wstring outfile = L"vtpt.out";
 HANDLE hOutFile = INVALID_HANDLE_VALUE;
 ////////////////////////////////////////////////////////////////////////////////
@@ -62,6 +72,12 @@ void PrintOutputToDebug(std::string& rawOutput);
 
 void ReadCallback(BYTE* buffer, DWORD dwRead)
 {
+    if (g_measure)
+    {
+        g_measuredBytes += dwRead;
+        return;
+    }
+
     // We already set the console to UTF-8 CP, so we can just write straight to it
     bool fSuccess = !!WriteFile(hOut, buffer, dwRead, nullptr, nullptr);
     if (fSuccess && g_useOutfile)
@@ -115,11 +131,32 @@ HANDLE outPipe()
 
 void newConsole()
 {
-    auto con = new VtConsole(ReadCallback, g_headless, g_useConpty, { lastTerminalWidth, lastTerminalHeight });
-    con->spawn();
+    auto con = new VtConsole(ReadCallback, g_headless, g_useConpty, g_passthrough, { lastTerminalWidth, lastTerminalHeight });
+    if (g_measure)
+    {
+        g_measureStart = std::chrono::steady_clock::now();
+        con->spawn(g_measureCommand);
+    }
+    else
+    {
+        con->spawn();
+    }
     consoles.push_back(con);
 }
 
+// The output thread exits the process once the conpty closes its pipe, which
+// is when the measured commandline is done.
+void PrintMeasurement()
+{
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_measureStart).count();
+    const auto bytes = g_measuredBytes.load();
+    printf("\n%s: %zu bytes of VT in %.3fs (%.2f MB/s)\n",
+           g_passthrough ? "passthrough" : "rendered",
+           bytes,
+           elapsed,
+           elapsed > 0 ? bytes / elapsed / (1024 * 1024) : 0.0);
+}
+
 void signalConsole()
 {
     // The 0th console is always our active one.
@@ -550,6 +587,16 @@ int __cdecl wmain(int argc, WCHAR* argv[])
             {
                 fUseDebug = true;
             }
+            else if (arg == std::wstring(L"--passthrough"))
+            {
+                g_passthrough = true;
+            }
+            else if (arg == std::wstring(L"--measure") && i + 1 < argc)
+            {
+                g_measure = true;
+                g_measureCommand = argv[i + 1];
+                i++;
+            }
             else if (arg == std::wstring(L"--out") && i + 1 < argc)
             {
                 g_useOutfile = true;
@@ -576,6 +623,11 @@ int __cdecl wmain(int argc, WCHAR* argv[])
         }
     }
 
+    if (g_measure)
+    {
+        atexit(PrintMeasurement);
+    }
+
     SetupOutput();
     SetupInput();
 
@@ -589,7 +641,7 @@ int __cdecl wmain(int argc, WCHAR* argv[])
     if (fUseDebug)
     {
         // Create a debug console for writing debugging output to.
-        debug = new VtConsole(DebugReadCallback, false, false, { 80, 32 });
+        debug = new VtConsole(DebugReadCallback, false, false, false, { 80, 32 });
         // Echo stdin to stdout, but ignore newlines (so cat doesn't echo the input)
         // debug->spawn(L"ubuntu run tr -d '\n' | cat -sA");
         debug->spawn(L"wsl tr -d '\n' | cat -sA");
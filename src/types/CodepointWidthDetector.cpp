@@ -3,6 +3,7 @@
 
 #include "precomp.h"
 #include "inc/CodepointWidthDetector.hpp"
+#include "inc/Utf16Parser.hpp"
 
 namespace
 {
@@ -313,11 +314,49 @@ namespace
 // Routine Description:
 // - Constructs an instance of the CodepointWidthDetector class
 CodepointWidthDetector::CodepointWidthDetector() noexcept :
+    _bmpWidths{ _getBmpWidthTable() },
     _fallbackCache{},
     _pfnFallbackMethod{}
 {
 }
 
+// Routine Description:
+// - returns the table of BMP codepoint widths, which is shared by all instances and filled in on first use.
+//   Each entry holds what GetWidth would answer for that codepoint without asking the font:
+//   the quick width if it has an opinion, else the width from the unicode table.
+//   Whenever either one of those says Ambiguous, the entry is Ambiguous, so that the font fallback still gets asked.
+// Return Value:
+// - the table, with 4 codepoints per byte.
+const CodepointWidthDetector::BmpWidthTable& CodepointWidthDetector::_getBmpWidthTable() noexcept
+{
+    static const auto table = []() noexcept {
+        BmpWidthTable widths{};
+
+        // The unicode table is sorted, so we can walk it alongside the codepoints instead of searching it every time.
+        auto range = s_wideAndAmbiguousTable.begin();
+        for (unsigned int codepoint = 0; codepoint <= 0xFFFF; ++codepoint)
+        {
+            while (range != s_wideAndAmbiguousTable.end() && range->upperBound < codepoint)
+            {
+                ++range;
+            }
+
+            auto width = GetQuickCharWidth(gsl::narrow_cast<wchar_t>(codepoint));
+            if (width == CodepointWidth::Invalid)
+            {
+                const bool inRange = range != s_wideAndAmbiguousTable.end() && codepoint >= range->lowerBound;
+                width = inRange ? range->width : CodepointWidth::Narrow;
+            }
+
+            til::at(widths, codepoint / 4) |= gsl::narrow_cast<BYTE>(static_cast<BYTE>(width) << (codepoint % 4 * 2));
+        }
+
+        return widths;
+    }();
+
+    return table;
+}
+
 // Routine Description:
 // - returns the width type of codepoint as fast as we can by using quick lookup table and fallback cache.
 // Arguments:
@@ -329,6 +368,13 @@ CodepointWidth CodepointWidthDetector::GetWidth(const std::wstring_view glyph) c
     THROW_HR_IF(E_INVALIDARG, glyph.empty());
     if (glyph.size() == 1)
     {
+        // The BMP table already knows the answer, unless it depends on the font.
+        const auto tableWidth = _getBmpWidth(glyph.front());
+        if (tableWidth != CodepointWidth::Ambiguous)
+        {
+            return tableWidth;
+        }
+
         // We first attempt to look at our custom quick lookup table of char width preferences.
         const auto width = GetQuickCharWidth(glyph.front());
 
@@ -370,6 +416,13 @@ CodepointWidth CodepointWidthDetector::GetWidth(const std::wstring_view glyph) c
 // - true if wch is wide
 bool CodepointWidthDetector::IsWide(const wchar_t wch) const noexcept
 {
+    // Nearly everything is answered by the table. Only glyphs that need the font go the slow way.
+    const auto width = _getBmpWidth(wch);
+    if (width != CodepointWidth::Ambiguous)
+    {
+        return width == CodepointWidth::Wide;
+    }
+
     try
     {
         return IsWide({ &wch, 1 });
@@ -390,6 +443,40 @@ bool CodepointWidthDetector::IsWide(const std::wstring_view glyph) const
     return GetWidth(glyph) == CodepointWidth::Wide;
 }
 
+// Routine Description:
+// - measures a whole string in one go, which saves callers from cutting it into glyphs themselves.
+//   A surrogate pair is measured as one glyph; its leading half gets the glyph's width and its trailing half 0.
+// Arguments:
+// - text - the utf16 encoded string to measure
+// - widths - receives the column width of each wchar in text. Must be at least as long as text.
+// Return Value:
+// - the amount of columns the whole string takes up
+size_t CodepointWidthDetector::GetColumnWidths(const std::wstring_view text, const gsl::span<BYTE> widths) const
+{
+    THROW_HR_IF(E_INVALIDARG, gsl::narrow_cast<size_t>(widths.size()) < text.size());
+
+    size_t columns = 0;
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        const auto wch = til::at(text, i);
+        BYTE width;
+        if (i + 1 < text.size() && Utf16Parser::IsLeadingSurrogate(wch) && Utf16Parser::IsTrailingSurrogate(til::at(text, i + 1)))
+        {
+            width = IsWide(text.substr(i, 2)) ? 2 : 1;
+            til::at(widths, i) = width;
+            til::at(widths, ++i) = 0;
+        }
+        else
+        {
+            width = IsWide(wch) ? 2 : 1;
+            til::at(widths, i) = width;
+        }
+        columns += width;
+    }
+
+    return columns;
+}
+
 // Routine Description:
 // - returns the width type of codepoint by searching the map generated from the unicode spec
 // Arguments:
@@ -22,9 +22,27 @@ bool IsGlyphFullWidth(const std::wstring_view glyph)
 //      wide or not. See CodepointWidthDetector::IsWide
 bool IsGlyphFullWidth(const wchar_t wch) noexcept
 {
+    // Printable ASCII is by far the most common input and always narrow.
+    if (wch >= L' ' && wch <= L'~')
+    {
+        return false;
+    }
     return widthDetector.IsWide(wch);
 }
 
+// Function Description:
+// - measures the column width of every character in the given text.
+//      See CodepointWidthDetector::GetColumnWidths
+// Arguments:
+// - text - the text to measure.
+// - widths - receives the width of each wchar in text, 0 for the trailing half of a surrogate pair.
+// Return Value:
+// - the amount of columns the whole text takes up.
+size_t GetGlyphColumnWidths(const std::wstring_view text, const gsl::span<BYTE> widths)
+{
+    return widthDetector.GetColumnWidths(text, widths);
+}
+
 // Function Description:
 // - Sets a function that should be used by the global CodepointWidthDetector
 //      as the fallback mechanism for determining a particular glyph's width,
@@ -33,6 +33,7 @@ public:
     CodepointWidth GetWidth(const std::wstring_view glyph) const;
     bool IsWide(const std::wstring_view glyph) const;
     bool IsWide(const wchar_t wch) const noexcept;
+    size_t GetColumnWidths(const std::wstring_view text, const gsl::span<BYTE> widths) const;
     void SetFallbackMethod(std::function<bool(const std::wstring_view)> pfnFallback);
     void NotifyFontChanged() const noexcept;
 
@@ -41,11 +42,23 @@ public:
 #endif
 
 private:
+    // The width of every BMP codepoint, packed into 2 bits each. Narrow and Wide are final,
+    // Ambiguous means the answer depends on the font fallback and needs the slow path.
+    using BmpWidthTable = std::array<BYTE, 0x10000 / 4>;
+
+    static const BmpWidthTable& _getBmpWidthTable() noexcept;
+
+    CodepointWidth _getBmpWidth(const wchar_t wch) const noexcept
+    {
+        return static_cast<CodepointWidth>((til::at(_bmpWidths, wch / 4) >> (wch % 4 * 2)) & 0b11);
+    }
+
     CodepointWidth _lookupGlyphWidth(const std::wstring_view glyph) const;
     CodepointWidth _lookupGlyphWidthWithCache(const std::wstring_view glyph) const noexcept;
     bool _checkFallbackViaCache(const std::wstring_view glyph) const;
     static unsigned int _extractCodepoint(const std::wstring_view glyph) noexcept;
 
+    const BmpWidthTable& _bmpWidths;
     mutable std::map<std::wstring, bool> _fallbackCache;
     std::function<bool(std::wstring_view)> _pfnFallbackMethod;
 };
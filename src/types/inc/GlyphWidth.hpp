@@ -14,5 +14,6 @@ Abstract:
 
 bool IsGlyphFullWidth(const std::wstring_view glyph);
 bool IsGlyphFullWidth(const wchar_t wch) noexcept;
+size_t GetGlyphColumnWidths(const std::wstring_view text, const gsl::span<BYTE> widths);
 void SetGlyphWidthFallback(std::function<bool(std::wstring_view)> pfnFallback);
 void NotifyGlyphWidthFontChanged() noexcept;
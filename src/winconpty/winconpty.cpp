@@ -83,17 +83,21 @@ HRESULT _CreatePseudoConsole(const HANDLE hToken,
     RETURN_IF_WIN32_BOOL_FALSE(SetHandleInformation(signalPipeConhostSide.get(), HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT));
 
     // GH4061: Ensure that the path to executable in the format is escaped so C:\Program.exe cannot collide with C:\Program Files
-    const wchar_t* pwszFormat = L"\"%s\" --headless %s%s--width %hu --height %hu --signal 0x%x --server 0x%x";
+    const wchar_t* pwszFormat = L"\"%s\" --headless %s%s%s%s--width %hu --height %hu --signal 0x%x --server 0x%x";
     // This is plenty of space to hold the formatted string
     wchar_t cmd[MAX_PATH]{};
     const BOOL bInheritCursor = (dwFlags & PSEUDOCONSOLE_INHERIT_CURSOR) == PSEUDOCONSOLE_INHERIT_CURSOR;
     const BOOL bResizeQuirk = (dwFlags & PSEUDOCONSOLE_RESIZE_QUIRK) == PSEUDOCONSOLE_RESIZE_QUIRK;
+    const BOOL bPassthroughMode = (dwFlags & PSEUDOCONSOLE_PASSTHROUGH_MODE) == PSEUDOCONSOLE_PASSTHROUGH_MODE;
+    const BOOL bRectangularCopy = (dwFlags & PSEUDOCONSOLE_RECTANGULAR_COPY) == PSEUDOCONSOLE_RECTANGULAR_COPY;
     swprintf_s(cmd,
                MAX_PATH,
                pwszFormat,
                _ConsoleHostPath(),
                bInheritCursor ? L"--inheritcursor " : L"",
                bResizeQuirk ? L"--resizeQuirk " : L"",
+               bPassthroughMode ? L"--passthrough " : L"",
+               bRectangularCopy ? L"--rectangularCopy " : L"",
                size.X,
                size.Y,
                signalPipeConhostSide.get(),
@@ -312,6 +316,15 @@ VOID _ClosePseudoConsole(_In_ PseudoConsole* pPty)
 //      reply to this message, the conpty will not process any input until it
 //      does. Most *nix terminals and the Windows Console (after Windows 10
 //      Anniversary Update) will be able to handle such a message.
+//  PASSTHROUGH_MODE: VT that client applications write is sent to hOutput as
+//      it is, instead of being rendered from the conpty's buffer. Anything
+//      written with the legacy console APIs is still rendered. The terminal
+//      application has to understand everything its clients might emit.
+//  RECTANGULAR_COPY: When the conpty's buffer has a rectangle of the viewport
+//      copied to another place on it, like for a scroll of part of the screen,
+//      the conpty may emit a DECCRA sequence for the terminal to do the same,
+//      instead of repainting where it went. Only set this if the terminal
+//      supports DECCRA.
 
 extern "C" HRESULT WINAPI ConptyCreatePseudoConsole(_In_ COORD size,
                                                     _In_ HANDLE hInput,